@@ -0,0 +1,187 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+ * RNS basis conversion (DCRTPoly::ApproxSwitchCRTBasis) at the shapes the hybrid
+ * key switch produces: sizeQ source towers to sizeP target towers at N = 2^16.
+ * BConvBlocked is the library path (column-blocked GEMM with lazy 128-bit
+ * accumulation); BConvPerCoefficient is the previous per-coefficient loop.
+ * Arguments are (sizeQ, sizeP, modulus bits, ISA: 0 scalar, 1 AVX2, 2 AVX-512 IFMA).
+ * The ISA is clamped to what the CPU supports; AVX2 runs the scalar BConv kernel.
+ */
+
+#include "OffloadDispatcher.h"
+#include "lattice/lat-hal.h"
+#include "math/discreteuniformgenerator.h"
+#include "math/hal/intnat/ntt-simd.h"
+#include "utils/utilities-int.h"
+
+#include "benchmark/benchmark.h"
+
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace lbcrypto;
+
+namespace {
+
+constexpr uint32_t kRingDim  = 1 << 16;
+constexpr uint32_t kMaxSizeQ = 60;
+constexpr uint32_t kMaxSizeP = 12;
+
+struct BConvSetup {
+    std::shared_ptr<ILDCRTParams<BigInteger>> paramsQ;
+    std::shared_ptr<ILDCRTParams<BigInteger>> paramsP;
+    std::vector<NativeInteger> QHatInvModq;
+    std::vector<NativeInteger> QHatInvModqPrecon;
+    std::vector<std::vector<NativeInteger>> QHatModp;
+    std::vector<DoubleNativeInt> modpBarrettMu;
+    DCRTPoly x;
+};
+
+// Prime generation for 72 towers dominates, so one tower set per bit size is shared
+// and each shape takes the first sizeQ towers as Q and the next sizeP as P
+const BConvSetup& GetSetup(uint32_t sizeQ, uint32_t sizeP, uint32_t bits) {
+    static std::map<uint32_t, std::shared_ptr<ILDCRTParams<BigInteger>>> towers;
+    static std::map<std::vector<uint32_t>, BConvSetup> setups;
+    const std::vector<uint32_t> key{sizeQ, sizeP, bits};
+    auto it = setups.find(key);
+    if (it != setups.end())
+        return it->second;
+
+    auto& all = towers[bits];
+    if (!all)
+        all = std::make_shared<ILDCRTParams<BigInteger>>(2 * kRingDim, kMaxSizeQ + kMaxSizeP, bits);
+    const auto& p = all->GetParams();
+
+    BConvSetup s;
+    s.paramsQ = std::make_shared<ILDCRTParams<BigInteger>>(
+        2 * kRingDim, std::vector<std::shared_ptr<ILNativeParams>>(p.begin(), p.begin() + sizeQ));
+    s.paramsP = std::make_shared<ILDCRTParams<BigInteger>>(
+        2 * kRingDim,
+        std::vector<std::shared_ptr<ILNativeParams>>(p.begin() + kMaxSizeQ, p.begin() + kMaxSizeQ + sizeP));
+
+    const BigInteger Q     = s.paramsQ->GetModulus();
+    const auto barrettBase = BigInteger(1).LShiftEq(128);
+    s.QHatModp.resize(sizeQ);
+    for (uint32_t i = 0; i < sizeQ; ++i) {
+        const NativeInteger qi = s.paramsQ->GetParams()[i]->GetModulus();
+        const BigInteger QHati = Q / BigInteger(qi);
+        s.QHatInvModq.push_back(QHati.Mod(BigInteger(qi)).ModInverse(BigInteger(qi)).ConvertToInt());
+        s.QHatInvModqPrecon.push_back(s.QHatInvModq[i].PrepModMulConst(qi));
+        for (uint32_t j = 0; j < sizeP; ++j)
+            s.QHatModp[i].push_back(QHati.Mod(BigInteger(s.paramsP->GetParams()[j]->GetModulus())).ConvertToInt());
+    }
+    for (uint32_t j = 0; j < sizeP; ++j) {
+        const BigInteger pj(s.paramsP->GetParams()[j]->GetModulus());
+        s.modpBarrettMu.push_back((barrettBase / pj).ConvertToInt<DoubleNativeInt>());
+    }
+
+    DiscreteUniformGeneratorImpl<NativeVector> dug;
+    s.x = DCRTPoly(dug, s.paramsQ, Format::COEFFICIENT);
+
+    return setups.emplace(key, std::move(s)).first->second;
+}
+
+// The loop ApproxSwitchCRTBasis ran before the blocked kernel
+DCRTPoly PerCoefficient(const BConvSetup& s) {
+    const uint32_t sizeQ = s.paramsQ->GetParams().size();
+    const uint32_t sizeP = s.paramsP->GetParams().size();
+    DCRTPoly ans(s.paramsP, Format::COEFFICIENT, true);
+    auto& y = ans.GetAllElements();
+    std::vector<DoubleNativeInt> sum(sizeP);
+#pragma omp parallel for firstprivate(sum)
+    for (uint32_t ri = 0; ri < kRingDim; ++ri) {
+        std::fill(sum.begin(), sum.end(), 0);
+        for (uint32_t i = 0; i < sizeQ; ++i) {
+            const auto& xi = s.x.GetElementAtIndex(i);
+            const auto xQHatInvModqi =
+                xi[ri].ModMulFastConst(s.QHatInvModq[i], xi.GetModulus(), s.QHatInvModqPrecon[i]).ConvertToInt();
+            for (uint32_t j = 0; j < sizeP; ++j)
+                sum[j] += Mul128(xQHatInvModqi, s.QHatModp[i][j].ConvertToInt());
+        }
+        for (uint32_t j = 0; j < sizeP; ++j)
+            y[j][ri] = BarrettUint128ModUint64(sum[j], y[j].GetModulus().ConvertToInt(), s.modpBarrettMu[j]);
+    }
+    return ans;
+}
+
+void BConvBlocked(benchmark::State& state) {
+    const auto& s = GetSetup(state.range(0), state.range(1), state.range(2));
+    OffloadDispatcher::ScopedCpuOnly cpuOnly;
+    const auto isa = intnat::GetNttIsa();
+    intnat::SetNttIsa(static_cast<intnat::NttIsa>(state.range(3)));
+    state.SetLabel(intnat::NttIsaName(intnat::GetNttIsa()));
+
+    for (auto _ : state) {
+        auto y = s.x.ApproxSwitchCRTBasis(s.paramsQ, s.paramsP, s.QHatInvModq, s.QHatInvModqPrecon, s.QHatModp,
+                                          s.modpBarrettMu);
+        benchmark::DoNotOptimize(y);
+    }
+
+    intnat::SetNttIsa(isa);
+}
+
+void BConvPerCoefficient(benchmark::State& state) {
+    const auto& s = GetSetup(state.range(0), state.range(1), state.range(2));
+    for (auto _ : state) {
+        auto y = PerCoefficient(s);
+        benchmark::DoNotOptimize(y);
+    }
+}
+
+void ShapeArguments(benchmark::internal::Benchmark* b, bool withIsa) {
+    if (withIsa)
+        b->ArgNames({"sizeQ", "sizeP", "bits", "isa"});
+    else
+        b->ArgNames({"sizeQ", "sizeP", "bits"});
+    for (int bits : {50, 60}) {
+        for (int sizeQ : {1, 4, 12, 30, 60}) {
+            for (int sizeP : {1, 4, 12}) {
+                if (!withIsa) {
+                    b->Args({sizeQ, sizeP, bits});
+                    continue;
+                }
+                for (int isa : {0, 1, 2})
+                    b->Args({sizeQ, sizeP, bits, isa});
+            }
+        }
+    }
+    b->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+}  // namespace
+
+BENCHMARK(BConvBlocked)->Apply([](benchmark::internal::Benchmark* b) { ShapeArguments(b, true); });
+BENCHMARK(BConvPerCoefficient)->Apply([](benchmark::internal::Benchmark* b) { ShapeArguments(b, false); });
+
+BENCHMARK_MAIN();
@@ -0,0 +1,131 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+ * Thread scaling of the hybrid key switch: DC (digit by digit) vs MP (each of
+ * the INTT, BConv and NTT phases is one parallel loop over digits x towers).
+ * Arguments are (dnum, OpenMP threads); threads go from 1 up to the machine.
+ */
+
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "gen-cryptocontext.h"
+#include "cryptocontext.h"
+#include "keyswitch/hks_strategy.h"
+#include "utils/parallel.h"
+
+#include "benchmark/benchmark.h"
+
+#include <map>
+#include <vector>
+
+using namespace lbcrypto;
+
+namespace {
+
+struct RotationSetup {
+    CryptoContext<DCRTPoly> cc;
+    Ciphertext<DCRTPoly> ct;
+};
+
+// Key generation dominates a run, so one context per dnum is shared
+const RotationSetup& GetSetup(uint32_t dnum) {
+    static std::map<uint32_t, RotationSetup> setups;
+    auto it = setups.find(dnum);
+    if (it != setups.end())
+        return it->second;
+
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 14);
+    parameters.SetMultiplicativeDepth(11);
+    parameters.SetScalingModSize(40);
+    parameters.SetFirstModSize(50);
+    parameters.SetBatchSize(8);
+    parameters.SetKeySwitchTechnique(HYBRID);
+    parameters.SetNumLargeDigits(dnum);
+
+    RotationSetup s;
+    s.cc = GenCryptoContext(parameters);
+    s.cc->Enable(PKE);
+    s.cc->Enable(KEYSWITCH);
+    s.cc->Enable(LEVELEDSHE);
+
+    auto keys = s.cc->KeyGen();
+    s.cc->EvalRotateKeyGen(keys.secretKey, {1});
+    std::vector<double> x = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+    s.ct                  = s.cc->Encrypt(keys.publicKey, s.cc->MakeCKKSPackedPlaintext(x));
+
+    return setups.emplace(dnum, std::move(s)).first->second;
+}
+
+void KeySwitchScaling(benchmark::State& state, HKSStrategy strategy) {
+    const auto& s = GetSetup(state.range(0));
+    OpenFHEParallelControls.SetNumThreads(state.range(1));
+    SetHKSStrategy(strategy);
+
+    for (auto _ : state) {
+        auto rotated = s.cc->EvalRotate(s.ct, 1);
+        benchmark::DoNotOptimize(rotated);
+    }
+
+    SetHKSStrategy(HKSStrategy::DC);
+    OpenFHEParallelControls.SetNumThreads(OpenFHEParallelControls.GetMachineThreads());
+}
+
+void KeySwitchDC(benchmark::State& state) {
+    KeySwitchScaling(state, HKSStrategy::DC);
+}
+
+void KeySwitchMP(benchmark::State& state) {
+    KeySwitchScaling(state, HKSStrategy::MP);
+}
+
+void ScalingArguments(benchmark::internal::Benchmark* b) {
+    const int machineThreads = OpenFHEParallelControls.GetMachineThreads();
+    std::vector<int> threads;
+    for (int t = 1; t < machineThreads; t *= 2)
+        threads.push_back(t);
+    threads.push_back(machineThreads);
+
+    b->ArgNames({"dnum", "threads"});
+    for (int dnum : {2, 3, 4}) {
+        for (int t : threads)
+            b->Args({dnum, t});
+    }
+    b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+}  // namespace
+
+BENCHMARK(KeySwitchDC)->Apply(ScalingArguments);
+BENCHMARK(KeySwitchMP)->Apply(ScalingArguments);
+
+BENCHMARK_MAIN();
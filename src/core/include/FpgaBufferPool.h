@@ -0,0 +1,205 @@
+#ifndef _FPGA_BUFFER_POOL_H_
+#define _FPGA_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// =============================================================
+// Size-bucketed pool of reusable device buffers
+// -------------------------------------------------------------
+// Buffers are keyed by (kernel argument group, bucket size). A bucket is the
+// requested byte count rounded up to the next power of two (minimum
+// kMinBucketBytes), so a 1-limb and a 3-limb request never share a buffer but
+// repeated calls with the same shape always hit.
+//
+// BufferT is xrt::bo inside FpgaManager; it is a template parameter so the pool
+// can be exercised (and unit tested) without XRT or a card.
+// =============================================================
+struct DeviceBufferPoolStats {
+    uint64_t hits     = 0;  // Acquire() served from the free list
+    uint64_t misses   = 0;  // Acquire() had to allocate a new buffer
+    uint64_t releases = 0;  // buffers returned to the pool
+    size_t cached     = 0;  // buffers currently idle in the pool
+    size_t in_use     = 0;  // buffers currently handed out
+    size_t bytes      = 0;  // total bytes owned by the pool (idle + in use)
+};
+
+template <typename BufferT>
+class DeviceBufferPool {
+public:
+    using Factory = std::function<BufferT(size_t bytes, int group)>;
+    using Stats   = DeviceBufferPoolStats;
+
+    static constexpr size_t kMinBucketBytes = 4096;
+
+    // RAII lease on a pooled buffer; returns it to the pool on destruction.
+    class Handle {
+    public:
+        Handle() = default;
+        Handle(const Handle&)            = delete;
+        Handle& operator=(const Handle&) = delete;
+        Handle(Handle&& rhs) noexcept
+            : m_pool{rhs.m_pool}, m_group{rhs.m_group}, m_capacity{rhs.m_capacity}, m_buffer{std::move(rhs.m_buffer)} {
+            rhs.m_pool = nullptr;
+        }
+        Handle& operator=(Handle&& rhs) noexcept {
+            if (this != &rhs) {
+                Release();
+                m_pool     = rhs.m_pool;
+                m_group    = rhs.m_group;
+                m_capacity = rhs.m_capacity;
+                m_buffer   = std::move(rhs.m_buffer);
+                rhs.m_pool = nullptr;
+            }
+            return *this;
+        }
+        ~Handle() {
+            Release();
+        }
+
+        BufferT& Get() {
+            return m_buffer;
+        }
+        const BufferT& Get() const {
+            return m_buffer;
+        }
+        BufferT& operator*() {
+            return m_buffer;
+        }
+        BufferT* operator->() {
+            return &m_buffer;
+        }
+
+        // bucket size actually backing this lease (>= requested bytes)
+        size_t Capacity() const {
+            return m_capacity;
+        }
+        int Group() const {
+            return m_group;
+        }
+        bool Valid() const {
+            return m_pool != nullptr;
+        }
+
+        void Release() {
+            if (m_pool != nullptr) {
+                m_pool->Return(m_group, m_capacity, std::move(m_buffer));
+                m_pool = nullptr;
+            }
+        }
+
+    private:
+        friend class DeviceBufferPool;
+        Handle(DeviceBufferPool* pool, int group, size_t capacity, BufferT&& buffer)
+            : m_pool{pool}, m_group{group}, m_capacity{capacity}, m_buffer{std::move(buffer)} {}
+
+        DeviceBufferPool* m_pool = nullptr;
+        int m_group              = 0;
+        size_t m_capacity        = 0;
+        BufferT m_buffer{};
+    };
+
+    DeviceBufferPool() = default;
+    explicit DeviceBufferPool(Factory factory, size_t maxIdlePerBucket = 4)
+        : m_factory{std::move(factory)}, m_max_idle{maxIdlePerBucket} {}
+
+    DeviceBufferPool(const DeviceBufferPool&)            = delete;
+    DeviceBufferPool& operator=(const DeviceBufferPool&) = delete;
+
+    void SetFactory(Factory factory) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_factory = std::move(factory);
+    }
+
+    // Number of idle buffers kept per (group, bucket); extra releases are freed.
+    void SetMaxIdlePerBucket(size_t n) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_max_idle = n;
+    }
+
+    static size_t BucketSize(size_t bytes) {
+        size_t b = kMinBucketBytes;
+        while (b < bytes)
+            b <<= 1;
+        return b;
+    }
+
+    Handle Acquire(int group, size_t bytes) {
+        const size_t bucket = BucketSize(bytes);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            auto it = m_free.find({group, bucket});
+            if (it != m_free.end() && !it->second.empty()) {
+                BufferT buf = std::move(it->second.back());
+                it->second.pop_back();
+                ++m_stats.hits;
+                --m_stats.cached;
+                ++m_stats.in_use;
+                return Handle(this, group, bucket, std::move(buf));
+            }
+            ++m_stats.misses;
+            ++m_stats.in_use;
+            m_stats.bytes += bucket;
+        }
+        // allocate outside the lock: device allocation can be slow
+        try {
+            return Handle(this, group, bucket, m_factory(bucket, group));
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_stats.in_use;
+            m_stats.bytes -= bucket;
+            throw;
+        }
+    }
+
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    // Clears the hit/miss/release counters; buffer accounting is kept.
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats.hits     = 0;
+        m_stats.misses   = 0;
+        m_stats.releases = 0;
+    }
+
+    // Frees every idle buffer. Leases that are still out are unaffected.
+    void Clear() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& kv : m_free)
+            m_stats.bytes -= kv.second.size() * kv.first.second;
+        m_free.clear();
+        m_stats.cached = 0;
+    }
+
+private:
+    void Return(int group, size_t bucket, BufferT&& buf) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_stats.releases;
+        --m_stats.in_use;
+        auto& list = m_free[{group, bucket}];
+        if (list.size() < m_max_idle) {
+            list.push_back(std::move(buf));
+            ++m_stats.cached;
+        }
+        else {
+            m_stats.bytes -= bucket;
+        }
+    }
+
+    Factory m_factory;
+    size_t m_max_idle = 4;
+    mutable std::mutex m_mutex;
+    std::map<std::pair<int, size_t>, std::vector<BufferT>> m_free;
+    Stats m_stats;
+};
+
+#endif  // _FPGA_BUFFER_POOL_H_
@@ -0,0 +1,232 @@
+#ifndef _FPGA_COMMAND_QUEUE_H_
+#define _FPGA_COMMAND_QUEUE_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// =============================================================
+// Three-stage asynchronous command queue (H2D -> Run -> D2H)
+// -------------------------------------------------------------
+// Each stage runs on its own worker thread, so while the kernel executes op i
+// the H2D copy of op i+1 and the D2H copy of op i-1 proceed in parallel.
+//
+// Double buffering is enforced with two slot counters of size `depth`
+// (default 2, i.e. ping-pong):
+//   - an input slot is taken before H2D and given back after Run finishes
+//     (the device no longer reads the input buffer);
+//   - an output slot is taken before Run and given back after D2H finishes
+//     (the host has drained the output buffer).
+// At most `depth` input and `depth` output buffer sets are therefore live on
+// the device, and with the FpgaManager buffer pool they are the same buffers
+// on every iteration.
+//
+// The queue only sequences callbacks; it knows nothing about XRT, which keeps
+// it usable (and testable) without a card.
+// =============================================================
+class FpgaCommandQueue {
+public:
+    using Stage = std::function<void()>;
+
+    struct Stats {
+        uint64_t submitted    = 0;
+        uint64_t completed    = 0;
+        uint64_t failed       = 0;
+        size_t max_in_flight  = 0;  // peak number of submitted-but-not-completed commands
+        size_t max_overlap    = 0;  // peak number of stages executing at the same time
+    };
+
+    explicit FpgaCommandQueue(size_t depth = 2) : m_depth{depth == 0 ? 1 : depth} {}
+
+    FpgaCommandQueue(const FpgaCommandQueue&)            = delete;
+    FpgaCommandQueue& operator=(const FpgaCommandQueue&) = delete;
+
+    ~FpgaCommandQueue() {
+        Shutdown();
+    }
+
+    // Enqueues one command. Any stage may be empty. The future becomes ready
+    // after D2H completes, or carries the first exception thrown by a stage
+    // (later stages of that command are skipped).
+    std::future<void> Submit(Stage h2d, Stage run, Stage d2h) {
+        auto cmd = std::make_shared<Command>();
+        cmd->h2d = std::move(h2d);
+        cmd->run = std::move(run);
+        cmd->d2h = std::move(d2h);
+        auto fut = cmd->done.get_future();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            StartLocked();
+            ++m_stats.submitted;
+            ++m_in_flight;
+            if (m_in_flight > m_stats.max_in_flight)
+                m_stats.max_in_flight = m_in_flight;
+            m_q_h2d.push_back(std::move(cmd));
+        }
+        m_cv.notify_all();
+        return fut;
+    }
+
+    // Blocks until every submitted command has completed.
+    void Drain() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv_idle.wait(lock, [this] { return m_in_flight == 0; });
+    }
+
+    Stats GetStats() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_stats;
+    }
+
+    void ResetStats() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stats = Stats{};
+    }
+
+    size_t Depth() const {
+        return m_depth;
+    }
+
+private:
+    struct Command {
+        Stage h2d, run, d2h;
+        std::exception_ptr error;
+        std::promise<void> done;
+    };
+    using CommandPtr = std::shared_ptr<Command>;
+
+    void StartLocked() {
+        if (m_started)
+            return;
+        m_started = true;
+        m_free_in = m_free_out = m_depth;
+        m_threads[0]           = std::thread([this] { H2DLoop(); });
+        m_threads[1]           = std::thread([this] { RunLoop(); });
+        m_threads[2]           = std::thread([this] { D2HLoop(); });
+    }
+
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_started)
+                return;
+            m_stop = true;
+        }
+        m_cv.notify_all();
+        for (auto& t : m_threads) {
+            if (t.joinable())
+                t.join();
+        }
+    }
+
+    // runs one stage outside the lock and records the first failure
+    void RunStage(const CommandPtr& cmd, const Stage& stage) {
+        if (!stage || cmd->error)
+            return;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (++m_active > m_stats.max_overlap)
+                m_stats.max_overlap = m_active;
+        }
+        try {
+            stage();
+        }
+        catch (...) {
+            cmd->error = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_active;
+    }
+
+    // pops the next command once `ready` holds; returns nullptr on shutdown
+    template <typename Pred>
+    CommandPtr Pop(std::deque<CommandPtr>& q, Pred ready) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&] { return (m_stop && q.empty()) || (!q.empty() && ready()); });
+        if (q.empty())
+            return nullptr;
+        auto cmd = std::move(q.front());
+        q.pop_front();
+        return cmd;
+    }
+
+    void Push(std::deque<CommandPtr>& q, CommandPtr cmd) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            q.push_back(std::move(cmd));
+        }
+        m_cv.notify_all();
+    }
+
+    void H2DLoop() {
+        while (auto cmd = Pop(m_q_h2d, [this] { return m_free_in > 0; })) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_free_in;
+            }
+            RunStage(cmd, cmd->h2d);
+            Push(m_q_run, std::move(cmd));
+        }
+    }
+
+    void RunLoop() {
+        while (auto cmd = Pop(m_q_run, [this] { return m_free_out > 0; })) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                --m_free_out;
+            }
+            RunStage(cmd, cmd->run);
+            {
+                // the kernel has consumed the input buffers
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_free_in;
+            }
+            Push(m_q_d2h, std::move(cmd));
+        }
+    }
+
+    void D2HLoop() {
+        while (auto cmd = Pop(m_q_d2h, [] { return true; })) {
+            RunStage(cmd, cmd->d2h);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                ++m_free_out;
+                --m_in_flight;
+                ++m_stats.completed;
+                if (cmd->error)
+                    ++m_stats.failed;
+            }
+            m_cv.notify_all();
+            m_cv_idle.notify_all();
+            // complete the future last so callers observe up-to-date stats
+            if (cmd->error)
+                cmd->done.set_exception(cmd->error);
+            else
+                cmd->done.set_value();
+        }
+    }
+
+    const size_t m_depth;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::condition_variable m_cv_idle;
+    std::deque<CommandPtr> m_q_h2d, m_q_run, m_q_d2h;
+    std::thread m_threads[3];
+    size_t m_free_in   = 0;
+    size_t m_free_out  = 0;
+    size_t m_in_flight = 0;
+    size_t m_active    = 0;
+    bool m_started     = false;
+    bool m_stop        = false;
+    Stats m_stats;
+};
+
+#endif  // _FPGA_COMMAND_QUEUE_H_
@@ -11,6 +11,20 @@
 #include <algorithm> // std::max, std::find
 #include <numeric>   // std::gcd (C++17)
 
+#include <atomic>
+#include <chrono>
+#include <cstdio>     // std::rename, std::snprintf
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include "FpgaBufferPool.h"
+#include "FpgaCommandQueue.h"
+#include "PolyAccelerator.h"
+
 // =============================================================
 // 1. XRT Configuration (不变)
 // =============================================================
@@ -35,21 +49,8 @@
 #endif
 
 // =============================================================
-// 2. Definitions 
+// 2. Definitions（opcode / 维度常量见 PolyAccelerator.h）
 // =============================================================
-#define OP_INIT   0
-#define OP_ADD    1
-#define OP_SUB    2
-#define OP_MULT   3
-#define OP_NTT    4
-#define OP_INTT   5
-#define OP_BCONV  6
-#define OP_AUTO   7
-
-#define MAX_LIMBS 5 
-#define FPGA_RING_DIM  4096
-#define STAGE_NUM 12 
-
 inline std::string GetXclbinPath() {
     const char* mode = std::getenv("XCL_EMULATION_MODE");
     std::string base = "/home/timhan/FHE/openfhe-for-HKS-ACC/src/fpga_backend/";
@@ -82,88 +83,30 @@ public:
         return Power(n, mod - 2, mod);
     }
 
-    static uint64_t GCD(uint64_t a, uint64_t b) {
-        while (b) {
-            a %= b;
-            std::swap(a, b);
-        }
-        return a;
-    }
-
-    static std::vector<uint64_t> GetPrimeFactors(uint64_t n) {
-        std::vector<uint64_t> factors;
-        uint64_t temp = n;
-        for (uint64_t i = 2; i * i <= temp; ++i) {
-            if (temp % i == 0) {
-                factors.push_back(i);
-                while (temp % i == 0) {
-                    temp /= i;
-                }
-            }
-        }
-        if (temp > 1) {
-            factors.push_back(temp);
-        }
-        return factors;
+    static size_t BitReverse(size_t x, int bits) {
+        size_t r = 0;
+        for (int b = 0; b < bits; ++b)
+            r |= ((x >> b) & 1) << (bits - 1 - b);
+        return r;
     }
 
-    static bool IsPrimitiveRoot(uint64_t a, uint64_t p) {
-        if (GCD(a, p) != 1) return false;
-        uint64_t phi = p - 1;  
-        std::vector<uint64_t> factors = GetPrimeFactors(phi);
-        if (factors.empty()) return false; 
-
-        for (uint64_t q_i : factors) {
-            // 使用 128 位进行中间计算
-            if (Power(a, phi / q_i, p) == 1) {
-                return false;
-            }
-        }
-
-        return true;
-    }
-
-
-    static uint64_t FindSmallestPrimitiveRoot(uint64_t p) {
-        if (p <= 4) return p - 1;
-
-     
-        for (uint64_t g = 2; g < p; ++g) {
-            if (IsPrimitiveRoot(g, p)) {
-                return g; 
-            }
-        }
-        return 0; 
+    static int Log2(size_t n) {
+        int log_n = 0;
+        while (((size_t)1 << log_n) < n)
+            ++log_n;
+        return log_n;
     }
 
-
-    // [修改] 使用 FindSmallestPrimitiveRoot 替换朴素搜索
-    static uint64_t Find2NthRootOfUnity(uint64_t modulus, uint64_t n) {
-        uint64_t required_order = 2 * n; 
-        if ((modulus - 1) % required_order != 0) {
-            throw std::runtime_error("Modulus does not support 2N-th root of unity");
-        }
-        
-        // 1. 找到最小原根 g (SymPy 的 'pr')
-        // WARNING: 这个调用可能非常慢，因为它包含了大数的质因数分解。
-        uint64_t primitive_root_g = FindSmallestPrimitiveRoot(modulus);
-        
-        if (primitive_root_g == 0) {
-            throw std::runtime_error("Failed to find smallest primitive root for the modulus.");
-        }
-        
-        unsigned __int128 exponent = (modulus - 1) / required_order;
-        uint64_t psi = Power(primitive_root_g, exponent, modulus);
-
-        // 3. 验证性质: psi^N == -1 (即 p-1)
-        if (Power(psi, n, modulus) == (modulus - 1)) {
-            return psi;
-        } else {
-             throw std::runtime_error("Calculated Psi failed the N-th power test. Primitive root found but exponentiation error.");
+    // out[br(i)] = psi^i，与 ChineseRemainderTransformFTTNat 的 bit-reverse 表相同
+    static void BitReversedPowers(uint64_t psi, uint64_t mod, size_t n, uint64_t* out) {
+        const int log_n = Log2(n);
+        uint64_t w      = 1;
+        for (size_t i = 0; i < n; ++i) {
+            out[BitReverse(i, log_n)] = w;
+            w = (uint64_t)(((unsigned __int128)w * psi) % mod);
         }
     }
 
-
     static std::vector<int> GenerateTwiddleIndices(int n) {
         std::vector<int> index = {0};
         for (int i = 0; i < STAGE_NUM; ++i) {
@@ -180,126 +123,262 @@ public:
 };
 
 // =============================================================
-// 4. FPGA Manager Class 
+// 4. FPGA Manager Class（PolyAccelerator 的 XRT 后端）
 // =============================================================
-class FpgaManager {
+class FpgaManager : public PolyAccelerator {
 public:
     static FpgaManager& GetInstance() {
         static FpgaManager instance;
         return instance;
     }
 
-    bool IsReady() const { return m_is_ready; }
+    const char* Name() const override { return "fpga"; }
 
+    bool IsReady() const override { return m_is_ready; }
+
+// ----------------------------------------------------------------------
+// InitModuli: 模数 + twiddle 打包成一个设备镜像，一次 DMA 上传
 // ----------------------------------------------------------------------
-// InitModuli: 接收 CPU 的 Roots -> Index -> Permute -> Pack
+// ringDim: 上下文的环维度，roots 为对应的 2*ringDim 次本原单位根。
+// ringDim == FPGA_RING_DIM 时还装载片上 [64][64] 参数表（OP_INIT），供逐元素运算和融合 opcode 使用；
+// 主机侧的 NTT/INTT（N 最大 FPGA_MAX_RING_DIM，任意 limb 数）都由 OP_NTT_STREAM 处理。
+// twiddle 优先取 ChineseRemainderTransformFTTNat 已缓存的 bit-reverse 表（见 SetTwiddleTableLookup）；
+// 设置了缓存目录（OPENFHE_FPGA_TWIDDLE_CACHE）时，打包好的镜像按模数集合存盘，下次启动直接读入。
 // ----------------------------------------------------------------------
     void InitModuli(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
-                    const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots) {
+                    const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots,
+                    size_t ringDim = FPGA_RING_DIM) override {
     #ifdef OPENFHE_FPGA_ENABLE
         if (!m_is_ready) return;
-        
-        size_t n_q = q_mods.size();
-        size_t n_p = p_mods.size();
-        size_t total_limbs = n_q + n_p;
-        const int N = FPGA_RING_DIM;
 
-        std::cout << "[Host] InitModuli: Q=" << n_q << ", P=" << n_p << std::endl;
+        // 参数重载前必须等待所有异步命令结束
+        m_queue.Drain();
 
         m_stored_moduli.clear();
+        m_num_q = q_mods.size();
         m_stored_moduli.insert(m_stored_moduli.end(), q_mods.begin(), q_mods.end());
         m_stored_moduli.insert(m_stored_moduli.end(), p_mods.begin(), p_mods.end());
 
-        // 🔥 将从 CPU 传来的单位根合并
         std::vector<uint64_t> combined_roots;
         combined_roots.insert(combined_roots.end(), q_roots.begin(), q_roots.end());
         combined_roots.insert(combined_roots.end(), p_roots.begin(), p_roots.end());
 
-        std::vector<uint64_t> K_vals(total_limbs), M_vals(total_limbs);
-        for(size_t i=0; i<total_limbs; i++) {
-            uint64_t p = m_stored_moduli[i];
-            int k = (int)std::ceil(std::log2((double)p));
-            unsigned __int128 power = (unsigned __int128)1 << (2 * k);
-            uint64_t m = (uint64_t)(power / p);
-            K_vals[i] = k;
-            M_vals[i] = m;
-            std::cout << "  [Barrett] idx=" << i << ": mod=" << p << ", k=" << k << ", m=" << m << std::endl;
-        }
-
-        std::vector<uint64_t> all_ntt_twiddles(total_limbs * N);
-        std::vector<uint64_t> all_intt_twiddles(total_limbs * N);
-
-        for(size_t limb = 0; limb < total_limbs; limb++) {
-            uint64_t mod = m_stored_moduli[limb];
-            
-            // 🔥 直接使用 CPU 提取好的单位根，绝对不再自己瞎算！
-            uint64_t psi = combined_roots[limb]; 
-            uint64_t psi_inv = MathUtils::ModInverse(psi, mod);
-
-            uint64_t w = 1;
-            uint64_t w_inv = 1;
-
-            for(int i = 0; i < N; i++) {
-                all_ntt_twiddles[limb * N + i] = w;
-                all_intt_twiddles[limb * N + i] = w_inv;
-                w = ((unsigned __int128)w * psi) % mod;
-                w_inv = ((unsigned __int128)w_inv * psi_inv) % mod;
-            }
+        m_ring_dim = 0;
+        m_stream_image[0].reset();
+        m_stream_image[1].reset();
+        m_init_image.reset();
+
+        FpgaInitImage image = LoadOrPackInitImage(q_mods, p_mods, combined_roots, ringDim);
+        if (image.words.empty()) {
+            std::cerr << "[FPGA Warning] Ring dimension " << ringDim << " is not supported by the kernel" << std::endl;
+            return;
         }
 
-        std::vector<int> perm_index = MathUtils::GenerateTwiddleIndices(N);
-        std::vector<uint64_t> permuted_ntt(total_limbs * N);
-        std::vector<uint64_t> permuted_intt(total_limbs * N);
+        // 整个镜像一次 DMA；流式 NTT 的正/逆镜像是它的子 buffer，常驻设备
+        const size_t bytes = image.words.size() * sizeof(uint64_t);
+        m_init_image       = std::make_unique<xrt::bo>(m_device, bytes, m_kernel_top.group_id(1));
+        m_init_image->write(image.words.data(), bytes, 0);
+        m_init_image->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+        m_h2d_bytes += bytes;
+
+        if (image.stream_words != 0) {
+            for (int inv = 0; inv < 2; ++inv)
+                m_stream_image[inv] = std::make_unique<xrt::bo>(*m_init_image, image.stream_words * sizeof(uint64_t),
+                                                                image.stream_offset[inv] * sizeof(uint64_t));
+            m_ring_dim = ringDim;
+        }
 
-        for (size_t limb = 0; limb < total_limbs; limb++) {
-            size_t base_offset = limb * N;
-            for (size_t i = 0; i < perm_index.size(); ++i) {
-                permuted_ntt[base_offset + i]  = all_ntt_twiddles[base_offset + perm_index[i]];
-                permuted_intt[base_offset + i] = all_intt_twiddles[base_offset + perm_index[i]];
-            }
+        // 片上 [64][64] 路径只认 FPGA_RING_DIM；OP_INIT 从设备镜像里取两段参数
+        if (image.init_p_offset != 0) {
+            auto bo_in  = m_bo_pool.Acquire(m_kernel_top.group_id(0), sizeof(uint64_t));
+            auto bo_out = m_bo_pool.Acquire(m_kernel_top.group_id(2), sizeof(uint64_t));
+            auto run    = m_kernel_top(*bo_in, *m_init_image, *bo_out, OP_INIT, 0, (int)image.init_p_offset);
+            run.wait();
+            CountTransfer(0, 0);
         }
+    #endif
+    }
+
+    // ============================================================
+    // 设备初始化镜像
+    // ------------------------------------------------------------
+    // [OP_INIT 段 1: Q 参数 + NTT twiddle] [OP_INIT 段 2: P 参数 + INTT twiddle]   (仅 N == FPGA_RING_DIM)
+    // [流式 NTT 正变换镜像] [流式 NTT 逆变换镜像]                                  (N <= FPGA_MAX_RING_DIM)
+    // 各段起点按 FPGA_IMAGE_ALIGN_WORDS 对齐（子 buffer 偏移要求）。
+    // ============================================================
+    static const size_t FPGA_IMAGE_ALIGN_WORDS = 512;  // 4 KiB
+    static const uint64_t FPGA_IMAGE_MAGIC     = 0x4d49574654454846ULL;  // "FHETFWIM"
+    static const uint64_t FPGA_IMAGE_VERSION   = 2;
+
+    struct FpgaInitImage {
+        uint64_t ring_dim = 0;
+        uint64_t num_q    = 0;
+        std::vector<uint64_t> moduli;        // Q 后接 P
+        std::vector<uint64_t> roots;         // 与 moduli 对应的 2N 次本原单位根
+        uint64_t init_p_offset    = 0;       // OP_INIT 段 2 的字偏移（0: 无 OP_INIT 段）
+        uint64_t stream_offset[2] = {0, 0};  // 流式镜像的字偏移：[0] 正变换, [1] 逆变换
+        uint64_t stream_words     = 0;       // 每个流式镜像的字数（0: 无）
+        std::vector<uint64_t> words;
+    };
+
+    // 打包镜像的存盘目录（空: 不缓存）。默认取环境变量 OPENFHE_FPGA_TWIDDLE_CACHE
+    void SetTwiddleCacheDir(const std::string& dir) {
+        std::lock_guard<std::mutex> lock(m_init_mutex);
+        m_twiddle_cache_dir = dir;
+    }
 
-        const int PARAMS_PER_LIMB = 3; 
-        size_t buf1_size = n_q * PARAMS_PER_LIMB + total_limbs * N;
-        std::vector<uint64_t> buf1_Q(buf1_size);
-        for(size_t i=0; i<n_q; i++) {
-            buf1_Q[i] = m_stored_moduli[i];           
-            buf1_Q[n_q + i] = K_vals[i];              
-            buf1_Q[n_q*2 + i] = M_vals[i];            
+    static FpgaInitImage PackInitImage(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                                       const std::vector<uint64_t>& roots, size_t n,
+                                       const TwiddleTableLookup& lookup = nullptr) {
+        FpgaInitImage image;
+        image.ring_dim = n;
+        image.num_q    = q_mods.size();
+        image.moduli   = q_mods;
+        image.moduli.insert(image.moduli.end(), p_mods.begin(), p_mods.end());
+        image.roots = roots;
+        if (!IsStreamRingDim(n))
+            return image;
+
+        std::vector<std::vector<uint64_t>> owned;
+        std::vector<const uint64_t*> fwd, inv;
+        ResolveTwiddles(image.moduli, roots, n, lookup, owned, fwd, inv);
+
+        const size_t n_q   = q_mods.size();
+        const size_t total = image.moduli.size();
+        auto align         = [](size_t w) { return (w + FPGA_IMAGE_ALIGN_WORDS - 1) / FPGA_IMAGE_ALIGN_WORDS * FPGA_IMAGE_ALIGN_WORDS; };
+
+        // OP_INIT 段按 kernel 的固定槽位布局（见 OnChipSlot），与实际的 Q / P 个数无关
+        const size_t slot_q  = KERNEL_LIMB_Q;
+        const size_t slot_p  = MAX_LIMBS - KERNEL_LIMB_Q;
+        size_t init_words[2] = {0, 0};
+        if (n == FPGA_RING_DIM) {
+            init_words[0] = slot_q * 3 + MAX_LIMBS * n;
+            init_words[1] = slot_p * 3 + MAX_LIMBS * n;
+        }
+        image.stream_words     = NTT_STREAM_HDR_WORDS + total * (NTT_STREAM_LIMB_WORDS + n);
+        image.init_p_offset    = n == FPGA_RING_DIM ? align(init_words[0]) : 0;
+        const size_t init_end  = n == FPGA_RING_DIM ? align(image.init_p_offset + init_words[1]) : 0;
+        image.stream_offset[0] = init_end;
+        image.stream_offset[1] = align(init_end + image.stream_words);
+        image.words.assign(image.stream_offset[1] + image.stream_words, 0);
+
+        if (n == FPGA_RING_DIM) {
+            // OP_INIT 段: [MODULUS] [K_HALF] [M] 各 KERNEL_LIMB_Q (段 2 为 LIMB_P) 个，之后 MAX_LIMBS 个槽位的 twiddle，
+            // 自然顺序 psi^i 按 GenerateTwiddleIndices 置换（自然顺序 i 的值即 bit-reverse 表的 br(i) 项）。
+            // 放不进片上表的模数和空槽位保持 0
+            const int log_n     = MathUtils::Log2(n);
+            std::vector<int> perm = MathUtils::GenerateTwiddleIndices((int)n);
+            for (int seg = 0; seg < 2; ++seg) {
+                uint64_t* base     = image.words.data() + (seg == 0 ? 0 : image.init_p_offset);
+                const size_t count = seg == 0 ? slot_q : slot_p;
+                uint64_t* tf       = base + 3 * count;
+                for (size_t l = 0; l < total; ++l) {
+                    const int slot = OnChipSlot(l, n_q);
+                    if (slot < 0)
+                        continue;
+                    const size_t s = (size_t)slot - (seg == 0 ? 0 : slot_q);
+                    if ((seg == 0) == (l < n_q)) {
+                        base[s] = image.moduli[l];
+                        BarrettConsts(image.moduli[l], base[count + s], base[2 * count + s]);
+                    }
+                    const uint64_t* table = seg == 0 ? fwd[l] : inv[l];
+                    for (size_t i = 0; i < perm.size(); ++i)
+                        tf[slot * n + i] = table[MathUtils::BitReverse(perm[i], log_n)];
+                }
+            }
         }
-        memcpy(buf1_Q.data() + n_q * PARAMS_PER_LIMB, permuted_ntt.data(), total_limbs * N * sizeof(uint64_t));
 
-        size_t buf2_size = n_p * PARAMS_PER_LIMB + total_limbs * N;
-        std::vector<uint64_t> buf2_P(buf2_size);
-        for(size_t i=0; i<n_p; i++) {
-            size_t global_idx = n_q + i; 
-            buf2_P[i] = m_stored_moduli[global_idx];        
-            buf2_P[n_p + i] = K_vals[global_idx];           
-            buf2_P[n_p*2 + i] = M_vals[global_idx];         
+        for (int dir = 0; dir < 2; ++dir) {
+            uint64_t* base             = image.words.data() + image.stream_offset[dir];
+            base[NTT_STREAM_LOG_N]     = MathUtils::Log2(n);
+            base[NTT_STREAM_INVERSE]   = dir;
+            for (size_t l = 0; l < total; ++l) {
+                uint64_t* p = base + NTT_STREAM_HDR_WORDS + l * (NTT_STREAM_LIMB_WORDS + n);
+                p[0]        = image.moduli[l];
+                BarrettConsts(image.moduli[l], p[1], p[2]);
+                std::memcpy(p + NTT_STREAM_LIMB_WORDS, dir == 0 ? fwd[l] : inv[l], n * sizeof(uint64_t));
+            }
         }
-        memcpy(buf2_P.data() + n_p * PARAMS_PER_LIMB, permuted_intt.data(), total_limbs * N * sizeof(uint64_t));
+        return image;
+    }
 
-        // 探针：如果这里打印出来了，说明准备工作完毕，即将呼叫硬件
-        std::cout << "[DEBUG] Ready to allocate XRT buffers..." << std::endl;
+    // 镜像缓存文件名由 (N, 模数, 单位根) 的 FNV-1a 哈希决定；读入时逐项校验
+    static uint64_t InitImageKey(const FpgaInitImage& image) {
+        uint64_t h   = 1469598103934665603ULL;
+        auto mix     = [&h](uint64_t v) {
+            for (int b = 0; b < 8; ++b) {
+                h ^= (v >> (8 * b)) & 0xff;
+                h *= 1099511628211ULL;
+            }
+        };
+        mix(FPGA_IMAGE_VERSION);
+        mix(image.ring_dim);
+        mix(image.num_q);
+        for (uint64_t q : image.moduli)
+            mix(q);
+        for (uint64_t r : image.roots)
+            mix(r);
+        return h;
+    }
 
-        auto bo_1 = xrt::bo(m_device, buf1_Q.size() * sizeof(uint64_t), m_kernel_top.group_id(0));
-        auto bo_2 = xrt::bo(m_device, buf2_P.size() * sizeof(uint64_t), m_kernel_top.group_id(1));
-        auto bo_out = xrt::bo(m_device, 8, m_kernel_top.group_id(2)); 
+    static std::string InitImageCachePath(const std::string& dir, const FpgaInitImage& image) {
+        char name[64];
+        std::snprintf(name, sizeof(name), "fpga-init-%016llx.bin", (unsigned long long)InitImageKey(image));
+        return dir + "/" + name;
+    }
 
-        bo_1.write(buf1_Q.data());
-        bo_2.write(buf2_P.data());
-        
-        bo_1.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-        bo_2.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+    static bool SaveInitImage(const std::string& path, const FpgaInitImage& image) {
+        const std::string tmp = path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+            if (!out)
+                return false;
+            const uint64_t header[] = {FPGA_IMAGE_MAGIC,          FPGA_IMAGE_VERSION,      image.ring_dim,
+                                       image.num_q,               image.moduli.size(),     image.init_p_offset,
+                                       image.stream_offset[0],    image.stream_offset[1],  image.stream_words,
+                                       image.words.size()};
+            out.write(reinterpret_cast<const char*>(header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(image.moduli.data()), image.moduli.size() * sizeof(uint64_t));
+            out.write(reinterpret_cast<const char*>(image.roots.data()), image.roots.size() * sizeof(uint64_t));
+            out.write(reinterpret_cast<const char*>(image.words.data()), image.words.size() * sizeof(uint64_t));
+            if (!out)
+                return false;
+        }
+        // 先写临时文件再改名，并发启动的进程不会读到半个镜像
+        return std::rename(tmp.c_str(), path.c_str()) == 0;
+    }
 
-        std::cout << "[Host] Launching Init Kernel..." << std::endl;
-        auto run = m_kernel_top(bo_1, bo_2, bo_out, OP_INIT, 0, 0); 
-        run.wait();
-        
-        std::cout << "[Host] FPGA Parameter Init Complete." << std::endl;
-    #endif
+    // image 传入期望的 ring_dim / num_q / moduli / roots；文件与之不符（或损坏）返回 false
+    static bool LoadInitImage(const std::string& path, FpgaInitImage& image) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return false;
+        uint64_t header[10];
+        if (!in.read(reinterpret_cast<char*>(header), sizeof(header)))
+            return false;
+        const size_t total = image.moduli.size();
+        if (header[0] != FPGA_IMAGE_MAGIC || header[1] != FPGA_IMAGE_VERSION || header[2] != image.ring_dim ||
+            header[3] != image.num_q || header[4] != total || image.roots.size() != total)
+            return false;
+        std::vector<uint64_t> moduli(total), roots(total);
+        in.read(reinterpret_cast<char*>(moduli.data()), total * sizeof(uint64_t));
+        in.read(reinterpret_cast<char*>(roots.data()), total * sizeof(uint64_t));
+        if (!in || moduli != image.moduli || roots != image.roots)
+            return false;
+        const uint64_t words = header[9];
+        if (header[8] == 0 || header[6] + header[8] > words || header[7] + header[8] > words || header[5] > words)
+            return false;
+        std::vector<uint64_t> data(words);
+        if (!in.read(reinterpret_cast<char*>(data.data()), words * sizeof(uint64_t)))
+            return false;
+        image.init_p_offset    = header[5];
+        image.stream_offset[0] = header[6];
+        image.stream_offset[1] = header[7];
+        image.stream_words     = header[8];
+        image.words            = std::move(data);
+        return true;
     }
-    
+
     // --- 其他函数 (Execute, Wrappers) 保持不变 ---
     void Execute(
         uint8_t opcode, 
@@ -314,90 +393,103 @@ public:
         try {
             size_t size_bytes = (size_t)num_limbs * FPGA_RING_DIM * sizeof(uint64_t);
             size_t out_size_bytes = size_bytes;
-            auto bo_in1 = xrt::bo(m_device, size_bytes, m_kernel_top.group_id(0));
-            auto bo_out = xrt::bo(m_device, out_size_bytes, m_kernel_top.group_id(2));
+            auto bo_in1 = m_bo_pool.Acquire(m_kernel_top.group_id(0), size_bytes);
+            auto bo_out = m_bo_pool.Acquire(m_kernel_top.group_id(2), out_size_bytes);
 
-            bo_in1.write(in1);
-            bo_in1.sync(XCL_BO_SYNC_BO_TO_DEVICE);
+            bo_in1->write(in1, size_bytes, 0);
+            bo_in1->sync(XCL_BO_SYNC_BO_TO_DEVICE, size_bytes, 0);
 
-            xrt::bo bo_in2;
+            // in2 == nullptr: kernel 只读 mem_in1, mem_in2 复用同一个 bo
+            DeviceBufferPool<xrt::bo>::Handle bo_in2;
             if (in2 && in2 != in1) {
                 size_t in2_size_bytes = size_bytes;
-                bo_in2 = xrt::bo(m_device, in2_size_bytes, m_kernel_top.group_id(1));
-                bo_in2.write(in2);
-                bo_in2.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-            } else { 
-                bo_in2 = bo_in1; 
+                bo_in2 = m_bo_pool.Acquire(m_kernel_top.group_id(1), in2_size_bytes);
+                bo_in2->write(in2, in2_size_bytes, 0);
+                bo_in2->sync(XCL_BO_SYNC_BO_TO_DEVICE, in2_size_bytes, 0);
             }
 
-            auto run = m_kernel_top(bo_in1, bo_in2, bo_out, opcode, num_limbs, mod_idx);
+            auto run = m_kernel_top(*bo_in1, bo_in2.Valid() ? *bo_in2 : *bo_in1, *bo_out, opcode, num_limbs, mod_idx);
             run.wait();
-            
 
-            bo_out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-            bo_out.read(out);
+            bo_out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, out_size_bytes, 0);
+            bo_out->read(out, out_size_bytes, 0);
+            CountTransfer(size_bytes * (bo_in2.Valid() ? 2 : 1), out_size_bytes);
         } catch (const std::exception& e) {
             std::cerr << "[FPGA Exec Error] " << e.what() << std::endl;
         }
     #endif
     }
 
+    bool HasModulus(uint64_t modulus) const override {
+        return std::find(m_stored_moduli.begin(), m_stored_moduli.end(), modulus) != m_stored_moduli.end();
+    }
+
     int GetModIndex(uint64_t modulus) {
-        auto it = std::find(m_stored_moduli.begin(), m_stored_moduli.end(), modulus);
-        if (it != m_stored_moduli.end()) {
-            return (int)std::distance(m_stored_moduli.begin(), it);
+        const int slot = OnChipIndices(&modulus, 1)[0];
+        if (slot >= 0) {
+            return slot;
         } else {
             std::cerr << "[FPGA Warning] Modulus " << modulus << " not found! Using 0." << std::endl;
             return 0;
         }
     }
 
-    void NttForwardOffload(
+    bool NttForwardOffload(
         const uint64_t* in, 
         uint64_t* out, 
         uint64_t modulus, 
         size_t n
-    ) {
+    ) override {
+        // 走 OP_NTT_STREAM：片上 OP_NTT/OP_INTT 的求值域是按行错位的（第 r 行循环右移 r），与 CPU 的顺序不同
+        if (!SupportsRingDim(n) || !HasModulus(modulus))
+            return false;
         std::cout << "=== [FPGA] Execute NTT ===" << std::endl;
-        int mod_idx = GetModIndex(modulus);
-        if (n != FPGA_RING_DIM) {
-            std::cerr << "[FPGA Warning] NTT size " << n << " != FPGA_RING_DIM " << FPGA_RING_DIM << std::endl;
-            return;
-        }
-        Execute(OP_NTT, in, nullptr, out, 1, mod_idx);
+        if (in != out)
+            std::copy(in, in + n, out);
+        if (!NttBatchOffload(true, &out, &modulus, 1, n))
+            return false;
         if (std::getenv("OPENFHE_NTT_DUMP")) {
             const size_t dumpLen = std::min(n, (size_t)16);
             std::cerr << "[NTT_DUMP] NTT forward first " << dumpLen << " in/out (mod=" << modulus << "):" << std::endl;
             std::cerr << "  in :"; for (size_t i = 0; i < dumpLen; ++i) std::cerr << " " << in[i]; std::cerr << std::endl;
             std::cerr << "  out:"; for (size_t i = 0; i < dumpLen; ++i) std::cerr << " " << out[i]; std::cerr << std::endl;
         }
+        return true;
     }
 
-    void NttInverseOffload(
+    bool NttInverseOffload(
         const uint64_t* in, 
         uint64_t* out, 
         uint64_t modulus, 
         size_t n
-    ) {
+    ) override {
+        // 与 NttForwardOffload 相同走 OP_NTT_STREAM
+        if (!SupportsRingDim(n) || !HasModulus(modulus))
+            return false;
         std::cout << "=== [FPGA] Execute INTT ===" << std::endl;
-        int mod_idx = GetModIndex(modulus);
-        Execute(OP_INTT, in, nullptr, out, 1, mod_idx);
+        if (in != out)
+            std::copy(in, in + n, out);
+        if (!NttBatchOffload(false, &out, &modulus, 1, n))
+            return false;
         if (std::getenv("OPENFHE_NTT_DUMP")) {
             const size_t dumpLen = std::min(n, (size_t)16);
             std::cerr << "[NTT_DUMP] INTT first " << dumpLen << " in/out (mod=" << modulus << "):" << std::endl;
             std::cerr << "  in :"; for (size_t i = 0; i < dumpLen; ++i) std::cerr << " " << in[i]; std::cerr << std::endl;
             std::cerr << "  out:"; for (size_t i = 0; i < dumpLen; ++i) std::cerr << " " << out[i]; std::cerr << std::endl;
         }
+        return true;
     }
 
-    void AutoOffload(
+    bool AutoOffload(
         const uint64_t* in,
         uint64_t* out,
         uint32_t k,
         uint32_t kinv,
         uint64_t modulus,
         size_t n
-    ) {
+    ) override {
+        if (!CanExecute(modulus, n))
+            return false;
         std::cout << "=== [FPGA] Execute Auto (k=" << k << ", kinv=" << kinv << ") ===" << std::endl;
         int mod_idx = GetModIndex(modulus);
         size_t meta_size = FPGA_RING_DIM;  // Execute expects in2 same size as poly
@@ -405,6 +497,7 @@ public:
         meta[0] = (uint64_t)k;
         meta[1] = (uint64_t)kinv;
         Execute(OP_AUTO, in, meta.data(), out, 1, mod_idx);
+        return true;
     }
 
     // ============================================================
@@ -444,127 +537,961 @@ public:
     }
 
     // ============================================================
-    // 批量limb操作（一次kernel调用处理所有limb）
-    // 要求：所有limb的模数索引是连续的（从mod_idx_start开始）
+    // 批量 limb 操作（OP_ADD / OP_SUB / OP_MULT）
+    // ------------------------------------------------------------
+    // 与 NttBatchOffload 相同：tower 按片上连续模数索引切段，每段一次 kernel 调用，
+    // 每个 tower 直接写到 bo 的对应偏移，不经过中间 flat buffer。
     // ============================================================
-    void ModOpBatchOffload(
-        int opcode,             // OP_ADD, OP_SUB, or OP_MUL (注意是OP_MUL不是OP_MULT)
-        const uint64_t* a,      // [numLimbs × ringDim]
-        const uint64_t* b,      // [numLimbs × ringDim]
-        uint64_t* result,       // [numLimbs × ringDim]
-        int mod_idx_start,      // 起始模数索引
-        size_t ringDim,
-        size_t numLimbs
-    ) {
+    bool ModOpOffload(int opcode, const uint64_t* const* a, const uint64_t* const* b, uint64_t* const* out,
+                      const uint64_t* moduli, size_t numTowers, size_t n) override {
     #ifdef OPENFHE_FPGA_ENABLE
-        if (!m_is_ready) return;
-        
-        std::cout << "=== [FPGA] Batch Op=" << opcode << " numLimbs=" << numLimbs 
-                  << " modStart=" << mod_idx_start << " ===" << std::endl;
-
+        if (!m_is_ready || n != FPGA_RING_DIM || numTowers == 0)
+            return false;
+        auto runs = PlanLimbRuns(OnChipIndices(moduli, numTowers));
+        if (runs.empty())
+            return false;
+
+        const size_t limb_bytes = n * sizeof(uint64_t);
+        // 先读回 scratch，全部段成功后才写 out：out 可能与 a/b 相同，中途失败时输入原样，调用者可以回退 CPU
+        std::vector<uint64_t> scratch(numTowers * n);
         try {
-            size_t total_size = numLimbs * ringDim * sizeof(uint64_t);
-            
-            auto bo_a = xrt::bo(m_device, total_size, m_kernel_top.group_id(0));
-            auto bo_b = xrt::bo(m_device, total_size, m_kernel_top.group_id(1));
-            auto bo_out = xrt::bo(m_device, total_size, m_kernel_top.group_id(2));
-
-            // 一次性传输所有数据
-            bo_a.write(a);
-            bo_a.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-            
-            bo_b.write(b);
-            bo_b.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-
-            // 一次kernel调用处理所有limb
-            // num_active_limbs = numLimbs, mod_index = mod_idx_start
-            auto run = m_kernel_top(bo_a, bo_b, bo_out, opcode, (int)numLimbs, mod_idx_start);
-            run.wait();
+            for (const auto& r : runs) {
+                const size_t bytes = r.count * limb_bytes;
+                auto bo_a   = m_bo_pool.Acquire(m_kernel_top.group_id(0), bytes);
+                auto bo_b   = m_bo_pool.Acquire(m_kernel_top.group_id(1), bytes);
+                auto bo_out = m_bo_pool.Acquire(m_kernel_top.group_id(2), bytes);
+
+                for (size_t l = 0; l < r.count; ++l) {
+                    bo_a->write(a[r.first + l], limb_bytes, l * limb_bytes);
+                    bo_b->write(b[r.first + l], limb_bytes, l * limb_bytes);
+                }
+                bo_a->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+                bo_b->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
 
-            // 一次性读取所有结果
-            bo_out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-            bo_out.read(result);
+                auto run = m_kernel_top(*bo_a, *bo_b, *bo_out, opcode, (int)r.count, r.mod_idx);
+                run.wait();
+
+                bo_out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, bytes, 0);
+                bo_out->read(scratch.data() + r.first * n, bytes, 0);
+                CountTransfer(2 * bytes, bytes);
+            }
         } catch (const std::exception& e) {
             std::cerr << "[FPGA Batch Op Error] " << e.what() << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < numTowers; ++i)
+            std::copy(scratch.data() + i * n, scratch.data() + (i + 1) * n, out[i]);
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    // ============================================================
+    // 多limb批量 NTT/INTT（DCRTPoly 所有 tower 一次 kernel 启动）
+    // ------------------------------------------------------------
+    // Kernel 按 mod_index 起的连续模数索引处理 num_active_limbs 个 limb，
+    // 所以 tower 按 "设备模数索引连续" 切成若干段，每段一次启动（最多 MAX_LIMBS 个）。
+    // ============================================================
+    struct LimbRun {
+        size_t first;  // 第一个 tower 的下标
+        size_t count;  // 本段 tower 数
+        int mod_idx;   // 第一个 tower 在设备模数表中的索引
+    };
+
+    // mod_idx[i] < 0 表示该 tower 的模数不在设备上 -> 返回空（整体回退 CPU）
+    static std::vector<LimbRun> PlanLimbRuns(const std::vector<int>& mod_idx, size_t max_limbs = MAX_LIMBS) {
+        std::vector<LimbRun> runs;
+        for (size_t i = 0; i < mod_idx.size(); ++i) {
+            if (mod_idx[i] < 0)
+                return {};
+            if (!runs.empty()) {
+                auto& r = runs.back();
+                if (r.count < max_limbs && mod_idx[i] == r.mod_idx + static_cast<int>(r.count)) {
+                    ++r.count;
+                    continue;
+                }
+            }
+            runs.push_back({i, 1, mod_idx[i]});
+        }
+        return runs;
+    }
+
+    // ============================================================
+    // 流式 NTT（OP_NTT_STREAM）的 twiddle 镜像
+    // ------------------------------------------------------------
+    // 布局与 fpga_backend/include/define.h 的 NTT_STREAM_* 一致：
+    //   [log_n, inverse, 0...]（NTT_STREAM_HDR_WORDS 字）
+    //   每个模数一段: [q, k_half, m, 0] + n 个 twiddle（bit-reverse 顺序，与 OpenFHE 相同）
+    // roots[i] 为 moduli[i] 的 2n 次本原单位根。
+    // ============================================================
+    static const int NTT_STREAM_LOG_N      = 0;
+    static const int NTT_STREAM_INVERSE    = 1;
+    static const int NTT_STREAM_HDR_WORDS  = 8;
+    static const int NTT_STREAM_LIMB_WORDS = 4;
+
+    // OP_INIT 片上参数表的槽位：kernel 固定把 Q 放在 [0, KERNEL_LIMB_Q)，P 放在 [KERNEL_LIMB_Q, MAX_LIMBS)。
+    // pos 为模数在 Q ++ P 中的位置，num_q 为 Q 的个数；放不进片上表为 -1
+    static int OnChipSlot(size_t pos, size_t num_q) {
+        if (pos < num_q)
+            return pos < (size_t)KERNEL_LIMB_Q ? (int)pos : -1;
+        const size_t slot = KERNEL_LIMB_Q + (pos - num_q);
+        return slot < MAX_LIMBS ? (int)slot : -1;
+    }
+
+    static bool IsStreamRingDim(size_t n) {
+        return n >= 2 && n <= FPGA_MAX_RING_DIM && (n & (n - 1)) == 0;
+    }
+
+    static std::vector<uint64_t> PackNttStreamImage(const std::vector<uint64_t>& moduli,
+                                                    const std::vector<uint64_t>& roots, size_t n, bool inverse) {
+        FpgaInitImage image = PackInitImage(moduli, {}, roots, n);
+        const uint64_t* base = image.words.data() + image.stream_offset[inverse ? 1 : 0];
+        return std::vector<uint64_t>(base, base + image.stream_words);
+    }
+
+    // 单次 OP_NTT_STREAM 启动最多处理的 limb 数（大上下文按此自动分块）
+    static size_t StreamTileLimbs(size_t n) {
+        return std::max<size_t>(1, FPGA_STREAM_TILE_BYTES / (n * sizeof(uint64_t)));
+    }
+
+    // 当前 InitModuli 装载的环维度（0: 流式 NTT 不可用）
+    size_t GetRingDim() const override {
+        return m_ring_dim;
+    }
+
+    // 维度为 n 的多项式能否走 NttBatchOffload
+    bool SupportsRingDim(size_t n) const override {
+        return m_is_ready && m_ring_dim != 0 && n == m_ring_dim;
+    }
+
+    // towers[i] 原地变换（forward: NTT, 否则 INTT）。
+    // 零拷贝打包：每个 tower 直接从 NativeVector 存储写入 bo 的对应偏移，
+    // 结果按同样偏移读回，不经过中间 flat buffer。
+    // 一律用 OP_NTT_STREAM（任意 N <= FPGA_MAX_RING_DIM、任意 limb 数，按 StreamTileLimbs 分块），
+    // 输出与 CPU 相同的 bit-reverse 顺序；片上 OP_NTT/OP_INTT 的求值域按行错位，不能交给 CPU。
+    // 返回 false 表示无法卸载（未就绪 / 维度不符 / 模数不在设备上），调用者走 CPU。
+    bool NttBatchOffload(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers,
+                         size_t n) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (!SupportsRingDim(n) || numTowers == 0)
+            return false;
+
+        auto runs = PlanLimbRuns(DeviceIndices(moduli, numTowers), StreamTileLimbs(n));
+        if (runs.empty())
+            return false;
+
+        const size_t limb_bytes = n * sizeof(uint64_t);
+        const xrt::bo& image    = *m_stream_image[forward ? 0 : 1];
+        // 先读回 scratch，全部段成功后才原地写回：中途失败时 tower 原样，调用者可以回退 CPU
+        std::vector<uint64_t> scratch(numTowers * n);
+        try {
+            for (const auto& r : runs) {
+                const size_t bytes = r.count * limb_bytes;
+                auto bo_in  = m_bo_pool.Acquire(m_kernel_top.group_id(0), bytes);
+                auto bo_out = m_bo_pool.Acquire(m_kernel_top.group_id(2), bytes);
+
+                for (size_t l = 0; l < r.count; ++l)
+                    bo_in->write(towers[r.first + l], limb_bytes, l * limb_bytes);
+                bo_in->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+
+                auto run = m_kernel_top(*bo_in, image, *bo_out, OP_NTT_STREAM, (int)r.count, r.mod_idx);
+                run.wait();
+
+                bo_out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, bytes, 0);
+                bo_out->read(scratch.data() + r.first * n, bytes, 0);
+                CountTransfer(bytes, bytes);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA Batch NTT Error] " << e.what() << std::endl;
+            return false;
         }
+        for (size_t i = 0; i < numTowers; ++i)
+            std::copy(scratch.data() + i * n, scratch.data() + (i + 1) * n, towers[i]);
+        m_ntt_batch_launches += runs.size();
+        return true;
+    #else
+        return false;
     #endif
     }
 
+    // NttBatchOffload 累计的 kernel 启动次数（用于确认一个多 tower 多项式只启动一次）
+    uint64_t GetNttBatchLaunches() const {
+        return m_ntt_batch_launches;
+    }
+
     // BConv with dynamic output moduli
-    // Kernel: LIMB_Q rows × MAX_OUT_COLS columns (3×5)
-    static const int KERNEL_LIMB_Q = 3;
-    static const int KERNEL_MAX_OUT_COLS = 5;  // LIMB_Q + LIMB_P
-    
-    void BConvOffload(
+    // Kernel: KERNEL_LIMB_Q rows × KERNEL_MAX_OUT_COLS columns (3×5)
+    bool BConvOffload(
         const uint64_t* x,              // 输入: [KERNEL_LIMB_Q × RING_DIM]
         const uint64_t* w,              // 权重: [KERNEL_LIMB_Q × KERNEL_MAX_OUT_COLS]
         const uint64_t* out_mod,        // 输出模数: [sizeP]
         uint64_t* result,               // 输出: [sizeP × RING_DIM]
         size_t ringDim, 
         int sizeP                       // 实际输出列数
-    ) {
+    ) override {
     #ifdef OPENFHE_FPGA_ENABLE
-        if (!m_is_ready) return;
-        
+        if (!m_is_ready || ringDim != FPGA_RING_DIM || sizeP < 1 || sizeP > KERNEL_MAX_OUT_COLS)
+            return false;
+
         std::cout << "=== [FPGA] Execute BConv === sizeP=" << sizeP << std::endl;
 
         try {
-            // Buffer sizes
-            size_t in_size = KERNEL_LIMB_Q * ringDim * sizeof(uint64_t);
-            // mem_in2 = weights + out_mod
-            size_t weights_count = KERNEL_LIMB_Q * KERNEL_MAX_OUT_COLS;
-            size_t mod_count = KERNEL_MAX_OUT_COLS;
-            size_t meta_size = (weights_count + mod_count) * sizeof(uint64_t);
-            size_t out_size = sizeP * ringDim * sizeof(uint64_t);
-            
-            // Pack weights + moduli into single buffer
-            std::vector<uint64_t> meta_buffer(weights_count + mod_count, 0);
-            // Copy weights
-            std::memcpy(meta_buffer.data(), w, weights_count * sizeof(uint64_t));
-            // Copy output moduli (padded with 0)
-            for (int i = 0; i < sizeP && i < KERNEL_MAX_OUT_COLS; i++) {
-                meta_buffer[weights_count + i] = out_mod[i];
+            RunBConv(x, PackBConvMeta(w, out_mod, sizeP), result, ringDim, sizeP);
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA BConv Error] " << e.what() << std::endl;
+        }
+    #endif
+        return false;
+    }
+
+    // 单输出 tower 模式（sizeP = 1）：只算补集中的一个 tower，
+    // 设备输出 buffer 和 D2H 都只有一个 tower，OC 策略逐 tower 调用。
+    // x: [KERNEL_LIMB_Q × RING_DIM]（已乘 QHatInvModq）；w_col: [KERNEL_LIMB_Q] 该 tower 的权重列。
+    // 返回 false 表示未在 FPGA 上执行，调用者走 CPU。
+    bool BConvTowerOffload(const uint64_t* x, const uint64_t* w_col, uint64_t out_mod, uint64_t* result,
+                           size_t ringDim) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (!m_is_ready || ringDim != FPGA_RING_DIM) return false;
+
+        std::vector<uint64_t> w(KERNEL_LIMB_Q * KERNEL_MAX_OUT_COLS, 0);
+        for (int i = 0; i < KERNEL_LIMB_Q; i++)
+            w[i * KERNEL_MAX_OUT_COLS] = w_col[i];
+        try {
+            RunBConv(x, PackBConvMeta(w.data(), &out_mod, 1), result, ringDim, 1);
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA BConv Error] " << e.what() << std::endl;
+        }
+    #endif
+        return false;
+    }
+
+    // ============================================================
+    // 融合 hybrid key-switch（OP_HKS_DIGIT）
+    // ------------------------------------------------------------
+    // 每个 digit 一次 kernel 启动，INTT -> BConv -> NTT -> MAC 全在片上完成；
+    // 累加器 (c0', c1') 留在同一个设备 buffer 里跨 digit 累加，
+    // 所有 digit 结束后才读回主机一次。
+    // mem_in2 头部布局与 fpga_backend/include/define.h 的 HKS_META_* 一致；
+    // digit 描述见 PolyAccelerator::HksDigit。
+    // ============================================================
+    static const int HKS_META_ALPHA   = 0;
+    static const int HKS_META_START   = 1;
+    static const int HKS_META_SIZE    = 2;
+    static const int HKS_META_ACC     = 3;
+    static const int HKS_META_DEVIDX  = 4;
+    static const int HKS_META_QHATINV = HKS_META_DEVIDX + KERNEL_MAX_OUT_COLS;
+    static const int HKS_META_W       = HKS_META_QHATINV + KERNEL_LIMB_Q;
+    static const int HKS_META_WORDS   = 32;
+
+    // moduli: QlP 顺序的 tower 模数。out0/out1: sizeQlP 个 tower 的输出地址。
+    // 返回 false 表示形状超出 kernel 能力或模数不在设备上，调用者走 CPU。
+    bool HksFusedOffload(const std::vector<HksDigit>& digits, const uint64_t* moduli, size_t sizeQlP,
+                         uint64_t* const* out0, uint64_t* const* out1, size_t n) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (!m_is_ready || n != FPGA_RING_DIM || digits.empty() || sizeQlP > (size_t)KERNEL_MAX_OUT_COLS)
+            return false;
+
+        std::vector<int> dev_idx = OnChipIndices(moduli, sizeQlP);
+        if (std::find(dev_idx.begin(), dev_idx.end(), -1) != dev_idx.end())
+            return false;
+        for (const auto& d : digits) {
+            if (d.alpha == 0 || d.alpha > (size_t)KERNEL_LIMB_Q || d.start + d.alpha > sizeQlP)
+                return false;
+            // digit 在片上按模数索引连续存放
+            for (size_t i = 1; i < d.alpha; ++i) {
+                if (dev_idx[d.start + i] != dev_idx[d.start] + (int)i)
+                    return false;
+            }
+            // digit 到补集的 BConv：补集模数不能比 digit 窄
+            std::vector<uint64_t> compl_mod(moduli, moduli + d.start);
+            compl_mod.insert(compl_mod.end(), moduli + d.start + d.alpha, moduli + sizeQlP);
+            if (!BConvFits(moduli + d.start, d.alpha, compl_mod.data(), compl_mod.size()))
+                return false;
+        }
+
+        const size_t limb_bytes = n * sizeof(uint64_t);
+        const size_t key_words  = 2 * sizeQlP * n;
+        const size_t meta_bytes = (HKS_META_WORDS + key_words) * sizeof(uint64_t);
+        const size_t acc_bytes  = 2 * sizeQlP * limb_bytes;
+        try {
+            auto bo_in  = m_bo_pool.Acquire(m_kernel_top.group_id(0), KERNEL_LIMB_Q * limb_bytes);
+            auto bo_key = m_bo_pool.Acquire(m_kernel_top.group_id(1), meta_bytes);
+            auto bo_acc = m_bo_pool.Acquire(m_kernel_top.group_id(2), acc_bytes);
+
+            for (size_t j = 0; j < digits.size(); ++j) {
+                const auto& d           = digits[j];
+                const size_t sizeCompl  = sizeQlP - d.alpha;
+                const size_t digit_bytes = d.alpha * limb_bytes;
+
+                std::vector<uint64_t> meta(HKS_META_WORDS, 0);
+                meta[HKS_META_ALPHA] = d.alpha;
+                meta[HKS_META_START] = d.start;
+                meta[HKS_META_SIZE]  = sizeQlP;
+                meta[HKS_META_ACC]   = (j > 0) ? 1 : 0;
+                for (size_t e = 0; e < sizeQlP; ++e)
+                    meta[HKS_META_DEVIDX + e] = (uint64_t)dev_idx[e];
+                for (size_t i = 0; i < d.alpha; ++i) {
+                    meta[HKS_META_QHATINV + i] = d.qhat_inv[i];
+                    for (size_t c = 0; c < sizeCompl; ++c)
+                        meta[HKS_META_W + i * KERNEL_MAX_OUT_COLS + c] = d.qhat_mod[i * sizeCompl + c];
+                }
+
+                // 零拷贝打包：digit / key 的每个 tower 直接写到 bo 偏移处
+                for (size_t i = 0; i < d.alpha; ++i)
+                    bo_in->write(d.towers[i], limb_bytes, i * limb_bytes);
+                bo_in->sync(XCL_BO_SYNC_BO_TO_DEVICE, digit_bytes, 0);
+
+                const size_t key_base = HKS_META_WORDS * sizeof(uint64_t);
+                bo_key->write(meta.data(), key_base, 0);
+                for (size_t e = 0; e < sizeQlP; ++e) {
+                    bo_key->write(d.key_b[e], limb_bytes, key_base + e * limb_bytes);
+                    bo_key->write(d.key_a[e], limb_bytes, key_base + (sizeQlP + e) * limb_bytes);
+                }
+                bo_key->sync(XCL_BO_SYNC_BO_TO_DEVICE, meta_bytes, 0);
+
+                auto run = m_kernel_top(*bo_in, *bo_key, *bo_acc, OP_HKS_DIGIT, (int)sizeQlP, dev_idx[d.start]);
+                run.wait();
+                CountTransfer(digit_bytes + meta_bytes, 0);
+            }
+
+            // 只有最终的 (c0', c1') 回到主机
+            bo_acc->sync(XCL_BO_SYNC_BO_FROM_DEVICE, acc_bytes, 0);
+            for (size_t e = 0; e < sizeQlP; ++e) {
+                bo_acc->read(out0[e], limb_bytes, e * limb_bytes);
+                bo_acc->read(out1[e], limb_bytes, (sizeQlP + e) * limb_bytes);
+            }
+            m_d2h_bytes += acc_bytes;
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA HKS Error] " << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    // ============================================================
+    // 批量 hoisted 旋转（OP_HKS_ROTATE）
+    // ------------------------------------------------------------
+    // 一次启动：digits 上传一次常驻 mem_in1，每个旋转的 key 和 ROT 头部依次排在 mem_in2，
+    // kernel 逐旋转做 MAC 和 EVALUATION 下的自同态，所有旋转的 (b, a) 一次读回。
+    // mem_in2 头部布局与 fpga_backend/include/define.h 的 ROT_META_* 一致。
+    // ============================================================
+    static const int ROT_META_DIGITS = 0;
+    static const int ROT_META_SIZE   = 1;
+    static const int ROT_META_AUTO   = 2;
+    static const int ROT_META_FIRST  = 3;
+    static const int ROT_META_DEVIDX = 4;
+    static const int ROT_META_WORDS  = 16;
+
+    bool HksRotateBatchOffload(const uint64_t* const* digits, size_t numDigits, const uint64_t* const* first,
+                               const uint64_t* moduli, size_t sizeQlP, const std::vector<HksRotation>& rotations,
+                               size_t n) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (!m_is_ready || n != FPGA_RING_DIM || numDigits == 0 || rotations.empty() ||
+            sizeQlP > (size_t)KERNEL_MAX_OUT_COLS)
+            return false;
+
+        // 旋转 key 的 MAC 用片上参数表，模数须都在表里
+        std::vector<int> dev_idx = OnChipIndices(moduli, sizeQlP);
+        if (std::find(dev_idx.begin(), dev_idx.end(), -1) != dev_idx.end())
+            return false;
+
+        const size_t limb_bytes = n * sizeof(uint64_t);
+        const size_t num_towers = numDigits * sizeQlP;
+        const size_t key_bytes  = num_towers * limb_bytes;
+        const size_t in_bytes   = key_bytes + (first ? sizeQlP * limb_bytes : 0);
+        const size_t rot_bytes  = ROT_META_WORDS * sizeof(uint64_t) + 2 * key_bytes;
+        const size_t out_bytes  = 2 * sizeQlP * limb_bytes;
+        try {
+            auto bo_digits = m_bo_pool.Acquire(m_kernel_top.group_id(0), in_bytes);
+            auto bo_key    = m_bo_pool.Acquire(m_kernel_top.group_id(1), rotations.size() * rot_bytes);
+            auto bo_out    = m_bo_pool.Acquire(m_kernel_top.group_id(2), rotations.size() * out_bytes);
+
+            // hoisted digits（和 first）只上传一次，所有旋转共用
+            for (size_t t = 0; t < num_towers; ++t)
+                bo_digits->write(digits[t], limb_bytes, t * limb_bytes);
+            for (size_t e = 0; first && e < sizeQlP; ++e)
+                bo_digits->write(first[e], limb_bytes, key_bytes + e * limb_bytes);
+            bo_digits->sync(XCL_BO_SYNC_BO_TO_DEVICE, in_bytes, 0);
+
+            for (size_t r = 0; r < rotations.size(); ++r) {
+                const auto& rot = rotations[r];
+                std::vector<uint64_t> meta(ROT_META_WORDS, 0);
+                meta[ROT_META_DIGITS] = numDigits;
+                meta[ROT_META_SIZE]   = sizeQlP;
+                meta[ROT_META_AUTO]   = rot.auto_index;
+                meta[ROT_META_FIRST]  = first ? 1 : 0;
+                for (size_t e = 0; e < sizeQlP; ++e)
+                    meta[ROT_META_DEVIDX + e] = (uint64_t)dev_idx[e];
+
+                const size_t base     = r * rot_bytes;
+                const size_t key_base = base + ROT_META_WORDS * sizeof(uint64_t);
+                bo_key->write(meta.data(), ROT_META_WORDS * sizeof(uint64_t), base);
+                for (size_t t = 0; t < num_towers; ++t) {
+                    bo_key->write(rot.key_b[t], limb_bytes, key_base + t * limb_bytes);
+                    bo_key->write(rot.key_a[t], limb_bytes, key_base + key_bytes + t * limb_bytes);
+                }
             }
-            
-            auto bo_in = xrt::bo(m_device, in_size, m_kernel_top.group_id(0));
-            auto bo_meta = xrt::bo(m_device, meta_size, m_kernel_top.group_id(1));
-            auto bo_out = xrt::bo(m_device, out_size, m_kernel_top.group_id(2));
-
-            bo_in.write(x);
-            bo_in.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-            
-            bo_meta.write(meta_buffer.data());
-            bo_meta.sync(XCL_BO_SYNC_BO_TO_DEVICE);
-
-            // num_active_limbs = sizeP (输出列数)
-            auto run = m_kernel_top(bo_in, bo_meta, bo_out, OP_BCONV, sizeP, 0);
+            bo_key->sync(XCL_BO_SYNC_BO_TO_DEVICE, rotations.size() * rot_bytes, 0);
+
+            auto run = m_kernel_top(*bo_digits, *bo_key, *bo_out, OP_HKS_ROTATE, (int)rotations.size(), 0);
             run.wait();
+            CountTransfer(in_bytes + rotations.size() * rot_bytes, 0);
 
-            bo_out.sync(XCL_BO_SYNC_BO_FROM_DEVICE);
-            bo_out.read(result);
+            bo_out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, rotations.size() * out_bytes, 0);
+            for (size_t r = 0; r < rotations.size(); ++r) {
+                for (size_t e = 0; e < sizeQlP; ++e) {
+                    bo_out->read(rotations[r].out0[e], limb_bytes, r * out_bytes + e * limb_bytes);
+                    bo_out->read(rotations[r].out1[e], limb_bytes, r * out_bytes + (sizeQlP + e) * limb_bytes);
+                }
+            }
+            m_d2h_bytes += rotations.size() * out_bytes;
         } catch (const std::exception& e) {
-            std::cerr << "[FPGA BConv Error] " << e.what() << std::endl;
+            std::cerr << "[FPGA Rotate Error] " << e.what() << std::endl;
+            return false;
+        }
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    // ============================================================
+    // 常驻 tower 组（DeviceDCRTPoly）
+    // ------------------------------------------------------------
+    // 每组一个 group_id(0) 的 bo，towers 按下标连续存放。kernel 的 in2 / out 参数可能接在
+    // 别的 HBM bank 上，所以 b 和结果经池里对应 bank 的 bo 做设备内拷贝（xrt::bo::copy，不经过 PCIe）。
+    // ============================================================
+    ResidentId AllocResident(const uint64_t* moduli, size_t numTowers, size_t n) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (!m_is_ready || n != FPGA_RING_DIM || numTowers == 0)
+            return 0;
+        if (PlanLimbRuns(OnChipIndices(moduli, numTowers)).empty())
+            return 0;
+        try {
+            auto bo = std::make_unique<xrt::bo>(m_device, numTowers * n * sizeof(uint64_t), m_kernel_top.group_id(0));
+            std::lock_guard<std::mutex> lock(m_resident_mutex);
+            const ResidentId id = m_next_resident++;
+            m_resident[id]      = Resident{std::vector<uint64_t>(moduli, moduli + numTowers), n, std::move(bo)};
+            return id;
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA Resident Error] " << e.what() << std::endl;
+            return 0;
+        }
+    #else
+        return 0;
+    #endif
+    }
+
+    void FreeResident(ResidentId id) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        std::lock_guard<std::mutex> lock(m_resident_mutex);
+        m_resident.erase(id);
+    #endif
+    }
+
+    bool WriteResident(ResidentId id, const uint64_t* const* towers) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        std::lock_guard<std::mutex> lock(m_resident_mutex);
+        auto it = m_resident.find(id);
+        if (it == m_resident.end())
+            return false;
+        auto& r                 = it->second;
+        const size_t limb_bytes = r.n * sizeof(uint64_t);
+        const size_t bytes      = r.moduli.size() * limb_bytes;
+        try {
+            for (size_t i = 0; i < r.moduli.size(); ++i)
+                r.bo->write(towers[i], limb_bytes, i * limb_bytes);
+            r.bo->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA Resident Error] " << e.what() << std::endl;
+            return false;
+        }
+        CountTransfer(bytes, 0);
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    bool ReadResident(ResidentId id, uint64_t* const* towers) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        std::lock_guard<std::mutex> lock(m_resident_mutex);
+        auto it = m_resident.find(id);
+        if (it == m_resident.end())
+            return false;
+        auto& r                 = it->second;
+        const size_t limb_bytes = r.n * sizeof(uint64_t);
+        const size_t bytes      = r.moduli.size() * limb_bytes;
+        try {
+            r.bo->sync(XCL_BO_SYNC_BO_FROM_DEVICE, bytes, 0);
+            for (size_t i = 0; i < r.moduli.size(); ++i)
+                r.bo->read(towers[i], limb_bytes, i * limb_bytes);
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA Resident Error] " << e.what() << std::endl;
+            return false;
+        }
+        CountTransfer(0, bytes);
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    bool ModOpResident(int opcode, ResidentId a, ResidentId b, ResidentId out) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        std::lock_guard<std::mutex> lock(m_resident_mutex);
+        auto ia = m_resident.find(a), ib = m_resident.find(b), io = m_resident.find(out);
+        if (ia == m_resident.end() || ib == m_resident.end() || io == m_resident.end())
+            return false;
+        const auto& moduli = ia->second.moduli;
+        if (ib->second.moduli != moduli || io->second.moduli != moduli)
+            return false;
+        auto runs = PlanLimbRuns(OnChipIndices(moduli.data(), moduli.size()));
+        if (runs.empty())
+            return false;
+
+        const size_t limb_bytes = ia->second.n * sizeof(uint64_t);
+        size_t done             = 0;
+        try {
+            for (const auto& r : runs) {
+                const size_t bytes  = r.count * limb_bytes;
+                const size_t offset = r.first * limb_bytes;
+                xrt::bo sub_a(*ia->second.bo, bytes, offset);
+                auto bo_b   = m_bo_pool.Acquire(m_kernel_top.group_id(1), bytes);
+                auto bo_out = m_bo_pool.Acquire(m_kernel_top.group_id(2), bytes);
+                bo_b->copy(*ib->second.bo, bytes, offset, 0);
+
+                auto run = m_kernel_top(sub_a, *bo_b, *bo_out, opcode, (int)r.count, r.mod_idx);
+                run.wait();
+                // out 与 a 相同时只覆盖本段，后面的段还没读
+                io->second.bo->copy(*bo_out, bytes, 0, offset);
+                ++done;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA Resident Error] " << e.what() << std::endl;
+            if (done > 0)
+                throw;
+            return false;
         }
+        return true;
+    #else
+        return false;
+    #endif
+    }
+
+    bool NttResident(bool forward, ResidentId id) override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        std::lock_guard<std::mutex> lock(m_resident_mutex);
+        auto it = m_resident.find(id);
+        if (it == m_resident.end())
+            return false;
+        auto& res = it->second;
+        if (!SupportsRingDim(res.n))
+            return false;
+        // 与 NttBatchOffload 相同走 OP_NTT_STREAM，常驻数据随时可以按 CPU 顺序读回
+        auto runs = PlanLimbRuns(DeviceIndices(res.moduli.data(), res.moduli.size()), StreamTileLimbs(res.n));
+        if (runs.empty())
+            return false;
+        const xrt::bo& image = *m_stream_image[forward ? 0 : 1];
+
+        const size_t limb_bytes = res.n * sizeof(uint64_t);
+        size_t done             = 0;
+        try {
+            for (const auto& r : runs) {
+                const size_t bytes  = r.count * limb_bytes;
+                const size_t offset = r.first * limb_bytes;
+                xrt::bo sub(*res.bo, bytes, offset);
+                auto bo_out = m_bo_pool.Acquire(m_kernel_top.group_id(2), bytes);
+
+                auto run = m_kernel_top(sub, image, *bo_out, OP_NTT_STREAM, (int)r.count, r.mod_idx);
+                run.wait();
+                res.bo->copy(*bo_out, bytes, 0, offset);
+                ++done;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA Resident Error] " << e.what() << std::endl;
+            if (done > 0)
+                throw;
+            return false;
+        }
+        m_ntt_batch_launches += runs.size();
+        return true;
+    #else
+        return false;
     #endif
     }
 
+    // ============================================================
+    // 异步流水线接口 (H2D / Run / D2H 三级重叠, ping-pong buffer)
+    // ------------------------------------------------------------
+    // 返回的 future 就绪前, 调用者必须保证 in/out 指针有效且不被修改。
+    // in == out (原地变换) 是允许的: H2D 总是在 D2H 之前完成。
+    // ============================================================
+    std::future<void> ExecuteAsync(
+        uint8_t opcode,
+        const uint64_t* in1, size_t in1_bytes,
+        const uint64_t* in2, size_t in2_bytes,   // in2 == nullptr: 复用 in1
+        uint64_t* out, size_t out_bytes,
+        int num_limbs,
+        int mod_idx,
+        std::shared_ptr<void> keepalive = nullptr  // 主机侧临时数据, 保持到 H2D 完成
+    ) {
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (m_is_ready) {
+            struct Job {
+                DeviceBufferPool<xrt::bo>::Handle in1, in2, out;
+            };
+            auto job = std::make_shared<Job>();
+            auto h2d = [this, job, in1, in1_bytes, in2, in2_bytes, keepalive]() {
+                job->in1 = m_bo_pool.Acquire(m_kernel_top.group_id(0), in1_bytes);
+                job->in1->write(in1, in1_bytes, 0);
+                job->in1->sync(XCL_BO_SYNC_BO_TO_DEVICE, in1_bytes, 0);
+                if (in2 && in2 != in1) {
+                    job->in2 = m_bo_pool.Acquire(m_kernel_top.group_id(1), in2_bytes);
+                    job->in2->write(in2, in2_bytes, 0);
+                    job->in2->sync(XCL_BO_SYNC_BO_TO_DEVICE, in2_bytes, 0);
+                }
+                CountTransfer(in1_bytes + (job->in2.Valid() ? in2_bytes : 0), 0);
+            };
+            auto run = [this, job, out_bytes, opcode, num_limbs, mod_idx]() {
+                job->out = m_bo_pool.Acquire(m_kernel_top.group_id(2), out_bytes);
+                auto r = m_kernel_top(*job->in1, job->in2.Valid() ? *job->in2 : *job->in1, *job->out, opcode,
+                                      num_limbs, mod_idx);
+                r.wait();
+                // 输入 buffer 归还给 pool, 下一条命令的 H2D 可以立即复用
+                job->in1.Release();
+                job->in2.Release();
+            };
+            auto d2h = [this, job, out, out_bytes]() {
+                job->out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, out_bytes, 0);
+                job->out->read(out, out_bytes, 0);
+                job->out.Release();
+                m_d2h_bytes += out_bytes;
+            };
+            return m_queue.Submit(std::move(h2d), std::move(run), std::move(d2h));
+        }
+    #endif
+        // 没有提交：不能返回就绪的 future，否则调用者会把没变换的数据当成结果
+        return Rejected("FpgaManager: device is not ready");
+    }
+
+    std::future<void> NttForwardOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override {
+        return NttAsync(true, in, out, modulus, n);
+    }
+
+    std::future<void> NttInverseOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override {
+        return NttAsync(false, in, out, modulus, n);
+    }
+
+    // 单 limb 异步 NTT/INTT，与同步接口相同走 OP_NTT_STREAM（twiddle 镜像常驻设备，只传数据）。
+    // 设备模数表里的任何模数都可以（不受片上 MAX_LIMBS 限制）；不在表里时不提交
+    std::future<void> NttAsync(bool forward, const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) {
+    #ifdef OPENFHE_FPGA_ENABLE
+        const int mod_idx = SupportsRingDim(n) ? DeviceIndices(&modulus, 1)[0] : -1;
+        if (mod_idx >= 0) {
+            struct Job {
+                DeviceBufferPool<xrt::bo>::Handle in, out;
+            };
+            const size_t bytes = n * sizeof(uint64_t);
+            auto job           = std::make_shared<Job>();
+            auto h2d           = [this, job, in, bytes]() {
+                job->in = m_bo_pool.Acquire(m_kernel_top.group_id(0), bytes);
+                job->in->write(in, bytes, 0);
+                job->in->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+                CountTransfer(bytes, 0);
+            };
+            // InitModuli 先排空队列再换镜像，执行时镜像一定有效
+            auto run = [this, job, bytes, forward, mod_idx]() {
+                job->out = m_bo_pool.Acquire(m_kernel_top.group_id(2), bytes);
+                auto r   = m_kernel_top(*job->in, *m_stream_image[forward ? 0 : 1], *job->out, OP_NTT_STREAM, 1,
+                                        mod_idx);
+                r.wait();
+                job->in.Release();
+            };
+            auto d2h = [this, job, out, bytes]() {
+                job->out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, bytes, 0);
+                job->out->read(out, bytes, 0);
+                job->out.Release();
+                m_d2h_bytes += bytes;
+            };
+            return m_queue.Submit(std::move(h2d), std::move(run), std::move(d2h));
+        }
+    #endif
+        return Rejected("FpgaManager: modulus " + std::to_string(modulus) + " / ring dimension " +
+                        std::to_string(n) + " is not loaded on the device");
+    }
+
+    // 与 BConvOffload 相同的打包方式; meta 在调用线程打包, 随命令一起保存
+    std::future<void> BConvOffloadAsync(
+        const uint64_t* x,
+        const uint64_t* w,
+        const uint64_t* out_mod,
+        uint64_t* result,
+        size_t ringDim,
+        int sizeP
+    ) {
+        auto meta = std::make_shared<std::vector<uint64_t>>(PackBConvMeta(w, out_mod, sizeP));
+        return ExecuteAsync(OP_BCONV, x, KERNEL_LIMB_Q * ringDim * sizeof(uint64_t), meta->data(),
+                            meta->size() * sizeof(uint64_t), result, sizeP * ringDim * sizeof(uint64_t), sizeP, 0,
+                            meta);
+    }
+
+    // 等待所有已提交的异步命令完成
+    void Synchronize() override {
+    #ifdef OPENFHE_FPGA_ENABLE
+        m_queue.Drain();
+    #endif
+    }
+
+    FpgaCommandQueue::Stats GetQueueStats() const {
+    #ifdef OPENFHE_FPGA_ENABLE
+        return m_queue.GetStats();
+    #else
+        return FpgaCommandQueue::Stats{};
+    #endif
+    }
+
+    // bytes 字节的 write+sync / sync+read，加一次 0 limb 的 OP_ADD 空启动；不计入传输统计
+    LinkTiming MeasureLink(size_t bytes) override {
+        LinkTiming t;
+    #ifdef OPENFHE_FPGA_ENABLE
+        if (!m_is_ready || bytes == 0) return t;
+        using clock  = std::chrono::steady_clock;
+        auto seconds = [](clock::time_point start) {
+            return std::chrono::duration<double>(clock::now() - start).count();
+        };
+        try {
+            std::vector<uint64_t> host((bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t), 1);
+            auto bo = m_bo_pool.Acquire(m_kernel_top.group_id(0), bytes);
+
+            auto start = clock::now();
+            bo->write(host.data(), bytes, 0);
+            bo->sync(XCL_BO_SYNC_BO_TO_DEVICE, bytes, 0);
+            t.h2d_s = seconds(start);
+
+            start    = clock::now();
+            auto run = m_kernel_top(*bo, *bo, *bo, OP_ADD, 0, 0);
+            run.wait();
+            t.launch_s = seconds(start);
+
+            start = clock::now();
+            bo->sync(XCL_BO_SYNC_BO_FROM_DEVICE, bytes, 0);
+            bo->read(host.data(), bytes, 0);
+            t.d2h_s = seconds(start);
+        } catch (const std::exception& e) {
+            std::cerr << "[FPGA MeasureLink Error] " << e.what() << std::endl;
+        }
+    #else
+        (void)bytes;
+    #endif
+        return t;
+    }
+
+    FpgaTransferStats GetTransferStats() const override {
+        FpgaTransferStats s;
+        s.h2d_bytes = m_h2d_bytes;
+        s.d2h_bytes = m_d2h_bytes;
+        s.launches  = m_launches;
+        return s;
+    }
+
+    void ResetTransferStats() override {
+        m_h2d_bytes = 0;
+        m_d2h_bytes = 0;
+        m_launches  = 0;
+    }
+
+    // ============================================================
+    // Device buffer pool (per-call xrt::bo reuse)
+    // ============================================================
+    DeviceBufferPoolStats GetBufferPoolStats() const {
+    #ifdef OPENFHE_FPGA_ENABLE
+        return m_bo_pool.GetStats();
+    #else
+        return DeviceBufferPoolStats{};
+    #endif
+    }
+
+    void ResetBufferPoolStats() {
+    #ifdef OPENFHE_FPGA_ENABLE
+        m_bo_pool.ResetStats();
+    #endif
+    }
+
+    // Frees all idle pooled buffers (e.g. before switching to a larger context)
+    void ReleasePooledBuffers() {
+    #ifdef OPENFHE_FPGA_ENABLE
+        m_bo_pool.Clear();
+    #endif
+    }
+
+    // kernel 的 Barrett 常数：k = ceil(log2 p), m = floor(2^(2k) / p)
+    static void BarrettConsts(uint64_t p, uint64_t& k, uint64_t& m) {
+        k = (uint64_t)std::ceil(std::log2((double)p));
+        unsigned __int128 power = (unsigned __int128)1 << (2 * k);
+        m = (uint64_t)(power / p);
+    }
+
+    // OP_BCONV 的 mem_in2 布局：[权重 LIMB_Q*MAX_OUT_COLS] [模数] [k_half] [m_barrett]，后三段各 MAX_OUT_COLS
+    static std::vector<uint64_t> PackBConvMeta(const uint64_t* w, const uint64_t* out_mod, int sizeP) {
+        const size_t weights_count = KERNEL_LIMB_Q * KERNEL_MAX_OUT_COLS;
+        std::vector<uint64_t> meta(weights_count + 3 * KERNEL_MAX_OUT_COLS, 0);
+        std::memcpy(meta.data(), w, weights_count * sizeof(uint64_t));
+        for (int i = 0; i < sizeP && i < KERNEL_MAX_OUT_COLS; i++) {
+            meta[weights_count + i] = out_mod[i];
+            BarrettConsts(out_mod[i], meta[weights_count + KERNEL_MAX_OUT_COLS + i],
+                          meta[weights_count + 2 * KERNEL_MAX_OUT_COLS + i]);
+        }
+        return meta;
+    }
 
 private:
+    // 单 limb 的片上操作：n 为 FPGA_RING_DIM 且模数在 OP_INIT 装载的片上参数表里
+    bool CanExecute(uint64_t modulus, size_t n) const {
+        if (!m_is_ready || n != FPGA_RING_DIM)
+            return false;
+        return OnChipIndices(&modulus, 1)[0] >= 0;
+    }
+
+    // 设备模数表（InitModuli 的 Q + P，流式 NTT 镜像按此顺序）索引；不在表里为 -1
+    std::vector<int> DeviceIndices(const uint64_t* moduli, size_t numTowers) const {
+        std::vector<int> idx(numTowers);
+        for (size_t i = 0; i < numTowers; ++i) {
+            auto it = std::find(m_stored_moduli.begin(), m_stored_moduli.end(), moduli[i]);
+            idx[i]  = (it == m_stored_moduli.end()) ? -1 : (int)std::distance(m_stored_moduli.begin(), it);
+        }
+        return idx;
+    }
+
+    // 片上参数表槽位（见 OnChipSlot）；不在表里为 -1，配合 PlanLimbRuns 整体回退 CPU
+    std::vector<int> OnChipIndices(const uint64_t* moduli, size_t numTowers) const {
+        std::vector<int> idx = DeviceIndices(moduli, numTowers);
+        for (auto& d : idx)
+            d = d < 0 ? -1 : OnChipSlot((size_t)d, m_num_q);
+        return idx;
+    }
+
 #ifdef OPENFHE_FPGA_ENABLE
     xrt::device m_device;
     xrt::kernel m_kernel_top;
+    DeviceBufferPool<xrt::bo> m_bo_pool;
+    FpgaCommandQueue m_queue{2};   // ping-pong: 2 input + 2 output buffer sets in flight
+    std::unique_ptr<xrt::bo> m_init_image;       // InitModuli 上传的整个设备镜像
+    std::unique_ptr<xrt::bo> m_stream_image[2];  // OP_NTT_STREAM twiddle 镜像（m_init_image 的子 buffer）: [0] 正, [1] 逆
+
+    struct Resident {
+        std::vector<uint64_t> moduli;
+        size_t n;
+        std::unique_ptr<xrt::bo> bo;
+    };
+    std::mutex m_resident_mutex;
+    std::unordered_map<ResidentId, Resident> m_resident;
+    ResidentId m_next_resident = 1;
 #endif
-    bool m_is_ready = true;                    // FIX control the fpga ?
+    std::mutex m_init_mutex;
+    std::string m_twiddle_cache_dir;
+    size_t m_ring_dim = 0;                     // 流式 NTT 镜像对应的环维度
+    bool m_is_ready = false;                   // 构造时连上设备并加载 xclbin 后置 true
     std::vector<uint64_t> m_stored_moduli;
+    size_t m_num_q = 0;                        // m_stored_moduli 中 Q 的个数（其后为 P）
     std::vector<uint64_t> m_stored_roots; // <--- 新增
+    std::atomic<uint64_t> m_ntt_batch_launches{0};
+    std::atomic<uint64_t> m_h2d_bytes{0};
+    std::atomic<uint64_t> m_d2h_bytes{0};
+    std::atomic<uint64_t> m_launches{0};
+
+    // 每个模数的 bit-reverse 正/逆 twiddle 表放进 owned：lookup 拷出的表与 roots 一致（表的 n/2 项即 psi）时直接用，
+    // 否则按 roots 计算
+    static void ResolveTwiddles(const std::vector<uint64_t>& moduli, const std::vector<uint64_t>& roots, size_t n,
+                                const TwiddleTableLookup& lookup, std::vector<std::vector<uint64_t>>& owned,
+                                std::vector<const uint64_t*>& fwd, std::vector<const uint64_t*>& inv) {
+        fwd.assign(moduli.size(), nullptr);
+        inv.assign(moduli.size(), nullptr);
+        owned.assign(2 * moduli.size(), {});
+        for (size_t l = 0; l < moduli.size(); ++l) {
+            const uint64_t q = moduli[l];
+            auto& f          = owned[2 * l];
+            auto& i          = owned[2 * l + 1];
+            if (!lookup || !lookup(q, n, f, i) || f.size() != n || i.size() != n || f[n / 2] != roots[l]) {
+                f.resize(n);
+                i.resize(n);
+                MathUtils::BitReversedPowers(roots[l], q, n, f.data());
+                MathUtils::BitReversedPowers(MathUtils::ModInverse(roots[l], q), q, n, i.data());
+            }
+            fwd[l] = f.data();
+            inv[l] = i.data();
+        }
+    }
+
+    // 缓存目录里有匹配的镜像就直接读入，否则打包（并写入缓存）
+    FpgaInitImage LoadOrPackInitImage(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                                      const std::vector<uint64_t>& roots, size_t n) {
+        std::lock_guard<std::mutex> lock(m_init_mutex);
+        FpgaInitImage image;
+        image.ring_dim = n;
+        image.num_q    = q_mods.size();
+        image.moduli   = q_mods;
+        image.moduli.insert(image.moduli.end(), p_mods.begin(), p_mods.end());
+        image.roots = roots;
+
+        const std::string path = m_twiddle_cache_dir.empty() ? "" : InitImageCachePath(m_twiddle_cache_dir, image);
+        if (!path.empty() && LoadInitImage(path, image))
+            return image;
+        image = PackInitImage(q_mods, p_mods, roots, n, GetTwiddleTableLookup());
+        if (!path.empty() && !image.words.empty() && !SaveInitImage(path, image))
+            std::cerr << "[FPGA Warning] Cannot write twiddle image " << path << std::endl;
+        return image;
+    }
+
+    // 每次 kernel 启动调用一次
+    void CountTransfer(size_t h2d, size_t d2h) {
+        m_h2d_bytes += h2d;
+        m_d2h_bytes += d2h;
+        ++m_launches;
+    }
+
+#ifdef OPENFHE_FPGA_ENABLE
+    // 同步执行一次 OP_BCONV；只读回 sizeP 个输出 tower
+    void RunBConv(const uint64_t* x, const std::vector<uint64_t>& meta, uint64_t* result, size_t ringDim, int sizeP) {
+        size_t in_size   = KERNEL_LIMB_Q * ringDim * sizeof(uint64_t);
+        size_t meta_size = meta.size() * sizeof(uint64_t);
+        size_t out_size  = sizeP * ringDim * sizeof(uint64_t);
+
+        auto bo_in   = m_bo_pool.Acquire(m_kernel_top.group_id(0), in_size);
+        auto bo_meta = m_bo_pool.Acquire(m_kernel_top.group_id(1), meta_size);
+        auto bo_out  = m_bo_pool.Acquire(m_kernel_top.group_id(2), out_size);
+
+        bo_in->write(x, in_size, 0);
+        bo_in->sync(XCL_BO_SYNC_BO_TO_DEVICE, in_size, 0);
+        bo_meta->write(meta.data(), meta_size, 0);
+        bo_meta->sync(XCL_BO_SYNC_BO_TO_DEVICE, meta_size, 0);
+
+        // num_active_limbs = sizeP (输出列数)
+        auto run = m_kernel_top(*bo_in, *bo_meta, *bo_out, OP_BCONV, sizeP, 0);
+        run.wait();
+
+        bo_out->sync(XCL_BO_SYNC_BO_FROM_DEVICE, out_size, 0);
+        bo_out->read(result, out_size, 0);
+        CountTransfer(in_size + meta_size, out_size);
+    }
+#endif
 
     FpgaManager() {
+        if (const char* dir = std::getenv("OPENFHE_FPGA_TWIDDLE_CACHE"))
+            m_twiddle_cache_dir = dir;
 #ifdef OPENFHE_FPGA_ENABLE
         try {
             m_device = xrt::device(0); 
             std::cout << "[FPGA] Device connected: " << m_device.get_info<xrt::info::device::name>() << std::endl;
             auto uuid = m_device.load_xclbin(GetXclbinPath());
             m_kernel_top = xrt::kernel(m_device, uuid, "Top");
+            m_bo_pool.SetFactory([this](size_t bytes, int group) { return xrt::bo(m_device, bytes, group); });
             m_is_ready = true;
             std::cout << "[FPGA] Unified Top Kernel Loaded.\n";
         } catch (const std::exception& e) { 
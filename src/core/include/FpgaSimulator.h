@@ -0,0 +1,146 @@
+#ifndef _FPGA_SIMULATOR_H_
+#define _FPGA_SIMULATOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "FpgaBufferPool.h"
+#include "FpgaCommandQueue.h"
+#include "PolyAccelerator.h"
+
+// =============================================================
+// 进程内 FPGA 模拟器（PolyAccelerator 的 "sim" 后端）
+// -------------------------------------------------------------
+// fpga_backend/src 的 kernel 以 FPGA_STANDALONE_TEST 编进 OPENFHEcore（OPENFHE_FPGA_SIM），
+// 这里直接调用 Top()，主机侧流程与 FpgaManager 相同：
+//   - InitModuli 打包同一个设备镜像（FpgaManager::PackInitImage），OP_INIT 从镜像里取参数；
+//   - tower 按模数索引切段（PlanLimbRuns），回退 CPU 的条件与 FpgaManager 一致；
+//   - 设备 buffer 来自 DeviceBufferPool，H2D / D2H 是 memcpy，计入 GetTransferStats。
+// Top() 的片上存储是全局静态数组，整个进程只有一个"设备"，所以模拟器是单例，
+// kernel 启动由 m_kernel_mutex 串行化；任意主机线程都可以并发调用，
+// 异步接口的 H2D / Run / D2H 在 FpgaCommandQueue 的三个线程上重叠。
+// =============================================================
+class FpgaSimulator : public PolyAccelerator {
+public:
+    static FpgaSimulator& GetInstance();
+
+    const char* Name() const override {
+        return "sim";
+    }
+    bool IsReady() const override {
+        return true;
+    }
+
+    void InitModuli(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                    const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots,
+                    size_t ringDim = FPGA_RING_DIM) override;
+    bool HasModulus(uint64_t modulus) const override;
+    size_t GetRingDim() const override {
+        return m_ring_dim;
+    }
+    bool SupportsRingDim(size_t n) const override {
+        return m_ring_dim != 0 && n == m_ring_dim;
+    }
+
+    bool NttForwardOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    bool NttInverseOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    bool NttBatchOffload(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers,
+                         size_t n) override;
+    std::future<void> NttForwardOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    std::future<void> NttInverseOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    void Synchronize() override;
+
+    bool ModOpOffload(int opcode, const uint64_t* const* a, const uint64_t* const* b, uint64_t* const* out,
+                      const uint64_t* moduli, size_t numTowers, size_t n) override;
+
+    bool BConvOffload(const uint64_t* x, const uint64_t* w, const uint64_t* out_mod, uint64_t* result, size_t ringDim,
+                      int sizeP) override;
+    bool BConvTowerOffload(const uint64_t* x, const uint64_t* w_col, uint64_t out_mod, uint64_t* result,
+                           size_t ringDim) override;
+
+    bool AutoOffload(const uint64_t* in, uint64_t* out, uint32_t k, uint32_t kinv, uint64_t modulus,
+                     size_t n) override;
+
+    bool HksFusedOffload(const std::vector<HksDigit>& digits, const uint64_t* moduli, size_t sizeQlP,
+                         uint64_t* const* out0, uint64_t* const* out1, size_t n) override;
+
+    bool HksRotateBatchOffload(const uint64_t* const* digits, size_t numDigits, const uint64_t* const* first,
+                               const uint64_t* moduli, size_t sizeQlP, const std::vector<HksRotation>& rotations,
+                               size_t n) override;
+
+    ResidentId AllocResident(const uint64_t* moduli, size_t numTowers, size_t n) override;
+    void FreeResident(ResidentId id) override;
+    bool WriteResident(ResidentId id, const uint64_t* const* towers) override;
+    bool ReadResident(ResidentId id, uint64_t* const* towers) override;
+    bool ModOpResident(int opcode, ResidentId a, ResidentId b, ResidentId out) override;
+    bool NttResident(bool forward, ResidentId id) override;
+
+    // 当前分配的常驻 tower 组数
+    size_t GetResidentCount() const;
+
+    LinkTiming MeasureLink(size_t bytes) override;
+    FpgaTransferStats GetTransferStats() const override;
+    void ResetTransferStats() override;
+
+    FpgaCommandQueue::Stats GetQueueStats() const {
+        return m_queue.GetStats();
+    }
+    DeviceBufferPoolStats GetBufferPoolStats() const {
+        return m_pool.GetStats();
+    }
+
+private:
+    using DeviceBuffer = std::vector<uint64_t>;
+
+    // 常驻 tower 组：towers 按下标连续存放，每个 n 个字
+    struct Resident {
+        std::vector<uint64_t> moduli;
+        size_t n;
+        DeviceBuffer data;
+    };
+
+    FpgaSimulator();
+    FpgaSimulator(const FpgaSimulator&)            = delete;
+    FpgaSimulator& operator=(const FpgaSimulator&) = delete;
+
+    // 一次 kernel 启动（串行化）
+    void Launch(const uint64_t* in1, const uint64_t* in2, uint64_t* out, uint8_t opcode, int num_limbs, int mod_idx);
+    // 单 limb 同步执行：H2D -> Top -> D2H
+    void Execute(uint8_t opcode, const uint64_t* in1, const uint64_t* in2, size_t in2_words, uint64_t* out,
+                 int mod_idx);
+    // 单 limb 异步 OP_NTT_STREAM；模数不在设备上或 n 不对时返回带异常的 future
+    std::future<void> NttAsync(bool forward, const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n);
+    void RunBConv(const uint64_t* x, const std::vector<uint64_t>& meta, uint64_t* result, size_t ringDim, int sizeP);
+
+    // 设备模数表索引，-1 为不在表里；onChip 时返回片上参数表槽位（FpgaManager::OnChipSlot），放不下为 -1
+    std::vector<int> DeviceIndices(const uint64_t* moduli, size_t numTowers, bool onChip) const;
+    int OnChipIndex(uint64_t modulus, size_t n) const;
+    void CountTransfer(size_t h2d, size_t d2h) {
+        m_h2d_bytes += h2d;
+        m_d2h_bytes += d2h;
+    }
+
+    std::mutex m_kernel_mutex;
+    DeviceBufferPool<DeviceBuffer> m_pool;
+    FpgaCommandQueue m_queue{2};
+
+    mutable std::mutex m_resident_mutex;  // 先于 m_kernel_mutex 加锁
+    std::unordered_map<ResidentId, Resident> m_resident;
+    ResidentId m_next_resident = 1;
+
+    std::vector<uint64_t> m_stored_moduli;
+    size_t m_num_q = 0;             // m_stored_moduli 中 Q 的个数（其后为 P）
+    std::vector<uint64_t> m_image;  // InitModuli 上传的设备镜像（常驻）
+    size_t m_stream_offset[2] = {0, 0};
+    size_t m_ring_dim         = 0;
+
+    std::atomic<uint64_t> m_h2d_bytes{0};
+    std::atomic<uint64_t> m_d2h_bytes{0};
+    std::atomic<uint64_t> m_launches{0};
+};
+
+#endif  // _FPGA_SIMULATOR_H_
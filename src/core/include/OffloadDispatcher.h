@@ -0,0 +1,287 @@
+#ifndef _OFFLOAD_DISPATCHER_H_
+#define _OFFLOAD_DISPATCHER_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "PolyAccelerator.h"
+
+// 卸载决策的算子类别（OffloadStats::ops 的下标）
+enum class AccelOp { NTT = 0, MODOP, BCONV, AUTO, COUNT };
+
+const char* AccelOpName(AccelOp op);
+
+// AUTO: 按代价模型逐个算子选 CPU / 设备；ALWAYS: 能卸载就卸载（原来的行为）；NEVER: 全部 CPU
+enum class OffloadPolicy { AUTO, ALWAYS, NEVER };
+
+// =============================================================
+// 代价模型（秒）
+// -------------------------------------------------------------
+// 设备：launches × 启动延迟 + H2D / D2H 字节 ÷ PCIe 带宽 + 计算量 ÷ kernel 吞吐
+// CPU  ：计算量 ÷ (单线程吞吐 × 线程数)，线程数 = min(limbs, 可用线程)
+// 计算量按 limb 计：NTT 为 n/2·log2(n) 个蝶形；MODOP / AUTO 为 n 个元素；
+// BCONV 为每个输出 limb n·KERNEL_LIMB_Q 个乘加。
+// 默认值是 U280 + PCIe Gen3 x16 的量级，OffloadDispatcher::Calibrate 在 InitModuli 之后实测覆盖。
+// =============================================================
+struct OffloadCostModel {
+    double h2d_bytes_per_s        = 8e9;
+    double d2h_bytes_per_s        = 8e9;
+    double launch_latency_s       = 30e-6;  // 一次空启动（不含数据）
+    double device_butterfly_per_s = 4e9;    // NTT kernel
+    double device_elem_per_s      = 2e9;    // modadd / modmul / auto / BConv MAC
+    double cpu_butterfly_per_s    = 2.5e8;  // 单线程
+    double cpu_elem_per_s         = 5e8;    // 单线程
+    bool calibrated               = false;
+
+    // limbs 个维度为 n 的 tower 在设备上（分 launches 次启动）/ CPU 上（threads 个线程）的预测耗时
+    double DeviceSeconds(AccelOp op, size_t n, size_t limbs, size_t launches = 1) const;
+    double CpuSeconds(AccelOp op, size_t n, size_t limbs, size_t threads = 1) const;
+};
+
+// 每类算子的决策统计
+struct OffloadOpStats {
+    uint64_t cpu_calls          = 0;  // 选了 CPU 的调用
+    uint64_t device_calls       = 0;  // 选了设备的调用
+    uint64_t declined           = 0;  // 选了设备但后端不接（形状 / 模数不支持），实际走了 CPU
+    uint64_t limbs              = 0;
+    double predicted_cpu_s      = 0;  // 所有决策的 CPU 预测耗时之和
+    double predicted_device_s   = 0;  // 所有决策的设备预测耗时之和
+    double predicted_chosen_s   = 0;  // 所选路径的预测耗时之和
+};
+
+struct OffloadStats {
+    std::array<OffloadOpStats, static_cast<size_t>(AccelOp::COUNT)> ops{};
+    uint64_t batches       = 0;  // 异步 NTT 攒批后的提交次数
+    uint64_t batched_limbs = 0;
+
+    const OffloadOpStats& operator[](AccelOp op) const {
+        return ops[static_cast<size_t>(op)];
+    }
+};
+
+std::ostream& operator<<(std::ostream& os, const OffloadStats& stats);
+
+// =============================================================
+// 卸载调度器
+// -------------------------------------------------------------
+// 包在具体后端外面的 PolyAccelerator（PolyAccelerator::Set / 默认选择时自动套上），
+// 每个 bool 算子先用代价模型比较 CPU 和设备，CPU 更快时返回 false，调用者照常走 CPU。
+// 异步 NTT（key-switch 的 DC 流水线）在提交线程内按 (方向, n) 攒批：攒到设备划算的 limb 数
+// （BreakEvenLimbs）时一次 NttBatchOffload 提交；等待 future 时还没攒够的批按模型选
+// CPU 或设备执行。批由它的 future 持有，一批的 future 全部丢弃时在析构里执行，
+// 所以 out 须活到 future 被 get() 或析构之后，future 不能比调度器活得久。
+// 钩子不加锁：模型按代（generation）复制到线程本地，统计为原子计数。
+// =============================================================
+class OffloadDispatcher : public PolyAccelerator {
+public:
+    explicit OffloadDispatcher(std::shared_ptr<PolyAccelerator> backend);
+    ~OffloadDispatcher() override;
+
+    // PolyAccelerator::Get() 的调度器（nullptr: CPU）
+    static OffloadDispatcher* Active();
+
+    // 维度 n、模数 q 的 CPU NTT（forward: 正变换），结果为 bit-reverse 顺序；没有 q 的表时返回 false。
+    // ChineseRemainderTransformFTTNat::PreCompute 注册，用于 CPU 标定和攒批的 CPU 执行。
+    using CpuTransform = std::function<bool(bool forward, uint64_t* data, uint64_t q, size_t n)>;
+    static void SetCpuTransform(CpuTransform transform);
+    static CpuTransform GetCpuTransform();
+
+    // 作用域内本线程的所有卸载请求都走 CPU（CPU 标定时避免钩子又回到加速器）
+    class ScopedCpuOnly {
+    public:
+        ScopedCpuOnly();
+        ~ScopedCpuOnly();
+        ScopedCpuOnly(const ScopedCpuOnly&)            = delete;
+        ScopedCpuOnly& operator=(const ScopedCpuOnly&) = delete;
+
+        static bool Active();
+
+    private:
+        bool m_prev;
+    };
+
+    PolyAccelerator& Backend() {
+        return *m_backend;
+    }
+
+    void SetPolicy(OffloadPolicy policy);
+    OffloadPolicy GetPolicy() const;
+
+    // 固定代价模型（之后 InitModuli 不再自动标定；否则只在第一次 InitModuli 时标定）
+    void SetCostModel(const OffloadCostModel& model);
+    OffloadCostModel GetCostModel() const;
+
+    // 用模数 modulus、维度 n 实测 PCIe 带宽、启动延迟、kernel 吞吐和 CPU 单线程吞吐；
+    // modulus 须已装载到设备，CPU 部分需要 modulus 的 NTT 表（没有时保留默认值）
+    OffloadCostModel Calibrate(uint64_t modulus, size_t n);
+
+    // 预测并记录一次决策：true 表示交给设备
+    bool Decide(AccelOp op, size_t n, size_t limbs);
+    // 一次启动至少要多少个 limb 设备才比 CPU 快（0: 1024 个 limb 以内都不划算）
+    size_t BreakEvenLimbs(AccelOp op, size_t n) const;
+
+    OffloadStats GetStats() const;
+    void ResetStats();
+
+    // 本线程等待中的攒批立即执行
+    void Flush();
+
+    // ------------------------------------------------------------
+    // PolyAccelerator
+    // ------------------------------------------------------------
+    const char* Name() const override {
+        return m_backend->Name();
+    }
+    bool IsReady() const override {
+        return m_backend->IsReady();
+    }
+    void InitModuli(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                    const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots,
+                    size_t ringDim = FPGA_RING_DIM) override;
+    bool HasModulus(uint64_t modulus) const override {
+        return m_backend->HasModulus(modulus);
+    }
+    size_t GetRingDim() const override {
+        return m_backend->GetRingDim();
+    }
+    bool SupportsRingDim(size_t n) const override {
+        return m_backend->SupportsRingDim(n);
+    }
+
+    bool NttForwardOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    bool NttInverseOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    bool NttBatchOffload(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers,
+                         size_t n) override;
+    std::future<void> NttForwardOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    std::future<void> NttInverseOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) override;
+    void Synchronize() override;
+
+    bool ModOpOffload(int opcode, const uint64_t* const* a, const uint64_t* const* b, uint64_t* const* out,
+                      const uint64_t* moduli, size_t numTowers, size_t n) override;
+
+    bool BConvOffload(const uint64_t* x, const uint64_t* w, const uint64_t* out_mod, uint64_t* result, size_t ringDim,
+                      int sizeP) override;
+    bool BConvTowerOffload(const uint64_t* x, const uint64_t* w_col, uint64_t out_mod, uint64_t* result,
+                           size_t ringDim) override;
+
+    bool AutoOffload(const uint64_t* in, uint64_t* out, uint32_t k, uint32_t kinv, uint64_t modulus,
+                     size_t n) override;
+
+    bool HksFusedOffload(const std::vector<HksDigit>& digits, const uint64_t* moduli, size_t sizeQlP,
+                         uint64_t* const* out0, uint64_t* const* out1, size_t n) override;
+
+    bool HksRotateBatchOffload(const uint64_t* const* digits, size_t numDigits, const uint64_t* const* first,
+                               const uint64_t* moduli, size_t sizeQlP, const std::vector<HksRotation>& rotations,
+                               size_t n) override;
+
+    ResidentId AllocResident(const uint64_t* moduli, size_t numTowers, size_t n) override;
+    void FreeResident(ResidentId id) override {
+        m_backend->FreeResident(id);
+    }
+    bool WriteResident(ResidentId id, const uint64_t* const* towers) override {
+        return m_backend->WriteResident(id, towers);
+    }
+    bool ReadResident(ResidentId id, uint64_t* const* towers) override {
+        return m_backend->ReadResident(id, towers);
+    }
+    bool ModOpResident(int opcode, ResidentId a, ResidentId b, ResidentId out) override;
+    bool NttResident(bool forward, ResidentId id) override;
+
+    LinkTiming MeasureLink(size_t bytes) override {
+        return m_backend->MeasureLink(bytes);
+    }
+    FpgaTransferStats GetTransferStats() const override {
+        return m_backend->GetTransferStats();
+    }
+    void ResetTransferStats() override {
+        m_backend->ResetTransferStats();
+    }
+
+private:
+    // 一批等待中的异步 NTT（同方向、同 n）；第一个 Claim() 的一方执行，没人认领时析构执行。
+    // future 可以交给别的线程等待，所以追加和认领都持有 mutex。
+    struct Batch {
+        OffloadDispatcher* owner;
+        bool forward;
+        size_t n;
+        std::vector<uint64_t*> towers;
+        std::vector<uint64_t> moduli;
+        std::mutex mutex;
+        bool started = false;
+        std::promise<void> done;
+        std::shared_future<void> ready;
+
+        ~Batch();
+        bool Claim() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return !std::exchange(started, true);
+        }
+        // 还没开始执行时追加一个 tower，返回追加后的 tower 数（0: 已开始）
+        size_t Append(uint64_t* tower, uint64_t modulus) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (started)
+                return 0;
+            towers.push_back(tower);
+            moduli.push_back(modulus);
+            return towers.size();
+        }
+    };
+
+    // 每个线程、每个调度器一份：代价模型的副本和攒批队列
+    struct ThreadState {
+        uint64_t generation = 0;
+        OffloadCostModel model;
+        std::vector<std::weak_ptr<Batch>> pending;
+    };
+
+    struct AtomicOpStats {
+        std::atomic<uint64_t> cpu_calls{0};
+        std::atomic<uint64_t> device_calls{0};
+        std::atomic<uint64_t> declined{0};
+        std::atomic<uint64_t> limbs{0};
+        std::atomic<double> predicted_cpu_s{0};
+        std::atomic<double> predicted_device_s{0};
+        std::atomic<double> predicted_chosen_s{0};
+    };
+
+    static std::unordered_map<uint64_t, ThreadState>& ThreadStates();
+    ThreadState& LocalState() const;
+    // 本线程的模型副本，m_generation 变了才在锁内重新复制
+    const OffloadCostModel& LocalModel() const;
+
+    std::future<void> SubmitNtt(bool forward, const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n);
+    // 还没人执行 batch 时在本线程执行；之后等它完成
+    void FlushBatch(const std::shared_ptr<Batch>& batch);
+    void RunBatch(Batch& batch);
+    bool RunOnCpu(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers, size_t n);
+    // 按策略在预测耗时之间选择并记录
+    bool Choose(AccelOp op, size_t limbs, double cpu_s, double device_s);
+    bool DecideSingle(AccelOp op, size_t n);
+    void RecordDeclined(AccelOp op);
+
+    std::shared_ptr<PolyAccelerator> m_backend;
+    const uint64_t m_id;  // 线程本地状态的键（地址会被复用）
+
+    std::atomic<OffloadPolicy> m_policy;
+
+    mutable std::mutex m_model_mutex;  // 只有写模型和刷新线程副本时持有
+    OffloadCostModel m_model;
+    bool m_fixed_model = false;
+    std::atomic<uint64_t> m_generation{1};
+
+    std::array<AtomicOpStats, static_cast<size_t>(AccelOp::COUNT)> m_ops;
+    std::atomic<uint64_t> m_batches{0};
+    std::atomic<uint64_t> m_batched_limbs{0};
+};
+
+#endif  // _OFFLOAD_DISPATCHER_H_
@@ -0,0 +1,244 @@
+#ifndef _POLY_ACCELERATOR_H_
+#define _POLY_ACCELERATOR_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// =============================================================
+// Top kernel 的公共定义（与 fpga_backend/include/opcode.h、define.h 一致）
+// =============================================================
+#define OP_INIT   0
+#define OP_ADD    1
+#define OP_SUB    2
+#define OP_MULT   3
+#define OP_NTT    4
+#define OP_INTT   5
+#define OP_BCONV  6
+#define OP_AUTO   7
+#define OP_HKS_DIGIT 8
+#define OP_NTT_STREAM 9
+#define OP_HKS_ROTATE 10
+
+#define MAX_LIMBS 5
+#define FPGA_RING_DIM  4096
+#define STAGE_NUM 12
+
+// OP_NTT_STREAM: 运行时 N，逐 limb 经 HBM 流过 kernel 的 URAM buffer
+#define FPGA_MAX_RING_DIM      65536
+#define FPGA_STREAM_TILE_BYTES (64u << 20)  // 单次启动的最大输入字节数，超出则分块启动
+
+// Host <-> device traffic and kernel launches (cumulative, see ResetTransferStats)
+struct FpgaTransferStats {
+    uint64_t h2d_bytes = 0;
+    uint64_t d2h_bytes = 0;
+    uint64_t launches  = 0;
+};
+
+// 一次链路测量（秒）：bytes 字节的 H2D、D2H，以及一次不带数据的 kernel 启动
+struct LinkTiming {
+    double h2d_s    = 0;
+    double d2h_s    = 0;
+    double launch_s = 0;
+};
+
+// =============================================================
+// 多项式加速器接口
+// -------------------------------------------------------------
+// DCRTPoly / NTT / key-switch 的卸载钩子只通过这个接口访问设备，
+// 具体后端在运行时选择（见 Get / Set）：
+//   "fpga" : FpgaManager，XRT + Top kernel（需要 OPENFHE_FPGA_ENABLE 和板卡）
+//   "sim"  : FpgaSimulator，进程内直接运行 fpga_backend/src 的 kernel（FPGA_STANDALONE_TEST 编译），
+//            不需要 XRT，CI 上可以跑完整的卸载路径
+//   "cpu"  : 不卸载（Get() 返回 nullptr）
+// 所有 bool 返回的操作：false 表示该形状 / 模数不能在设备上执行，调用者走 CPU，
+// 此时输出未被修改。
+// =============================================================
+class PolyAccelerator {
+public:
+    virtual ~PolyAccelerator() = default;
+
+    // BConv systolic array: LIMB_Q rows × MAX_OUT_COLS columns (3×5)
+    static const int KERNEL_LIMB_Q       = 3;
+    static const int KERNEL_MAX_OUT_COLS = 5;  // LIMB_Q + LIMB_P
+
+    // 融合 key-switch（OP_HKS_DIGIT）的一个 digit
+    struct HksDigit {
+        const uint64_t* const* towers;  // [alpha] digit towers, EVALUATION
+        size_t alpha;                   // towers in this digit
+        size_t start;                   // first Ql index of the digit
+        const uint64_t* qhat_inv;       // [alpha] [(Q_j/q_i)^-1]_{q_i}
+        const uint64_t* qhat_mod;       // [alpha][sizeQlP - alpha] [Q_j/q_i]_{compl}, row-major
+        const uint64_t* const* key_b;   // [sizeQlP] key towers in QlP order
+        const uint64_t* const* key_a;   // [sizeQlP]
+    };
+
+    // 批量旋转（OP_HKS_ROTATE）的一个自同态
+    struct HksRotation {
+        uint32_t auto_index;            // k（奇数，< 2n）
+        const uint64_t* const* key_b;   // [numDigits × sizeQlP] 该 k 的旋转 key towers，digit 优先，QlP 顺序
+        const uint64_t* const* key_a;
+        uint64_t* const* out0;          // [sizeQlP] σ_k(Σ_j digit_j · b_j + first)
+        uint64_t* const* out1;          // [sizeQlP] σ_k(Σ_j digit_j · a_j)
+    };
+
+    // kernel 的 Barrett 约减（k = ceil(log2 p)）只对 < 2^(2k) 的乘积正确。BConv 把输入模数下的值乘到
+    // 输出模数上，输出模数比输入窄（如 FLEXIBLEAUTOEXT 的小模数）时结果错误，这种形状留在 CPU
+    static bool BConvFits(const uint64_t* in_mod, size_t numIn, const uint64_t* out_mod, size_t numOut) {
+        auto bits = [](uint64_t p) {
+            size_t b = 0;
+            while (b < 64 && (p - 1) >> b)
+                ++b;
+            return b;
+        };
+        size_t in_bits = 0;
+        for (size_t i = 0; i < numIn; ++i)
+            in_bits = std::max(in_bits, bits(in_mod[i]));
+        for (size_t j = 0; j < numOut; ++j) {
+            if (bits(out_mod[j]) < in_bits)
+                return false;
+        }
+        return true;
+    }
+
+    // 把模数 q、维度 n 的 bit-reverse 正/逆 twiddle 表拷进 fwd / inv（各 n 项）；找不到返回 false（InitModuli 自行计算）。
+    // 拷贝而不是返回指针：表的所有者可能在别的线程改写它，拷贝要在它的锁里做完
+    using TwiddleTableLookup =
+        std::function<bool(uint64_t q, size_t n, std::vector<uint64_t>& fwd, std::vector<uint64_t>& inv)>;
+
+    // ------------------------------------------------------------
+    // 后端注册表
+    // ------------------------------------------------------------
+    // 当前后端；nullptr 表示全部走 CPU。第一次调用时按环境变量 OPENFHE_ACCEL（fpga / sim / cpu）选择，
+    // 未设置时有 OPENFHE_FPGA_ENABLE 且板卡就绪用 fpga，否则 cpu。
+    static PolyAccelerator* Get();
+    // 与 Get() 相同，但共享所有权：持有者（例如常驻数据）在 Set() 之后仍能安全访问原后端
+    static std::shared_ptr<PolyAccelerator> GetShared();
+
+    // 运行时切换后端（nullptr: CPU）。旧后端在最后一个 GetShared() 持有者放手后销毁，
+    // 所以 Get() 返回的裸指针只在下一次 Set() 之前有效，跨 Set() 使用须改用 GetShared()。
+    // 非空后端会套上 OffloadDispatcher（策略见环境变量 OPENFHE_OFFLOAD=auto / always / never），
+    // Get() 返回的是调度器，具体后端用 OffloadDispatcher::Active()->Backend() 取。
+    static void Set(std::shared_ptr<PolyAccelerator> backend);
+
+    // 按名字构造后端；名字未知时抛异常，后端不可用（例如没有板卡）时返回 nullptr
+    static std::shared_ptr<PolyAccelerator> Create(const std::string& name);
+
+    // ChineseRemainderTransformFTTNat::PreCompute 注册，所有后端的 InitModuli 直接复用其缓存
+    static void SetTwiddleTableLookup(TwiddleTableLookup lookup);
+    static TwiddleTableLookup GetTwiddleTableLookup();
+
+    // ------------------------------------------------------------
+    // 设备状态
+    // ------------------------------------------------------------
+    virtual const char* Name() const = 0;
+    virtual bool IsReady() const     = 0;
+
+    // ringDim: 上下文的环维度，roots 为对应的 2*ringDim 次本原单位根
+    virtual void InitModuli(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                            const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots,
+                            size_t ringDim = FPGA_RING_DIM) = 0;
+    virtual bool HasModulus(uint64_t modulus) const = 0;
+    // 当前 InitModuli 装载的环维度（0: 流式 NTT 不可用）
+    virtual size_t GetRingDim() const = 0;
+    // 维度为 n 的多项式能否走 NttBatchOffload
+    virtual bool SupportsRingDim(size_t n) const = 0;
+
+    // ------------------------------------------------------------
+    // NTT / INTT
+    // ------------------------------------------------------------
+    // 单 limb，n == FPGA_RING_DIM；in == out 允许
+    virtual bool NttForwardOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) = 0;
+    virtual bool NttInverseOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) = 0;
+    // towers[i] 原地变换（forward: NTT, 否则 INTT），所有 tower 尽量一次启动
+    virtual bool NttBatchOffload(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers,
+                                 size_t n) = 0;
+    // 异步单 limb NTT（H2D / Run / D2H 流水线）。模数不在设备上、n 不是 SupportsRingDim 的维度
+    // 或设备未就绪时命令不提交：future 携带 std::invalid_argument，out 保持不变
+    virtual std::future<void> NttForwardOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                                     size_t n) = 0;
+    virtual std::future<void> NttInverseOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                                     size_t n) = 0;
+    // 等待所有已提交的异步命令完成
+    virtual void Synchronize() = 0;
+
+    // ------------------------------------------------------------
+    // 逐元素 modadd / modsub / modmul（opcode: OP_ADD / OP_SUB / OP_MULT）
+    // ------------------------------------------------------------
+    // out[i] = a[i] op b[i] mod moduli[i]；out 可与 a 或 b 相同
+    virtual bool ModOpOffload(int opcode, const uint64_t* const* a, const uint64_t* const* b, uint64_t* const* out,
+                              const uint64_t* moduli, size_t numTowers, size_t n) = 0;
+
+    // ------------------------------------------------------------
+    // BConv
+    // ------------------------------------------------------------
+    // x: [KERNEL_LIMB_Q × n]（已乘 QHatInvModq）；w: [KERNEL_LIMB_Q × KERNEL_MAX_OUT_COLS]；
+    // result: [sizeP × n]
+    virtual bool BConvOffload(const uint64_t* x, const uint64_t* w, const uint64_t* out_mod, uint64_t* result,
+                              size_t ringDim, int sizeP) = 0;
+    // 单输出 tower：w_col 为该 tower 的 [KERNEL_LIMB_Q] 权重列
+    virtual bool BConvTowerOffload(const uint64_t* x, const uint64_t* w_col, uint64_t out_mod, uint64_t* result,
+                                   size_t ringDim) = 0;
+
+    // ------------------------------------------------------------
+    // Automorphism（系数表示）：X -> X^k，kinv = k^-1 mod 2n
+    // ------------------------------------------------------------
+    virtual bool AutoOffload(const uint64_t* in, uint64_t* out, uint32_t k, uint32_t kinv, uint64_t modulus,
+                             size_t n) = 0;
+
+    // ------------------------------------------------------------
+    // 融合 hybrid key-switch：所有 digit 的 INTT -> BConv -> NTT -> MAC
+    // ------------------------------------------------------------
+    // moduli: QlP 顺序的 tower 模数。out0/out1: sizeQlP 个 tower 的输出地址。
+    virtual bool HksFusedOffload(const std::vector<HksDigit>& digits, const uint64_t* moduli, size_t sizeQlP,
+                                 uint64_t* const* out0, uint64_t* const* out1, size_t n) = 0;
+
+    // ------------------------------------------------------------
+    // 批量 hoisted 旋转：EvalFastRotationPrecompute 的 digits 上传一次，
+    // 每个旋转在设备上做 key MAC 和 EVALUATION 下的自同态，结果一起读回
+    // ------------------------------------------------------------
+    // digits: [numDigits × sizeQlP] 扩展到 QlP 的 digit towers（EVALUATION），digit 优先；
+    // first: nullptr 或 [sizeQlP]，自同态前加到每个旋转的 b 侧（EvalFastRotationExt 的 P·c0）
+    virtual bool HksRotateBatchOffload(const uint64_t* const* digits, size_t numDigits, const uint64_t* const* first,
+                                       const uint64_t* moduli, size_t sizeQlP,
+                                       const std::vector<HksRotation>& rotations, size_t n) = 0;
+
+    // ------------------------------------------------------------
+    // 常驻设备内存的 tower 组（DeviceDCRTPoly）
+    // ------------------------------------------------------------
+    // 连续的卸载算子直接读写 HBM 里的 tower，只有 Write/ReadResident 经过 PCIe（计入 GetTransferStats）。
+    // 句柄 0 无效。AllocResident 只分配不传输；n 不是 FPGA_RING_DIM 或模数不在片上参数表时返回 0。
+    using ResidentId = uint64_t;
+    virtual ResidentId AllocResident(const uint64_t* moduli, size_t numTowers, size_t n) = 0;
+    virtual void FreeResident(ResidentId id) = 0;
+    virtual bool WriteResident(ResidentId id, const uint64_t* const* towers) = 0;
+    virtual bool ReadResident(ResidentId id, uint64_t* const* towers) = 0;
+    // 设备上 out = a op b（OP_ADD / OP_SUB / OP_MULT），三者模数相同；out 可与 a 或 b 相同
+    virtual bool ModOpResident(int opcode, ResidentId a, ResidentId b, ResidentId out) = 0;
+    // 原地 NTT（forward）/ INTT
+    virtual bool NttResident(bool forward, ResidentId id) = 0;
+
+    // ------------------------------------------------------------
+    // 统计
+    // ------------------------------------------------------------
+    // 代价模型标定用（OffloadDispatcher::Calibrate），不计入 GetTransferStats
+    virtual LinkTiming MeasureLink(size_t bytes)       = 0;
+    virtual FpgaTransferStats GetTransferStats() const = 0;
+    virtual void ResetTransferStats()                  = 0;
+
+protected:
+    // 未提交的异步命令（见 NttForwardOffloadAsync）
+    static std::future<void> Rejected(const std::string& what) {
+        std::promise<void> failed;
+        failed.set_exception(std::make_exception_ptr(std::invalid_argument(what)));
+        return failed.get_future();
+    }
+};
+
+#endif  // _POLY_ACCELERATOR_H_
@@ -928,6 +928,28 @@ public:
                                              const std::vector<std::vector<NativeInteger>>& QHatModp,
                                              const std::vector<DoubleNativeInt>& modpBarrettMu) const = 0;
 
+    /**
+   * @brief Computes a single output tower of ApproxSwitchCRTBasis:
+   * {X}_{Q} -> [X']_{p_j}
+   * Only tower j of the result is materialized, so callers that consume the
+   * target basis one tower at a time never hold the full {X'}_P.
+   *
+   * @param &paramsQ parameters for the CRT basis {q_1,...,q_l}
+   * @param &paramsP parameters for the CRT basis {p_1,...,p_k}
+   * @param j index of the output tower in {p_1,...,p_k}
+   * @param &QHatinvModq precomputed values for [(Q/q_i)^{-1}]_{q_i}
+   * @param &QHatinvModqPrecon NTL-specific precomputations
+   * @param &QHatModp precomputed values for [Q/q_i]_{p_j}
+   * @param &modpBarrettMu 128-bit Barrett reduction precomputed values
+   * @return tower j of the representation of {X + alpha*Q} in basis {P}.
+   */
+    virtual TowerType ApproxSwitchCRTBasisTower(const std::shared_ptr<Params>& paramsQ,
+                                                const std::shared_ptr<Params>& paramsP, uint32_t j,
+                                                const std::vector<NativeInteger>& QHatInvModq,
+                                                const std::vector<NativeInteger>& QHatInvModqPrecon,
+                                                const std::vector<std::vector<NativeInteger>>& QHatModp,
+                                                const std::vector<DoubleNativeInt>& modpBarrettMu) const = 0;
+
     /**
    * @brief Performs approximate modulus raising:
    * {X}_{Q} -> {X'}_{Q,P}.
@@ -41,13 +41,12 @@
 #include <type_traits>
 #include <iomanip>  // 用于 std::setw 格式化输出
 
-#ifdef OPENFHE_FPGA_ENABLE
-    #include "FpgaManager.h"
-#endif
+#include "PolyAccelerator.h"
 
 
 #include "lattice/hal/default/poly-impl.h"
 #include "lattice/hal/default/dcrtpoly.h"
+#include "math/hal/intnat/ntt-simd.h"
 
 #include "utils/exception.h"
 #include "utils/inttypes.h"
@@ -65,6 +64,68 @@
 
 namespace lbcrypto {
 
+// 逐 tower 的 modadd / modsub / modmul 交给当前加速器（out 的 tower 须已分配存储）。
+// 返回 false 表示没有加速器或形状 / 模数不支持，out 未被修改，调用者走 CPU。
+template <typename PolyType>
+bool AcceleratorModOp(int opcode, const std::vector<PolyType>& a, const std::vector<PolyType>& b,
+                      std::vector<PolyType>& out) {
+    auto* accel = PolyAccelerator::Get();
+    const size_t size{a.size()};
+    if (accel == nullptr || size == 0)
+        return false;
+    std::vector<const uint64_t*> pa(size), pb(size);
+    std::vector<uint64_t*> po(size);
+    std::vector<uint64_t> moduli(size);
+    for (size_t i = 0; i < size; ++i) {
+        if (a[i].IsEmpty() || b[i].IsEmpty() || out[i].IsEmpty())
+            return false;
+        pa[i]     = reinterpret_cast<const uint64_t*>(&a[i][0]);
+        pb[i]     = reinterpret_cast<const uint64_t*>(&b[i][0]);
+        po[i]     = reinterpret_cast<uint64_t*>(&out[i][0]);
+        moduli[i] = a[i].GetModulus().ConvertToInt();
+    }
+    return accel->ModOpOffload(opcode, pa.data(), pb.data(), po.data(), moduli.data(), size, a[0].GetLength());
+}
+
+#if defined(HAVE_INT128) && (NATIVEINT == 64) && !defined(WITH_REDUCED_NOISE)
+// 基转换的主机侧分块实现（intnat::BConvLazy）：x 的前 sizeQ 个 tower 转到 out，
+// out[j] 用 QHatModp 的第 col0 + j 列。返回 false 时 out 未修改，调用者走逐系数的实现。
+template <typename PolyType>
+bool HostBConv(const std::vector<PolyType>& x, uint32_t sizeQ, const std::vector<NativeInteger>& QHatInvModq,
+               const std::vector<NativeInteger>& QHatInvModqPrecon,
+               const std::vector<std::vector<NativeInteger>>& QHatModp, uint32_t col0,
+               const std::vector<PolyType*>& out) {
+    const size_t sizeP{out.size()};
+    if (sizeQ == 0 || sizeP == 0)
+        return false;
+    intnat::BConvParams params;
+    params.q.resize(sizeQ);
+    params.qHatInv.resize(sizeQ);
+    params.qHatInvPrecon.resize(sizeQ);
+    params.p.resize(sizeP);
+    params.qHatModp.resize(sizeQ * sizeP);
+    std::vector<const uint64_t*> px(sizeQ);
+    std::vector<uint64_t*> py(sizeP);
+    for (uint32_t i = 0; i < sizeQ; ++i) {
+        if (x[i].IsEmpty())
+            return false;
+        params.q[i]             = x[i].GetModulus().ConvertToInt();
+        params.qHatInv[i]       = QHatInvModq[i].ConvertToInt();
+        params.qHatInvPrecon[i] = QHatInvModqPrecon[i].ConvertToInt();
+        for (size_t j = 0; j < sizeP; ++j)
+            params.qHatModp[i * sizeP + j] = QHatModp[i][col0 + j].ConvertToInt();
+        px[i] = reinterpret_cast<const uint64_t*>(&x[i][0]);
+    }
+    for (size_t j = 0; j < sizeP; ++j) {
+        if (out[j]->IsEmpty())
+            return false;
+        params.p[j] = out[j]->GetModulus().ConvertToInt();
+        py[j]       = reinterpret_cast<uint64_t*>(&(*out[j])[0]);
+    }
+    return intnat::BConvLazy(params, px.data(), py.data(), x[0].GetLength());
+}
+#endif
+
 template <typename VecType>
 DCRTPolyImpl<VecType>::DCRTPolyImpl(const PolyLargeType& rhs,
                                     const std::shared_ptr<DCRTPolyImpl::Params>& params) noexcept
@@ -132,6 +193,187 @@ DCRTPolyImpl<VecType>::DCRTPolyImpl(const std::vector<DCRTPolyImpl::PolyType>& t
     m_params = std::make_shared<DCRTPolyImpl::Params>(cyclotomicOrder, parms);
 }
 
+template <typename VecType>
+std::vector<typename DCRTPolyImpl<VecType>::PolyType> DCRTPolyImpl<VecType>::ContiguousCopy(
+    const std::vector<PolyType>& towers) {
+    size_t n{0};
+    for (const auto& t : towers) {
+        if (!t.IsEmpty()) {
+            n = t.GetLength();
+            break;
+        }
+    }
+    if (n == 0)
+        return towers;
+    auto slab = std::make_shared<intnat::TowerSlab>(towers.size(), n * sizeof(NativeInteger));
+    std::vector<PolyType> out;
+    out.reserve(towers.size());
+    for (size_t i = 0; i < towers.size(); ++i) {
+        const auto& t{towers[i]};
+        if (t.IsEmpty())
+            out.push_back(t);
+        else
+            out.emplace_back(t.GetParams(), t.GetFormat(), NativeVector(t.GetValues(), NativeVector::Allocator(slab, i)));
+    }
+    return out;
+}
+
+template <typename VecType>
+std::vector<typename DCRTPolyImpl<VecType>::PolyType> DCRTPolyImpl<VecType>::ContiguousZero(
+    const std::vector<std::shared_ptr<typename PolyType::Params>>& params, Format format) {
+    std::vector<PolyType> out;
+    if (params.empty())
+        return out;
+    auto slab = std::make_shared<intnat::TowerSlab>(params.size(), params[0]->GetRingDimension() * sizeof(NativeInteger));
+    out.reserve(params.size());
+    for (size_t i = 0; i < params.size(); ++i) {
+        const auto& p{params[i]};
+        out.emplace_back(p, format,
+                         NativeVector(p->GetRingDimension(), p->GetModulus(), NativeVector::Allocator(slab, i)));
+    }
+    return out;
+}
+
+template <typename VecType>
+bool DCRTPolyImpl<VecType>::IsContiguous() const {
+    return GetTowerSlab() != nullptr;
+}
+
+template <typename VecType>
+std::shared_ptr<intnat::TowerSlab> DCRTPolyImpl<VecType>::GetTowerSlab() const {
+    if (m_vectors.empty() || m_vectors[0].IsEmpty())
+        return nullptr;
+    auto slab = m_vectors[0].GetValues().GetAllocator().GetSlab();
+    if (!slab || slab->NumTowers() != m_vectors.size())
+        return nullptr;
+    for (size_t i = 0; i < m_vectors.size(); ++i) {
+        if (m_vectors[i].IsEmpty() || m_vectors[i].GetLength() == 0)
+            return nullptr;
+        const auto* data = &m_vectors[i].GetValues()[0];
+        if (static_cast<const void*>(data) != slab->Tower(i))
+            return nullptr;
+    }
+    return slab;
+}
+
+template <typename VecType>
+DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::FromTowerSlab(const std::shared_ptr<Params>& params, Format format,
+                                                           const std::shared_ptr<intnat::TowerSlab>& slab) {
+    const auto& towers{params->GetParams()};
+    const size_t n{params->GetRingDimension()};
+    if (!slab || slab->NumTowers() != towers.size() || slab->TowerBytes() < n * sizeof(NativeInteger))
+        OPENFHE_THROW("tower slab does not fit the parameters");
+    DCRTPolyImpl<VecType> ans;
+    ans.m_params = params;
+    ans.m_format = format;
+    ans.m_vectors.reserve(towers.size());
+    for (size_t i = 0; i < towers.size(); ++i) {
+        const auto& p{towers[i]};
+        ans.m_vectors.emplace_back(p, format, NativeVector(n, p->GetModulus(), NativeVector::Allocator(slab, i)));
+    }
+    return ans;
+}
+
+template <typename VecType>
+void DCRTPolyImpl<VecType>::Pack() {
+    if (!IsContiguous())
+        m_vectors = ContiguousCopy(m_vectors);
+}
+
+template <typename VecType>
+DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::FromSeed(const std::shared_ptr<Params>& params, const PRNGSeed& seed,
+                                                      uint32_t stream) {
+    DCRTPolyImpl<VecType> ans(params, Format::EVALUATION, true);
+    const size_t size = ans.m_vectors.size();
+    const uint32_t n  = ans.GetRingDimension();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
+    for (size_t i = 0; i < size; ++i) {
+        auto& v = ans.m_vectors[i];
+        SeedUniformGenerator::GenerateTower(seed, stream, i, v.GetModulus().ConvertToInt(), n,
+                                            reinterpret_cast<uint64_t*>(&v[0]));
+    }
+    return ans;
+}
+
+template <typename VecType>
+void DCRTPolyImpl<VecType>::KeyMultAccumulate(const std::vector<DCRTPolyImpl>& digits,
+                                              const std::vector<DCRTPolyImpl>& b, const std::vector<DCRTPolyImpl>& a,
+                                              uint32_t sizeQl, DCRTPolyImpl& out0, DCRTPolyImpl& out1) {
+    KeyMultAccumulateTowers(digits, b, sizeQl, out0, out1,
+                      [&a](size_t j, size_t k, PolyType&) -> const PolyType& { return a[j].m_vectors[k]; });
+}
+
+template <typename VecType>
+void DCRTPolyImpl<VecType>::KeyMultAccumulate(const std::vector<DCRTPolyImpl>& digits,
+                                              const std::vector<DCRTPolyImpl>& b, const PRNGSeed& aSeed,
+                                              uint32_t sizeQl, DCRTPolyImpl& out0, DCRTPolyImpl& out1) {
+    KeyMultAccumulateTowers(digits, b, sizeQl, out0, out1,
+                      [&b, &aSeed](size_t j, size_t k, PolyType& scratch) -> const PolyType& {
+                          const auto& bjk = b[j].m_vectors[k];
+                          scratch         = PolyType(bjk.GetParams(), Format::EVALUATION, true);
+                          SeedUniformGenerator::GenerateTower(aSeed, j, k, bjk.GetModulus().ConvertToInt(),
+                                                              bjk.GetRingDimension(),
+                                                              reinterpret_cast<uint64_t*>(&scratch[0]));
+                          return scratch;
+                      });
+}
+
+template <typename VecType>
+template <typename TowerA>
+void DCRTPolyImpl<VecType>::KeyMultAccumulateTowers(const std::vector<DCRTPolyImpl>& digits,
+                                                    const std::vector<DCRTPolyImpl>& b, uint32_t sizeQl,
+                                                    DCRTPolyImpl& out0, DCRTPolyImpl& out1, TowerA&& towerA) {
+    const size_t numDigits = digits.size();
+    const size_t size      = out0.m_vectors.size();
+    const uint32_t n       = out0.GetRingDimension();
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
+    for (size_t i = 0; i < size; ++i) {
+        auto& o0 = out0.m_vectors[i];
+        auto& o1 = out1.m_vectors[i];
+
+        std::vector<intnat::MacTerm> terms(numDigits);
+        std::vector<PolyType> scratch(numDigits);
+        bool lazy = !o0.IsEmpty() && !o1.IsEmpty();
+        for (size_t j = 0; j < numDigits && lazy; ++j) {
+            const size_t k  = (i < sizeQl) ? i : i + b[j].m_vectors.size() - size;
+            const auto& cj  = digits[j].m_vectors[i];
+            const auto& bjk = b[j].m_vectors[k];
+            lazy            = !cj.IsEmpty() && !bjk.IsEmpty();
+            if (!lazy)
+                break;
+            const auto& ajk = towerA(j, k, scratch[j]);
+            lazy            = !ajk.IsEmpty();
+            if (lazy)
+                terms[j] = {reinterpret_cast<const uint64_t*>(&cj[0]), reinterpret_cast<const uint64_t*>(&bjk[0]),
+                            reinterpret_cast<const uint64_t*>(&ajk[0])};
+        }
+        if (lazy && intnat::KeyMacLazy(terms, n, o0.GetModulus().ConvertToInt(), reinterpret_cast<uint64_t*>(&o0[0]),
+                                       reinterpret_cast<uint64_t*>(&o1[0])))
+            continue;
+
+        // 模数超出 SIMD 内核的范围：逐项 ModMul + ModAdd
+        o0 = PolyType(o0.GetParams(), Format::EVALUATION, true);
+        o1 = PolyType(o1.GetParams(), Format::EVALUATION, true);
+        for (size_t j = 0; j < numDigits; ++j) {
+            const size_t k = (i < sizeQl) ? i : i + b[j].m_vectors.size() - size;
+            const auto& cj = digits[j].m_vectors[i];
+            o0 += cj * b[j].m_vectors[k];
+            o1 += cj * towerA(j, k, scratch[j]);
+        }
+    }
+}
+
+template <typename VecType>
+bool DCRTPolyImpl<VecType>::SameContiguousShape(const std::vector<PolyType>& towers) const {
+    if (towers.size() != m_vectors.size() || !IsContiguous())
+        return false;
+    for (size_t i = 0; i < towers.size(); ++i) {
+        if (!towers[i].IsEmpty() && towers[i].GetLength() > m_vectors[i].GetLength())
+            return false;
+    }
+    return true;
+}
+
 /*The dgg will be the seed to populate the towers of the DCRTPolyImpl with
  * random numbers. The algorithm to populate the towers can be seen below. */
 template <typename VecType>
@@ -415,42 +657,25 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Minus(const DCRTPolyImpl& rhs) cons
     if (m_vectors[0].GetModulus() != rhs.m_vectors[0].GetModulus())
         OPENFHE_THROW("Modulus missmatch");
 
+    if (ContiguousStorage()) {
+        DCRTPolyImpl<VecType> tmp(*this);
+        if (AcceleratorModOp(OP_SUB, tmp.m_vectors, rhs.m_vectors, tmp.m_vectors))
+            return tmp;
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
+        for (size_t i = 0; i < size; ++i)
+            tmp.m_vectors[i] -= rhs.m_vectors[i];
+        return tmp;
+    }
+
     DCRTPolyImpl<VecType> tmp(m_params, m_format);
 
  
-#ifdef OPENFHE_FPGA_ENABLE
-    auto& fpga = FpgaManager::GetInstance();
-    if (fpga.IsReady() && size <= 5) {  // 批量处理最多5个limb
-        size_t ringDim = m_vectors[0].GetLength();
-        
-        // 准备连续内存的buffer
-        std::vector<uint64_t> flat_a(size * ringDim);
-        std::vector<uint64_t> flat_b(size * ringDim);
-        std::vector<uint64_t> flat_result(size * ringDim);
-        
-        int mod_idx_start = fpga.GetModIndex(m_vectors[0].GetModulus().ConvertToInt());
-        
-        // 打包所有limb的数据
-        for (size_t i = 0; i < size; ++i) {
-            tmp.m_vectors[i] = m_vectors[i];  // 初始化
-            const uint64_t* pa = reinterpret_cast<const uint64_t*>(&m_vectors[i][0]);
-            const uint64_t* pb = reinterpret_cast<const uint64_t*>(&rhs.m_vectors[i][0]);
-            std::memcpy(&flat_a[i * ringDim], pa, ringDim * sizeof(uint64_t));
-            std::memcpy(&flat_b[i * ringDim], pb, ringDim * sizeof(uint64_t));
-        }
-        
-        // 一次FPGA调用处理所有limb
-        fpga.ModOpBatchOffload(OP_SUB, flat_a.data(), flat_b.data(), flat_result.data(),
-                               mod_idx_start, ringDim, size);
-        
-        // 解包结果
-        for (size_t i = 0; i < size; ++i) {
-            uint64_t* pr = reinterpret_cast<uint64_t*>(&tmp.m_vectors[i][0]);
-            std::memcpy(pr, &flat_result[i * ringDim], ringDim * sizeof(uint64_t));
-        }
-        return tmp;
+    if (PolyAccelerator::Get() != nullptr) {
+        for (size_t i = 0; i < size; ++i)
+            tmp.m_vectors[i] = m_vectors[i];  // 给输出 tower 分配存储
+        if (AcceleratorModOp(OP_SUB, m_vectors, rhs.m_vectors, tmp.m_vectors))
+            return tmp;
     }
-#endif // OPENFHE_FPGA_ENABLE
 
 #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
     for (size_t i = 0; i < size; ++i)
@@ -681,38 +906,26 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Plus(const DCRTPolyType& rhs) const
     if (m_vectors[0].GetModulus() != rhs.m_vectors[0].GetModulus())
         OPENFHE_THROW("Modulus missmatch");
 
+    if (ContiguousStorage()) {
+        // 结果一次拷进新 slab 后原地相加，不再逐 tower 分配
+        DCRTPolyType tmp(*this);
+        if (AcceleratorModOp(OP_ADD, tmp.m_vectors, rhs.m_vectors, tmp.m_vectors))
+            return tmp;
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
+        for (size_t i = 0; i < size; ++i)
+            tmp.m_vectors[i].GetValues().ModAddNoCheckEq(rhs.m_vectors[i].GetValues());
+        return tmp;
+    }
+
     DCRTPolyType tmp(m_params, m_format);
 
  
-#ifdef OPENFHE_FPGA_ENABLE
-    auto& fpga = FpgaManager::GetInstance();
-    if (fpga.IsReady() && size <= 5) {  // 批量处理最多5个limb
-        size_t ringDim = m_vectors[0].GetLength();
-        
-        std::vector<uint64_t> flat_a(size * ringDim);
-        std::vector<uint64_t> flat_b(size * ringDim);
-        std::vector<uint64_t> flat_result(size * ringDim);
-        
-        int mod_idx_start = fpga.GetModIndex(m_vectors[0].GetModulus().ConvertToInt());
-        
-        for (size_t i = 0; i < size; ++i) {
-            tmp.m_vectors[i] = m_vectors[i];
-            const uint64_t* pa = reinterpret_cast<const uint64_t*>(&m_vectors[i][0]);
-            const uint64_t* pb = reinterpret_cast<const uint64_t*>(&rhs.m_vectors[i][0]);
-            std::memcpy(&flat_a[i * ringDim], pa, ringDim * sizeof(uint64_t));
-            std::memcpy(&flat_b[i * ringDim], pb, ringDim * sizeof(uint64_t));
-        }
-        
-        fpga.ModOpBatchOffload(OP_ADD, flat_a.data(), flat_b.data(), flat_result.data(),
-                               mod_idx_start, ringDim, size);
-        
-        for (size_t i = 0; i < size; ++i) {
-            uint64_t* pr = reinterpret_cast<uint64_t*>(&tmp.m_vectors[i][0]);
-            std::memcpy(pr, &flat_result[i * ringDim], ringDim * sizeof(uint64_t));
-        }
-        return tmp;
+    if (PolyAccelerator::Get() != nullptr) {
+        for (size_t i = 0; i < size; ++i)
+            tmp.m_vectors[i] = m_vectors[i];  // 给输出 tower 分配存储
+        if (AcceleratorModOp(OP_ADD, m_vectors, rhs.m_vectors, tmp.m_vectors))
+            return tmp;
     }
-#endif // OPENFHE_FPGA_ENABLE
   
 #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
     for (size_t i = 0; i < size; ++i)
@@ -785,60 +998,31 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Times(const std::vector<NativeInteg
 }
 
 
-#ifdef OPENFHE_FPGA_ENABLE
-    template <typename VecType>
-    DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Times(const DCRTPolyImpl<VecType>& element) const {
-
-        DCRTPolyImpl<VecType> tmp = *this;
-        
-        auto& fpga = FpgaManager::GetInstance();
-        size_t size = m_vectors.size();
-
-        if (fpga.IsReady() && size <= 5) {  // 批量处理最多5个limb
-            size_t ringDim = m_vectors[0].GetLength();
-            
-            std::vector<uint64_t> flat_a(size * ringDim);
-            std::vector<uint64_t> flat_b(size * ringDim);
-            std::vector<uint64_t> flat_result(size * ringDim);
-            
-            int mod_idx_start = fpga.GetModIndex(m_vectors[0].GetModulus().ConvertToInt());
-            
-            for (size_t i = 0; i < size; ++i) {
-                const uint64_t* pa = reinterpret_cast<const uint64_t*>(&m_vectors[i][0]);
-                const uint64_t* pb = reinterpret_cast<const uint64_t*>(&element.m_vectors[i][0]);
-                std::memcpy(&flat_a[i * ringDim], pa, ringDim * sizeof(uint64_t));
-                std::memcpy(&flat_b[i * ringDim], pb, ringDim * sizeof(uint64_t));
-            }
-            
-            fpga.ModOpBatchOffload(OP_MULT, flat_a.data(), flat_b.data(), flat_result.data(),
-                                   mod_idx_start, ringDim, size);
-            
-            for (size_t i = 0; i < size; ++i) {
-                uint64_t* pr = reinterpret_cast<uint64_t*>(&tmp.m_vectors[i][0]);
-                std::memcpy(pr, &flat_result[i * ringDim], ringDim * sizeof(uint64_t));
-            }
+template <typename VecType>
+DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Times(const DCRTPolyImpl<VecType>& element) const {
+    if (m_vectors.size() != element.m_vectors.size())
+        OPENFHE_THROW("tower size mismatch; cannot multiply");
+    size_t size{m_vectors.size()};
+    if (ContiguousStorage()) {
+        DCRTPolyImpl<VecType> tmp(*this);
+        if (AcceleratorModOp(OP_MULT, tmp.m_vectors, element.m_vectors, tmp.m_vectors))
             return tmp;
-        }
-
-        // Fallback to CPU implementation
-        for (size_t i = 0; i < size; ++i) {
-            tmp.m_vectors[i] = m_vectors[i].Times(element.m_vectors[i]);
-        }
-        return tmp;
-    }
-#else
-    template <typename VecType>
-    DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::Times(const DCRTPolyImpl<VecType>& element) const {
-        if (m_vectors.size() != element.m_vectors.size())
-            OPENFHE_THROW("tower size mismatch; cannot multiply");
-        DCRTPolyImpl<VecType> tmp(m_params, m_format);
-        size_t size{m_vectors.size()};
-    #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
         for (size_t i = 0; i < size; ++i)
-            tmp.m_vectors[i] = m_vectors[i].Times(element.m_vectors[i]);
+            tmp.m_vectors[i] *= element.m_vectors[i];
         return tmp;
     }
-#endif // OPENFHE_FPGA_ENABLE
+    if (PolyAccelerator::Get() != nullptr) {
+        DCRTPolyImpl<VecType> tmp(*this);
+        if (AcceleratorModOp(OP_MULT, m_vectors, element.m_vectors, tmp.m_vectors))
+            return tmp;
+    }
+    DCRTPolyImpl<VecType> tmp(m_params, m_format);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
+    for (size_t i = 0; i < size; ++i)
+        tmp.m_vectors[i] = m_vectors[i].Times(element.m_vectors[i]);
+    return tmp;
+}
 
 template <typename VecType>
 DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::TimesNoCheck(const std::vector<NativeInteger>& rhs) const {
@@ -1155,6 +1339,7 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxSwitchCRTBasis(
     const std::vector<std::vector<NativeInteger>>& QHatModp, 
     const std::vector<DoubleNativeInt>& modpBarrettMu
 ) const {
+    intnat::TowerArena::Scope arena;
     DCRTPolyImpl<VecType> ans(paramsP, m_format, true);
     // DCRTPolyImpl<VecType> ans_fpga(paramsP, m_format, true);
 
@@ -1165,17 +1350,23 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxSwitchCRTBasis(
 
 
     // ================= [START] FPGA Hook =================
-#ifdef OPENFHE_FPGA_ENABLE
     // Kernel: LIMB_Q rows × MAX_OUT_COLS columns (3×5)
     // 支持任意基转换：Q→P, P→Q, 等等
-    const uint32_t KERNEL_LIMB_Q = 3;
-    const uint32_t KERNEL_MAX_OUT_COLS = 5;  // LIMB_Q + LIMB_P
-    
+    constexpr uint32_t KERNEL_LIMB_Q       = PolyAccelerator::KERNEL_LIMB_Q;
+    constexpr uint32_t KERNEL_MAX_OUT_COLS = PolyAccelerator::KERNEL_MAX_OUT_COLS;
+
     // 检查维度是否在kernel能力范围内
-    if (FpgaManager::GetInstance().IsReady() && sizeQ <= KERNEL_LIMB_Q && sizeP <= KERNEL_MAX_OUT_COLS) {
-        auto& fpga = FpgaManager::GetInstance();
-        std::cout << "[FPGA BConv] sizeQ=" << sizeQ << ", sizeP=" << sizeP 
-                  << " -> Using FPGA (3x5 systolic array)" << std::endl;
+    // 输出模数不比输入模数窄时 kernel 的 Barrett 约减才正确（见 PolyAccelerator::BConvFits）
+    auto* accel    = PolyAccelerator::Get();
+    auto bconvFits = [&]() {
+        std::vector<uint64_t> in_mod(sizeQ), out_mod(sizeP);
+        for (uint32_t i = 0; i < sizeQ; ++i)
+            in_mod[i] = m_vectors[i].GetModulus().ConvertToInt();
+        for (uint32_t j = 0; j < sizeP; ++j)
+            out_mod[j] = ans.m_vectors[j].GetModulus().ConvertToInt();
+        return PolyAccelerator::BConvFits(in_mod.data(), sizeQ, out_mod.data(), sizeP);
+    };
+    if (accel != nullptr && sizeQ <= KERNEL_LIMB_Q && sizeP <= KERNEL_MAX_OUT_COLS && bconvFits()) {
 
         // 1. 准备输入矩阵 X: [KERNEL_LIMB_Q × ringDim]，带padding
         std::vector<uint64_t> flat_inputs(ringDim * KERNEL_LIMB_Q, 0);
@@ -1204,25 +1395,26 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxSwitchCRTBasis(
         // 4. 准备输出缓冲区: [sizeP × ringDim]
         std::vector<uint64_t> flat_outputs(ringDim * sizeP, 0);
 
-        // 5. 调用FPGA
-        fpga.BConvOffload(
-            flat_inputs.data(),
-            flat_weights.data(),
-            out_moduli.data(),
-            flat_outputs.data(),
-            ringDim,
-            sizeP
-        );
-
-        // 6. 提取FPGA结果
-        for (uint32_t j = 0; j < sizeP; ++j) {
-            for (uint32_t ri = 0; ri < ringDim; ++ri) {
-                uint64_t result_val = flat_outputs[j * ringDim + ri];
-                ans.m_vectors[j][ri] = result_val;
+        // 5. 调用加速器；不支持该形状时走 CPU
+        if (accel->BConvOffload(flat_inputs.data(), flat_weights.data(), out_moduli.data(), flat_outputs.data(),
+                                ringDim, sizeP)) {
+            // 6. 提取结果
+            for (uint32_t j = 0; j < sizeP; ++j) {
+                for (uint32_t ri = 0; ri < ringDim; ++ri)
+                    ans.m_vectors[j][ri] = flat_outputs[j * ringDim + ri];
             }
+            return ans;
         }
-        
-        return ans;
+    }
+
+#if defined(HAVE_INT128) && (NATIVEINT == 64) && !defined(WITH_REDUCED_NOISE)
+    // 主机侧：sizeQ × sizeP 的小矩阵乘 ringDim 列，按列分块、128 位惰性累加（IFMA / 标量）
+    {
+        std::vector<PolyType*> out(sizeP);
+        for (uint32_t j = 0; j < sizeP; ++j)
+            out[j] = &ans.m_vectors[j];
+        if (HostBConv(m_vectors, sizeQ, QHatInvModq, QHatInvModqPrecon, QHatModp, 0, out))
+            return ans;
     }
 #endif
 
@@ -1280,6 +1472,76 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxSwitchCRTBasis(
     return ans;
 }
 
+template <typename VecType>
+typename DCRTPolyImpl<VecType>::PolyType DCRTPolyImpl<VecType>::ApproxSwitchCRTBasisTower(
+    const std::shared_ptr<Params>& paramsQ, const std::shared_ptr<Params>& paramsP, uint32_t j,
+    const std::vector<NativeInteger>& QHatInvModq, const std::vector<NativeInteger>& QHatInvModqPrecon,
+    const std::vector<std::vector<NativeInteger>>& QHatModp, const std::vector<DoubleNativeInt>& modpBarrettMu) const {
+    intnat::TowerArena::Scope arena;
+    PolyType ans(paramsP->GetParams()[j], m_format, true);
+
+    uint32_t sizeQ   = (m_vectors.size() > paramsQ->GetParams().size()) ? paramsQ->GetParams().size() : m_vectors.size();
+    uint32_t ringDim = m_params->GetRingDimension();
+
+    // 单输出 tower 的 BConv：kernel 只算一列，只回传一个 tower
+    auto* accel    = PolyAccelerator::Get();
+    auto bconvFits = [&]() {
+        std::vector<uint64_t> in_mod(sizeQ);
+        for (uint32_t i = 0; i < sizeQ; ++i)
+            in_mod[i] = m_vectors[i].GetModulus().ConvertToInt();
+        const uint64_t out_mod = ans.GetModulus().ConvertToInt();
+        return PolyAccelerator::BConvFits(in_mod.data(), sizeQ, &out_mod, 1);
+    };
+    if (accel != nullptr && sizeQ <= PolyAccelerator::KERNEL_LIMB_Q && bconvFits()) {
+        std::vector<uint64_t> flat_inputs(ringDim * PolyAccelerator::KERNEL_LIMB_Q, 0);
+        std::vector<uint64_t> weights(PolyAccelerator::KERNEL_LIMB_Q, 0);
+        for (uint32_t i = 0; i < sizeQ; ++i) {
+            const auto& qi = m_vectors[i].GetModulus();
+            for (uint32_t ri = 0; ri < ringDim; ++ri)
+                flat_inputs[i * ringDim + ri] =
+                    m_vectors[i][ri].ModMulFastConst(QHatInvModq[i], qi, QHatInvModqPrecon[i]).ConvertToInt();
+            weights[i] = QHatModp[i][j].ConvertToInt();
+        }
+        if (accel->BConvTowerOffload(flat_inputs.data(), weights.data(), ans.GetModulus().ConvertToInt(),
+                                     reinterpret_cast<uint64_t*>(&ans[0]), ringDim))
+            return ans;
+    }
+
+#if defined(HAVE_INT128) && (NATIVEINT == 64) && !defined(WITH_REDUCED_NOISE)
+    if (HostBConv(m_vectors, sizeQ, QHatInvModq, QHatInvModqPrecon, QHatModp, j, std::vector<PolyType*>{&ans}))
+        return ans;
+#endif
+
+#if defined(HAVE_INT128) && (NATIVEINT == 64) && !defined(WITH_REDUCED_NOISE) && \
+    (defined(WITH_OPENMP) || (defined(__clang__) && !defined(WITH_NATIVEOPT)))
+    auto&& pj = ans.GetModulus().template ConvertToInt<uint64_t>();
+    #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(8))
+    for (uint32_t ri = 0; ri < ringDim; ++ri) {
+        DoubleNativeInt sum = 0;
+        for (uint32_t i = 0; i < sizeQ; ++i) {
+            const auto& qi           = m_vectors[i].GetModulus();
+            const auto xQHatInvModqi = m_vectors[i][ri]
+                                           .ModMulFastConst(QHatInvModq[i], qi, QHatInvModqPrecon[i])
+                                           .template ConvertToInt<uint64_t>();
+            sum += Mul128(xQHatInvModqi, QHatModp[i][j].ConvertToInt<uint64_t>());
+        }
+        ans[ri] = BarrettUint128ModUint64(sum, pj, modpBarrettMu[j]);
+    }
+#else
+    for (uint32_t i = 0; i < sizeQ; ++i) {
+        auto xQHatInvModqi = m_vectors[i] * QHatInvModq[i];
+    #if defined(WITH_REDUCED_NOISE)
+        xQHatInvModqi.SwitchModulus(ans.GetModulus(), ans.GetRootOfUnity(), 0, 0);
+        ans += (xQHatInvModqi *= QHatModp[i][j]);
+    #else
+        ans.MultAccEqNoCheck(xQHatInvModqi, QHatModp[i][j]);
+    #endif
+    }
+#endif
+
+    return ans;
+}
+
 template <typename VecType>
 void DCRTPolyImpl<VecType>::ApproxModUp(const std::shared_ptr<Params>& paramsQ, const std::shared_ptr<Params>& paramsP,
                                         const std::shared_ptr<Params>& paramsQP,
@@ -1319,6 +1581,7 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxModDown(
     const std::vector<std::vector<NativeInteger>>& PHatModq, const std::vector<DoubleNativeInt>& modqBarrettMu,
     const std::vector<NativeInteger>& tInvModp, const std::vector<NativeInteger>& tInvModpPrecon,
     const NativeInteger& t, const std::vector<NativeInteger>& tModqPrecon) const {
+    intnat::TowerArena::Scope arena;
     DCRTPolyImpl<VecType> partP(paramsP, m_format, true);
     uint32_t sizeP = paramsP->GetParams().size();
     uint32_t sizeQ = m_vectors.size() - sizeP;
@@ -1348,7 +1611,11 @@ DCRTPolyImpl<VecType> DCRTPolyImpl<VecType>::ApproxModDown(
         if (t > 0)
             partPSwitchedToQ.m_vectors[i] *= t;
         partPSwitchedToQ.m_vectors[i].SetFormat(Format::EVALUATION);
-        ans.m_vectors[i] = (m_vectors[i] - partPSwitchedToQ.m_vectors[i]) * PInvModq[i];
+        // (x - partP) * P^-1 在 ans 已分配的 tower 里原地算，不产生中间 tower
+        auto& ansi = ans.m_vectors[i];
+        ansi       = m_vectors[i];
+        ansi -= partPSwitchedToQ.m_vectors[i];
+        ansi *= PInvModq[i];
     }
     return ans;
 }
@@ -2281,6 +2548,54 @@ template <typename VecType>
 void DCRTPolyImpl<VecType>::SwitchFormat() {
     m_format = (m_format == Format::COEFFICIENT) ? Format::EVALUATION : Format::COEFFICIENT;
     size_t size{m_vectors.size()};
+
+    // 所有 tower 一次 kernel 启动，直接从 tower 存储打包（不走 transformnat 的逐 limb 路径）；
+    // N != FPGA_RING_DIM 或 limb 数超过片上容量时由后端自动分块走流式 NTT
+    auto* accel    = PolyAccelerator::Get();
+    const size_t n = m_params->GetRingDimension();
+    if (accel != nullptr && size > 0 && accel->SupportsRingDim(n) && m_params->GetCyclotomicOrder() == 2 * n) {
+        std::vector<uint64_t*> towers(size);
+        std::vector<uint64_t> moduli(size);
+        bool packable = true;
+        for (size_t i = 0; i < size && packable; ++i) {
+            packable  = !m_vectors[i].IsEmpty();
+            towers[i] = packable ? reinterpret_cast<uint64_t*>(&m_vectors[i][0]) : nullptr;
+            moduli[i] = m_vectors[i].GetModulus().ConvertToInt();
+        }
+        if (packable && accel->NttBatchOffload(m_format == Format::EVALUATION, towers.data(), moduli.data(), size, n)) {
+            for (auto& v : m_vectors)
+                v.OverrideFormat(m_format);
+            return;
+        }
+    }
+
+    // CPU：所有 tower 交给合并的 NTT 引擎，(tower, 块) 为线程间的调度单位；
+    // 非 2 的幂分圆阶（任意环）仍逐 tower 变换
+    if (size > 0 && m_params->GetCyclotomicOrder() == 2 * n) {
+        std::vector<NativeVector*> elements(size);
+        std::vector<NativeInteger> roots(size);
+        bool packable = true;
+        for (size_t i = 0; i < size && packable; ++i) {
+            packable = !m_vectors[i].IsEmpty();
+            if (packable) {
+                elements[i] = &m_vectors[i].GetValues();
+                roots[i]    = m_vectors[i].GetRootOfUnity();
+            }
+        }
+        if (packable) {
+            const usint cycloOrder = m_params->GetCyclotomicOrder();
+            if (m_format == Format::EVALUATION)
+                ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(roots, cycloOrder,
+                                                                                                 elements);
+            else
+                ChineseRemainderTransformFTT<NativeVector>().InverseTransformFromBitReverseInPlace(roots, cycloOrder,
+                                                                                                   elements);
+            for (auto& v : m_vectors)
+                v.OverrideFormat(m_format);
+            return;
+        }
+    }
+
 #pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(size))
     for (size_t i = 0; i < size; ++i)
         m_vectors[i].SwitchFormat();
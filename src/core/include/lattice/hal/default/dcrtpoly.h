@@ -42,6 +42,8 @@
 
 #include "math/math-hal.h"
 #include "math/distrgen.h"
+#include "math/seeduniformgenerator.h"
+#include "math/hal/intnat/tower-slab.h"
 
 #include "utils/exception.h"
 #include "utils/inttypes.h"
@@ -73,11 +75,18 @@ public:
 
     DCRTPolyImpl() = default;
 
-    DCRTPolyImpl(const DCRTPolyType& e) noexcept : m_params{e.m_params}, m_format{e.m_format}, m_vectors{e.m_vectors} {}
+    // 连续存储模式下拷贝落在一块新 slab 里；拷贝赋值时左边已经是同形状的 slab 则原地拷贝
+    DCRTPolyImpl(const DCRTPolyType& e) noexcept
+        : m_params{e.m_params},
+          m_format{e.m_format},
+          m_vectors{ContiguousStorage() ? ContiguousCopy(e.m_vectors) : e.m_vectors} {}
     DCRTPolyType& operator=(const DCRTPolyType& rhs) noexcept override {
-        m_params  = rhs.m_params;
-        m_format  = rhs.m_format;
-        m_vectors = rhs.m_vectors;
+        m_params = rhs.m_params;
+        m_format = rhs.m_format;
+        if (ContiguousStorage() && !SameContiguousShape(rhs.m_vectors))
+            m_vectors = ContiguousCopy(rhs.m_vectors);
+        else
+            m_vectors = rhs.m_vectors;
         return *this;
     }
 
@@ -101,6 +110,10 @@ public:
     DCRTPolyImpl(const std::shared_ptr<Params>& params, Format format = Format::EVALUATION,
                  bool initializeElementToZero = false) noexcept
         : m_params{params}, m_format{format} {
+        if (initializeElementToZero && ContiguousStorage()) {
+            m_vectors = ContiguousZero(m_params->GetParams(), m_format);
+            return;
+        }
         m_vectors.reserve(m_params->GetParams().size());
         for (const auto& p : m_params->GetParams())
             m_vectors.emplace_back(p, m_format, initializeElementToZero);
@@ -238,6 +251,12 @@ public:
                                       const std::vector<std::vector<NativeInteger>>& QHatModp,
                                       const std::vector<DoubleNativeInt>& modpBarrettMu) const override;
 
+    PolyType ApproxSwitchCRTBasisTower(const std::shared_ptr<Params>& paramsQ, const std::shared_ptr<Params>& paramsP,
+                                       uint32_t j, const std::vector<NativeInteger>& QHatInvModq,
+                                       const std::vector<NativeInteger>& QHatInvModqPrecon,
+                                       const std::vector<std::vector<NativeInteger>>& QHatModp,
+                                       const std::vector<DoubleNativeInt>& modpBarrettMu) const override;
+
     void ApproxModUp(const std::shared_ptr<Params>& paramsQ, const std::shared_ptr<Params>& paramsP,
                      const std::shared_ptr<Params>& paramsQP, const std::vector<NativeInteger>& QHatInvModq,
                      const std::vector<NativeInteger>& QHatInvModqPrecon,
@@ -353,6 +372,8 @@ public:
         ar(::cereal::make_nvp("v", m_vectors));
         ar(::cereal::make_nvp("f", m_format));
         ar(::cereal::make_nvp("p", m_params));
+        if (ContiguousStorage())
+            Pack();
     }
 
     static const std::string GetElementName() {
@@ -395,7 +416,61 @@ public:
         m_vectors[index] = std::move(element);
     }
 
+    // ------------------------------------------------------------
+    // 连续存储（intnat::TowerStorage::CONTIGUOUS）
+    // ------------------------------------------------------------
+    // 所有 tower 是否都是同一块 slab 里按下标排列的视图（tower i 在 GetTowerSlab()->Tower(i)）。
+    // 逐 tower 的接口照常可用：移动赋值进来的 tower、扩容过的 tower 会离开 slab，此时返回 false。
+    bool IsContiguous() const;
+
+    // 把所有 tower 搬进一块新的 slab（已经连续时什么都不做）；空 tower 保持为空
+    void Pack();
+
+    // IsContiguous() 时返回 tower 所在的 slab（FPGA DMA / SIMD 内核按 towers × TowerBytes 一次访问），否则 nullptr
+    std::shared_ptr<intnat::TowerSlab> GetTowerSlab() const;
+
+    // 以 slab 里已有的内容为 tower 的多项式（外部存储的 slab 不拷贝，tower i 就是 slab->Tower(i) 的视图）。
+    // slab 须有 params 的 tower 数、每段至少 N 个字
+    static DCRTPolyImpl FromTowerSlab(const std::shared_ptr<Params>& params, Format format,
+                                      const std::shared_ptr<intnat::TowerSlab>& slab);
+
+    // 由种子展开的均匀多项式（EVALUATION）：tower i 是 SeedUniformGenerator::GenerateTower(seed, stream, i, q_i, N)，
+    // 所以只取 params 前几个 tower 时得到的是完整多项式对应 tower 的值
+    static DCRTPolyImpl FromSeed(const std::shared_ptr<Params>& params, const PRNGSeed& seed, uint32_t stream);
+
+    // ------------------------------------------------------------
+    // key-switch 内积（惰性约减）
+    // ------------------------------------------------------------
+    // out0 = Σ_j digits[j]·b[j]，out1 = Σ_j digits[j]·a[j]（EVALUATION，逐 tower 覆盖原值），
+    // 每个系数只约减一次，见 intnat::KeyMacLazy。b / a 至少有 digits.size() 个，
+    // out0 / out1 的 tower 与 digits 一致；key 的 tower 更多时（key 在 Q·P 上、digits 在 Ql·P 上），
+    // 前 sizeQl 个按下标对应，其余与 key 的末尾对齐。
+    static void KeyMultAccumulate(const std::vector<DCRTPolyImpl>& digits, const std::vector<DCRTPolyImpl>& b,
+                                  const std::vector<DCRTPolyImpl>& a, uint32_t sizeQl, DCRTPolyImpl& out0,
+                                  DCRTPolyImpl& out1);
+    // 同上，但 a 不在内存里：a[j] 是 FromSeed(b[j] 的 params, aSeed, j)，每个输出 tower 只临时展开
+    // 用到的 a[j] 的那个 tower
+    static void KeyMultAccumulate(const std::vector<DCRTPolyImpl>& digits, const std::vector<DCRTPolyImpl>& b,
+                                  const PRNGSeed& aSeed, uint32_t sizeQl, DCRTPolyImpl& out0, DCRTPolyImpl& out1);
+
 protected:
+    // KeyMultAccumulate 的主体；towerA(j, k, scratch) 返回 a[j] 的 tower k（可以写进 scratch 再返回它）
+    template <typename TowerA>
+    static void KeyMultAccumulateTowers(const std::vector<DCRTPolyImpl>& digits,
+                                        const std::vector<DCRTPolyImpl>& b, uint32_t sizeQl, DCRTPolyImpl& out0,
+                                        DCRTPolyImpl& out1, TowerA&& towerA);
+
+    static bool ContiguousStorage() {
+        return intnat::GetTowerStorage() == intnat::TowerStorage::CONTIGUOUS;
+    }
+    // towers 的拷贝，非空 tower 放在一块新的 slab 里
+    static std::vector<PolyType> ContiguousCopy(const std::vector<PolyType>& towers);
+    // params 对应的全零 tower，放在一块新的 slab 里
+    static std::vector<PolyType> ContiguousZero(
+        const std::vector<std::shared_ptr<typename PolyType::Params>>& params, Format format);
+    // 本对象是连续的，且 towers 逐个拷贝进来后仍留在原位（tower 数相同、长度都不超过 slab 的一段）
+    bool SameContiguousShape(const std::vector<PolyType>& towers) const;
+
     std::shared_ptr<Params> m_params{std::make_shared<DCRTPolyImpl::Params>()};
     Format m_format{Format::EVALUATION};
     std::vector<PolyType> m_vectors;
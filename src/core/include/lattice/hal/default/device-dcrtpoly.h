@@ -0,0 +1,323 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2023, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  DCRTPoly whose towers stay resident in accelerator memory across consecutive offloaded ops
+ */
+
+#ifndef LBCRYPTO_INC_LATTICE_HAL_DEFAULT_DEVICE_DCRTPOLY_H
+#define LBCRYPTO_INC_LATTICE_HAL_DEFAULT_DEVICE_DCRTPOLY_H
+
+#include "lattice/lat-hal.h"
+
+#include "PolyAccelerator.h"
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace lbcrypto {
+
+// =============================================================
+// 常驻设备的 DCRTPoly
+// -------------------------------------------------------------
+// 包装一个 DCRTPoly（主机副本），第一次设备算子时把 towers 上传到加速器的常驻内存
+// （PolyAccelerator::AllocResident / WriteResident），之后的 +=、-=、*=、SwitchFormat
+// 直接在设备上读写，结果不读回。主机副本只在需要时同步：
+//   - Host() / 序列化：设备上的数据更新时先读回（一次 D2H）；
+//   - MutableHost() / 设备不接的算子：读回后设备副本作废，下次设备算子重新上传。
+// 没有加速器、形状或模数不在片上时所有算子在主机副本上执行，结果与 DCRTPoly 相同。
+// 常驻内存属于分配时的后端（持有其 shared_ptr）；PolyAccelerator::Set 换了后端后，
+// 下一个算子先把数据读回主机并释放旧后端上的常驻内存，再按新后端处理。
+// 与 DCRTPoly 一样不是线程安全的；Host() 是 const 但可能写主机副本。
+// 范围：只有上面这些 lattice 层算子常驻设备。方案层的算子（relin、rescale、rotate 等）
+// 只接受 DCRTPoly，交给它们时须先取 Host()，所以 mult→relin→rescale→rotate 这样的链
+// 每一步之间仍各读回一次。
+// =============================================================
+template <typename VecType>
+class DeviceDCRTPolyImpl {
+public:
+    using DCRTPolyType = DCRTPolyImpl<VecType>;
+    using ResidentId   = PolyAccelerator::ResidentId;
+
+    // 哪一侧的数据是最新的
+    enum class Residency { HOST, DEVICE, BOTH };
+
+    DeviceDCRTPolyImpl() = default;
+
+    // 只包装，不传输
+    explicit DeviceDCRTPolyImpl(DCRTPolyType poly) : m_host(std::move(poly)) {}
+
+    // 拷贝只复制主机数据（必要时先读回），新对象不常驻
+    DeviceDCRTPolyImpl(const DeviceDCRTPolyImpl& rhs) : m_host(rhs.Host()) {}
+
+    DeviceDCRTPolyImpl& operator=(const DeviceDCRTPolyImpl& rhs) {
+        if (this != &rhs) {
+            m_host      = rhs.Host();
+            m_residency = Residency::HOST;
+        }
+        return *this;
+    }
+
+    DeviceDCRTPolyImpl(DeviceDCRTPolyImpl&& rhs) noexcept
+        : m_host(std::move(rhs.m_host)),
+          m_accel(std::move(rhs.m_accel)),
+          m_id(rhs.m_id),
+          m_shape(std::move(rhs.m_shape)),
+          m_residency(rhs.m_residency) {
+        rhs.m_id        = 0;
+        rhs.m_residency = Residency::HOST;
+    }
+
+    DeviceDCRTPolyImpl& operator=(DeviceDCRTPolyImpl&& rhs) noexcept {
+        if (this != &rhs) {
+            Free();
+            m_host          = std::move(rhs.m_host);
+            m_accel         = std::move(rhs.m_accel);
+            m_id            = rhs.m_id;
+            m_shape         = std::move(rhs.m_shape);
+            m_residency     = rhs.m_residency;
+            rhs.m_id        = 0;
+            rhs.m_residency = Residency::HOST;
+        }
+        return *this;
+    }
+
+    ~DeviceDCRTPolyImpl() {
+        Free();
+    }
+
+    Residency GetResidency() const {
+        return m_residency;
+    }
+
+    // 设备上有最新数据
+    bool IsResident() const {
+        return m_residency != Residency::HOST;
+    }
+
+    Format GetFormat() const {
+        return m_host.GetFormat();
+    }
+
+    const std::shared_ptr<typename DCRTPolyType::Params>& GetParams() const {
+        return m_host.GetParams();
+    }
+
+    // 上传到常驻内存（已是最新时不传输）；没有加速器或形状不支持时返回 false，数据留在主机
+    bool ToDevice() const {
+        Rebind();
+        if (m_residency != Residency::HOST)
+            return true;
+        if (!Allocate())
+            return false;
+        auto towers = Towers();
+        if (!m_accel->WriteResident(m_id, towers.data()))
+            return false;
+        m_residency = Residency::BOTH;
+        return true;
+    }
+
+    // 主机副本；设备上的数据更新时先读回
+    const DCRTPolyType& Host() const {
+        if (m_residency == Residency::DEVICE) {
+            auto towers = Towers();
+            if (!m_accel->ReadResident(m_id, towers.data()))
+                OPENFHE_THROW("DeviceDCRTPoly: failed to read resident towers back from the accelerator");
+            m_residency = Residency::BOTH;
+        }
+        return m_host;
+    }
+
+    // 可写的主机副本；设备副本作废（常驻内存保留，下次上传复用）
+    DCRTPolyType& MutableHost() {
+        Host();
+        m_residency = Residency::HOST;
+        return m_host;
+    }
+
+    // 读回并交出主机副本，释放常驻内存
+    DCRTPolyType ToHost() && {
+        Host();
+        Free();
+        return std::move(m_host);
+    }
+
+    DeviceDCRTPolyImpl& operator+=(const DeviceDCRTPolyImpl& rhs) {
+        return ModOp(OP_ADD, rhs);
+    }
+
+    DeviceDCRTPolyImpl& operator-=(const DeviceDCRTPolyImpl& rhs) {
+        return ModOp(OP_SUB, rhs);
+    }
+
+    // 逐元素乘，EVALUATION 格式
+    DeviceDCRTPolyImpl& operator*=(const DeviceDCRTPolyImpl& rhs) {
+        return ModOp(OP_MULT, rhs);
+    }
+
+    DeviceDCRTPolyImpl Plus(const DeviceDCRTPolyImpl& rhs) const {
+        return Binary(OP_ADD, rhs);
+    }
+
+    DeviceDCRTPolyImpl Minus(const DeviceDCRTPolyImpl& rhs) const {
+        return Binary(OP_SUB, rhs);
+    }
+
+    DeviceDCRTPolyImpl Times(const DeviceDCRTPolyImpl& rhs) const {
+        return Binary(OP_MULT, rhs);
+    }
+
+    void SwitchFormat() {
+        const bool forward = m_host.GetFormat() == Format::COEFFICIENT;
+        if (ToDevice() && m_accel->NttResident(forward, m_id)) {
+            // 只改格式标记，数据在设备上
+            const Format f = forward ? Format::EVALUATION : Format::COEFFICIENT;
+            m_host.OverrideFormat(f);
+            for (auto& v : m_host.GetAllElements())
+                v.OverrideFormat(f);
+            m_residency = Residency::DEVICE;
+            return;
+        }
+        MutableHost().SwitchFormat();
+    }
+
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::make_nvp("p", Host()));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        ar(::cereal::make_nvp("p", m_host));
+        m_residency = Residency::HOST;
+    }
+
+private:
+    // 安装的后端换了：数据读回主机，常驻内存还给原后端
+    void Rebind() const {
+        if (m_id != 0 && m_accel.get() != PolyAccelerator::Get()) {
+            Host();
+            Free();
+        }
+    }
+
+    // 主机副本的形状（模数、环维度）变了时重新分配
+    bool Allocate() const {
+        auto accel = m_id != 0 ? m_accel : PolyAccelerator::GetShared();
+        if (accel == nullptr || m_host.GetAllElements().empty())
+            return false;
+        std::vector<uint64_t> moduli;
+        for (const auto& v : m_host.GetAllElements()) {
+            if (v.IsEmpty())
+                return false;
+            moduli.push_back(v.GetModulus().ConvertToInt());
+        }
+        moduli.push_back(m_host.GetRingDimension());
+        if (m_id != 0 && moduli == m_shape)
+            return true;
+        if (m_id != 0)
+            accel->FreeResident(m_id);
+        m_id    = accel->AllocResident(moduli.data(), moduli.size() - 1, moduli.back());
+        m_accel = m_id != 0 ? std::move(accel) : nullptr;
+        m_shape = m_id != 0 ? std::move(moduli) : std::vector<uint64_t>{};
+        return m_id != 0;
+    }
+
+    void Free() const {
+        if (m_id != 0)
+            m_accel->FreeResident(m_id);
+        m_accel.reset();
+        m_id = 0;
+        m_shape.clear();
+        m_residency = Residency::HOST;
+    }
+
+    std::vector<uint64_t*> Towers() const {
+        auto& towers = m_host.GetAllElements();
+        std::vector<uint64_t*> ptrs(towers.size());
+        for (size_t i = 0; i < towers.size(); ++i)
+            ptrs[i] = reinterpret_cast<uint64_t*>(&towers[i][0]);
+        return ptrs;
+    }
+
+    // 两边都能常驻在同一个加速器上
+    bool BothOnDevice(const DeviceDCRTPolyImpl& rhs) const {
+        return ToDevice() && rhs.ToDevice() && m_accel == rhs.m_accel;
+    }
+
+    DeviceDCRTPolyImpl& ModOp(int opcode, const DeviceDCRTPolyImpl& rhs) {
+        if (BothOnDevice(rhs) && m_accel->ModOpResident(opcode, m_id, rhs.m_id, m_id)) {
+            m_residency = Residency::DEVICE;
+            return *this;
+        }
+        return HostModOp(opcode, rhs);
+    }
+
+    DeviceDCRTPolyImpl& HostModOp(int opcode, const DeviceDCRTPolyImpl& rhs) {
+        auto& host = MutableHost();
+        if (opcode == OP_ADD)
+            host += rhs.Host();
+        else if (opcode == OP_SUB)
+            host -= rhs.Host();
+        else
+            host *= rhs.Host();
+        return *this;
+    }
+
+    DeviceDCRTPolyImpl Binary(int opcode, const DeviceDCRTPolyImpl& rhs) const {
+        if (BothOnDevice(rhs)) {
+            // 输出只需要形状：主机副本分配成零，数据由设备写
+            DeviceDCRTPolyImpl out(DCRTPolyType(m_host.GetParams(), m_host.GetFormat(), true));
+            bool done = out.Allocate() && out.m_accel == m_accel;
+            if (done && m_accel->ModOpResident(opcode, m_id, rhs.m_id, out.m_id)) {
+                out.m_residency = Residency::DEVICE;
+                return out;
+            }
+        }
+        DeviceDCRTPolyImpl out(Host());
+        out.HostModOp(opcode, rhs);
+        return out;
+    }
+
+    mutable DCRTPolyType m_host;
+    mutable std::shared_ptr<PolyAccelerator> m_accel;
+    mutable ResidentId m_id = 0;
+    mutable std::vector<uint64_t> m_shape;  // 分配时的模数 + 环维度
+    mutable Residency m_residency = Residency::HOST;
+};
+
+using DeviceDCRTPoly = DeviceDCRTPolyImpl<BigVector>;
+
+}  // namespace lbcrypto
+
+#endif
@@ -38,9 +38,7 @@
 
 #include "lattice/hal/default/poly.h"
 
-#ifdef OPENFHE_FPGA_ENABLE
-#include "FpgaManager.h"
-#endif
+#include "PolyAccelerator.h"
 
 #include "utils/debug.h"
 #include "utils/exception.h"
@@ -376,26 +374,29 @@ PolyImpl<VecType> PolyImpl<VecType>::AutomorphismTransform(uint32_t k, const std
     PolyImpl<VecType> tmp(*this); 
     uint32_t n = m_params->GetRingDimension();
     auto q = m_params->GetModulus(); 
+    // 每一步单独卸载；加速器拒绝（返回 false）的步骤走 CPU
+    auto* accel = PolyAccelerator::Get();
+    using IntType = typename VecType::Integer;
+    std::vector<uint64_t> inBuf, outBuf;
+    if (accel != nullptr) {
+        inBuf.resize(n);
+        outBuf.resize(n);
+    }
    
     // ==========================================
     // 1. EVAL -> COEF (FPGA INTT 卸载)
     // ==========================================
-#ifdef OPENFHE_FPGA_ENABLE
-    if (FpgaManager::GetInstance().IsReady() && n == FPGA_RING_DIM) {
-        using IntType = typename VecType::Integer;
-        std::vector<uint64_t> inBuf(n), outBuf(n);
-        
+    bool offloaded = false;
+    if (accel != nullptr) {
         for (uint32_t i = 0; i < n; ++i) inBuf[i] = (*tmp.m_values)[i].ConvertToInt();
-        
-        FpgaManager::GetInstance().NttInverseOffload(inBuf.data(), outBuf.data(), q.ConvertToInt(), n);
-    
-        for (uint32_t i = 0; i < n; ++i) (*tmp.m_values)[i] = IntType(outBuf[i]);
-        //tmp.SetFormat(Format::COEFFICIENT);// 手动更新为 COEFFICIENT (自然序)
-    } else
-#endif
-    {
-        tmp.SwitchFormat();
+        offloaded = accel->NttInverseOffload(inBuf.data(), outBuf.data(), q.ConvertToInt(), n);
+        if (offloaded) {
+            for (uint32_t i = 0; i < n; ++i) (*tmp.m_values)[i] = IntType(outBuf[i]);
+            tmp.OverrideFormat(Format::COEFFICIENT);
+        }
     }
+    if (!offloaded)
+        tmp.SwitchFormat();
 
     // ==========================================
     // 2. Execute Automorphism Transform (FPGA Auto 卸载)
@@ -403,21 +404,15 @@ PolyImpl<VecType> PolyImpl<VecType>::AutomorphismTransform(uint32_t k, const std
     uint32_t logn = lbcrypto::GetMSB(n) - 1;
     uint32_t mask = (uint32_t(1) << logn) - 1;
     
-#ifdef OPENFHE_FPGA_ENABLE
-    if (FpgaManager::GetInstance().IsReady() && n == FPGA_RING_DIM) {
-        using Integer = typename VecType::Integer;
-        Integer kinvInt = Integer(k).ModInverse(Integer(2 * n));
-        uint32_t kinv = kinvInt.ConvertToInt();
-        std::vector<uint64_t> inBuf(n), outBuf(n);
-        
+    offloaded = false;
+    if (accel != nullptr) {
+        uint32_t kinv = IntType(k).ModInverse(IntType(2 * n)).ConvertToInt();
         for (uint32_t i = 0; i < n; ++i) inBuf[i] = (*tmp.m_values)[i].ConvertToInt();
-        
-        FpgaManager::GetInstance().AutoOffload(inBuf.data(), outBuf.data(), k, kinv, q.ConvertToInt(), n);
-        
-        for (uint32_t i = 0; i < n; ++i) (*tmp.m_values)[i] = Integer(outBuf[i]);
-    } else
-#endif
-    {
+        offloaded = accel->AutoOffload(inBuf.data(), outBuf.data(), k, kinv, q.ConvertToInt(), n);
+        if (offloaded)
+            for (uint32_t i = 0; i < n; ++i) (*tmp.m_values)[i] = IntType(outBuf[i]);
+    }
+    if (!offloaded) {
         PolyImpl<VecType> coeffInput = tmp; 
         for (uint32_t j = 0, jk = 0; j < n; ++j, jk += k) {
             (*tmp.m_values)[jk & mask] =
@@ -428,22 +423,17 @@ PolyImpl<VecType> PolyImpl<VecType>::AutomorphismTransform(uint32_t k, const std
     // ==========================================
     // 3. COEF -> EVAL (FPGA NTT 卸载)
     // ==========================================
-#ifdef OPENFHE_FPGA_ENABLE
-    if (FpgaManager::GetInstance().IsReady() && n == FPGA_RING_DIM) {
-        using IntType = typename VecType::Integer;
-        std::vector<uint64_t> inBuf(n), outBuf(n);
-        
-        for (uint32_t i = 0; i < n; ++i) inBuf[i] = (*tmp.m_values)[i].ConvertToInt();            
-        
-        FpgaManager::GetInstance().NttForwardOffload(inBuf.data(), outBuf.data(), q.ConvertToInt(), n);
-        
-        for (uint32_t i = 0; i < n; ++i) (*tmp.m_values)[i] = IntType(outBuf[i]);
-        //tmp.SetFormat(Format::EVALUATION);// 手动更新为 EVALUATION (位反转序)
-    } else
-#endif     
-    {
-        tmp.SwitchFormat();
+    offloaded = false;
+    if (accel != nullptr) {
+        for (uint32_t i = 0; i < n; ++i) inBuf[i] = (*tmp.m_values)[i].ConvertToInt();
+        offloaded = accel->NttForwardOffload(inBuf.data(), outBuf.data(), q.ConvertToInt(), n);
+        if (offloaded) {
+            for (uint32_t i = 0; i < n; ++i) (*tmp.m_values)[i] = IntType(outBuf[i]);
+            tmp.OverrideFormat(Format::EVALUATION);
+        }
     }
+    if (!offloaded)
+        tmp.SwitchFormat();
 
     return tmp;
 }
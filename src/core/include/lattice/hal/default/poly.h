@@ -90,6 +90,9 @@ public:
         if (initializeElementToZero)
             this->SetValuesToZero();
     }
+    // values 直接作为系数存储（例如 DCRTPoly 连续 slab 里的一个 tower），不做参数检查
+    PolyImpl(const std::shared_ptr<Params>& params, Format format, VecType&& values)
+        : m_format{format}, m_params{params}, m_values{std::make_unique<VecType>(std::move(values))} {}
 
     PolyImpl(bool initializeElementToMax, const std::shared_ptr<Params>& params, Format format = Format::EVALUATION)
         : m_format{format}, m_params{params} {
@@ -195,6 +198,13 @@ public:
         return *m_values;
     }
 
+    // 原地变换用（DCRTPoly 的多 tower NTT 引擎），调用者负责维护格式
+    inline VecType& GetValues() {
+        if (m_values == nullptr)
+            OPENFHE_THROW("No values in PolyImpl");
+        return *m_values;
+    }
+
     inline bool IsEmpty() const final {
         return m_values == nullptr;
     }
@@ -44,10 +44,6 @@
 #include <map>
 #include <vector>
 #include <type_traits>
-#ifdef OPENFHE_FPGA_ENABLE
-    #include "FpgaManager.h"
-    // #include "math/hal/nativeintbackend.h"
-#endif
 namespace bigintdyn {
 
 using namespace lbcrypto;
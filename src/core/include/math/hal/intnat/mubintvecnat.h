@@ -37,6 +37,7 @@
 #define LBCRYPTO_INC_MATH_HAL_INTNAT_MUBINTVECNAT_H
 
 #include "math/hal/basicint.h"
+#include "math/hal/intnat/tower-slab.h"
 #include "math/hal/intnat/ubintnat.h"
 #include "math/hal/vector.h"
 
@@ -119,12 +120,16 @@ bool operator!=(const NAlloc<T>&, const NAlloc<U>&) { return false; }
 template <class IntegerType>
 class NativeVectorT final : public lbcrypto::BigVectorInterface<NativeVectorT<IntegerType>, IntegerType>,
                             public lbcrypto::Serializable {
+public:
+    // 默认在堆上分配；绑定到 TowerSlab 的某个 tower 时存储落在 slab 里（DCRTPoly 的连续存储）
+    using Allocator = TowerAllocator<IntegerType>;
+
 private:
     // m_modulus stores the internal modulus of the vector.
     IntegerType m_modulus{0};
 
 #if BLOCK_VECTOR_ALLOCATION != 1
-    std::vector<IntegerType> m_data{};
+    std::vector<IntegerType, Allocator> m_data{};
 #else
     xvector<IntegerType> m_data{};
 #endif
@@ -180,6 +185,27 @@ public:
    */
     constexpr NativeVectorT(const NativeVectorT& v) noexcept : m_modulus{v.m_modulus}, m_data{v.m_data} {}
 
+    /**
+   * Constructor for a zero vector whose storage comes from an allocator
+   * (e.g. one tower of a contiguous DCRTPoly slab). On a preloaded tower of an
+   * external slab the entries keep the slab contents instead of being zeroed.
+   *
+   * @param length is the length of the native vector.
+   * @param modulus is the modulus of the ring.
+   * @param alloc is the allocator for the entries.
+   */
+    NativeVectorT(usint length, const IntegerType& modulus, const Allocator& alloc)
+        : m_modulus{modulus}, m_data(length, alloc) {}
+
+    /**
+   * Copy constructor placing the copy in storage from an allocator.
+   *
+   * @param v is the native vector to be copied.
+   * @param alloc is the allocator for the entries.
+   */
+    NativeVectorT(const NativeVectorT& v, const Allocator& alloc)
+        : m_modulus{v.m_modulus}, m_data(v.m_data.begin(), v.m_data.end(), alloc) {}
+
     /**
    * Basic move constructor for moving a vector
    *
@@ -345,6 +371,15 @@ public:
         return m_data.size();
     }
 
+    /**
+   * Allocator of the entries (bound to a TowerSlab tower for contiguous DCRTPoly storage).
+   *
+   * @return the allocator.
+   */
+    Allocator GetAllocator() const {
+        return m_data.get_allocator();
+    }
+
     // MODULAR ARITHMETIC OPERATIONS
 
     /**
@@ -0,0 +1,151 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Runtime-dispatched SIMD kernels for the native negacyclic NTT, the
+  lazy-reduction multiply-accumulate of key switching and RNS basis conversion
+ */
+
+#ifndef LBCRYPTO_MATH_HAL_INTNAT_NTT_SIMD_H
+#define LBCRYPTO_MATH_HAL_INTNAT_NTT_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace intnat {
+
+// =============================================================
+// 主机侧向量化 NTT / INTT（NativeVector 的 CPU 路径）
+// -------------------------------------------------------------
+// 与 NumberTheoreticTransformNat 的 ForwardTransformToBitReverseInPlace /
+// InverseTransformFromBitReverseInPlace 同一个变换、同一套 bit-reverse 表，结果逐位相同。
+// 蝶形用 Harvey / Shoup 惰性约减：正变换各级之间的值保持在 [0, 4q)，逆变换在 [0, 2q)，
+// 只在最后一级归约到 [0, q)。指令集在运行时按 CPU 选择：
+//   AVX512IFMA : 8 路 52 位乘加（vpmadd52lo/hi），要求 q < 2^50，否则退到 AVX2
+//   AVX2       : 4 路，64 位乘法用 32 位 vpmuludq 拼出来
+//   SCALAR     : 64 位标量
+// 蝶形距离小于向量宽度的几级走标量。
+// 变换按块大小拆成列段和块段（见 NttBatchForward），块内数据和所用 twiddle 都留在 L2。
+// =============================================================
+enum class NttIsa { SCALAR = 0, AVX2, AVX512IFMA };
+
+const char* NttIsaName(NttIsa isa);
+
+// CPU 是否支持 isa（SCALAR 总是支持）
+bool NttIsaSupported(NttIsa isa);
+
+// 当前使用的指令集：第一次调用时取 CPU 支持的最高一级，
+// 环境变量 OPENFHE_NTT_ISA（scalar / avx2 / avx512ifma）可以往下压
+NttIsa GetNttIsa();
+
+// 指定指令集（测试 / 基准用）；CPU 不支持时取支持的最高一级，返回实际生效的
+NttIsa SetNttIsa(NttIsa isa);
+
+// 原地负循环 NTT，输入自然顺序，输出 bit-reverse 顺序。
+// w / wPrecon: 长度 n 的 bit-reverse psi 幂表及其 Shoup 常数 floor(w·2^64/q)。
+// 要求 n 为 2 的幂、a 的元素在 [0, q)；q >= 2^61 时返回 false，调用者走原来的实现。
+bool NttForwardSimd(uint64_t* a, size_t n, uint64_t q, const uint64_t* w, const uint64_t* wPrecon);
+
+// 原地负循环 INTT，输入 bit-reverse 顺序，输出自然顺序（已乘 n^-1）。
+// wInv / wInvPrecon: bit-reverse psi^-1 幂表；nInv: n^-1 mod q，nInvPrecon 为其 Shoup 常数
+bool NttInverseSimd(uint64_t* a, size_t n, uint64_t q, const uint64_t* wInv, const uint64_t* wInvPrecon,
+                    uint64_t nInv, uint64_t nInvPrecon);
+
+// 分块大小（元素数，2 的幂，至少 16）：默认 4096，环境变量 OPENFHE_NTT_BLOCK 可覆盖
+size_t GetNttBlockSize();
+// 返回实际生效的块大小（向下取 2 的幂）
+size_t SetNttBlockSize(size_t block);
+
+// =============================================================
+// 多 tower 合并 NTT（DCRTPoly::SwitchFormat）
+// -------------------------------------------------------------
+// 维度 n、块大小 B 时，每个 tower 的变换拆成：
+//   列段：蝶形距离 >= B 的 log2(n/B) 级，按列切成 B/cols 个列块，每个列块独立；
+//   块段：其余各级，n/B 个连续块各自独立，只读表里对应的一段 twiddle。
+// 所有 tower 的 (tower, 列块) 和 (tower, 块) 分别在 OpenMP 线程间均分，
+// tower 少时一个 tower 内部也能并行，tower 多时每个工作项的数据和 twiddle 仍在 L2 内。
+// =============================================================
+struct NttTower {
+    uint64_t* data;           // n 个系数，原地变换
+    uint64_t q;
+    const uint64_t* w;        // 正变换：psi 表；逆变换：psi^-1 表（bit-reverse）
+    const uint64_t* wPrecon;  // Shoup 常数
+    uint64_t nInv;            // 仅逆变换：n^-1 mod q
+    uint64_t nInvPrecon;
+};
+
+// 任一 tower 的 q >= 2^61 时返回 false，数据未修改
+bool NttBatchForward(const std::vector<NttTower>& towers, size_t n);
+bool NttBatchInverse(const std::vector<NttTower>& towers, size_t n);
+
+// =============================================================
+// 惰性约减的乘累加（key-switch 的 digit × key 内积）
+// -------------------------------------------------------------
+// out0[k] = Σ_j c_j[k]·b_j[k] mod q，out1[k] = Σ_j c_j[k]·a_j[k] mod q。
+// 乘积不约减，逐系数按 128 位累加所有项（IFMA：52 位乘积的高、低两列分别累加），
+// 每个系数最后只约减一次：累加值折成 hi·(2^64 mod q) + lo，两部分各做一次 Barrett（μ = floor(2^64/q)）。
+// 项数超过 128 位累加器的容量（q < 2^61 时至少 64 项）时分段，段间约减一次。
+// GetNttIsa() 为 AVX512IFMA 且 q < 2^50 时走 8 路 IFMA，其余走标量（64×64->128 位乘法）。
+// 输入须在 [0, q)；q >= 2^61 时返回 false，out 未修改。
+// =============================================================
+struct MacTerm {
+    const uint64_t* c;  // digit
+    const uint64_t* b;  // key 的两个分量
+    const uint64_t* a;
+};
+
+bool KeyMacLazy(const std::vector<MacTerm>& terms, size_t n, uint64_t q, uint64_t* out0, uint64_t* out1);
+
+// =============================================================
+// 基转换（DCRTPoly::ApproxSwitchCRTBasis 的 CPU 路径）
+// -------------------------------------------------------------
+// y_j[k] = Σ_i [x_i[k]·qHatInv_i]_{q_i}·qHatModp[i][j] mod p_j，即 sizeP × sizeQ 的小矩阵乘 N 列。
+// 按 256 列分块，块在 OpenMP 线程间均分。块内先把 x_i·qHatInv_i（Shoup）放进线程本地的
+// sizeQ × 256 缓冲，再沿 i 做 128 位惰性累加，每个系数一次 Barrett（同 KeyMacLazy）。
+// 输出列 4 个一组，累加器留在寄存器里，x 的每次载入给一组共用。
+// GetNttIsa() 为 AVX512IFMA 且所有模数 < 2^50 时走 8 路 IFMA，其余走标量。
+// 模数 >= 2^61 或 sizeQ 项会让 128 位累加溢出时返回 false，y 未修改。
+// =============================================================
+struct BConvParams {
+    std::vector<uint64_t> q;              // 源基，sizeQ 个
+    std::vector<uint64_t> qHatInv;        // [(Q/q_i)^-1]_{q_i}
+    std::vector<uint64_t> qHatInvPrecon;  // 其 Shoup 常数
+    std::vector<uint64_t> p;              // 目标基，sizeP 个
+    std::vector<uint64_t> qHatModp;       // [Q/q_i]_{p_j}，sizeQ × sizeP 行优先
+};
+
+// x: sizeQ 个源 tower；y: sizeP 个目标 tower；各 n 个系数
+bool BConvLazy(const BConvParams& params, const uint64_t* const* x, uint64_t* const* y, size_t n);
+
+}  // namespace intnat
+
+#endif  // LBCRYPTO_MATH_HAL_INTNAT_NTT_SIMD_H
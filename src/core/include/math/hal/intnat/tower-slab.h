@@ -0,0 +1,273 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  Contiguous 64-byte aligned storage for the towers of a DCRTPoly, and the
+  per-thread arena that recycles tower storage during key switching
+ */
+
+#ifndef LBCRYPTO_MATH_HAL_INTNAT_TOWER_SLAB_H
+#define LBCRYPTO_MATH_HAL_INTNAT_TOWER_SLAB_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace intnat {
+
+// =============================================================
+// DCRTPoly 的 tower 存储方式
+// -------------------------------------------------------------
+//   PER_TOWER  : 每个 tower 的 NativeVector 各自在堆上分配（原来的行为）
+//   CONTIGUOUS : 所有 tower 放在一块 64 字节对齐的 slab 里（towers × N 个字），
+//                每个 NativeVector 仍是一个 tower 的视图，逐 tower 的接口不变
+// 默认 PER_TOWER，环境变量 OPENFHE_DCRT_STORAGE=contiguous 切换。
+// =============================================================
+enum class TowerStorage { PER_TOWER = 0, CONTIGUOUS };
+
+TowerStorage GetTowerStorage();
+void SetTowerStorage(TowerStorage storage);
+
+// =============================================================
+// tower 存储的线程级复用（key-switch 临时量）
+// -------------------------------------------------------------
+// 线程上有 TowerArena::Scope 存活时，该线程释放的 NativeVector / TowerSlab 存储不还给堆，
+// 按字节数放进本线程的空闲表；之后本线程同样大小的分配直接从空闲表取。
+// Scope 只对开它的线程生效，其他线程（包括 Scope 里派出的 OpenMP 工作线程）照常走堆。
+// key switching 的临时量只有 tower（N 个字）和 slab（若干 tower）几种大小，反复出现，
+// 所以大小类就是精确的字节数，取出的块和新分配的一样可以直接还给堆。
+// 每个线程缓存的字节数有上限（默认 64MB，环境变量 OPENFHE_TOWER_ARENA_MB），超出的还给堆。
+// KeySwitchHYBRID / KeySwitchBV 的入口和 ApproxSwitchCRTBasis / ApproxModDown 自动开 Scope；
+// OPENFHE_TOWER_ARENA=off 或 SetEnabled(false) 时 Scope 不生效。
+// 计数按线程记（只有本线程写），GetStats 时汇总。
+// =============================================================
+struct TowerArenaStats {
+    uint64_t heap_allocs  = 0;  // 向堆申请
+    uint64_t arena_allocs = 0;  // 由空闲表满足
+    uint64_t heap_frees   = 0;  // 还给堆
+    uint64_t arena_frees  = 0;  // 放进空闲表
+};
+
+class TowerArena {
+public:
+    class Scope {
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope&)            = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        bool m_active;
+    };
+
+    // 诊断用：Meter 存活期间统计所有线程经 TowerArena 分配、尚未释放的字节数（从创建时算起的净增量）
+    // 及其峰值。从空闲表取出的块同样计入。计数是进程级的，同一时刻只应有一个 Meter，
+    // 并发的其他工作也会算进去；没有 Meter 时分配路径只多一次读。
+    class Meter {
+    public:
+        Meter();
+        ~Meter();
+        Meter(const Meter&)            = delete;
+        Meter& operator=(const Meter&) = delete;
+
+        int64_t LiveBytes() const;
+        int64_t PeakBytes() const;
+    };
+
+    static bool Enabled();
+    static void SetEnabled(bool enabled);
+    // 本线程是否有 Scope 存活
+    static bool Active();
+
+    // bytes 字节的 tower 存储（::operator new 兼容）。malloc 属性告诉编译器返回的块不与已有对象重叠，
+    // vector 的填零、拷贝才能像 std::allocator 那样向量化
+    __attribute__((malloc)) static void* Allocate(size_t bytes);
+    static void Deallocate(void* p, size_t bytes);
+    // TowerSlab::ALIGNMENT 对齐的 slab 存储
+    __attribute__((malloc)) static void* AllocateAligned(size_t bytes);
+    static void DeallocateAligned(void* p, size_t bytes);
+
+    // 每个线程空闲表的字节上限；0 表示不缓存
+    static size_t GetThreadCapacity();
+    static void SetThreadCapacity(size_t bytes);
+    // 本线程的空闲表全部还给堆
+    static void Trim();
+
+    // 所有线程自上次 ResetStats 以来的累计
+    static TowerArenaStats GetStats();
+    static void ResetStats();
+};
+
+// =============================================================
+// numTowers 个 tower 的连续存储：tower i 从 Data() + i·TowerBytes() 开始，
+// TowerBytes() 为每个 tower 的字节数向上取整到 64。
+// 每个 tower 同一时刻只借给一个 vector（Acquire / Release），
+// vector 扩容、重新分配时旧区域归还，新存储落到堆上。
+// 外部存储（如 mmap 的 eval-key 文件）：slab 不分配也不释放，owner 保活那块内存；
+// 各 tower 是预载的，第一次借出时 vector 直接以原内容为值（不清零），归还后预载失效。
+// =============================================================
+class TowerSlab {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+    TowerSlab(size_t numTowers, size_t towerBytes);
+    // data 须 ALIGNMENT 对齐、towerBytes 须为 ALIGNMENT 的倍数
+    TowerSlab(size_t numTowers, size_t towerBytes, void* data, std::shared_ptr<const void> owner);
+    ~TowerSlab();
+    TowerSlab(const TowerSlab&)            = delete;
+    TowerSlab& operator=(const TowerSlab&) = delete;
+
+    size_t NumTowers() const {
+        return m_num_towers;
+    }
+    size_t TowerBytes() const {
+        return m_tower_bytes;
+    }
+    uint64_t* Data() const {
+        return reinterpret_cast<uint64_t*>(m_data);
+    }
+    void* Tower(size_t i) const {
+        return m_data + i * m_tower_bytes;
+    }
+
+    // tower i 空闲时标记为占用并返回 true
+    bool Acquire(size_t i);
+    void Release(size_t i);
+
+    bool IsExternal() const {
+        return m_owner != nullptr;
+    }
+    // tower i 的内容是否还是外部存储里的原值
+    bool Preloaded(size_t i) const {
+        return m_preloaded && m_preloaded[i].load(std::memory_order_relaxed);
+    }
+
+private:
+    size_t m_num_towers;
+    size_t m_tower_bytes;
+    unsigned char* m_data;
+    std::unique_ptr<std::atomic<bool>[]> m_in_use;
+    std::shared_ptr<const void> m_owner;
+    std::unique_ptr<std::atomic<bool>[]> m_preloaded;
+};
+
+// =============================================================
+// NativeVector 的分配器：绑定了 (slab, tower) 时，第一次分配（不超过一个 tower）
+// 直接用 slab 里的那一段，其余情况走堆（经 TowerArena）。
+//   - 拷贝构造的 vector 用默认（堆）分配器，拷贝不会抢占原 tower 的区域；
+//   - 移动构造 / 移动赋值 / swap 时分配器跟着存储走，slab 由 shared_ptr 保活；
+//   - 拷贝赋值保留左边的分配器，长度不变时原地拷贝，仍在 slab 里。
+// =============================================================
+template <typename T>
+class TowerAllocator {
+public:
+    using value_type                             = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap            = std::true_type;
+    using is_always_equal                        = std::false_type;
+
+    TowerAllocator() noexcept = default;
+    TowerAllocator(std::shared_ptr<TowerSlab> slab, size_t tower) noexcept
+        : m_slab{std::move(slab)}, m_tower{static_cast<uint32_t>(tower)} {}
+    TowerAllocator(const TowerAllocator& a) noexcept = default;
+    template <typename U>
+    TowerAllocator(const TowerAllocator<U>& a) noexcept
+        : m_slab{a.GetSlab()}, m_tower{static_cast<uint32_t>(a.GetTower())} {}
+
+    T* allocate(size_t n) {
+        if (m_slab && n * sizeof(T) <= m_slab->TowerBytes() && m_slab->Acquire(m_tower)) {
+            m_keep = m_slab->Preloaded(m_tower);
+            return static_cast<T*>(m_slab->Tower(m_tower));
+        }
+        m_keep = false;
+        return static_cast<T*>(TowerArena::Allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (m_slab && p == m_slab->Tower(m_tower)) {
+            m_slab->Release(m_tower);
+            return;
+        }
+        TowerArena::Deallocate(p, n * sizeof(T));
+    }
+
+    // 预载 tower 上的值初始化保留原内容，vector 即为外部存储的视图。
+    // 是否预载在 allocate 时记下：逐元素只判断一个普通 bool，未绑定时循环照样向量化
+    template <typename U, typename... Args>
+    void construct(U* p, Args&&... args) {
+        if constexpr (sizeof...(Args) == 0) {
+            if (m_keep) {
+                const auto* tower = static_cast<const unsigned char*>(m_slab->Tower(m_tower));
+                const auto* at    = reinterpret_cast<const unsigned char*>(p);
+                if (at >= tower && at < tower + m_slab->TowerBytes())
+                    return;
+            }
+        }
+        ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+    }
+
+    TowerAllocator select_on_container_copy_construction() const {
+        return TowerAllocator();
+    }
+
+    const std::shared_ptr<TowerSlab>& GetSlab() const {
+        return m_slab;
+    }
+    size_t GetTower() const {
+        return m_tower;
+    }
+
+private:
+    std::shared_ptr<TowerSlab> m_slab;
+    uint32_t m_tower{0};
+    // 最近一次 allocate 借到的是预载的 tower
+    bool m_keep{false};
+};
+
+template <typename T, typename U>
+bool operator==(const TowerAllocator<T>& a, const TowerAllocator<U>& b) {
+    return a.GetSlab() == b.GetSlab() && (!a.GetSlab() || a.GetTower() == b.GetTower());
+}
+template <typename T, typename U>
+bool operator!=(const TowerAllocator<T>& a, const TowerAllocator<U>& b) {
+    return !(a == b);
+}
+
+}  // namespace intnat
+
+#endif  // LBCRYPTO_MATH_HAL_INTNAT_TOWER_SLAB_H
@@ -40,19 +40,19 @@
 #include "math/hal/intnat/ubintnat.h"
 #include "math/hal/intnat/mubintvecnat.h"
 #include "math/hal/intnat/transformnat.h"
+#include "math/hal/intnat/ntt-simd.h"
 #include "math/nbtheory.h"
 
 #include "utils/exception.h"
 #include "utils/inttypes.h"
+#include "utils/parallel.h"
 #include "utils/utilities.h"
 
 #include <algorithm>
 #include <map>
 #include <vector>
 
-#ifdef OPENFHE_FPGA_ENABLE
-    #include "FpgaManager.h"
-#endif
+#include "OffloadDispatcher.h"
 
 
 #include <fstream>
@@ -377,21 +377,20 @@ void NumberTheoreticTransformNat<VecType>::ForwardTransformToBitReverseInPlace(
     };
     
     // Xiangchen: Implement NTT on FPGA
-#ifdef OPENFHE_FPGA_ENABLE
-    {
-        FpgaManager& fm = FpgaManager::GetInstance();
-        if (fm.IsReady()) {
-            const uint32_t len = static_cast<uint32_t>(element->GetLength());
-            std::vector<uint64_t> in(len), out(len);
-            for (uint32_t i = 0; i < len; ++i)
-                in[i] = (*element)[i].ConvertToInt();
-            uint64_t q = static_cast<uint64_t>(modulus.ConvertToInt());
-            fm.NttForwardOffload(in.data(), out.data(), q, static_cast<size_t>(len));
-            for (uint32_t i = 0; i < len; ++i)
-                (*element)[i] = IntType(out[i]);
+    if (auto* accel = PolyAccelerator::Get()) {
+        // 原地变换: 直接使用 NativeVector 存储, 不再经过临时 vector；维度 / 模数不在设备上时走 CPU
+        uint64_t* data = reinterpret_cast<uint64_t*>(&(*element)[0]);
+        uint64_t q     = static_cast<uint64_t>(modulus.ConvertToInt());
+        if (accel->NttForwardOffload(data, data, q, static_cast<size_t>(element->GetLength())))
             return;
-        }
     }
+#if NATIVEINT == 64
+    // 主机 SIMD 核（ntt-simd.h，运行时选指令集）；模数超出其范围时用下面的标量实现
+    if (NttForwardSimd(reinterpret_cast<uint64_t*>(&(*element)[0]), static_cast<size_t>(element->GetLength()),
+                       static_cast<uint64_t>(modulus.ConvertToInt()),
+                       reinterpret_cast<const uint64_t*>(&rootOfUnityTable[0]),
+                       reinterpret_cast<const uint64_t*>(&preconRootOfUnityTable[0])))
+        return;
 #endif
     cpu_ntt(*element);
 }
@@ -619,21 +618,20 @@ void NumberTheoreticTransformNat<VecType>::InverseTransformFromBitReverseInPlace
     auto modulus{element->GetModulus()};
     uint32_t n(element->GetLength());
 
-#ifdef OPENFHE_FPGA_ENABLE
-    {
-        FpgaManager& fm = FpgaManager::GetInstance();
-        if (fm.IsReady()) {
-            const uint32_t len = static_cast<uint32_t>(n);
-            std::vector<uint64_t> in_buf(len), fpga_out_buf(len);
-            for (uint32_t i = 0; i < len; ++i)
-                in_buf[i] = (*element)[i].ConvertToInt();
-            uint64_t q = static_cast<uint64_t>(modulus.ConvertToInt());
-            fm.NttInverseOffload(in_buf.data(), fpga_out_buf.data(), q, static_cast<size_t>(len));
-            for (uint32_t i = 0; i < len; ++i)
-                (*element)[i] = IntType(fpga_out_buf[i]);
+    if (auto* accel = PolyAccelerator::Get()) {
+        uint64_t* data = reinterpret_cast<uint64_t*>(&(*element)[0]);
+        uint64_t q     = static_cast<uint64_t>(modulus.ConvertToInt());
+        if (accel->NttInverseOffload(data, data, q, static_cast<size_t>(n)))
             return;
-        }
     }
+#if NATIVEINT == 64
+    if (NttInverseSimd(reinterpret_cast<uint64_t*>(&(*element)[0]), static_cast<size_t>(n),
+                       static_cast<uint64_t>(modulus.ConvertToInt()),
+                       reinterpret_cast<const uint64_t*>(&rootOfUnityInverseTable[0]),
+                       reinterpret_cast<const uint64_t*>(&preconRootOfUnityInverseTable[0]),
+                       static_cast<uint64_t>(cycloOrderInv.ConvertToInt()),
+                       static_cast<uint64_t>(preconCycloOrderInv.ConvertToInt())))
+        return;
 #endif
 
     // precomputed omega[bitreversed(1)] * (n inverse). used in final stage of intt.
@@ -837,6 +835,102 @@ void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverseInP
         element);
 }
 
+template <typename VecType>
+void ChineseRemainderTransformFTTNat<VecType>::ForwardTransformToBitReverseInPlace(
+    const std::vector<IntType>& rootOfUnity, const usint CycloOrder, const std::vector<VecType*>& elements) {
+    if (!IsPowerOfTwo(CycloOrder)) {
+        OPENFHE_THROW("CyclotomicOrder is not a power of two");
+    }
+
+    usint CycloOrderHf = (CycloOrder >> 1);
+    bool merged        = true;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (elements[i]->GetLength() != CycloOrderHf) {
+            OPENFHE_THROW("element size must be equal to CyclotomicOrder / 2");
+        }
+        if (rootOfUnity[i] == IntType(1) || rootOfUnity[i] == IntType(0)) {
+            merged = false;
+            continue;
+        }
+        IntType modulus = elements[i]->GetModulus();
+        auto mapSearch  = m_rootOfUnityReverseTableByModulus.find(modulus);
+        if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
+            PreCompute(rootOfUnity[i], CycloOrder, modulus);
+        }
+    }
+
+#if NATIVEINT == 64
+    if (merged) {
+        // 表在上面已经就绪，这里只读
+        std::vector<NttTower> towers(elements.size());
+        for (size_t i = 0; i < elements.size(); ++i) {
+            IntType modulus = elements[i]->GetModulus();
+            towers[i]       = {reinterpret_cast<uint64_t*>(&(*elements[i])[0]),
+                               static_cast<uint64_t>(modulus.ConvertToInt()),
+                               reinterpret_cast<const uint64_t*>(&m_rootOfUnityReverseTableByModulus[modulus][0]),
+                               reinterpret_cast<const uint64_t*>(&m_rootOfUnityPreconReverseTableByModulus[modulus][0]),
+                               0, 0};
+        }
+        if (NttBatchForward(towers, CycloOrderHf))
+            return;
+    }
+#endif
+
+    size_t size = elements.size();
+#pragma omp parallel for num_threads(lbcrypto::OpenFHEParallelControls.GetThreadLimit(size))
+    for (size_t i = 0; i < size; ++i)
+        ForwardTransformToBitReverseInPlace(rootOfUnity[i], CycloOrder, elements[i]);
+}
+
+template <typename VecType>
+void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverseInPlace(
+    const std::vector<IntType>& rootOfUnity, const usint CycloOrder, const std::vector<VecType*>& elements) {
+    if (!IsPowerOfTwo(CycloOrder)) {
+        OPENFHE_THROW("CyclotomicOrder is not a power of two");
+    }
+
+    usint CycloOrderHf = (CycloOrder >> 1);
+    bool merged        = true;
+    for (size_t i = 0; i < elements.size(); ++i) {
+        if (elements[i]->GetLength() != CycloOrderHf) {
+            OPENFHE_THROW("element size must be equal to CyclotomicOrder / 2");
+        }
+        if (rootOfUnity[i] == IntType(1) || rootOfUnity[i] == IntType(0)) {
+            merged = false;
+            continue;
+        }
+        IntType modulus = elements[i]->GetModulus();
+        auto mapSearch  = m_rootOfUnityReverseTableByModulus.find(modulus);
+        if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
+            PreCompute(rootOfUnity[i], CycloOrder, modulus);
+        }
+    }
+
+#if NATIVEINT == 64
+    if (merged) {
+        usint msb = GetMSB(CycloOrderHf - 1);
+        std::vector<NttTower> towers(elements.size());
+        for (size_t i = 0; i < elements.size(); ++i) {
+            IntType modulus = elements[i]->GetModulus();
+            towers[i]       = {
+                reinterpret_cast<uint64_t*>(&(*elements[i])[0]),
+                static_cast<uint64_t>(modulus.ConvertToInt()),
+                reinterpret_cast<const uint64_t*>(&m_rootOfUnityInverseReverseTableByModulus[modulus][0]),
+                reinterpret_cast<const uint64_t*>(&m_rootOfUnityInversePreconReverseTableByModulus[modulus][0]),
+                static_cast<uint64_t>(m_cycloOrderInverseTableByModulus[modulus][msb].ConvertToInt()),
+                static_cast<uint64_t>(m_cycloOrderInversePreconTableByModulus[modulus][msb].ConvertToInt())};
+        }
+        if (NttBatchInverse(towers, CycloOrderHf))
+            return;
+    }
+#endif
+
+    size_t size = elements.size();
+#pragma omp parallel for num_threads(lbcrypto::OpenFHEParallelControls.GetThreadLimit(size))
+    for (size_t i = 0; i < size; ++i)
+        InverseTransformFromBitReverseInPlace(rootOfUnity[i], CycloOrder, elements[i]);
+}
+
 template <typename VecType>
 void ChineseRemainderTransformFTTNat<VecType>::InverseTransformFromBitReverse(const VecType& element,
                                                                               const IntType& rootOfUnity,
@@ -910,6 +1004,59 @@ void ChineseRemainderTransformFTTNat<VecType>::PreCompute(const IntType& rootOfU
                                                           const IntType& modulus) {
     usint CycloOrderHf = (CycloOrder >> 1);
 
+    // 加速器后端的 InitModuli 直接复用这里缓存的 bit-reverse 表，不再自己生成 twiddle
+    static const bool fpgaLookupRegistered = [] {
+        PolyAccelerator::SetTwiddleTableLookup(
+            [](uint64_t q, size_t n, std::vector<uint64_t>& fwd, std::vector<uint64_t>& inv) {
+                using CRT  = ChineseRemainderTransformFTTNat<VecType>;
+                bool found = false;
+                // 表由下面的 omp critical 写入，读也在同一把锁里做完
+#pragma omp critical
+                {
+                    const VecType *fwdTable, *fwdPrecon, *invTable, *invPrecon;
+                    IntType cycloOrderInv, preconCycloOrderInv;
+                    found = CRT::GetForwardTablesForVerification(IntType(q), n, &fwdTable, &fwdPrecon) &&
+                            CRT::GetInverseTablesForVerification(IntType(q), n, &invTable, &invPrecon,
+                                                                 &cycloOrderInv, &preconCycloOrderInv);
+                    if (found) {
+                        fwd.resize(n);
+                        inv.resize(n);
+                        for (size_t i = 0; i < n; ++i) {
+                            fwd[i] = (*fwdTable)[i].ConvertToInt();
+                            inv[i] = (*invTable)[i].ConvertToInt();
+                        }
+                    }
+                }
+                return found;
+            });
+        // 卸载调度器的 CPU 路径（代价模型标定、攒批的 NTT 落到 CPU 时）
+        OffloadDispatcher::SetCpuTransform([](bool forward, uint64_t* data, uint64_t q, size_t n) {
+            using CRT = ChineseRemainderTransformFTTNat<VecType>;
+            const VecType *table, *precon;
+            IntType cycloOrderInv, preconCycloOrderInv;
+            const bool found =
+                forward ? CRT::GetForwardTablesForVerification(IntType(q), n, &table, &precon) :
+                          CRT::GetInverseTablesForVerification(IntType(q), n, &table, &precon, &cycloOrderInv,
+                                                               &preconCycloOrderInv);
+            if (!found)
+                return false;
+            VecType element(n, IntType(q));
+            for (size_t i = 0; i < n; ++i)
+                element[i] = data[i];
+            OffloadDispatcher::ScopedCpuOnly cpuOnly;
+            if (forward)
+                NumberTheoreticTransformNat<VecType>().ForwardTransformToBitReverseInPlace(*table, *precon, &element);
+            else
+                NumberTheoreticTransformNat<VecType>().InverseTransformFromBitReverseInPlace(
+                    *table, *precon, cycloOrderInv, preconCycloOrderInv, &element);
+            for (size_t i = 0; i < n; ++i)
+                data[i] = element[i].ConvertToInt();
+            return true;
+        });
+        return true;
+    }();
+    (void)fpgaLookupRegistered;
+
     auto mapSearch = m_rootOfUnityReverseTableByModulus.find(modulus);
     if (mapSearch == m_rootOfUnityReverseTableByModulus.end() || mapSearch->second.GetLength() != CycloOrderHf) {
 #pragma omp critical
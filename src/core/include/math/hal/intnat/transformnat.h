@@ -318,6 +318,28 @@ public:
    */
     void InverseTransformFromBitReverseInPlace(const IntType& rootOfUnity, const usint CycloOrder, VecType* element);
 
+    /**
+   * In-place forward transforms of several towers of the same ring dimension (DCRTPoly::SwitchFormat).
+   * All towers go through one multi-tower engine whose (tower, block) work items are shared by the
+   * threads (see intnat::NttBatchForward); the accelerator is not consulted here.
+   *
+   * @param &rootOfUnity the 2n-th root of unity of each tower.
+   * @param CycloOrder is 2n, should be a power-of-two or a throw if an error occurs.
+   * @param &elements the towers, each of length n with its own modulus.
+   */
+    void ForwardTransformToBitReverseInPlace(const std::vector<IntType>& rootOfUnity, const usint CycloOrder,
+                                             const std::vector<VecType*>& elements);
+
+    /**
+   * In-place inverse transforms of several towers of the same ring dimension (DCRTPoly::SwitchFormat).
+   *
+   * @param &rootOfUnity the 2n-th root of unity of each tower.
+   * @param CycloOrder is 2n, should be a power-of-two or a throw if an error occurs.
+   * @param &elements the towers, each of length n with its own modulus.
+   */
+    void InverseTransformFromBitReverseInPlace(const std::vector<IntType>& rootOfUnity, const usint CycloOrder,
+                                               const std::vector<VecType*>& elements);
+
     /**
    * Precomputation of root of unity tables for transforms in the ring
    * Z_q[X]/(X^n+1)
@@ -0,0 +1,72 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2023, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Uniform polynomials expanded from a short seed (compressed eval keys and ciphertexts)
+ */
+
+#ifndef LBCRYPTO_INC_MATH_SEEDUNIFORMGENERATOR_H_
+#define LBCRYPTO_INC_MATH_SEEDUNIFORMGENERATOR_H_
+
+#include "utils/prng/blake2engine.h"
+
+#include <cstdint>
+
+namespace lbcrypto {
+
+// =============================================================
+// 由种子确定性展开的 Z_q 上的均匀分布
+// -------------------------------------------------------------
+// 种子是 Blake2Engine 的 16 个 32 位字。(种子, stream, tower) 对应一个 Blake2Engine，
+// 计数器从 (stream << 48) | (tower << 32) 开始，各 (stream, tower) 的输出互不重叠。
+// 每个系数取两个 32 位输出拼成 64 位，截到 q 的位数后拒绝采样到 [0, q)。
+// 固定用内置的 BLAKE2 引擎，不受 InitPRNGEngine 加载的外部 PRNG 影响：
+// 同一个种子在任何线程数、任何同字节序的机器上都展开成同样的系数，可以只存 / 只传种子。
+// =============================================================
+using PRNGSeed = default_prng::Blake2Engine::blake2_seed_array_t;
+
+class SeedUniformGenerator {
+public:
+    // stream / tower 的上限（各占计数器的 16 位）
+    static constexpr uint32_t MAX_STREAMS = 1u << 16;
+    static constexpr uint32_t MAX_TOWERS  = 1u << 16;
+
+    // 新种子，取自 PseudoRandomNumberGenerator::GetPRNG()
+    static PRNGSeed GenerateSeed();
+
+    // out[0..n) = (seed, stream, tower) 展开的 n 个 [0, q) 上的均匀值
+    static void GenerateTower(const PRNGSeed& seed, uint32_t stream, uint32_t tower, uint64_t q, uint32_t n,
+                              uint64_t* out);
+};
+
+}  // namespace lbcrypto
+
+#endif  // LBCRYPTO_INC_MATH_SEEDUNIFORMGENERATOR_H_
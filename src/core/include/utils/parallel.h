@@ -108,10 +108,16 @@ public:
 #endif
     }
 
-    // @Brief returns min of int n and machineThreads
+    // @Brief returns min of int n and the current thread count (SetNumThreads)
+    // Returns 1 when called from inside a parallel region: the enclosing loop
+    // (e.g. over the digits of a key switch) already owns the threads, and a
+    // nested team would only oversubscribe the cores
     int GetThreadLimit(int n) const {
 #ifdef PARALLEL
-        return n > machineThreads ? machineThreads : n;
+        if (omp_in_parallel())
+            return 1;
+        int limit = omp_get_max_threads();
+        return n > limit ? limit : n;
 #else
         return 1;
 #endif
@@ -0,0 +1,619 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  In-process simulator of the FPGA Top kernel: runs the fpga_backend/src kernel
+  sources (built with FPGA_STANDALONE_TEST) behind the PolyAccelerator interface
+ */
+
+#ifdef OPENFHE_FPGA_SIM
+
+#include "FpgaSimulator.h"
+#include "FpgaManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// fpga_backend/include/top.h；不直接包含，kernel 的 define.h 与主机侧的 MAX_LIMBS 等宏同名
+extern "C" void Top(const uint64_t* mem_in1, const uint64_t* mem_in2, uint64_t* mem_out, const uint8_t opcode,
+                    const int num_active_limbs, const int mod_index);
+
+namespace {
+
+// kernel 参数组（与 xrt::kernel::group_id(0..2) 对应，只用于 buffer pool 的分桶）
+const int GROUP_IN1 = 0;
+const int GROUP_IN2 = 1;
+const int GROUP_OUT = 2;
+
+void WriteBuffer(std::vector<uint64_t>& buf, const uint64_t* src, size_t bytes, size_t offset) {
+    std::memcpy(reinterpret_cast<char*>(buf.data()) + offset, src, bytes);
+}
+
+void ReadBuffer(const std::vector<uint64_t>& buf, uint64_t* dst, size_t bytes, size_t offset) {
+    std::memcpy(dst, reinterpret_cast<const char*>(buf.data()) + offset, bytes);
+}
+
+}  // namespace
+
+FpgaSimulator& FpgaSimulator::GetInstance() {
+    static FpgaSimulator instance;
+    return instance;
+}
+
+FpgaSimulator::FpgaSimulator() {
+    m_pool.SetFactory([](size_t bytes, int) { return DeviceBuffer((bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t)); });
+}
+
+void FpgaSimulator::Launch(const uint64_t* in1, const uint64_t* in2, uint64_t* out, uint8_t opcode, int num_limbs,
+                           int mod_idx) {
+    std::lock_guard<std::mutex> lock(m_kernel_mutex);
+    Top(in1, in2, out, opcode, num_limbs, mod_idx);
+    ++m_launches;
+}
+
+// ----------------------------------------------------------------------
+// InitModuli：与 FpgaManager 相同的设备镜像，OP_INIT 从镜像取两段参数
+// ----------------------------------------------------------------------
+void FpgaSimulator::InitModuli(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                               const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots,
+                               size_t ringDim) {
+    // 参数重载前必须等待所有异步命令结束
+    m_queue.Drain();
+    std::lock_guard<std::mutex> lock(m_kernel_mutex);
+
+    m_stored_moduli = q_mods;
+    m_num_q         = q_mods.size();
+    m_stored_moduli.insert(m_stored_moduli.end(), p_mods.begin(), p_mods.end());
+    std::vector<uint64_t> roots = q_roots;
+    roots.insert(roots.end(), p_roots.begin(), p_roots.end());
+
+    m_ring_dim = 0;
+    m_image.clear();
+    auto image = FpgaManager::PackInitImage(q_mods, p_mods, roots, ringDim, GetTwiddleTableLookup());
+    if (image.words.empty()) {
+        std::cerr << "[FPGA Sim Warning] Ring dimension " << ringDim << " is not supported by the kernel"
+                  << std::endl;
+        return;
+    }
+    m_image = std::move(image.words);
+    m_h2d_bytes += m_image.size() * sizeof(uint64_t);
+
+    if (image.stream_words != 0) {
+        m_stream_offset[0] = image.stream_offset[0];
+        m_stream_offset[1] = image.stream_offset[1];
+        m_ring_dim         = ringDim;
+    }
+    if (image.init_p_offset != 0) {
+        uint64_t in = 0, out = 0;
+        Top(&in, m_image.data(), &out, OP_INIT, 0, (int)image.init_p_offset);
+        ++m_launches;
+    }
+}
+
+bool FpgaSimulator::HasModulus(uint64_t modulus) const {
+    return std::find(m_stored_moduli.begin(), m_stored_moduli.end(), modulus) != m_stored_moduli.end();
+}
+
+std::vector<int> FpgaSimulator::DeviceIndices(const uint64_t* moduli, size_t numTowers, bool onChip) const {
+    std::vector<int> idx(numTowers);
+    for (size_t i = 0; i < numTowers; ++i) {
+        auto it = std::find(m_stored_moduli.begin(), m_stored_moduli.end(), moduli[i]);
+        int d   = (it == m_stored_moduli.end()) ? -1 : (int)std::distance(m_stored_moduli.begin(), it);
+        idx[i]  = (onChip && d >= 0) ? FpgaManager::OnChipSlot((size_t)d, m_num_q) : d;
+    }
+    return idx;
+}
+
+int FpgaSimulator::OnChipIndex(uint64_t modulus, size_t n) const {
+    return n == FPGA_RING_DIM ? DeviceIndices(&modulus, 1, true)[0] : -1;
+}
+
+// ----------------------------------------------------------------------
+// 单 limb 操作
+// ----------------------------------------------------------------------
+void FpgaSimulator::Execute(uint8_t opcode, const uint64_t* in1, const uint64_t* in2, size_t in2_words,
+                            uint64_t* out, int mod_idx) {
+    const size_t bytes = FPGA_RING_DIM * sizeof(uint64_t);
+    auto bo_in1        = m_pool.Acquire(GROUP_IN1, bytes);
+    auto bo_out        = m_pool.Acquire(GROUP_OUT, bytes);
+    WriteBuffer(*bo_in1, in1, bytes, 0);
+
+    DeviceBufferPool<DeviceBuffer>::Handle bo_in2;
+    if (in2) {
+        bo_in2 = m_pool.Acquire(GROUP_IN2, in2_words * sizeof(uint64_t));
+        WriteBuffer(*bo_in2, in2, in2_words * sizeof(uint64_t), 0);
+    }
+
+    Launch(bo_in1->data(), bo_in2.Valid() ? bo_in2->data() : bo_in1->data(), bo_out->data(), opcode, 1, mod_idx);
+
+    ReadBuffer(*bo_out, out, bytes, 0);
+    CountTransfer(bytes + (in2 ? in2_words * sizeof(uint64_t) : 0), bytes);
+}
+
+// 单 limb NTT 也走 OP_NTT_STREAM：片上 OP_NTT/OP_INTT 的求值域是按行错位的（第 r 行循环右移 r），与 CPU 的顺序不同
+bool FpgaSimulator::NttForwardOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) {
+    if (!SupportsRingDim(n) || !HasModulus(modulus))
+        return false;
+    if (in != out)
+        std::copy(in, in + n, out);
+    return NttBatchOffload(true, &out, &modulus, 1, n);
+}
+
+bool FpgaSimulator::NttInverseOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) {
+    if (!SupportsRingDim(n) || !HasModulus(modulus))
+        return false;
+    if (in != out)
+        std::copy(in, in + n, out);
+    return NttBatchOffload(false, &out, &modulus, 1, n);
+}
+
+bool FpgaSimulator::AutoOffload(const uint64_t* in, uint64_t* out, uint32_t k, uint32_t kinv, uint64_t modulus,
+                                size_t n) {
+    const int mod_idx = OnChipIndex(modulus, n);
+    if (mod_idx < 0)
+        return false;
+    const uint64_t meta[2] = {k, kinv};
+    Execute(OP_AUTO, in, meta, 2, out, mod_idx);
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// 多 tower 操作：按连续模数索引切段，每段一次启动
+// NTT 一律用 OP_NTT_STREAM（与 CPU 相同的 bit-reverse 顺序）
+// ----------------------------------------------------------------------
+bool FpgaSimulator::NttBatchOffload(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers,
+                                    size_t n) {
+    if (!SupportsRingDim(n) || numTowers == 0)
+        return false;
+
+    auto runs = FpgaManager::PlanLimbRuns(DeviceIndices(moduli, numTowers, false), FpgaManager::StreamTileLimbs(n));
+    if (runs.empty())
+        return false;
+
+    const size_t limb_bytes = n * sizeof(uint64_t);
+    const uint64_t* image   = m_image.data() + m_stream_offset[forward ? 0 : 1];
+    // 与 FpgaManager 相同：全部段读回 scratch 后才写回 tower
+    std::vector<uint64_t> scratch(numTowers * n);
+    for (const auto& r : runs) {
+        const size_t bytes = r.count * limb_bytes;
+        auto bo_in         = m_pool.Acquire(GROUP_IN1, bytes);
+        auto bo_out        = m_pool.Acquire(GROUP_OUT, bytes);
+        for (size_t l = 0; l < r.count; ++l)
+            WriteBuffer(*bo_in, towers[r.first + l], limb_bytes, l * limb_bytes);
+
+        Launch(bo_in->data(), image, bo_out->data(), OP_NTT_STREAM, (int)r.count, r.mod_idx);
+
+        ReadBuffer(*bo_out, scratch.data() + r.first * n, bytes, 0);
+        CountTransfer(bytes, bytes);
+    }
+    for (size_t i = 0; i < numTowers; ++i)
+        std::copy(scratch.data() + i * n, scratch.data() + (i + 1) * n, towers[i]);
+    return true;
+}
+
+bool FpgaSimulator::ModOpOffload(int opcode, const uint64_t* const* a, const uint64_t* const* b, uint64_t* const* out,
+                                 const uint64_t* moduli, size_t numTowers, size_t n) {
+    if (n != FPGA_RING_DIM || numTowers == 0)
+        return false;
+    auto runs = FpgaManager::PlanLimbRuns(DeviceIndices(moduli, numTowers, true));
+    if (runs.empty())
+        return false;
+
+    const size_t limb_bytes = n * sizeof(uint64_t);
+    std::vector<uint64_t> scratch(numTowers * n);
+    for (const auto& r : runs) {
+        const size_t bytes = r.count * limb_bytes;
+        auto bo_a          = m_pool.Acquire(GROUP_IN1, bytes);
+        auto bo_b          = m_pool.Acquire(GROUP_IN2, bytes);
+        auto bo_out        = m_pool.Acquire(GROUP_OUT, bytes);
+        for (size_t l = 0; l < r.count; ++l) {
+            WriteBuffer(*bo_a, a[r.first + l], limb_bytes, l * limb_bytes);
+            WriteBuffer(*bo_b, b[r.first + l], limb_bytes, l * limb_bytes);
+        }
+
+        Launch(bo_a->data(), bo_b->data(), bo_out->data(), (uint8_t)opcode, (int)r.count, r.mod_idx);
+
+        ReadBuffer(*bo_out, scratch.data() + r.first * n, bytes, 0);
+        CountTransfer(2 * bytes, bytes);
+    }
+    for (size_t i = 0; i < numTowers; ++i)
+        std::copy(scratch.data() + i * n, scratch.data() + (i + 1) * n, out[i]);
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// BConv
+// ----------------------------------------------------------------------
+void FpgaSimulator::RunBConv(const uint64_t* x, const std::vector<uint64_t>& meta, uint64_t* result, size_t ringDim,
+                             int sizeP) {
+    const size_t in_size   = KERNEL_LIMB_Q * ringDim * sizeof(uint64_t);
+    const size_t meta_size = meta.size() * sizeof(uint64_t);
+    const size_t out_size  = sizeP * ringDim * sizeof(uint64_t);
+
+    auto bo_in   = m_pool.Acquire(GROUP_IN1, in_size);
+    auto bo_meta = m_pool.Acquire(GROUP_IN2, meta_size);
+    auto bo_out  = m_pool.Acquire(GROUP_OUT, out_size);
+    WriteBuffer(*bo_in, x, in_size, 0);
+    WriteBuffer(*bo_meta, meta.data(), meta_size, 0);
+
+    // num_active_limbs = sizeP (输出列数)
+    Launch(bo_in->data(), bo_meta->data(), bo_out->data(), OP_BCONV, sizeP, 0);
+
+    ReadBuffer(*bo_out, result, out_size, 0);
+    CountTransfer(in_size + meta_size, out_size);
+}
+
+bool FpgaSimulator::BConvOffload(const uint64_t* x, const uint64_t* w, const uint64_t* out_mod, uint64_t* result,
+                                 size_t ringDim, int sizeP) {
+    if (ringDim != FPGA_RING_DIM || sizeP < 1 || sizeP > KERNEL_MAX_OUT_COLS)
+        return false;
+    RunBConv(x, FpgaManager::PackBConvMeta(w, out_mod, sizeP), result, ringDim, sizeP);
+    return true;
+}
+
+bool FpgaSimulator::BConvTowerOffload(const uint64_t* x, const uint64_t* w_col, uint64_t out_mod, uint64_t* result,
+                                      size_t ringDim) {
+    if (ringDim != FPGA_RING_DIM)
+        return false;
+    std::vector<uint64_t> w(KERNEL_LIMB_Q * KERNEL_MAX_OUT_COLS, 0);
+    for (int i = 0; i < KERNEL_LIMB_Q; i++)
+        w[i * KERNEL_MAX_OUT_COLS] = w_col[i];
+    RunBConv(x, FpgaManager::PackBConvMeta(w.data(), &out_mod, 1), result, ringDim, 1);
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// 融合 key-switch：每个 digit 一次 OP_HKS_DIGIT，累加器 buffer 跨 digit 留在"设备"上
+// ----------------------------------------------------------------------
+bool FpgaSimulator::HksFusedOffload(const std::vector<HksDigit>& digits, const uint64_t* moduli, size_t sizeQlP,
+                                    uint64_t* const* out0, uint64_t* const* out1, size_t n) {
+    if (n != FPGA_RING_DIM || digits.empty() || sizeQlP > (size_t)KERNEL_MAX_OUT_COLS)
+        return false;
+
+    std::vector<int> dev_idx = DeviceIndices(moduli, sizeQlP, true);
+    if (std::find(dev_idx.begin(), dev_idx.end(), -1) != dev_idx.end())
+        return false;
+    for (const auto& d : digits) {
+        if (d.alpha == 0 || d.alpha > (size_t)KERNEL_LIMB_Q || d.start + d.alpha > sizeQlP)
+            return false;
+        // digit 在片上按模数索引连续存放
+        for (size_t i = 1; i < d.alpha; ++i) {
+            if (dev_idx[d.start + i] != dev_idx[d.start] + (int)i)
+                return false;
+        }
+        // digit 到补集的 BConv：补集模数不能比 digit 窄
+        std::vector<uint64_t> compl_mod(moduli, moduli + d.start);
+        compl_mod.insert(compl_mod.end(), moduli + d.start + d.alpha, moduli + sizeQlP);
+        if (!BConvFits(moduli + d.start, d.alpha, compl_mod.data(), compl_mod.size()))
+            return false;
+    }
+
+    const size_t limb_bytes = n * sizeof(uint64_t);
+    const size_t meta_words = FpgaManager::HKS_META_WORDS + 2 * sizeQlP * n;
+    const size_t acc_bytes  = 2 * sizeQlP * limb_bytes;
+    auto bo_in              = m_pool.Acquire(GROUP_IN1, KERNEL_LIMB_Q * limb_bytes);
+    auto bo_key             = m_pool.Acquire(GROUP_IN2, meta_words * sizeof(uint64_t));
+    auto bo_acc             = m_pool.Acquire(GROUP_OUT, acc_bytes);
+
+    for (size_t j = 0; j < digits.size(); ++j) {
+        const auto& d          = digits[j];
+        const size_t sizeCompl = sizeQlP - d.alpha;
+        uint64_t* meta         = bo_key->data();
+
+        std::fill(meta, meta + FpgaManager::HKS_META_WORDS, 0);
+        meta[FpgaManager::HKS_META_ALPHA] = d.alpha;
+        meta[FpgaManager::HKS_META_START] = d.start;
+        meta[FpgaManager::HKS_META_SIZE]  = sizeQlP;
+        meta[FpgaManager::HKS_META_ACC]   = (j > 0) ? 1 : 0;
+        for (size_t e = 0; e < sizeQlP; ++e)
+            meta[FpgaManager::HKS_META_DEVIDX + e] = (uint64_t)dev_idx[e];
+        for (size_t i = 0; i < d.alpha; ++i) {
+            meta[FpgaManager::HKS_META_QHATINV + i] = d.qhat_inv[i];
+            for (size_t c = 0; c < sizeCompl; ++c)
+                meta[FpgaManager::HKS_META_W + i * KERNEL_MAX_OUT_COLS + c] = d.qhat_mod[i * sizeCompl + c];
+        }
+
+        for (size_t i = 0; i < d.alpha; ++i)
+            WriteBuffer(*bo_in, d.towers[i], limb_bytes, i * limb_bytes);
+        const size_t key_base = FpgaManager::HKS_META_WORDS * sizeof(uint64_t);
+        for (size_t e = 0; e < sizeQlP; ++e) {
+            WriteBuffer(*bo_key, d.key_b[e], limb_bytes, key_base + e * limb_bytes);
+            WriteBuffer(*bo_key, d.key_a[e], limb_bytes, key_base + (sizeQlP + e) * limb_bytes);
+        }
+
+        Launch(bo_in->data(), bo_key->data(), bo_acc->data(), OP_HKS_DIGIT, (int)sizeQlP, dev_idx[d.start]);
+        CountTransfer(d.alpha * limb_bytes + meta_words * sizeof(uint64_t), 0);
+    }
+
+    // 只有最终的 (c0', c1') 回到主机
+    for (size_t e = 0; e < sizeQlP; ++e) {
+        ReadBuffer(*bo_acc, out0[e], limb_bytes, e * limb_bytes);
+        ReadBuffer(*bo_acc, out1[e], limb_bytes, (sizeQlP + e) * limb_bytes);
+    }
+    m_d2h_bytes += acc_bytes;
+    return true;
+}
+
+bool FpgaSimulator::HksRotateBatchOffload(const uint64_t* const* digits, size_t numDigits,
+                                          const uint64_t* const* first, const uint64_t* moduli, size_t sizeQlP,
+                                          const std::vector<HksRotation>& rotations, size_t n) {
+    if (n != FPGA_RING_DIM || numDigits == 0 || rotations.empty() || sizeQlP > (size_t)KERNEL_MAX_OUT_COLS)
+        return false;
+
+    std::vector<int> dev_idx = DeviceIndices(moduli, sizeQlP, true);
+    if (std::find(dev_idx.begin(), dev_idx.end(), -1) != dev_idx.end())
+        return false;
+
+    const size_t limb_bytes  = n * sizeof(uint64_t);
+    const size_t num_towers  = numDigits * sizeQlP;
+    const size_t key_bytes   = num_towers * limb_bytes;
+    const size_t in_bytes    = key_bytes + (first ? sizeQlP * limb_bytes : 0);
+    const size_t rot_words   = FpgaManager::ROT_META_WORDS + 2 * num_towers * n;
+    const size_t out_bytes   = 2 * sizeQlP * limb_bytes;
+    auto bo_digits           = m_pool.Acquire(GROUP_IN1, in_bytes);
+    auto bo_key              = m_pool.Acquire(GROUP_IN2, rotations.size() * rot_words * sizeof(uint64_t));
+    auto bo_out              = m_pool.Acquire(GROUP_OUT, rotations.size() * out_bytes);
+
+    // hoisted digits（和 first）只上传一次，所有旋转共用
+    for (size_t t = 0; t < num_towers; ++t)
+        WriteBuffer(*bo_digits, digits[t], limb_bytes, t * limb_bytes);
+    for (size_t e = 0; first && e < sizeQlP; ++e)
+        WriteBuffer(*bo_digits, first[e], limb_bytes, key_bytes + e * limb_bytes);
+
+    for (size_t r = 0; r < rotations.size(); ++r) {
+        const auto& rot = rotations[r];
+        uint64_t* meta  = bo_key->data() + r * rot_words;
+        std::fill(meta, meta + FpgaManager::ROT_META_WORDS, 0);
+        meta[FpgaManager::ROT_META_DIGITS] = numDigits;
+        meta[FpgaManager::ROT_META_SIZE]   = sizeQlP;
+        meta[FpgaManager::ROT_META_AUTO]   = rot.auto_index;
+        meta[FpgaManager::ROT_META_FIRST]  = first ? 1 : 0;
+        for (size_t e = 0; e < sizeQlP; ++e)
+            meta[FpgaManager::ROT_META_DEVIDX + e] = (uint64_t)dev_idx[e];
+
+        const size_t key_base = (r * rot_words + FpgaManager::ROT_META_WORDS) * sizeof(uint64_t);
+        for (size_t t = 0; t < num_towers; ++t) {
+            WriteBuffer(*bo_key, rot.key_b[t], limb_bytes, key_base + t * limb_bytes);
+            WriteBuffer(*bo_key, rot.key_a[t], limb_bytes, key_base + key_bytes + t * limb_bytes);
+        }
+    }
+
+    Launch(bo_digits->data(), bo_key->data(), bo_out->data(), OP_HKS_ROTATE, (int)rotations.size(), 0);
+    CountTransfer(in_bytes + rotations.size() * rot_words * sizeof(uint64_t), 0);
+
+    for (size_t r = 0; r < rotations.size(); ++r) {
+        for (size_t e = 0; e < sizeQlP; ++e) {
+            ReadBuffer(*bo_out, rotations[r].out0[e], limb_bytes, r * out_bytes + e * limb_bytes);
+            ReadBuffer(*bo_out, rotations[r].out1[e], limb_bytes, r * out_bytes + (sizeQlP + e) * limb_bytes);
+        }
+    }
+    m_d2h_bytes += rotations.size() * out_bytes;
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// 常驻 tower 组：输入输出都留在"设备"上，只有 Write/ReadResident 计入传输
+// ----------------------------------------------------------------------
+PolyAccelerator::ResidentId FpgaSimulator::AllocResident(const uint64_t* moduli, size_t numTowers, size_t n) {
+    if (n != FPGA_RING_DIM || numTowers == 0)
+        return 0;
+    if (FpgaManager::PlanLimbRuns(DeviceIndices(moduli, numTowers, true)).empty())
+        return 0;
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    const ResidentId id = m_next_resident++;
+    m_resident[id]      = Resident{std::vector<uint64_t>(moduli, moduli + numTowers), n, DeviceBuffer(numTowers * n)};
+    return id;
+}
+
+void FpgaSimulator::FreeResident(ResidentId id) {
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    m_resident.erase(id);
+}
+
+size_t FpgaSimulator::GetResidentCount() const {
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    return m_resident.size();
+}
+
+bool FpgaSimulator::WriteResident(ResidentId id, const uint64_t* const* towers) {
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    auto it = m_resident.find(id);
+    if (it == m_resident.end())
+        return false;
+    auto& r                 = it->second;
+    const size_t limb_bytes = r.n * sizeof(uint64_t);
+    for (size_t i = 0; i < r.moduli.size(); ++i)
+        WriteBuffer(r.data, towers[i], limb_bytes, i * limb_bytes);
+    CountTransfer(r.moduli.size() * limb_bytes, 0);
+    return true;
+}
+
+bool FpgaSimulator::ReadResident(ResidentId id, uint64_t* const* towers) {
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    auto it = m_resident.find(id);
+    if (it == m_resident.end())
+        return false;
+    const auto& r           = it->second;
+    const size_t limb_bytes = r.n * sizeof(uint64_t);
+    for (size_t i = 0; i < r.moduli.size(); ++i)
+        ReadBuffer(r.data, towers[i], limb_bytes, i * limb_bytes);
+    CountTransfer(0, r.moduli.size() * limb_bytes);
+    return true;
+}
+
+bool FpgaSimulator::ModOpResident(int opcode, ResidentId a, ResidentId b, ResidentId out) {
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    auto ia = m_resident.find(a), ib = m_resident.find(b), io = m_resident.find(out);
+    if (ia == m_resident.end() || ib == m_resident.end() || io == m_resident.end())
+        return false;
+    const auto& moduli = ia->second.moduli;
+    if (ib->second.moduli != moduli || io->second.moduli != moduli)
+        return false;
+    // InitModuli 之后模数可能已不在片上
+    auto runs = FpgaManager::PlanLimbRuns(DeviceIndices(moduli.data(), moduli.size(), true));
+    if (runs.empty())
+        return false;
+
+    // kernel 输出写到新 buffer 再换给 out（out 与 a / b 相同时不能原地写）
+    const size_t n = ia->second.n;
+    DeviceBuffer result(moduli.size() * n);
+    for (const auto& r : runs) {
+        const size_t offset = r.first * n;
+        Launch(ia->second.data.data() + offset, ib->second.data.data() + offset, result.data() + offset,
+               (uint8_t)opcode, (int)r.count, r.mod_idx);
+    }
+    io->second.data.swap(result);
+    return true;
+}
+
+bool FpgaSimulator::NttResident(bool forward, ResidentId id) {
+    std::lock_guard<std::mutex> lock(m_resident_mutex);
+    auto it = m_resident.find(id);
+    if (it == m_resident.end())
+        return false;
+    auto& res = it->second;
+    if (!SupportsRingDim(res.n))
+        return false;
+    // 与 NttBatchOffload 相同走 OP_NTT_STREAM，常驻数据随时可以按 CPU 顺序读回
+    auto runs = FpgaManager::PlanLimbRuns(DeviceIndices(res.moduli.data(), res.moduli.size(), false),
+                                          FpgaManager::StreamTileLimbs(res.n));
+    if (runs.empty())
+        return false;
+
+    const uint64_t* image = m_image.data() + m_stream_offset[forward ? 0 : 1];
+    DeviceBuffer result(res.data.size());
+    for (const auto& r : runs) {
+        const size_t offset = r.first * res.n;
+        Launch(res.data.data() + offset, image, result.data() + offset, OP_NTT_STREAM, (int)r.count, r.mod_idx);
+    }
+    res.data.swap(result);
+    return true;
+}
+
+// ----------------------------------------------------------------------
+// 异步接口：H2D / Run / D2H 三个阶段在 FpgaCommandQueue 的线程上执行
+// ----------------------------------------------------------------------
+std::future<void> FpgaSimulator::NttAsync(bool forward, const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                          size_t n) {
+    // 与同步接口相同走 OP_NTT_STREAM
+    const int mod_idx = SupportsRingDim(n) ? DeviceIndices(&modulus, 1, false)[0] : -1;
+    if (mod_idx < 0)
+        return Rejected("FpgaSimulator: modulus " + std::to_string(modulus) + " / ring dimension " +
+                        std::to_string(n) + " is not loaded on the device");
+
+    struct Job {
+        DeviceBufferPool<DeviceBuffer>::Handle in, out;
+    };
+    const size_t bytes = n * sizeof(uint64_t);
+    auto job           = std::make_shared<Job>();
+    auto h2d           = [this, job, in, bytes]() {
+        job->in = m_pool.Acquire(GROUP_IN1, bytes);
+        WriteBuffer(*job->in, in, bytes, 0);
+        CountTransfer(bytes, 0);
+    };
+    // InitModuli 先排空队列再换镜像，执行时镜像一定有效
+    auto run = [this, job, bytes, forward, mod_idx]() {
+        job->out = m_pool.Acquire(GROUP_OUT, bytes);
+        Launch(job->in->data(), m_image.data() + m_stream_offset[forward ? 0 : 1], job->out->data(), OP_NTT_STREAM, 1,
+               mod_idx);
+        // 输入 buffer 归还给 pool, 下一条命令的 H2D 可以立即复用
+        job->in.Release();
+    };
+    auto d2h = [this, job, out, bytes]() {
+        ReadBuffer(*job->out, out, bytes, 0);
+        job->out.Release();
+        m_d2h_bytes += bytes;
+    };
+    return m_queue.Submit(std::move(h2d), std::move(run), std::move(d2h));
+}
+
+std::future<void> FpgaSimulator::NttForwardOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                                        size_t n) {
+    return NttAsync(true, in, out, modulus, n);
+}
+
+std::future<void> FpgaSimulator::NttInverseOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                                        size_t n) {
+    return NttAsync(false, in, out, modulus, n);
+}
+
+void FpgaSimulator::Synchronize() {
+    m_queue.Drain();
+}
+
+// memcpy 进出池里的 buffer，加一次 0 limb 的 OP_ADD（只走启动和调度开销）
+LinkTiming FpgaSimulator::MeasureLink(size_t bytes) {
+    using clock = std::chrono::steady_clock;
+    auto seconds = [](clock::time_point start) {
+        return std::chrono::duration<double>(clock::now() - start).count();
+    };
+    std::vector<uint64_t> host((bytes + sizeof(uint64_t) - 1) / sizeof(uint64_t), 1);
+    auto bo = m_pool.Acquire(GROUP_IN1, bytes);
+
+    LinkTiming t;
+    auto start = clock::now();
+    WriteBuffer(*bo, host.data(), bytes, 0);
+    t.h2d_s = seconds(start);
+
+    start = clock::now();
+    {
+        std::lock_guard<std::mutex> lock(m_kernel_mutex);
+        Top(bo->data(), bo->data(), bo->data(), OP_ADD, 0, 0);
+    }
+    t.launch_s = seconds(start);
+
+    start = clock::now();
+    ReadBuffer(*bo, host.data(), bytes, 0);
+    t.d2h_s = seconds(start);
+    return t;
+}
+
+FpgaTransferStats FpgaSimulator::GetTransferStats() const {
+    FpgaTransferStats s;
+    s.h2d_bytes = m_h2d_bytes;
+    s.d2h_bytes = m_d2h_bytes;
+    s.launches  = m_launches;
+    return s;
+}
+
+void FpgaSimulator::ResetTransferStats() {
+    m_h2d_bytes = 0;
+    m_d2h_bytes = 0;
+    m_launches  = 0;
+}
+
+#endif  // OPENFHE_FPGA_SIM
@@ -0,0 +1,696 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+
+/*
+  Cost-model based CPU / accelerator dispatch for the PolyAccelerator hooks
+ */
+
+#include "OffloadDispatcher.h"
+#include "FpgaManager.h"
+
+#include "math/math-hal.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+thread_local bool tls_cpu_only = false;
+
+std::atomic<uint64_t> g_next_dispatcher_id{1};
+
+void AddSeconds(std::atomic<double>& sum, double s) {
+    double cur = sum.load(std::memory_order_relaxed);
+    while (!sum.compare_exchange_weak(cur, cur + s, std::memory_order_relaxed)) {
+    }
+}
+
+std::mutex& CpuTransformMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+OffloadDispatcher::CpuTransform& CpuTransformSlot() {
+    static OffloadDispatcher::CpuTransform transform;
+    return transform;
+}
+
+OffloadPolicy PolicyFromEnv() {
+    const char* env = std::getenv("OPENFHE_OFFLOAD");
+    if (env == nullptr)
+        return OffloadPolicy::AUTO;
+    const std::string name(env);
+    if (name == "always")
+        return OffloadPolicy::ALWAYS;
+    if (name == "never")
+        return OffloadPolicy::NEVER;
+    if (name != "auto")
+        std::cerr << "[Offload Warning] Unknown OPENFHE_OFFLOAD=" << name << ", using auto" << std::endl;
+    return OffloadPolicy::AUTO;
+}
+
+// 每个 limb 的工作量和传输字节
+struct OpWork {
+    double butterflies;
+    double elems;
+    double h2d_bytes;
+    double d2h_bytes;
+};
+
+OpWork WorkPerLimb(AccelOp op, size_t n) {
+    const double words = static_cast<double>(n) * sizeof(uint64_t);
+    switch (op) {
+        case AccelOp::NTT:
+            return {0.5 * n * std::log2(static_cast<double>(n)), 0, words, words};
+        case AccelOp::MODOP:
+            return {0, static_cast<double>(n), 2 * words, words};
+        case AccelOp::BCONV:
+            // 输入的 KERNEL_LIMB_Q 个 limb 由所有输出 limb 共用，见 DeviceSeconds
+            return {0, static_cast<double>(n) * PolyAccelerator::KERNEL_LIMB_Q, 0, words};
+        case AccelOp::AUTO:
+            return {0, static_cast<double>(n), words, words};
+        default:
+            return {0, 0, 0, 0};
+    }
+}
+
+// reps 次里最快的一次（秒）；f 返回 false 时返回 -1
+template <typename F>
+double BestSeconds(int reps, F&& f) {
+    double best = -1;
+    for (int r = 0; r < reps; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        if (!f())
+            return -1;
+        double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        best     = (best < 0) ? s : std::min(best, s);
+    }
+    return best;
+}
+
+// 扣掉启动和传输后的 kernel 计算时间，下限取实测的 5%（计时抖动时不至于为负）
+double KernelSeconds(double measured, double overhead) {
+    return std::max(measured - overhead, 0.05 * measured);
+}
+
+// 片上路径（n == FPGA_RING_DIM）一次最多 MAX_LIMBS 个 limb，流式 NTT 按 StreamTileLimbs 分块
+size_t Launches(AccelOp op, size_t n, size_t limbs) {
+    if (op == AccelOp::NTT && n != FPGA_RING_DIM)
+        return (limbs + FpgaManager::StreamTileLimbs(n) - 1) / FpgaManager::StreamTileLimbs(n);
+    if (op == AccelOp::NTT || op == AccelOp::MODOP)
+        return (limbs + MAX_LIMBS - 1) / MAX_LIMBS;
+    return 1;
+}
+
+// 调用者所在并行区的线程数（不在并行区时为 1）
+size_t ParallelPeers() {
+#ifdef PARALLEL
+    return omp_in_parallel() ? static_cast<size_t>(omp_get_num_threads()) : 1;
+#else
+    return 1;
+#endif
+}
+
+size_t BreakEven(const OffloadCostModel& model, AccelOp op, size_t n, size_t maxThreads) {
+    const size_t limit = 1024;
+    for (size_t limbs = 1; limbs <= limit; ++limbs) {
+        if (model.DeviceSeconds(op, n, limbs, Launches(op, n, limbs)) <
+            model.CpuSeconds(op, n, limbs, std::min(limbs, maxThreads)))
+            return limbs;
+    }
+    return 0;
+}
+
+}  // namespace
+
+const char* AccelOpName(AccelOp op) {
+    switch (op) {
+        case AccelOp::NTT:
+            return "NTT";
+        case AccelOp::MODOP:
+            return "MODOP";
+        case AccelOp::BCONV:
+            return "BCONV";
+        case AccelOp::AUTO:
+            return "AUTO";
+        default:
+            return "?";
+    }
+}
+
+// ----------------------------------------------------------------------
+// 代价模型
+// ----------------------------------------------------------------------
+double OffloadCostModel::DeviceSeconds(AccelOp op, size_t n, size_t limbs, size_t launches) const {
+    const OpWork w = WorkPerLimb(op, n);
+    double h2d     = w.h2d_bytes * limbs;
+    if (op == AccelOp::BCONV)
+        h2d += static_cast<double>(n) * sizeof(uint64_t) * PolyAccelerator::KERNEL_LIMB_Q;
+    return launches * launch_latency_s + h2d / h2d_bytes_per_s + w.d2h_bytes * limbs / d2h_bytes_per_s +
+           limbs * (w.butterflies / device_butterfly_per_s + w.elems / device_elem_per_s);
+}
+
+double OffloadCostModel::CpuSeconds(AccelOp op, size_t n, size_t limbs, size_t threads) const {
+    const OpWork w  = WorkPerLimb(op, n);
+    const double t  = static_cast<double>(std::max<size_t>(1, std::min(threads, limbs)));
+    return limbs * (w.butterflies / cpu_butterfly_per_s + w.elems / cpu_elem_per_s) / t;
+}
+
+std::ostream& operator<<(std::ostream& os, const OffloadStats& stats) {
+    os << std::left << std::setw(8) << "op" << std::right << std::setw(10) << "cpu" << std::setw(10) << "device"
+       << std::setw(10) << "declined" << std::setw(10) << "limbs" << std::setw(14) << "pred cpu ms" << std::setw(14)
+       << "pred dev ms" << std::setw(14) << "chosen ms" << "\n";
+    for (size_t i = 0; i < stats.ops.size(); ++i) {
+        const auto& s = stats.ops[i];
+        os << std::left << std::setw(8) << AccelOpName(static_cast<AccelOp>(i)) << std::right << std::setw(10)
+           << s.cpu_calls << std::setw(10) << s.device_calls << std::setw(10) << s.declined << std::setw(10) << s.limbs
+           << std::fixed << std::setprecision(3) << std::setw(14) << s.predicted_cpu_s * 1e3 << std::setw(14)
+           << s.predicted_device_s * 1e3 << std::setw(14) << s.predicted_chosen_s * 1e3 << "\n";
+    }
+    os << "async NTT batches: " << stats.batches << " (" << stats.batched_limbs << " limbs)\n";
+    return os;
+}
+
+// ----------------------------------------------------------------------
+// 全局：CPU 变换注册、本线程 CPU-only 标记
+// ----------------------------------------------------------------------
+void OffloadDispatcher::SetCpuTransform(CpuTransform transform) {
+    std::lock_guard<std::mutex> lock(CpuTransformMutex());
+    CpuTransformSlot() = std::move(transform);
+}
+
+OffloadDispatcher::CpuTransform OffloadDispatcher::GetCpuTransform() {
+    std::lock_guard<std::mutex> lock(CpuTransformMutex());
+    return CpuTransformSlot();
+}
+
+OffloadDispatcher::ScopedCpuOnly::ScopedCpuOnly() : m_prev(tls_cpu_only) {
+    tls_cpu_only = true;
+}
+
+OffloadDispatcher::ScopedCpuOnly::~ScopedCpuOnly() {
+    tls_cpu_only = m_prev;
+}
+
+bool OffloadDispatcher::ScopedCpuOnly::Active() {
+    return tls_cpu_only;
+}
+
+OffloadDispatcher* OffloadDispatcher::Active() {
+    return dynamic_cast<OffloadDispatcher*>(PolyAccelerator::Get());
+}
+
+// ----------------------------------------------------------------------
+// 调度器
+// ----------------------------------------------------------------------
+OffloadDispatcher::OffloadDispatcher(std::shared_ptr<PolyAccelerator> backend)
+    : m_backend(std::move(backend)), m_id(g_next_dispatcher_id++), m_policy(PolicyFromEnv()) {
+    if (!m_backend)
+        throw std::invalid_argument("OffloadDispatcher: null backend");
+}
+
+// 其它线程的攒批由它们的 future 持有，future 析构或 get() 时执行
+OffloadDispatcher::~OffloadDispatcher() {
+    try {
+        Flush();
+    }
+    catch (...) {
+    }
+    ThreadStates().erase(m_id);
+}
+
+OffloadDispatcher::Batch::~Batch() {
+    if (Claim())
+        owner->RunBatch(*this);
+}
+
+std::unordered_map<uint64_t, OffloadDispatcher::ThreadState>& OffloadDispatcher::ThreadStates() {
+    thread_local std::unordered_map<uint64_t, ThreadState> states;
+    return states;
+}
+
+OffloadDispatcher::ThreadState& OffloadDispatcher::LocalState() const {
+    return ThreadStates()[m_id];
+}
+
+const OffloadCostModel& OffloadDispatcher::LocalModel() const {
+    ThreadState& state = LocalState();
+    if (state.generation != m_generation.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_model_mutex);
+        state.model      = m_model;
+        state.generation = m_generation.load(std::memory_order_relaxed);
+    }
+    return state.model;
+}
+
+void OffloadDispatcher::SetPolicy(OffloadPolicy policy) {
+    m_policy.store(policy, std::memory_order_relaxed);
+}
+
+OffloadPolicy OffloadDispatcher::GetPolicy() const {
+    return m_policy.load(std::memory_order_relaxed);
+}
+
+void OffloadDispatcher::SetCostModel(const OffloadCostModel& model) {
+    std::lock_guard<std::mutex> lock(m_model_mutex);
+    m_model       = model;
+    m_fixed_model = true;
+    m_generation.fetch_add(1, std::memory_order_release);
+}
+
+OffloadCostModel OffloadDispatcher::GetCostModel() const {
+    std::lock_guard<std::mutex> lock(m_model_mutex);
+    return m_model;
+}
+
+OffloadStats OffloadDispatcher::GetStats() const {
+    OffloadStats stats;
+    for (size_t i = 0; i < m_ops.size(); ++i) {
+        const auto& from = m_ops[i];
+        auto& to              = stats.ops[i];
+        to.cpu_calls          = from.cpu_calls.load(std::memory_order_relaxed);
+        to.device_calls       = from.device_calls.load(std::memory_order_relaxed);
+        to.declined           = from.declined.load(std::memory_order_relaxed);
+        to.limbs              = from.limbs.load(std::memory_order_relaxed);
+        to.predicted_cpu_s    = from.predicted_cpu_s.load(std::memory_order_relaxed);
+        to.predicted_device_s = from.predicted_device_s.load(std::memory_order_relaxed);
+        to.predicted_chosen_s = from.predicted_chosen_s.load(std::memory_order_relaxed);
+    }
+    stats.batches       = m_batches.load(std::memory_order_relaxed);
+    stats.batched_limbs = m_batched_limbs.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void OffloadDispatcher::ResetStats() {
+    for (auto& s : m_ops) {
+        s.cpu_calls.store(0, std::memory_order_relaxed);
+        s.device_calls.store(0, std::memory_order_relaxed);
+        s.declined.store(0, std::memory_order_relaxed);
+        s.limbs.store(0, std::memory_order_relaxed);
+        s.predicted_cpu_s.store(0, std::memory_order_relaxed);
+        s.predicted_device_s.store(0, std::memory_order_relaxed);
+        s.predicted_chosen_s.store(0, std::memory_order_relaxed);
+    }
+    m_batches.store(0, std::memory_order_relaxed);
+    m_batched_limbs.store(0, std::memory_order_relaxed);
+}
+
+bool OffloadDispatcher::Choose(AccelOp op, size_t limbs, double cpu_s, double device_s) {
+    const OffloadPolicy policy = GetPolicy();
+    const bool device = (policy == OffloadPolicy::ALWAYS) || (policy == OffloadPolicy::AUTO && device_s < cpu_s);
+    auto& s           = m_ops[static_cast<size_t>(op)];
+    (device ? s.device_calls : s.cpu_calls).fetch_add(1, std::memory_order_relaxed);
+    s.limbs.fetch_add(limbs, std::memory_order_relaxed);
+    AddSeconds(s.predicted_cpu_s, cpu_s);
+    AddSeconds(s.predicted_device_s, device_s);
+    AddSeconds(s.predicted_chosen_s, device ? device_s : cpu_s);
+    return device;
+}
+
+void OffloadDispatcher::RecordDeclined(AccelOp op) {
+    m_ops[static_cast<size_t>(op)].declined.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool OffloadDispatcher::Decide(AccelOp op, size_t n, size_t limbs) {
+    if (ScopedCpuOnly::Active() || limbs == 0)
+        return false;
+    const size_t threads          = lbcrypto::OpenFHEParallelControls.GetThreadLimit(static_cast<int>(limbs));
+    const OffloadCostModel& model = LocalModel();
+    return Choose(op, limbs, model.CpuSeconds(op, n, limbs, threads),
+                  model.DeviceSeconds(op, n, limbs, Launches(op, n, limbs)));
+}
+
+// 单 limb 调用多半来自逐 tower 的并行循环：同一并行区的 peers 个线程各交一个 limb，
+// 设备要逐个启动，所以按 peers 个 limb、peers 次启动比较，记录本次的份额
+bool OffloadDispatcher::DecideSingle(AccelOp op, size_t n) {
+    const size_t peers = ParallelPeers();
+    if (peers <= 1)
+        return Decide(op, n, 1);
+    if (ScopedCpuOnly::Active())
+        return false;
+    const OffloadCostModel& model = LocalModel();
+    return Choose(op, 1, model.CpuSeconds(op, n, peers, peers) / peers,
+                  model.DeviceSeconds(op, n, peers, peers) / peers);
+}
+
+size_t OffloadDispatcher::BreakEvenLimbs(AccelOp op, size_t n) const {
+    const size_t threads = static_cast<size_t>(lbcrypto::OpenFHEParallelControls.GetThreadLimit(1 << 20));
+    return BreakEven(LocalModel(), op, n, threads);
+}
+
+OffloadCostModel OffloadDispatcher::Calibrate(uint64_t modulus, size_t n) {
+    OffloadCostModel model = GetCostModel();
+    const double bytes     = static_cast<double>(n) * sizeof(uint64_t);
+    const double butterflies = 0.5 * n * std::log2(static_cast<double>(n));
+
+    std::mt19937_64 rng(n);
+    std::vector<uint64_t> data(n), scratch(n);
+    for (auto& x : data)
+        x = rng() % modulus;
+
+    // CPU：OpenFHE 的 NTT 和 Barrett 模乘，单线程
+    if (auto cpu = GetCpuTransform()) {
+        ScopedCpuOnly cpuOnly;
+        scratch  = data;
+        double t = BestSeconds(3, [&] { return cpu(true, scratch.data(), modulus, n); });
+        if (t > 0)
+            model.cpu_butterfly_per_s = butterflies / t;
+    }
+    {
+        lbcrypto::NativeVector a(n, lbcrypto::NativeInteger(modulus)), b(n, lbcrypto::NativeInteger(modulus));
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = data[i];
+            b[i] = data[n - 1 - i];
+        }
+        double t = BestSeconds(3, [&] {
+            a.ModMulEq(b);
+            return true;
+        });
+        if (t > 0)
+            model.cpu_elem_per_s = n / t;
+    }
+
+    // 设备：空启动 + 单 limb 传输，再用单 limb NTT / modmul 推出 kernel 吞吐
+    if (m_backend->HasModulus(modulus) && m_backend->SupportsRingDim(n)) {
+        LinkTiming timing = m_backend->MeasureLink(static_cast<size_t>(bytes));
+        for (int r = 0; r < 2; ++r) {
+            LinkTiming again = m_backend->MeasureLink(static_cast<size_t>(bytes));
+            timing.h2d_s     = std::min(timing.h2d_s, again.h2d_s);
+            timing.d2h_s     = std::min(timing.d2h_s, again.d2h_s);
+            timing.launch_s  = std::min(timing.launch_s, again.launch_s);
+        }
+        if (timing.h2d_s > 0)
+            model.h2d_bytes_per_s = bytes / timing.h2d_s;
+        if (timing.d2h_s > 0)
+            model.d2h_bytes_per_s = bytes / timing.d2h_s;
+        if (timing.launch_s > 0)
+            model.launch_latency_s = timing.launch_s;
+
+        scratch           = data;
+        uint64_t* tower[] = {scratch.data()};
+        double t = BestSeconds(3, [&] { return m_backend->NttBatchOffload(true, tower, &modulus, 1, n); });
+        if (t > 0) {
+            double overhead = model.launch_latency_s + bytes / model.h2d_bytes_per_s + bytes / model.d2h_bytes_per_s;
+            model.device_butterfly_per_s = butterflies / KernelSeconds(t, overhead);
+        }
+
+        const uint64_t* in[] = {data.data()};
+        t = BestSeconds(3, [&] { return m_backend->ModOpOffload(OP_MULT, in, in, tower, &modulus, 1, n); });
+        if (t > 0) {
+            double overhead = model.launch_latency_s + 2 * bytes / model.h2d_bytes_per_s + bytes / model.d2h_bytes_per_s;
+            model.device_elem_per_s = n / KernelSeconds(t, overhead);
+        }
+    }
+
+    model.calibrated = true;
+    std::lock_guard<std::mutex> lock(m_model_mutex);
+    m_model = model;
+    m_generation.fetch_add(1, std::memory_order_release);
+    return model;
+}
+
+void OffloadDispatcher::InitModuli(const std::vector<uint64_t>& q_mods, const std::vector<uint64_t>& p_mods,
+                                   const std::vector<uint64_t>& q_roots, const std::vector<uint64_t>& p_roots,
+                                   size_t ringDim) {
+    Flush();
+    m_backend->InitModuli(q_mods, p_mods, q_roots, p_roots, ringDim);
+
+    // 链路和 kernel 吞吐与模数无关，只在第一次装载时标定
+    bool calibrate;
+    {
+        std::lock_guard<std::mutex> lock(m_model_mutex);
+        calibrate = !m_fixed_model && !m_model.calibrated && GetPolicy() == OffloadPolicy::AUTO;
+    }
+    if (calibrate && !q_mods.empty()) {
+        try {
+            Calibrate(q_mods[0], ringDim);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "[Offload Warning] Calibration failed: " << e.what() << std::endl;
+        }
+    }
+}
+
+// ----------------------------------------------------------------------
+// 同步算子：模型选 CPU 时返回 false，调用者走 CPU
+// ----------------------------------------------------------------------
+bool OffloadDispatcher::NttForwardOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) {
+    if (!DecideSingle(AccelOp::NTT, n))
+        return false;
+    if (m_backend->NttForwardOffload(in, out, modulus, n))
+        return true;
+    RecordDeclined(AccelOp::NTT);
+    return false;
+}
+
+bool OffloadDispatcher::NttInverseOffload(const uint64_t* in, uint64_t* out, uint64_t modulus, size_t n) {
+    if (!DecideSingle(AccelOp::NTT, n))
+        return false;
+    if (m_backend->NttInverseOffload(in, out, modulus, n))
+        return true;
+    RecordDeclined(AccelOp::NTT);
+    return false;
+}
+
+bool OffloadDispatcher::NttBatchOffload(bool forward, uint64_t* const* towers, const uint64_t* moduli,
+                                        size_t numTowers, size_t n) {
+    if (!Decide(AccelOp::NTT, n, numTowers))
+        return false;
+    if (m_backend->NttBatchOffload(forward, towers, moduli, numTowers, n))
+        return true;
+    RecordDeclined(AccelOp::NTT);
+    return false;
+}
+
+bool OffloadDispatcher::ModOpOffload(int opcode, const uint64_t* const* a, const uint64_t* const* b,
+                                     uint64_t* const* out, const uint64_t* moduli, size_t numTowers, size_t n) {
+    if (!Decide(AccelOp::MODOP, n, numTowers))
+        return false;
+    if (m_backend->ModOpOffload(opcode, a, b, out, moduli, numTowers, n))
+        return true;
+    RecordDeclined(AccelOp::MODOP);
+    return false;
+}
+
+bool OffloadDispatcher::BConvOffload(const uint64_t* x, const uint64_t* w, const uint64_t* out_mod, uint64_t* result,
+                                     size_t ringDim, int sizeP) {
+    if (sizeP <= 0 || !Decide(AccelOp::BCONV, ringDim, static_cast<size_t>(sizeP)))
+        return false;
+    if (m_backend->BConvOffload(x, w, out_mod, result, ringDim, sizeP))
+        return true;
+    RecordDeclined(AccelOp::BCONV);
+    return false;
+}
+
+bool OffloadDispatcher::BConvTowerOffload(const uint64_t* x, const uint64_t* w_col, uint64_t out_mod,
+                                          uint64_t* result, size_t ringDim) {
+    if (!DecideSingle(AccelOp::BCONV, ringDim))
+        return false;
+    if (m_backend->BConvTowerOffload(x, w_col, out_mod, result, ringDim))
+        return true;
+    RecordDeclined(AccelOp::BCONV);
+    return false;
+}
+
+bool OffloadDispatcher::AutoOffload(const uint64_t* in, uint64_t* out, uint32_t k, uint32_t kinv, uint64_t modulus,
+                                    size_t n) {
+    if (!DecideSingle(AccelOp::AUTO, n))
+        return false;
+    if (m_backend->AutoOffload(in, out, k, kinv, modulus, n))
+        return true;
+    RecordDeclined(AccelOp::AUTO);
+    return false;
+}
+
+// 融合 key-switch 是否上设备由 HKS 策略（autotuner 实测）决定，这里不再建模
+bool OffloadDispatcher::HksFusedOffload(const std::vector<HksDigit>& digits, const uint64_t* moduli, size_t sizeQlP,
+                                        uint64_t* const* out0, uint64_t* const* out1, size_t n) {
+    if (ScopedCpuOnly::Active() || GetPolicy() == OffloadPolicy::NEVER)
+        return false;
+    return m_backend->HksFusedOffload(digits, moduli, sizeQlP, out0, out1, n);
+}
+
+// 批量旋转由调用者（EvalFastRotationExtBatch）整体选择，同样不建模
+bool OffloadDispatcher::HksRotateBatchOffload(const uint64_t* const* digits, size_t numDigits,
+                                              const uint64_t* const* first, const uint64_t* moduli, size_t sizeQlP,
+                                              const std::vector<HksRotation>& rotations, size_t n) {
+    if (ScopedCpuOnly::Active() || GetPolicy() == OffloadPolicy::NEVER)
+        return false;
+    return m_backend->HksRotateBatchOffload(digits, numDigits, first, moduli, sizeQlP, rotations, n);
+}
+
+// 常驻数据：设备侧没有传输开销，CPU 侧反而要先读回，所以不走代价模型，只服从 NEVER / ScopedCpuOnly。
+// 被拒绝时 DeviceDCRTPoly 读回主机走 CPU。
+PolyAccelerator::ResidentId OffloadDispatcher::AllocResident(const uint64_t* moduli, size_t numTowers, size_t n) {
+    if (ScopedCpuOnly::Active() || GetPolicy() == OffloadPolicy::NEVER)
+        return 0;
+    return m_backend->AllocResident(moduli, numTowers, n);
+}
+
+bool OffloadDispatcher::ModOpResident(int opcode, ResidentId a, ResidentId b, ResidentId out) {
+    if (ScopedCpuOnly::Active() || GetPolicy() == OffloadPolicy::NEVER)
+        return false;
+    return m_backend->ModOpResident(opcode, a, b, out);
+}
+
+bool OffloadDispatcher::NttResident(bool forward, ResidentId id) {
+    if (ScopedCpuOnly::Active() || GetPolicy() == OffloadPolicy::NEVER)
+        return false;
+    return m_backend->NttResident(forward, id);
+}
+
+// ----------------------------------------------------------------------
+// 异步 NTT：攒批
+// ----------------------------------------------------------------------
+std::future<void> OffloadDispatcher::NttForwardOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                                            size_t n) {
+    return SubmitNtt(true, in, out, modulus, n);
+}
+
+std::future<void> OffloadDispatcher::NttInverseOffloadAsync(const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                                            size_t n) {
+    return SubmitNtt(false, in, out, modulus, n);
+}
+
+std::future<void> OffloadDispatcher::SubmitNtt(bool forward, const uint64_t* in, uint64_t* out, uint64_t modulus,
+                                               size_t n) {
+    // ALWAYS：不攒批，直接进后端的 H2D / Run / D2H 流水线
+    if (GetPolicy() == OffloadPolicy::ALWAYS && !ScopedCpuOnly::Active()) {
+        Decide(AccelOp::NTT, n, 1);
+        return forward ? m_backend->NttForwardOffloadAsync(in, out, modulus, n) :
+                         m_backend->NttInverseOffloadAsync(in, out, modulus, n);
+    }
+
+    if (in != out)
+        std::copy(in, in + n, out);
+
+    const size_t breakEven = BreakEvenLimbs(AccelOp::NTT, n);
+    auto& pending          = LocalState().pending;
+    std::shared_ptr<Batch> batch;
+    size_t limbs = 0;
+    // future 全被丢弃（析构时已执行）或已开始执行的批从队列里清掉
+    for (auto it = pending.begin(); it != pending.end();) {
+        batch = it->lock();
+        if (batch && (batch->forward != forward || batch->n != n)) {
+            ++it;
+            continue;
+        }
+        if (batch && (limbs = batch->Append(out, modulus)) != 0)
+            break;
+        it = pending.erase(it);
+    }
+    if (limbs == 0) {
+        batch          = std::make_shared<Batch>();
+        batch->owner   = this;
+        batch->forward = forward;
+        batch->n       = n;
+        batch->ready   = batch->done.get_future().share();
+        limbs          = batch->Append(out, modulus);
+        pending.push_back(batch);
+    }
+    // 攒够了：本线程立即提交（队列里的弱引用下次遍历时清掉）
+    if (GetPolicy() == OffloadPolicy::AUTO && breakEven != 0 && limbs >= breakEven && batch->Claim())
+        RunBatch(*batch);
+
+    return std::async(std::launch::deferred, [this, batch] { FlushBatch(batch); });
+}
+
+void OffloadDispatcher::FlushBatch(const std::shared_ptr<Batch>& batch) {
+    if (batch->Claim())
+        RunBatch(*batch);
+    batch->ready.get();
+}
+
+void OffloadDispatcher::Flush() {
+    std::vector<std::weak_ptr<Batch>> pending;
+    pending.swap(LocalState().pending);
+    for (auto& weak : pending) {
+        auto batch = weak.lock();
+        if (batch && batch->Claim())
+            RunBatch(*batch);
+    }
+}
+
+void OffloadDispatcher::Synchronize() {
+    Flush();
+    m_backend->Synchronize();
+}
+
+void OffloadDispatcher::RunBatch(Batch& batch) {
+    const size_t limbs = batch.towers.size();
+    try {
+        bool done = Decide(AccelOp::NTT, batch.n, limbs) &&
+                    m_backend->NttBatchOffload(batch.forward, batch.towers.data(), batch.moduli.data(), limbs, batch.n);
+        if (!done && !RunOnCpu(batch.forward, batch.towers.data(), batch.moduli.data(), limbs, batch.n)) {
+            // 没有 CPU 表：只能交给设备
+            done = m_backend->NttBatchOffload(batch.forward, batch.towers.data(), batch.moduli.data(), limbs, batch.n);
+            if (!done)
+                throw std::runtime_error("OffloadDispatcher: no CPU NTT tables and the device rejected the batch");
+        }
+        m_batches.fetch_add(1, std::memory_order_relaxed);
+        m_batched_limbs.fetch_add(limbs, std::memory_order_relaxed);
+        batch.done.set_value();
+    }
+    catch (...) {
+        batch.done.set_exception(std::current_exception());
+    }
+}
+
+bool OffloadDispatcher::RunOnCpu(bool forward, uint64_t* const* towers, const uint64_t* moduli, size_t numTowers,
+                                 size_t n) {
+    auto cpu = GetCpuTransform();
+    if (!cpu)
+        return false;
+    {
+        ScopedCpuOnly cpuOnly;
+        if (!cpu(forward, towers[0], moduli[0], n))
+            return false;
+    }
+    // 第一个 tower 已经变换，后面的失败只能报错
+    bool ok = true;
+#pragma omp parallel for reduction(&& : ok) num_threads(lbcrypto::OpenFHEParallelControls.GetThreadLimit(numTowers - 1))
+    for (size_t i = 1; i < numTowers; ++i) {
+        ScopedCpuOnly cpuOnly;
+        ok = cpu(forward, towers[i], moduli[i], n) && ok;
+    }
+    if (!ok)
+        throw std::runtime_error("OffloadDispatcher: missing CPU NTT tables for part of a batch");
+    return true;
+}
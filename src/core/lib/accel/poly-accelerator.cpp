@@ -0,0 +1,152 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  Runtime registry of PolyAccelerator backends (fpga / sim / cpu)
+ */
+
+#include "PolyAccelerator.h"
+#include "FpgaManager.h"
+#include "OffloadDispatcher.h"
+#ifdef OPENFHE_FPGA_SIM
+    #include "FpgaSimulator.h"
+#endif
+
+#include "utils/exception.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <utility>
+
+namespace {
+
+struct AcceleratorRegistry {
+    std::once_flag init;
+    std::atomic<PolyAccelerator*> active{nullptr};
+    std::mutex mutex;
+    // active 的所有者；Set() 换掉后旧后端随最后一个 GetShared() 持有者释放
+    std::shared_ptr<PolyAccelerator> current;
+    PolyAccelerator::TwiddleTableLookup lookup;
+};
+
+AcceleratorRegistry& Registry() {
+    static AcceleratorRegistry registry;
+    return registry;
+}
+
+// 单例后端不归注册表所有
+template <typename T>
+std::shared_ptr<PolyAccelerator> Unowned(T& backend) {
+    return std::shared_ptr<PolyAccelerator>(&backend, [](PolyAccelerator*) {});
+}
+
+// 具体后端外面套一层 OffloadDispatcher，由代价模型逐个算子选择 CPU / 设备
+void Install(AcceleratorRegistry& r, std::shared_ptr<PolyAccelerator> backend) {
+    if (backend && !std::dynamic_pointer_cast<OffloadDispatcher>(backend))
+        backend = std::make_shared<OffloadDispatcher>(std::move(backend));
+    std::shared_ptr<PolyAccelerator> previous;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.active = backend.get();
+        previous = std::exchange(r.current, std::move(backend));
+    }
+    // 旧调度器在锁外析构（会把攒着的异步 NTT 执行完）
+}
+
+// OPENFHE_ACCEL 未设置时：有 XRT 且板卡就绪用 fpga，否则 cpu
+void InstallDefault(AcceleratorRegistry& r) {
+    const char* env = std::getenv("OPENFHE_ACCEL");
+#ifdef OPENFHE_FPGA_ENABLE
+    const std::string name = env ? env : "fpga";
+#else
+    const std::string name = env ? env : "cpu";
+#endif
+    try {
+        Install(r, PolyAccelerator::Create(name));
+    }
+    catch (const std::exception& e) {
+        std::cerr << "[Accel Warning] " << e.what() << "; using cpu" << std::endl;
+    }
+}
+
+}  // namespace
+
+PolyAccelerator* PolyAccelerator::Get() {
+    auto& r = Registry();
+    std::call_once(r.init, InstallDefault, std::ref(r));
+    return r.active.load(std::memory_order_acquire);
+}
+
+std::shared_ptr<PolyAccelerator> PolyAccelerator::GetShared() {
+    auto& r = Registry();
+    std::call_once(r.init, InstallDefault, std::ref(r));
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.current;
+}
+
+void PolyAccelerator::Set(std::shared_ptr<PolyAccelerator> backend) {
+    auto& r = Registry();
+    // 显式设置优先于环境变量，之后的 Get() 不再读 OPENFHE_ACCEL
+    std::call_once(r.init, [] {});
+    Install(r, std::move(backend));
+}
+
+std::shared_ptr<PolyAccelerator> PolyAccelerator::Create(const std::string& name) {
+    if (name == "cpu")
+        return nullptr;
+    if (name == "fpga") {
+        auto& fpga = FpgaManager::GetInstance();
+        return fpga.IsReady() ? Unowned(fpga) : nullptr;
+    }
+    if (name == "sim") {
+#ifdef OPENFHE_FPGA_SIM
+        return Unowned(FpgaSimulator::GetInstance());
+#else
+        OPENFHE_THROW("Accelerator backend 'sim' is not built (configure with OPENFHE_FPGA_SIM=ON)");
+#endif
+    }
+    OPENFHE_THROW("Unknown accelerator backend '" + name + "' (expected fpga, sim or cpu)");
+}
+
+void PolyAccelerator::SetTwiddleTableLookup(TwiddleTableLookup lookup) {
+    auto& r = Registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.lookup = std::move(lookup);
+}
+
+PolyAccelerator::TwiddleTableLookup PolyAccelerator::GetTwiddleTableLookup() {
+    auto& r = Registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    return r.lookup;
+}
@@ -0,0 +1,935 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Runtime-dispatched SIMD kernels for the native negacyclic NTT
+ */
+
+#include "math/hal/intnat/ntt-simd.h"
+#include "utils/parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    #define NTT_SIMD_X86 1
+    #include <immintrin.h>
+#endif
+
+namespace intnat {
+
+namespace {
+
+// 正 / 逆变换的向量路径要求 4q < 2^63（AVX2 只有有符号 64 位比较）
+constexpr uint64_t kMaxModulus = uint64_t(1) << 61;
+// IFMA 的输入、Shoup 商都必须在 52 位内：4q < 2^52
+constexpr uint64_t kMaxModulusIfma = uint64_t(1) << 50;
+
+// 默认块大小：数据 32KB，加上块内各级的 twiddle 和 Shoup 常数共 64KB，留在 L2
+constexpr size_t kDefaultBlock = 4096;
+constexpr size_t kMinBlock     = 16;
+// 列分块时每行至少连续取一条 cache line 以上
+constexpr size_t kMinColumns = 16;
+
+inline uint64_t MulHi(uint64_t a, uint64_t b) {
+    return static_cast<uint64_t>((static_cast<unsigned __int128>(a) * b) >> 64);
+}
+
+// y·w mod q，结果在 [0, 2q)；wp = floor(w·2^64/q)，y 可以是任意 64 位值
+inline uint64_t MulShoupLazy(uint64_t y, uint64_t w, uint64_t wp, uint64_t q) {
+    return y * w - MulHi(y, wp) * q;
+}
+
+// ------------------------------------------------------------
+// 内核形状
+// ------------------------------------------------------------
+// 一级（或一级的一部分）：groups 个蝶形组，第 g 组的上半从 a + 2·g·t 开始、下半距离 t，
+// 每组做前 len 个蝶形（len <= t），twiddle 为 w[g]。
+// 整级：len = t；列分块：len 为列宽，a 指向该列块在本行的起点。
+using StageFn = void (*)(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q, const uint64_t* w,
+                         const uint64_t* wp);
+// x[i] = x[i]·c mod q，输入 < 4q，输出在 [0, q)
+using ScaleFn = void (*)(uint64_t* x, size_t len, uint64_t q, uint64_t c, uint64_t cp);
+// [0, 4q) -> [0, q)
+using ReduceFn = void (*)(uint64_t* x, size_t len, uint64_t q);
+
+// ------------------------------------------------------------
+// 标量
+// ------------------------------------------------------------
+// 正变换（CT）：输入输出都在 [0, 4q)
+void ForwardStageScalar(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q, const uint64_t* w,
+                        const uint64_t* wp) {
+    const uint64_t q2 = q << 1;
+    for (size_t g = 0; g < groups; ++g) {
+        const uint64_t omega = w[g], precon = wp[g];
+        uint64_t* x = a + 2 * g * t;
+        uint64_t* y = x + t;
+        for (size_t j = 0; j < len; ++j) {
+            uint64_t lo = x[j];
+            if (lo >= q2)
+                lo -= q2;
+            const uint64_t hi = MulShoupLazy(y[j], omega, precon, q);
+            x[j]              = lo + hi;
+            y[j]              = lo - hi + q2;
+        }
+    }
+}
+
+// 逆变换（GS）：输入输出都在 [0, 2q)
+void InverseStageScalar(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q, const uint64_t* w,
+                        const uint64_t* wp) {
+    const uint64_t q2 = q << 1;
+    for (size_t g = 0; g < groups; ++g) {
+        const uint64_t omega = w[g], precon = wp[g];
+        uint64_t* x = a + 2 * g * t;
+        uint64_t* y = x + t;
+        for (size_t j = 0; j < len; ++j) {
+            const uint64_t lo = x[j], hi = y[j];
+            uint64_t sum      = lo + hi;
+            if (sum >= q2)
+                sum -= q2;
+            x[j] = sum;
+            y[j] = MulShoupLazy(lo - hi + q2, omega, precon, q);
+        }
+    }
+}
+
+void ScaleScalar(uint64_t* x, size_t len, uint64_t q, uint64_t c, uint64_t cp) {
+    for (size_t i = 0; i < len; ++i) {
+        const uint64_t v = MulShoupLazy(x[i], c, cp, q);
+        x[i]             = v - ((v >= q) ? q : 0);
+    }
+}
+
+void ReduceScalar(uint64_t* x, size_t len, uint64_t q) {
+    const uint64_t q2 = q << 1;
+    for (size_t i = 0; i < len; ++i) {
+        uint64_t v = x[i];
+        v -= (v >= q2) ? q2 : 0;
+        v -= (v >= q) ? q : 0;
+        x[i] = v;
+    }
+}
+
+#ifdef NTT_SIMD_X86
+
+// ------------------------------------------------------------
+// AVX2：4 × 64 位，乘法由 vpmuludq（32×32->64）拼出
+// ------------------------------------------------------------
+struct Avx2Const {
+    __m256i lo;  // 常数的低 32 位（vpmuludq 只读每个 lane 的低 32 位，直接用常数本身）
+    __m256i hi;  // 常数的高 32 位
+};
+
+__attribute__((target("avx2"))) inline Avx2Const Avx2Split(uint64_t c) {
+    return {_mm256_set1_epi64x(static_cast<int64_t>(c)), _mm256_set1_epi64x(static_cast<int64_t>(c >> 32))};
+}
+
+// a·c 的低 64 位
+__attribute__((target("avx2"))) inline __m256i Avx2MulLo(__m256i a, const Avx2Const& c) {
+    const __m256i ll  = _mm256_mul_epu32(a, c.lo);
+    const __m256i lh  = _mm256_mul_epu32(a, c.hi);
+    const __m256i hl  = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), c.lo);
+    const __m256i mid = _mm256_add_epi64(lh, hl);
+    return _mm256_add_epi64(ll, _mm256_slli_epi64(mid, 32));
+}
+
+// a·c 的高 64 位
+__attribute__((target("avx2"))) inline __m256i Avx2MulHi(__m256i a, const Avx2Const& c) {
+    const __m256i mask32 = _mm256_set1_epi64x(0xFFFFFFFF);
+    const __m256i ahi    = _mm256_srli_epi64(a, 32);
+    const __m256i ll     = _mm256_mul_epu32(a, c.lo);
+    const __m256i lh     = _mm256_mul_epu32(a, c.hi);
+    const __m256i hl     = _mm256_mul_epu32(ahi, c.lo);
+    const __m256i hh     = _mm256_mul_epu32(ahi, c.hi);
+    // 中间列：ll 的高半 + lh、hl 的低半，< 3·2^32，不会溢出
+    __m256i mid = _mm256_add_epi64(_mm256_srli_epi64(ll, 32), _mm256_and_si256(lh, mask32));
+    mid         = _mm256_add_epi64(mid, _mm256_and_si256(hl, mask32));
+    __m256i hi  = _mm256_add_epi64(hh, _mm256_srli_epi64(lh, 32));
+    hi          = _mm256_add_epi64(hi, _mm256_srli_epi64(hl, 32));
+    return _mm256_add_epi64(hi, _mm256_srli_epi64(mid, 32));
+}
+
+// y·omega mod q，结果在 [0, 2q)
+__attribute__((target("avx2"))) inline __m256i Avx2MulShoupLazy(__m256i y, const Avx2Const& omega,
+                                                                  const Avx2Const& precon, const Avx2Const& q) {
+    const __m256i quot = Avx2MulHi(y, precon);
+    return _mm256_sub_epi64(Avx2MulLo(y, omega), Avx2MulLo(quot, q));
+}
+
+// x >= bound ? x - bound : x（x < 2^63）
+__attribute__((target("avx2"))) inline __m256i Avx2CondSub(__m256i x, __m256i bound, __m256i boundMinus1) {
+    return _mm256_sub_epi64(x, _mm256_and_si256(_mm256_cmpgt_epi64(x, boundMinus1), bound));
+}
+
+__attribute__((target("avx2"))) void ForwardStageAvx2(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q,
+                                                      const uint64_t* w, const uint64_t* wp) {
+    const Avx2Const vq = Avx2Split(q);
+    const __m256i q2   = _mm256_set1_epi64x(static_cast<int64_t>(q << 1));
+    const __m256i q2m1 = _mm256_set1_epi64x(static_cast<int64_t>((q << 1) - 1));
+    for (size_t g = 0; g < groups; ++g) {
+        const Avx2Const omega  = Avx2Split(w[g]);
+        const Avx2Const precon = Avx2Split(wp[g]);
+        uint64_t* x = a + 2 * g * t;
+        uint64_t* y = x + t;
+        for (size_t j = 0; j < len; j += 4) {
+            __m256i lo       = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j));
+            const __m256i hi = Avx2MulShoupLazy(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + j)), omega,
+                                                precon, vq);
+            lo               = Avx2CondSub(lo, q2, q2m1);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + j), _mm256_add_epi64(lo, hi));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j), _mm256_sub_epi64(_mm256_add_epi64(lo, q2), hi));
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void InverseStageAvx2(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q,
+                                                      const uint64_t* w, const uint64_t* wp) {
+    const Avx2Const vq = Avx2Split(q);
+    const __m256i q2   = _mm256_set1_epi64x(static_cast<int64_t>(q << 1));
+    const __m256i q2m1 = _mm256_set1_epi64x(static_cast<int64_t>((q << 1) - 1));
+    for (size_t g = 0; g < groups; ++g) {
+        const Avx2Const omega  = Avx2Split(w[g]);
+        const Avx2Const precon = Avx2Split(wp[g]);
+        uint64_t* x = a + 2 * g * t;
+        uint64_t* y = x + t;
+        for (size_t j = 0; j < len; j += 4) {
+            const __m256i lo   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + j));
+            const __m256i hi   = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + j));
+            const __m256i sum  = Avx2CondSub(_mm256_add_epi64(lo, hi), q2, q2m1);
+            const __m256i diff = _mm256_sub_epi64(_mm256_add_epi64(lo, q2), hi);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + j), sum);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j), Avx2MulShoupLazy(diff, omega, precon, vq));
+        }
+    }
+}
+
+__attribute__((target("avx2"))) void ScaleAvx2(uint64_t* x, size_t len, uint64_t q, uint64_t c, uint64_t cp) {
+    const Avx2Const vq = Avx2Split(q), vc = Avx2Split(c), vcp = Avx2Split(cp);
+    const __m256i q1   = _mm256_set1_epi64x(static_cast<int64_t>(q));
+    const __m256i qm1  = _mm256_set1_epi64x(static_cast<int64_t>(q - 1));
+    for (size_t i = 0; i < len; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + i), Avx2CondSub(Avx2MulShoupLazy(v, vc, vcp, vq), q1, qm1));
+    }
+}
+
+__attribute__((target("avx2"))) void ReduceAvx2(uint64_t* x, size_t len, uint64_t q) {
+    const __m256i q1   = _mm256_set1_epi64x(static_cast<int64_t>(q));
+    const __m256i qm1  = _mm256_set1_epi64x(static_cast<int64_t>(q - 1));
+    const __m256i q2   = _mm256_set1_epi64x(static_cast<int64_t>(q << 1));
+    const __m256i q2m1 = _mm256_set1_epi64x(static_cast<int64_t>((q << 1) - 1));
+    for (size_t i = 0; i < len; i += 4) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(x + i), Avx2CondSub(Avx2CondSub(v, q2, q2m1), q1, qm1));
+    }
+}
+
+// ------------------------------------------------------------
+// AVX-512 IFMA：8 × 52 位，Shoup 常数取 floor(w·2^52/q) = wp >> 12
+// ------------------------------------------------------------
+// y·omega mod q，结果在 [0, 2q)；y < 2^52
+__attribute__((target("avx512f,avx512ifma"))) inline __m512i IfmaMulShoupLazy(__m512i y, __m512i omega,
+                                                                              __m512i precon52, __m512i q) {
+    const __m512i zero   = _mm512_setzero_si512();
+    const __m512i mask52 = _mm512_set1_epi64((int64_t(1) << 52) - 1);
+    const __m512i quot   = _mm512_madd52hi_epu64(zero, y, precon52);
+    const __m512i prod   = _mm512_madd52lo_epu64(zero, y, omega);
+    // 真值 < 2q < 2^52，在 2^52 下相减即可
+    return _mm512_and_si512(_mm512_sub_epi64(prod, _mm512_madd52lo_epu64(zero, quot, q)), mask52);
+}
+
+__attribute__((target("avx512f,avx512ifma"))) inline __m512i IfmaCondSub(__m512i x, __m512i bound) {
+    return _mm512_mask_sub_epi64(x, _mm512_cmpge_epu64_mask(x, bound), x, bound);
+}
+
+__attribute__((target("avx512f,avx512ifma"))) void ForwardStageIfma(uint64_t* a, size_t groups, size_t t, size_t len,
+                                                                    uint64_t q, const uint64_t* w,
+                                                                    const uint64_t* wp) {
+    const __m512i vq = _mm512_set1_epi64(static_cast<int64_t>(q));
+    const __m512i q2 = _mm512_set1_epi64(static_cast<int64_t>(q << 1));
+    for (size_t g = 0; g < groups; ++g) {
+        const __m512i omega  = _mm512_set1_epi64(static_cast<int64_t>(w[g]));
+        const __m512i precon = _mm512_set1_epi64(static_cast<int64_t>(wp[g] >> 12));
+        uint64_t* x = a + 2 * g * t;
+        uint64_t* y = x + t;
+        for (size_t j = 0; j < len; j += 8) {
+            const __m512i lo = IfmaCondSub(_mm512_loadu_si512(x + j), q2);
+            const __m512i hi = IfmaMulShoupLazy(_mm512_loadu_si512(y + j), omega, precon, vq);
+            _mm512_storeu_si512(x + j, _mm512_add_epi64(lo, hi));
+            _mm512_storeu_si512(y + j, _mm512_sub_epi64(_mm512_add_epi64(lo, q2), hi));
+        }
+    }
+}
+
+__attribute__((target("avx512f,avx512ifma"))) void InverseStageIfma(uint64_t* a, size_t groups, size_t t, size_t len,
+                                                                    uint64_t q, const uint64_t* w,
+                                                                    const uint64_t* wp) {
+    const __m512i vq = _mm512_set1_epi64(static_cast<int64_t>(q));
+    const __m512i q2 = _mm512_set1_epi64(static_cast<int64_t>(q << 1));
+    for (size_t g = 0; g < groups; ++g) {
+        const __m512i omega  = _mm512_set1_epi64(static_cast<int64_t>(w[g]));
+        const __m512i precon = _mm512_set1_epi64(static_cast<int64_t>(wp[g] >> 12));
+        uint64_t* x = a + 2 * g * t;
+        uint64_t* y = x + t;
+        for (size_t j = 0; j < len; j += 8) {
+            const __m512i lo  = _mm512_loadu_si512(x + j);
+            const __m512i hi  = _mm512_loadu_si512(y + j);
+            const __m512i dif = _mm512_sub_epi64(_mm512_add_epi64(lo, q2), hi);
+            _mm512_storeu_si512(x + j, IfmaCondSub(_mm512_add_epi64(lo, hi), q2));
+            _mm512_storeu_si512(y + j, IfmaMulShoupLazy(dif, omega, precon, vq));
+        }
+    }
+}
+
+__attribute__((target("avx512f,avx512ifma"))) void ScaleIfma(uint64_t* x, size_t len, uint64_t q, uint64_t c,
+                                                             uint64_t cp) {
+    const __m512i vq  = _mm512_set1_epi64(static_cast<int64_t>(q));
+    const __m512i vc  = _mm512_set1_epi64(static_cast<int64_t>(c));
+    const __m512i vcp = _mm512_set1_epi64(static_cast<int64_t>(cp >> 12));
+    for (size_t i = 0; i < len; i += 8)
+        _mm512_storeu_si512(x + i, IfmaCondSub(IfmaMulShoupLazy(_mm512_loadu_si512(x + i), vc, vcp, vq), vq));
+}
+
+__attribute__((target("avx512f,avx512ifma"))) void ReduceIfma(uint64_t* x, size_t len, uint64_t q) {
+    const __m512i vq = _mm512_set1_epi64(static_cast<int64_t>(q));
+    const __m512i q2 = _mm512_set1_epi64(static_cast<int64_t>(q << 1));
+    for (size_t i = 0; i < len; i += 8)
+        _mm512_storeu_si512(x + i, IfmaCondSub(IfmaCondSub(_mm512_loadu_si512(x + i), q2), vq));
+}
+
+#endif  // NTT_SIMD_X86
+
+// 一个模数用到的内核；len < lanes 的调用落到标量
+struct Kernels {
+    StageFn forward;
+    StageFn inverse;
+    ScaleFn scale;
+    ReduceFn reduce;
+    size_t lanes;
+
+    void Forward(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q, const uint64_t* w,
+                 const uint64_t* wp) const {
+        (len >= lanes ? forward : ForwardStageScalar)(a, groups, t, len, q, w, wp);
+    }
+    void Inverse(uint64_t* a, size_t groups, size_t t, size_t len, uint64_t q, const uint64_t* w,
+                 const uint64_t* wp) const {
+        (len >= lanes ? inverse : InverseStageScalar)(a, groups, t, len, q, w, wp);
+    }
+    void Scale(uint64_t* x, size_t len, uint64_t q, uint64_t c, uint64_t cp) const {
+        (len >= lanes ? scale : ScaleScalar)(x, len, q, c, cp);
+    }
+    void Reduce(uint64_t* x, size_t len, uint64_t q) const {
+        (len >= lanes ? reduce : ReduceScalar)(x, len, q);
+    }
+};
+
+Kernels SelectKernels(uint64_t q) {
+#ifdef NTT_SIMD_X86
+    const NttIsa isa = GetNttIsa();
+    if (isa == NttIsa::AVX512IFMA && q < kMaxModulusIfma)
+        return {ForwardStageIfma, InverseStageIfma, ScaleIfma, ReduceIfma, 8};
+    if (isa != NttIsa::SCALAR)
+        return {ForwardStageAvx2, InverseStageAvx2, ScaleAvx2, ReduceAvx2, 4};
+#endif
+    return {ForwardStageScalar, InverseStageScalar, ScaleScalar, ReduceScalar, 1};
+}
+
+bool Detect(NttIsa isa) {
+    switch (isa) {
+        case NttIsa::SCALAR:
+            return true;
+#ifdef NTT_SIMD_X86
+        case NttIsa::AVX2:
+            return __builtin_cpu_supports("avx2");
+        case NttIsa::AVX512IFMA:
+            return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512ifma");
+#endif
+        default:
+            return false;
+    }
+}
+
+// 不超过 isa 的、CPU 支持的最高一级
+NttIsa Clamp(NttIsa isa) {
+    for (int i = static_cast<int>(isa); i > 0; --i) {
+        if (Detect(static_cast<NttIsa>(i)))
+            return static_cast<NttIsa>(i);
+    }
+    return NttIsa::SCALAR;
+}
+
+NttIsa InitialIsa() {
+    NttIsa isa      = NttIsa::AVX512IFMA;
+    const char* env = std::getenv("OPENFHE_NTT_ISA");
+    if (env) {
+        const std::string name = env;
+        if (name == "scalar")
+            isa = NttIsa::SCALAR;
+        else if (name == "avx2")
+            isa = NttIsa::AVX2;
+        else if (name != "avx512ifma")
+            std::cerr << "[NTT Warning] unknown OPENFHE_NTT_ISA '" << name << "'; using the best supported"
+                      << std::endl;
+    }
+    return Clamp(isa);
+}
+
+std::atomic<int>& ActiveIsa() {
+    static std::atomic<int> isa{static_cast<int>(InitialIsa())};
+    return isa;
+}
+
+// 2 的幂，不小于 kMinBlock
+size_t RoundBlock(size_t block) {
+    size_t b = kMinBlock;
+    while ((b << 1) <= block)
+        b <<= 1;
+    return b;
+}
+
+std::atomic<size_t>& ActiveBlock() {
+    static std::atomic<size_t> block{[] {
+        const char* env = std::getenv("OPENFHE_NTT_BLOCK");
+        return RoundBlock(env ? std::strtoull(env, nullptr, 10) : kDefaultBlock);
+    }()};
+    return block;
+}
+
+// ------------------------------------------------------------
+// 分块调度
+// ------------------------------------------------------------
+// 长度 n 的变换按块大小 B（<= n）拆成两段：
+//   列段：蝶形距离 t >= B 的 log2(n/B) 级只在下标低 log2(B) 位相同的元素之间运算，
+//         按列切成宽 cols 的列块，每个列块（rows 行 × cols 列）独立做完这几级；
+//   块段：之后 t < B 的各级只在连续的 B 个元素内运算，每块独立做完，只用到表里对应的一段 twiddle。
+// 正变换先列段后块段，逆变换相反；(tower, 列块)、(tower, 块) 为线程间的调度单位。
+struct Plan {
+    size_t n;
+    size_t block;  // B
+    size_t rows;   // n / B
+    size_t cols;   // 列块宽度
+    size_t tiles;  // 每个 tower 的列块数 = B / cols
+
+    Plan(size_t n_, size_t blockSize) : n(n_) {
+        block = std::min(n, blockSize);
+        rows  = n / block;
+        cols  = std::min(block, std::max(kMinColumns, block / rows));
+        tiles = block / cols;
+    }
+};
+
+void ForwardColumns(const Plan& p, const NttTower& tw, const Kernels& k, size_t tile) {
+    uint64_t* a = tw.data + tile * p.cols;
+    for (size_t m = 1, t = p.n >> 1; t >= p.block; m <<= 1, t >>= 1) {
+        for (size_t r = 0; r < t; r += p.block)
+            k.Forward(a + r, m, t, p.cols, tw.q, tw.w + m, tw.wPrecon + m);
+    }
+}
+
+void ForwardBlock(const Plan& p, const NttTower& tw, const Kernels& k, size_t b) {
+    uint64_t* a = tw.data + b * p.block;
+    for (size_t m = p.rows, t = p.block >> 1; t >= 1; m <<= 1, t >>= 1) {
+        const size_t groups = p.block / (2 * t);
+        const size_t g0     = b * groups;
+        k.Forward(a, groups, t, t, tw.q, tw.w + m + g0, tw.wPrecon + m + g0);
+    }
+    k.Reduce(a, p.block, tw.q);
+}
+
+// 最后一级（m = 1）：lo 侧乘 n^-1，hi 侧乘 omega[1]·n^-1，两侧都归约到 [0, q)
+void InverseLast(const NttTower& tw, const Kernels& k, uint64_t* x, size_t half, size_t len, uint64_t omega1,
+                 uint64_t omega1Precon) {
+    k.Inverse(x, 1, half, len, tw.q, &omega1, &omega1Precon);
+    k.Scale(x, len, tw.q, tw.nInv, tw.nInvPrecon);
+    k.Reduce(x + half, len, tw.q);
+}
+
+void InverseBlock(const Plan& p, const NttTower& tw, const Kernels& k, size_t b, uint64_t omega1,
+                  uint64_t omega1Precon) {
+    uint64_t* a = tw.data + b * p.block;
+    for (size_t m = p.n >> 1, t = 1; t < p.block && m > 1; m >>= 1, t <<= 1) {
+        const size_t groups = p.block / (2 * t);
+        const size_t g0     = b * groups;
+        k.Inverse(a, groups, t, t, tw.q, tw.w + m + g0, tw.wPrecon + m + g0);
+    }
+    if (p.rows == 1)
+        InverseLast(tw, k, a, p.n >> 1, p.n >> 1, omega1, omega1Precon);
+}
+
+void InverseColumns(const Plan& p, const NttTower& tw, const Kernels& k, size_t tile, uint64_t omega1,
+                    uint64_t omega1Precon) {
+    uint64_t* a = tw.data + tile * p.cols;
+    for (size_t m = p.rows >> 1, t = p.block; m > 1; m >>= 1, t <<= 1) {
+        for (size_t r = 0; r < t; r += p.block)
+            k.Inverse(a + r, m, t, p.cols, tw.q, tw.w + m, tw.wPrecon + m);
+    }
+    const size_t half = p.n >> 1;
+    for (size_t r = 0; r < half; r += p.block)
+        InverseLast(tw, k, a + r, half, p.cols, omega1, omega1Precon);
+}
+
+bool Transform(bool forward, const NttTower* towers, size_t numTowers, size_t n, bool parallel) {
+    if (n < 2 || numTowers == 0)
+        return false;
+    for (size_t i = 0; i < numTowers; ++i) {
+        if (towers[i].q >= kMaxModulus)
+            return false;
+    }
+
+    const Plan plan(n, GetNttBlockSize());
+    std::vector<Kernels> kernels(numTowers);
+    std::vector<uint64_t> omega1(numTowers), omega1Precon(numTowers);
+    for (size_t i = 0; i < numTowers; ++i) {
+        const NttTower& tw = towers[i];
+        kernels[i]         = SelectKernels(tw.q);
+        if (!forward) {
+            omega1[i] = static_cast<uint64_t>(static_cast<unsigned __int128>(tw.w[1]) * tw.nInv % tw.q);
+            omega1Precon[i] = static_cast<uint64_t>((static_cast<unsigned __int128>(omega1[i]) << 64) / tw.q);
+        }
+    }
+
+    const size_t columnItems = plan.rows > 1 ? numTowers * plan.tiles : 0;
+    const size_t blockItems  = numTowers * plan.rows;
+    auto columns = [&]() {
+#pragma omp parallel for num_threads(lbcrypto::OpenFHEParallelControls.GetThreadLimit(static_cast<int>(columnItems))) if (parallel)
+        for (size_t item = 0; item < columnItems; ++item) {
+            const size_t i = item / plan.tiles, tile = item % plan.tiles;
+            if (forward)
+                ForwardColumns(plan, towers[i], kernels[i], tile);
+            else
+                InverseColumns(plan, towers[i], kernels[i], tile, omega1[i], omega1Precon[i]);
+        }
+    };
+    auto blocks = [&]() {
+#pragma omp parallel for num_threads(lbcrypto::OpenFHEParallelControls.GetThreadLimit(static_cast<int>(blockItems))) if (parallel)
+        for (size_t item = 0; item < blockItems; ++item) {
+            const size_t i = item / plan.rows, b = item % plan.rows;
+            if (forward)
+                ForwardBlock(plan, towers[i], kernels[i], b);
+            else
+                InverseBlock(plan, towers[i], kernels[i], b, omega1[i], omega1Precon[i]);
+        }
+    };
+
+    if (forward) {
+        columns();
+        blocks();
+    }
+    else {
+        blocks();
+        columns();
+    }
+    return true;
+}
+
+// ------------------------------------------------------------
+// 惰性约减乘累加（KeyMacLazy）
+// ------------------------------------------------------------
+// 从 [0, start) 的余数开始，每项乘积 < maxX·maxW 时 128 位累加器不溢出的最多项数
+inline size_t WideTerms(uint64_t maxX, uint64_t maxW, uint64_t start) {
+    using u128       = unsigned __int128;
+    const u128 terms = (~u128(0) - start) / (u128(maxX - 1) * (maxW - 1));
+    return terms > SIZE_MAX ? SIZE_MAX : static_cast<size_t>(terms);
+}
+
+// 一个模数的约减常数
+struct MacConst {
+    uint64_t q;
+    uint64_t r64, r64Precon;    // 2^64 mod q 及其 Shoup 常数
+    uint64_t mu;                // floor(2^64/q)：乘 1 的 Shoup 常数，即 64 位 Barrett
+    uint64_t r52, r52Precon;    // IFMA：2^52 mod q 及其 52 位 Shoup 常数
+    uint64_t r104, r104Precon;  // IFMA：2^104 mod q
+    uint64_t mu52;              // IFMA：floor(2^52/q)
+    size_t chunk;               // 从 [0, q) 的余数开始，128 位累加器不溢出的最多项数
+
+    explicit MacConst(uint64_t q_) : q(q_) {
+        using u128 = unsigned __int128;
+        r64        = static_cast<uint64_t>((u128(1) << 64) % q);
+        r64Precon  = static_cast<uint64_t>((u128(r64) << 64) / q);
+        mu         = static_cast<uint64_t>((u128(1) << 64) / q);
+        r52        = static_cast<uint64_t>((u128(1) << 52) % q);
+        r52Precon  = static_cast<uint64_t>((u128(r52) << 52) / q);
+        r104       = static_cast<uint64_t>(u128(r52) * r52 % q);
+        r104Precon = static_cast<uint64_t>((u128(r104) << 52) / q);
+        mu52       = static_cast<uint64_t>((u128(1) << 52) / q);
+        chunk      = WideTerms(q, q, q);
+    }
+};
+
+// IFMA 的低位列每项加 < 2^52，从 < 2^50 的余数开始累加 2047 项仍 < 2^63
+constexpr size_t kMacChunkIfma = 2047;
+
+// 系数 [begin, end) 的 out0 / out1 = Σ terms；accumulate 时从 out 里已有的余数开始
+using MacFn = void (*)(const MacTerm* terms, size_t numTerms, size_t begin, size_t end, const MacConst& k,
+                       uint64_t* out0, uint64_t* out1, bool accumulate);
+
+// hi·2^64 + lo mod q
+inline uint64_t ReduceWide(uint64_t hi, uint64_t lo, const MacConst& k) {
+    const uint64_t q2 = k.q << 1;
+    uint64_t s        = MulShoupLazy(hi, k.r64, k.r64Precon, k.q) + (lo - MulHi(lo, k.mu) * k.q);
+    s -= (s >= q2) ? q2 : 0;
+    s -= (s >= k.q) ? k.q : 0;
+    return s;
+}
+
+void MacScalar(const MacTerm* terms, size_t numTerms, size_t begin, size_t end, const MacConst& k, uint64_t* out0,
+               uint64_t* out1, bool accumulate) {
+    for (size_t i = begin; i < end; ++i) {
+        unsigned __int128 s0 = accumulate ? out0[i] : 0;
+        unsigned __int128 s1 = accumulate ? out1[i] : 0;
+        for (size_t j = 0; j < numTerms; ++j) {
+            const unsigned __int128 c = terms[j].c[i];
+            s0 += c * terms[j].b[i];
+            s1 += c * terms[j].a[i];
+        }
+        out0[i] = ReduceWide(static_cast<uint64_t>(s0 >> 64), static_cast<uint64_t>(s0), k);
+        out1[i] = ReduceWide(static_cast<uint64_t>(s1 >> 64), static_cast<uint64_t>(s1), k);
+    }
+}
+
+#ifdef NTT_SIMD_X86
+
+struct IfmaMacConst {
+    __m512i q, q2, q4, one, mask52;
+    __m512i r52, r52Precon, r104, r104Precon, mu52;
+};
+
+__attribute__((target("avx512f,avx512ifma"))) inline IfmaMacConst IfmaConsts(const MacConst& k) {
+    return {_mm512_set1_epi64(static_cast<int64_t>(k.q)),
+            _mm512_set1_epi64(static_cast<int64_t>(k.q << 1)),
+            _mm512_set1_epi64(static_cast<int64_t>(k.q << 2)),
+            _mm512_set1_epi64(1),
+            _mm512_set1_epi64((int64_t(1) << 52) - 1),
+            _mm512_set1_epi64(static_cast<int64_t>(k.r52)),
+            _mm512_set1_epi64(static_cast<int64_t>(k.r52Precon)),
+            _mm512_set1_epi64(static_cast<int64_t>(k.r104)),
+            _mm512_set1_epi64(static_cast<int64_t>(k.r104Precon)),
+            _mm512_set1_epi64(static_cast<int64_t>(k.mu52))};
+}
+
+// x >> 52（maskz 形式：GCC 12 对 _mm512_srli_epi64 内部的 undefined 源会误报 maybe-uninitialized）
+__attribute__((target("avx512f,avx512ifma"))) inline __m512i IfmaShr52(__m512i x) {
+    return _mm512_maskz_srli_epi64(0xFF, x, 52);
+}
+
+// 累加值 H·2^52 + L（H < 2^60，L < 2^63）mod q：
+// L 的第 52 位以上并进 H，H 再拆成 H1·2^52 + H0，三段各乘 2^104 / 2^52 / 1 的 Shoup 约减后相加
+__attribute__((target("avx512f,avx512ifma"))) inline __m512i IfmaReduceWide(__m512i H, __m512i L,
+                                                                            const IfmaMacConst& k) {
+    H                = _mm512_add_epi64(H, IfmaShr52(L));
+    const __m512i L0 = _mm512_and_si512(L, k.mask52);
+    const __m512i H1 = IfmaShr52(H);
+    const __m512i H0 = _mm512_and_si512(H, k.mask52);
+    __m512i s        = IfmaMulShoupLazy(H1, k.r104, k.r104Precon, k.q);
+    s                = _mm512_add_epi64(s, IfmaMulShoupLazy(H0, k.r52, k.r52Precon, k.q));
+    s                = _mm512_add_epi64(s, IfmaMulShoupLazy(L0, k.one, k.mu52, k.q));
+    // s < 6q
+    return IfmaCondSub(IfmaCondSub(IfmaCondSub(s, k.q4), k.q2), k.q);
+}
+
+__attribute__((target("avx512f,avx512ifma"))) void MacIfma(const MacTerm* terms, size_t numTerms, size_t begin,
+                                                           size_t end, const MacConst& k, uint64_t* out0,
+                                                           uint64_t* out1, bool accumulate) {
+    const IfmaMacConst vk = IfmaConsts(k);
+    const __m512i zero    = _mm512_setzero_si512();
+    for (size_t i = begin; i < end; i += 8) {
+        // L：乘积低 52 位之和；H：乘积高 52 位之和
+        __m512i L0 = accumulate ? _mm512_loadu_si512(out0 + i) : zero;
+        __m512i L1 = accumulate ? _mm512_loadu_si512(out1 + i) : zero;
+        __m512i H0 = zero, H1 = zero;
+        for (size_t j = 0; j < numTerms; ++j) {
+            const __m512i c = _mm512_loadu_si512(terms[j].c + i);
+            const __m512i b = _mm512_loadu_si512(terms[j].b + i);
+            const __m512i a = _mm512_loadu_si512(terms[j].a + i);
+            L0              = _mm512_madd52lo_epu64(L0, c, b);
+            H0              = _mm512_madd52hi_epu64(H0, c, b);
+            L1              = _mm512_madd52lo_epu64(L1, c, a);
+            H1              = _mm512_madd52hi_epu64(H1, c, a);
+        }
+        _mm512_storeu_si512(out0 + i, IfmaReduceWide(H0, L0, vk));
+        _mm512_storeu_si512(out1 + i, IfmaReduceWide(H1, L1, vk));
+    }
+}
+
+#endif  // NTT_SIMD_X86
+
+struct MacKernel {
+    MacFn fn;
+    size_t lanes;
+    size_t chunk;
+};
+
+// AVX2 没有 64 位乘法，用 vpmuludq 拼 128 位乘积比标量 mul 还慢，所以 AVX2 下也走标量
+MacKernel SelectMac(const MacConst& k) {
+#ifdef NTT_SIMD_X86
+    if (GetNttIsa() == NttIsa::AVX512IFMA && k.q < kMaxModulusIfma)
+        return {MacIfma, 8, kMacChunkIfma};
+#endif
+    return {MacScalar, 1, k.chunk};
+}
+
+// ------------------------------------------------------------
+// 基转换（BConvLazy）
+// ------------------------------------------------------------
+// 列块宽度：sizeQ = 60 时块内的 x·qHatInv 缓冲为 120KB，留在 L2
+constexpr size_t kBConvBlock = 256;
+
+// J 个输出列：y[jj][offset + c] = Σ_i xs[i·stride + c]·w[i·wStride + jj] mod p_jj，c < len。
+// 累加器留在寄存器里，每个 x 载入一次给 J 列共用
+template <size_t J>
+void BConvColumnsScalar(const uint64_t* xs, size_t stride, size_t sizeQ, const uint64_t* w, size_t wStride,
+                        size_t len, const MacConst* pk, uint64_t* const* y, size_t offset) {
+    for (size_t c = 0; c < len; ++c) {
+        unsigned __int128 acc[J] = {};
+        for (size_t i = 0; i < sizeQ; ++i) {
+            const uint64_t x   = xs[i * stride + c];
+            const uint64_t* wi = w + i * wStride;
+            for (size_t jj = 0; jj < J; ++jj)
+                acc[jj] += static_cast<unsigned __int128>(x) * wi[jj];
+        }
+        for (size_t jj = 0; jj < J; ++jj)
+            y[jj][offset + c] =
+                ReduceWide(static_cast<uint64_t>(acc[jj] >> 64), static_cast<uint64_t>(acc[jj]), pk[jj]);
+    }
+}
+
+void BConvScalar(const uint64_t* xs, size_t stride, size_t sizeQ, const uint64_t* w, size_t sizeP, size_t len,
+                 const MacConst* pk, uint64_t* const* y, size_t offset) {
+    size_t j = 0;
+    for (; j + 4 <= sizeP; j += 4)
+        BConvColumnsScalar<4>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+    switch (sizeP - j) {
+        case 3:
+            BConvColumnsScalar<3>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+            break;
+        case 2:
+            BConvColumnsScalar<2>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+            break;
+        case 1:
+            BConvColumnsScalar<1>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+            break;
+        default:
+            break;
+    }
+}
+
+#ifdef NTT_SIMD_X86
+
+// J 个输出列一起算，x 的每次载入给 J 列共用；len 为 8 的倍数
+template <size_t J>
+__attribute__((target("avx512f,avx512ifma"))) void BConvColumnsIfma(const uint64_t* xs, size_t stride, size_t sizeQ,
+                                                                    const uint64_t* w, size_t wStride, size_t len,
+                                                                    const MacConst* pk, uint64_t* const* y,
+                                                                    size_t offset) {
+    IfmaMacConst vk[J];
+    for (size_t jj = 0; jj < J; ++jj)
+        vk[jj] = IfmaConsts(pk[jj]);
+    for (size_t c = 0; c < len; c += 8) {
+        __m512i L[J], H[J];
+        for (size_t jj = 0; jj < J; ++jj) {
+            L[jj] = _mm512_setzero_si512();
+            H[jj] = _mm512_setzero_si512();
+        }
+        for (size_t i = 0; i < sizeQ; ++i) {
+            const __m512i x    = _mm512_loadu_si512(xs + i * stride + c);
+            const uint64_t* wi = w + i * wStride;
+            for (size_t jj = 0; jj < J; ++jj) {
+                const __m512i wv = _mm512_set1_epi64(static_cast<int64_t>(wi[jj]));
+                L[jj]            = _mm512_madd52lo_epu64(L[jj], x, wv);
+                H[jj]            = _mm512_madd52hi_epu64(H[jj], x, wv);
+            }
+        }
+        for (size_t jj = 0; jj < J; ++jj)
+            _mm512_storeu_si512(y[jj] + offset + c, IfmaReduceWide(H[jj], L[jj], vk[jj]));
+    }
+}
+
+__attribute__((target("avx512f,avx512ifma"))) void BConvIfma(const uint64_t* xs, size_t stride, size_t sizeQ,
+                                                             const uint64_t* w, size_t sizeP, size_t len,
+                                                             const MacConst* pk, uint64_t* const* y, size_t offset) {
+    size_t j = 0;
+    for (; j + 4 <= sizeP; j += 4)
+        BConvColumnsIfma<4>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+    switch (sizeP - j) {
+        case 3:
+            BConvColumnsIfma<3>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+            break;
+        case 2:
+            BConvColumnsIfma<2>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+            break;
+        case 1:
+            BConvColumnsIfma<1>(xs, stride, sizeQ, w + j, sizeP, len, pk + j, y + j, offset);
+            break;
+        default:
+            break;
+    }
+}
+
+#endif  // NTT_SIMD_X86
+
+}  // namespace
+
+const char* NttIsaName(NttIsa isa) {
+    switch (isa) {
+        case NttIsa::AVX2:
+            return "avx2";
+        case NttIsa::AVX512IFMA:
+            return "avx512ifma";
+        default:
+            return "scalar";
+    }
+}
+
+bool NttIsaSupported(NttIsa isa) {
+    return Detect(isa);
+}
+
+NttIsa GetNttIsa() {
+    return static_cast<NttIsa>(ActiveIsa().load(std::memory_order_relaxed));
+}
+
+NttIsa SetNttIsa(NttIsa isa) {
+    const NttIsa active = Clamp(isa);
+    ActiveIsa().store(static_cast<int>(active), std::memory_order_relaxed);
+    return active;
+}
+
+size_t GetNttBlockSize() {
+    return ActiveBlock().load(std::memory_order_relaxed);
+}
+
+size_t SetNttBlockSize(size_t block) {
+    const size_t active = RoundBlock(block);
+    ActiveBlock().store(active, std::memory_order_relaxed);
+    return active;
+}
+
+bool NttForwardSimd(uint64_t* a, size_t n, uint64_t q, const uint64_t* w, const uint64_t* wPrecon) {
+    const NttTower tower{a, q, w, wPrecon, 0, 0};
+    return Transform(true, &tower, 1, n, false);
+}
+
+bool NttInverseSimd(uint64_t* a, size_t n, uint64_t q, const uint64_t* wInv, const uint64_t* wInvPrecon,
+                    uint64_t nInv, uint64_t nInvPrecon) {
+    const NttTower tower{a, q, wInv, wInvPrecon, nInv, nInvPrecon};
+    return Transform(false, &tower, 1, n, false);
+}
+
+bool NttBatchForward(const std::vector<NttTower>& towers, size_t n) {
+    return Transform(true, towers.data(), towers.size(), n, true);
+}
+
+bool NttBatchInverse(const std::vector<NttTower>& towers, size_t n) {
+    return Transform(false, towers.data(), towers.size(), n, true);
+}
+
+bool KeyMacLazy(const std::vector<MacTerm>& terms, size_t n, uint64_t q, uint64_t* out0, uint64_t* out1) {
+    if (q < 2 || q >= kMaxModulus)
+        return false;
+    if (terms.empty()) {
+        std::fill(out0, out0 + n, 0);
+        std::fill(out1, out1 + n, 0);
+        return true;
+    }
+
+    const MacConst k(q);
+    const MacKernel kernel = SelectMac(k);
+    const size_t vecEnd    = n / kernel.lanes * kernel.lanes;
+    for (size_t j0 = 0; j0 < terms.size(); j0 += kernel.chunk) {
+        const size_t count    = std::min(kernel.chunk, terms.size() - j0);
+        const bool accumulate = j0 > 0;
+        kernel.fn(terms.data() + j0, count, 0, vecEnd, k, out0, out1, accumulate);
+        MacScalar(terms.data() + j0, count, vecEnd, n, k, out0, out1, accumulate);
+    }
+    return true;
+}
+
+bool BConvLazy(const BConvParams& params, const uint64_t* const* x, uint64_t* const* y, size_t n) {
+    const size_t sizeQ = params.q.size();
+    const size_t sizeP = params.p.size();
+    if (n == 0 || sizeQ == 0 || sizeP == 0 || params.qHatModp.size() != sizeQ * sizeP)
+        return false;
+
+    uint64_t maxQ = 0, maxP = 0;
+    std::vector<Kernels> qk(sizeQ);
+    for (size_t i = 0; i < sizeQ; ++i) {
+        if (params.q[i] < 2 || params.q[i] >= kMaxModulus)
+            return false;
+        maxQ  = std::max(maxQ, params.q[i]);
+        qk[i] = SelectKernels(params.q[i]);
+    }
+    std::vector<MacConst> pk;
+    pk.reserve(sizeP);
+    for (uint64_t p : params.p) {
+        if (p < 2 || p >= kMaxModulus || WideTerms(maxQ, p, 0) < sizeQ)
+            return false;
+        maxP = std::max(maxP, p);
+        pk.emplace_back(p);
+    }
+#ifdef NTT_SIMD_X86
+    const bool ifma = GetNttIsa() == NttIsa::AVX512IFMA && maxQ < kMaxModulusIfma && maxP < kMaxModulusIfma &&
+                      sizeQ <= kMacChunkIfma;
+#endif
+
+    const size_t block  = std::min(n, kBConvBlock);
+    const size_t blocks = (n + block - 1) / block;
+#pragma omp parallel num_threads(lbcrypto::OpenFHEParallelControls.GetThreadLimit(static_cast<int>(blocks)))
+    {
+        std::vector<uint64_t> xs(sizeQ * block);
+#pragma omp for
+        for (size_t b = 0; b < blocks; ++b) {
+            const size_t k0  = b * block;
+            const size_t len = std::min(block, n - k0);
+            for (size_t i = 0; i < sizeQ; ++i) {
+                uint64_t* row = xs.data() + i * block;
+                std::copy(x[i] + k0, x[i] + k0 + len, row);
+                qk[i].Scale(row, len, params.q[i], params.qHatInv[i], params.qHatInvPrecon[i]);
+            }
+            size_t vecLen = 0;
+#ifdef NTT_SIMD_X86
+            if (ifma) {
+                vecLen = len / 8 * 8;
+                BConvIfma(xs.data(), block, sizeQ, params.qHatModp.data(), sizeP, vecLen, pk.data(), y, k0);
+            }
+#endif
+            if (vecLen < len)
+                BConvScalar(xs.data() + vecLen, block, sizeQ, params.qHatModp.data(), sizeP, len - vecLen, pk.data(), y,
+                            k0 + vecLen);
+        }
+    }
+    return true;
+}
+
+}  // namespace intnat
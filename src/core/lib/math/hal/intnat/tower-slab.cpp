@@ -0,0 +1,379 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  Contiguous 64-byte aligned storage for the towers of a DCRTPoly, and the
+  per-thread arena that recycles tower storage during key switching
+ */
+
+#include "math/hal/intnat/tower-slab.h"
+#include "utils/exception.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace intnat {
+
+namespace {
+
+std::atomic<TowerStorage>& ActiveStorage() {
+    static std::atomic<TowerStorage> storage{[] {
+        const char* env = std::getenv("OPENFHE_DCRT_STORAGE");
+        if (!env)
+            return TowerStorage::PER_TOWER;
+        const std::string name = env;
+        if (name == "contiguous")
+            return TowerStorage::CONTIGUOUS;
+        if (name != "per-tower")
+            std::cerr << "[DCRT Warning] unknown OPENFHE_DCRT_STORAGE '" << name << "'; using per-tower"
+                      << std::endl;
+        return TowerStorage::PER_TOWER;
+    }()};
+    return storage;
+}
+
+// ------------------------------------------------------------
+// TowerArena
+// ------------------------------------------------------------
+constexpr size_t kDefaultArenaBytes = size_t(64) << 20;
+
+std::atomic<bool>& ArenaEnabled() {
+    static std::atomic<bool> enabled{[] {
+        const char* env = std::getenv("OPENFHE_TOWER_ARENA");
+        return !(env && (std::string(env) == "off" || std::string(env) == "0"));
+    }()};
+    return enabled;
+}
+
+std::atomic<size_t>& ArenaCapacity() {
+    static std::atomic<size_t> capacity{[] {
+        const char* env = std::getenv("OPENFHE_TOWER_ARENA_MB");
+        return env ? size_t(std::strtoull(env, nullptr, 10)) << 20 : kDefaultArenaBytes;
+    }()};
+    return capacity;
+}
+
+// 本线程上存活的 Scope 层数
+thread_local int t_scope_depth = 0;
+
+// 各线程的计数只由本线程写，读改写用 relaxed 的 load + store，不需要锁前缀；
+// 其他线程只在 GetStats 时读
+struct ArenaCounters {
+    std::atomic<uint64_t> heap_allocs{0};
+    std::atomic<uint64_t> arena_allocs{0};
+    std::atomic<uint64_t> heap_frees{0};
+    std::atomic<uint64_t> arena_frees{0};
+};
+
+void Bump(std::atomic<uint64_t>& counter) {
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void AddTo(TowerArenaStats& sum, const ArenaCounters& c) {
+    sum.heap_allocs += c.heap_allocs.load(std::memory_order_relaxed);
+    sum.arena_allocs += c.arena_allocs.load(std::memory_order_relaxed);
+    sum.heap_frees += c.heap_frees.load(std::memory_order_relaxed);
+    sum.arena_frees += c.arena_frees.load(std::memory_order_relaxed);
+}
+
+// 所有线程的计数；退出的线程并入 retired。ResetStats 只记下当时的总数作为基线，
+// 不去改别的线程的计数
+struct CounterRegistry {
+    std::mutex mutex;
+    std::vector<const ArenaCounters*> threads;
+    TowerArenaStats retired;
+    TowerArenaStats baseline;
+};
+
+CounterRegistry& Counters() {
+    // 不析构：进程退出时仍可能有线程在注销
+    static auto* registry = new CounterRegistry;
+    return *registry;
+}
+
+TowerArenaStats SumCounters(CounterRegistry& r) {
+    TowerArenaStats sum = r.retired;
+    for (const auto* c : r.threads)
+        AddTo(sum, *c);
+    return sum;
+}
+
+// Meter 的进程级计数
+std::atomic<int> g_meters{0};
+std::atomic<int64_t> g_meter_live{0};
+std::atomic<int64_t> g_meter_peak{0};
+
+void Account(int64_t bytes) {
+    if (g_meters.load(std::memory_order_relaxed) == 0)
+        return;
+    const int64_t live = g_meter_live.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    int64_t peak       = g_meter_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_meter_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+// 本线程的空闲表：字节数 -> 空闲块；普通块和对齐块分开（释放方式不同）
+struct ThreadArena {
+    std::unordered_map<size_t, std::vector<void*>> plain;
+    std::unordered_map<size_t, std::vector<void*>> aligned;
+    size_t bytes = 0;
+    ArenaCounters counters;
+
+    ThreadArena() {
+        auto& r = Counters();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.threads.push_back(&counters);
+    }
+
+    void Clear() {
+        for (auto& kv : plain) {
+            for (void* p : kv.second)
+                ::operator delete(p);
+        }
+        for (auto& kv : aligned) {
+            for (void* p : kv.second)
+                ::operator delete(p, std::align_val_t{TowerSlab::ALIGNMENT});
+        }
+        plain.clear();
+        aligned.clear();
+        bytes = 0;
+    }
+    ~ThreadArena();
+};
+
+// 线程退出时空闲表先于其他 thread_local 析构，之后的释放直接还给堆、不再计数
+thread_local bool t_arena_gone = false;
+thread_local ThreadArena t_arena;
+
+ThreadArena::~ThreadArena() {
+    Clear();
+    t_arena_gone = true;
+    auto& r = Counters();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    AddTo(r.retired, counters);
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), &counters));
+}
+
+void Count(std::atomic<uint64_t> ArenaCounters::*counter) {
+    if (!t_arena_gone)
+        Bump(t_arena.counters.*counter);
+}
+
+void* TakeFree(bool aligned, size_t bytes) {
+    if (t_scope_depth == 0 || t_arena_gone)
+        return nullptr;
+    auto& lists = aligned ? t_arena.aligned : t_arena.plain;
+    auto it     = lists.find(bytes);
+    if (it == lists.end() || it->second.empty())
+        return nullptr;
+    void* p = it->second.back();
+    it->second.pop_back();
+    t_arena.bytes -= bytes;
+    Bump(t_arena.counters.arena_allocs);
+    return p;
+}
+
+bool PutFree(bool aligned, void* p, size_t bytes) {
+    if (t_scope_depth == 0 || t_arena_gone ||
+        t_arena.bytes + bytes > ArenaCapacity().load(std::memory_order_relaxed))
+        return false;
+    (aligned ? t_arena.aligned : t_arena.plain)[bytes].push_back(p);
+    t_arena.bytes += bytes;
+    Bump(t_arena.counters.arena_frees);
+    return true;
+}
+
+}  // namespace
+
+TowerArena::Scope::Scope() : m_active{ArenaEnabled().load(std::memory_order_relaxed)} {
+    if (m_active)
+        ++t_scope_depth;
+}
+
+TowerArena::Scope::~Scope() {
+    if (m_active)
+        --t_scope_depth;
+}
+
+TowerArena::Meter::Meter() {
+    if (g_meters.fetch_add(1, std::memory_order_relaxed) == 0) {
+        g_meter_live.store(0, std::memory_order_relaxed);
+        g_meter_peak.store(0, std::memory_order_relaxed);
+    }
+}
+
+TowerArena::Meter::~Meter() {
+    g_meters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+int64_t TowerArena::Meter::LiveBytes() const {
+    return g_meter_live.load(std::memory_order_relaxed);
+}
+
+int64_t TowerArena::Meter::PeakBytes() const {
+    return g_meter_peak.load(std::memory_order_relaxed);
+}
+
+bool TowerArena::Enabled() {
+    return ArenaEnabled().load(std::memory_order_relaxed);
+}
+
+void TowerArena::SetEnabled(bool enabled) {
+    ArenaEnabled().store(enabled, std::memory_order_relaxed);
+}
+
+bool TowerArena::Active() {
+    return t_scope_depth > 0;
+}
+
+void* TowerArena::Allocate(size_t bytes) {
+    Account(static_cast<int64_t>(bytes));
+    if (void* p = TakeFree(false, bytes))
+        return p;
+    Count(&ArenaCounters::heap_allocs);
+    return ::operator new(bytes);
+}
+
+void TowerArena::Deallocate(void* p, size_t bytes) {
+    if (p == nullptr)
+        return;
+    Account(-static_cast<int64_t>(bytes));
+    if (PutFree(false, p, bytes))
+        return;
+    Count(&ArenaCounters::heap_frees);
+    ::operator delete(p);
+}
+
+void* TowerArena::AllocateAligned(size_t bytes) {
+    Account(static_cast<int64_t>(bytes));
+    if (void* p = TakeFree(true, bytes))
+        return p;
+    Count(&ArenaCounters::heap_allocs);
+    return ::operator new(bytes, std::align_val_t{TowerSlab::ALIGNMENT});
+}
+
+void TowerArena::DeallocateAligned(void* p, size_t bytes) {
+    if (p == nullptr)
+        return;
+    Account(-static_cast<int64_t>(bytes));
+    if (PutFree(true, p, bytes))
+        return;
+    Count(&ArenaCounters::heap_frees);
+    ::operator delete(p, std::align_val_t{TowerSlab::ALIGNMENT});
+}
+
+size_t TowerArena::GetThreadCapacity() {
+    return ArenaCapacity().load(std::memory_order_relaxed);
+}
+
+void TowerArena::SetThreadCapacity(size_t bytes) {
+    ArenaCapacity().store(bytes, std::memory_order_relaxed);
+}
+
+void TowerArena::Trim() {
+    if (!t_arena_gone)
+        t_arena.Clear();
+}
+
+TowerArenaStats TowerArena::GetStats() {
+    auto& r = Counters();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    TowerArenaStats stats = SumCounters(r);
+    stats.heap_allocs -= r.baseline.heap_allocs;
+    stats.arena_allocs -= r.baseline.arena_allocs;
+    stats.heap_frees -= r.baseline.heap_frees;
+    stats.arena_frees -= r.baseline.arena_frees;
+    return stats;
+}
+
+void TowerArena::ResetStats() {
+    auto& r = Counters();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.baseline = SumCounters(r);
+}
+
+TowerStorage GetTowerStorage() {
+    return ActiveStorage().load(std::memory_order_relaxed);
+}
+
+void SetTowerStorage(TowerStorage storage) {
+    ActiveStorage().store(storage, std::memory_order_relaxed);
+}
+
+TowerSlab::TowerSlab(size_t numTowers, size_t towerBytes)
+    : m_num_towers{numTowers},
+      m_tower_bytes{(towerBytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT},
+      m_data{static_cast<unsigned char*>(TowerArena::AllocateAligned(m_num_towers * m_tower_bytes))},
+      m_in_use{new std::atomic<bool>[numTowers]} {
+    for (size_t i = 0; i < m_num_towers; ++i)
+        m_in_use[i].store(false, std::memory_order_relaxed);
+}
+
+TowerSlab::TowerSlab(size_t numTowers, size_t towerBytes, void* data, std::shared_ptr<const void> owner)
+    : m_num_towers{numTowers},
+      m_tower_bytes{towerBytes},
+      m_data{static_cast<unsigned char*>(data)},
+      m_in_use{new std::atomic<bool>[numTowers]},
+      m_owner{std::move(owner)},
+      m_preloaded{new std::atomic<bool>[numTowers]} {
+    if (!m_owner || towerBytes % ALIGNMENT != 0 || reinterpret_cast<uintptr_t>(data) % ALIGNMENT != 0)
+        OPENFHE_THROW("external tower storage must be owned and " + std::to_string(ALIGNMENT) + "-byte aligned");
+    for (size_t i = 0; i < m_num_towers; ++i) {
+        m_in_use[i].store(false, std::memory_order_relaxed);
+        m_preloaded[i].store(true, std::memory_order_relaxed);
+    }
+}
+
+TowerSlab::~TowerSlab() {
+    if (!m_owner)
+        TowerArena::DeallocateAligned(m_data, m_num_towers * m_tower_bytes);
+}
+
+bool TowerSlab::Acquire(size_t i) {
+    if (i >= m_num_towers)
+        return false;
+    bool expected = false;
+    return m_in_use[i].compare_exchange_strong(expected, true, std::memory_order_acq_rel);
+}
+
+void TowerSlab::Release(size_t i) {
+    if (m_preloaded)
+        m_preloaded[i].store(false, std::memory_order_relaxed);
+    m_in_use[i].store(false, std::memory_order_release);
+}
+
+}  // namespace intnat
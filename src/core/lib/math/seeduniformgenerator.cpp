@@ -0,0 +1,76 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2023, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Uniform polynomials expanded from a short seed (compressed eval keys and ciphertexts)
+ */
+
+#include "math/seeduniformgenerator.h"
+#include "math/distributiongenerator.h"
+#include "math/nbtheory.h"
+#include "utils/exception.h"
+
+#include <string>
+
+namespace lbcrypto {
+
+PRNGSeed SeedUniformGenerator::GenerateSeed() {
+    PRNGSeed seed;
+    auto& prng = PseudoRandomNumberGenerator::GetPRNG();
+    for (auto& word : seed)
+        word = prng();
+    return seed;
+}
+
+void SeedUniformGenerator::GenerateTower(const PRNGSeed& seed, uint32_t stream, uint32_t tower, uint64_t q,
+                                         uint32_t n, uint64_t* out) {
+    if (stream >= MAX_STREAMS || tower >= MAX_TOWERS)
+        OPENFHE_THROW("Seeded stream " + std::to_string(stream) + " / tower " + std::to_string(tower) +
+                      " out of range");
+    if (q < 2)
+        OPENFHE_THROW("Invalid modulus for seeded sampling");
+
+    default_prng::Blake2Engine engine(seed, (static_cast<uint64_t>(stream) << 48) | (static_cast<uint64_t>(tower) << 32));
+    // q 的位数对应的掩码：每次采样被接受的概率 > 1/2
+    const uint32_t bits = GetMSB64(q - 1);
+    const uint64_t mask = (bits >= 64) ? ~uint64_t(0) : (uint64_t(1) << bits) - 1;
+    for (uint32_t i = 0; i < n; ++i) {
+        uint64_t v;
+        do {
+            v = static_cast<uint64_t>(engine());
+            v |= static_cast<uint64_t>(engine()) << 32;
+            v &= mask;
+        } while (v >= q);
+        out[i] = v;
+    }
+}
+
+}  // namespace lbcrypto
@@ -592,6 +592,52 @@ TEST(UTDCRTPoly, DCRT_mod_ops_on_two_elements) {
     RUN_BIG_DCRTPOLYS(DCRT_mod_ops_on_two_elements, "DCRT DCRT_mod_ops_on_two_elements");
 }
 
+TEST(UTDCRTPoly, DCRT_approx_switch_crt_basis_tower) {
+    uint32_t order = 16;
+    auto allParams = std::make_shared<ILDCRTParams<BigInteger>>(order, 5, 50);
+    const auto& towers = allParams->GetParams();
+    auto paramsQ = std::make_shared<ILDCRTParams<BigInteger>>(
+        order, std::vector<std::shared_ptr<ILNativeParams>>(towers.begin(), towers.begin() + 3));
+    auto paramsP = std::make_shared<ILDCRTParams<BigInteger>>(
+        order, std::vector<std::shared_ptr<ILNativeParams>>(towers.begin() + 3, towers.end()));
+    uint32_t sizeQ = paramsQ->GetParams().size();
+    uint32_t sizeP = paramsP->GetParams().size();
+
+    std::vector<NativeInteger> QHatInvModq(sizeQ), QHatInvModqPrecon(sizeQ);
+    std::vector<std::vector<NativeInteger>> QHatModp(sizeQ, std::vector<NativeInteger>(sizeP, NativeInteger(1)));
+    for (uint32_t i = 0; i < sizeQ; ++i) {
+        NativeInteger qi = paramsQ->GetParams()[i]->GetModulus();
+        NativeInteger QHatModqi(1);
+        for (uint32_t k = 0; k < sizeQ; ++k) {
+            if (k == i)
+                continue;
+            NativeInteger qk = paramsQ->GetParams()[k]->GetModulus();
+            QHatModqi.ModMulEq(qk.Mod(qi), qi);
+            for (uint32_t j = 0; j < sizeP; ++j) {
+                NativeInteger pj = paramsP->GetParams()[j]->GetModulus();
+                QHatModp[i][j].ModMulEq(qk.Mod(pj), pj);
+            }
+        }
+        QHatInvModq[i]       = QHatModqi.ModInverse(qi);
+        QHatInvModqPrecon[i] = QHatInvModq[i].PrepModMulConst(qi);
+    }
+    const auto BarrettBase128Bit(BigInteger(1).LShiftEq(128));
+    std::vector<DoubleNativeInt> modpBarrettMu(sizeP);
+    for (uint32_t j = 0; j < sizeP; ++j)
+        modpBarrettMu[j] = (BarrettBase128Bit / BigInteger(paramsP->GetParams()[j]->GetModulus()))
+                               .ConvertToInt<DoubleNativeInt>();
+
+    DCRTPoly::DugType dug;
+    DCRTPoly x(dug, paramsQ, Format::COEFFICIENT);
+
+    DCRTPoly full = x.ApproxSwitchCRTBasis(paramsQ, paramsP, QHatInvModq, QHatInvModqPrecon, QHatModp, modpBarrettMu);
+    for (uint32_t j = 0; j < sizeP; ++j) {
+        auto tower =
+            x.ApproxSwitchCRTBasisTower(paramsQ, paramsP, j, QHatInvModq, QHatInvModqPrecon, QHatModp, modpBarrettMu);
+        EXPECT_EQ(full.GetElementAtIndex(j), tower) << "Failure: ApproxSwitchCRTBasisTower tower " << j;
+    }
+}
+
 // only need to try this with one
 void testDCRTPolyConstructorNegative(std::vector<NativePoly>& towers) {
     DCRTPoly expectException(towers);
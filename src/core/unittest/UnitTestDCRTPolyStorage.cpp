@@ -0,0 +1,321 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  This code checks the contiguous DCRTPoly storage mode: towers live in one
+  aligned slab, copies and arithmetic results stay contiguous, and every
+  result matches the per-tower storage mode. A slab over external memory
+  must be a view of its contents. It also checks that the tower arena
+  recycles storage only while a scope is open.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "OffloadDispatcher.h"
+#include "lattice/lat-hal.h"
+#include "math/distrgen.h"
+#include "math/hal/intnat/tower-slab.h"
+
+using namespace lbcrypto;
+using intnat::TowerStorage;
+
+class UTDCRTPolyStorage : public ::testing::Test {
+protected:
+    void SetUp() override {
+        intnat::SetTowerStorage(TowerStorage::CONTIGUOUS);
+    }
+    void TearDown() override {
+        intnat::SetTowerStorage(m_storage);
+    }
+
+    const uint32_t m_m = 64;
+    const uint32_t m_n = m_m / 2;
+    std::shared_ptr<ILDCRTParams<BigInteger>> m_params = std::make_shared<ILDCRTParams<BigInteger>>(m_m, 4, 50);
+    TowerStorage m_storage = intnat::GetTowerStorage();
+    OffloadDispatcher::ScopedCpuOnly m_cpuOnly;
+};
+
+TEST_F(UTDCRTPolyStorage, zero_poly_is_one_aligned_slab) {
+    DCRTPoly a(m_params, Format::EVALUATION, true);
+    ASSERT_TRUE(a.IsContiguous());
+    auto slab = a.GetTowerSlab();
+    ASSERT_NE(slab, nullptr);
+    EXPECT_EQ(slab->NumTowers(), a.GetNumOfElements());
+    EXPECT_EQ(slab->TowerBytes(), m_n * sizeof(uint64_t));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(slab->Data()) % intnat::TowerSlab::ALIGNMENT, 0u);
+
+    // tower 视图直接写 slab
+    a.GetAllElements()[2][5] = NativeInteger(7);
+    EXPECT_EQ(slab->Data()[2 * m_n + 5], 7u);
+    for (size_t i = 0; i < a.GetNumOfElements(); ++i)
+        EXPECT_EQ(a.GetElementAtIndex(i).GetModulus(), m_params->GetParams()[i]->GetModulus());
+}
+
+TEST_F(UTDCRTPolyStorage, copies_get_their_own_slab) {
+    DCRTPoly::DugType dug;
+    DCRTPoly a(dug, m_params, Format::EVALUATION);
+    EXPECT_FALSE(a.IsContiguous());
+
+    DCRTPoly b(a);
+    ASSERT_TRUE(b.IsContiguous());
+    EXPECT_EQ(b, a);
+
+    DCRTPoly c(b);
+    ASSERT_TRUE(c.IsContiguous());
+    EXPECT_NE(c.GetTowerSlab(), b.GetTowerSlab());
+    EXPECT_EQ(c, a);
+
+    // 同形状的拷贝赋值原地覆盖，slab 不变
+    DCRTPoly d(m_params, Format::EVALUATION, true);
+    auto slab = d.GetTowerSlab();
+    d         = a;
+    EXPECT_EQ(d.GetTowerSlab(), slab);
+    EXPECT_EQ(d, a);
+
+    // 不连续的左边拷贝赋值后也连续
+    DCRTPoly e(dug, m_params, Format::EVALUATION);
+    e = a;
+    EXPECT_TRUE(e.IsContiguous());
+    EXPECT_EQ(e, a);
+}
+
+TEST_F(UTDCRTPolyStorage, moved_in_tower_leaves_slab_until_packed) {
+    DCRTPoly a(m_params, Format::EVALUATION, true);
+    NativePoly t(a.GetElementAtIndex(1));
+    t[0] = NativeInteger(3);
+    a.SetElementAtIndex(1, std::move(t));
+    EXPECT_FALSE(a.IsContiguous());
+    EXPECT_EQ(a.GetTowerSlab(), nullptr);
+
+    const DCRTPoly before(a.GetAllElements());
+    a.Pack();
+    ASSERT_TRUE(a.IsContiguous());
+    EXPECT_EQ(a.GetAllElements(), before.GetAllElements());
+    EXPECT_EQ(a.GetTowerSlab()->Data()[m_n], 3u);
+}
+
+TEST_F(UTDCRTPolyStorage, arithmetic_matches_per_tower_storage) {
+    DCRTPoly::DugType dug;
+    intnat::SetTowerStorage(TowerStorage::PER_TOWER);
+    const DCRTPoly a(dug, m_params, Format::EVALUATION);
+    const DCRTPoly b(dug, m_params, Format::EVALUATION);
+    const DCRTPoly sum  = a + b;
+    const DCRTPoly diff = a - b;
+    const DCRTPoly prod = a * b;
+    DCRTPoly coef(a);
+    coef.SwitchFormat();
+    EXPECT_FALSE(sum.IsContiguous());
+
+    intnat::SetTowerStorage(TowerStorage::CONTIGUOUS);
+    for (const DCRTPoly& r : {a + b, a - b, a * b})
+        EXPECT_TRUE(r.IsContiguous());
+    EXPECT_EQ(a + b, sum);
+    EXPECT_EQ(a - b, diff);
+    EXPECT_EQ(a * b, prod);
+
+    DCRTPoly x(a);
+    x += b;
+    EXPECT_EQ(x, sum);
+    x -= b;
+    x *= b;
+    EXPECT_EQ(x, prod);
+
+    DCRTPoly y(a);
+    auto slab = y.GetTowerSlab();
+    y.SwitchFormat();
+    EXPECT_EQ(y.GetTowerSlab(), slab);
+    EXPECT_EQ(y, coef);
+    y.SwitchFormat();
+    EXPECT_EQ(y, a);
+}
+
+TEST_F(UTDCRTPolyStorage, per_tower_mode_is_unchanged) {
+    intnat::SetTowerStorage(TowerStorage::PER_TOWER);
+    DCRTPoly a(m_params, Format::EVALUATION, true);
+    EXPECT_FALSE(a.IsContiguous());
+    DCRTPoly b(a);
+    EXPECT_FALSE(b.IsContiguous());
+    // 显式 Pack 不看模式
+    b.Pack();
+    EXPECT_TRUE(b.IsContiguous());
+    EXPECT_EQ(b, a);
+}
+
+// 外部存储（如 mmap 的 key 文件）：第一次借出的 tower 就是原内容的视图，归还后重新借出时清零
+TEST_F(UTDCRTPolyStorage, external_slab_is_a_view_of_its_contents) {
+    const size_t towers = m_params->GetParams().size();
+    auto buffer = std::shared_ptr<uint64_t>(
+        static_cast<uint64_t*>(::operator new(towers * m_n * sizeof(uint64_t), std::align_val_t{64})),
+        [](uint64_t* p) { ::operator delete(p, std::align_val_t{64}); });
+    for (size_t i = 0; i < towers * m_n; ++i)
+        buffer.get()[i] = i + 1;
+
+    auto slab = std::make_shared<intnat::TowerSlab>(towers, m_n * sizeof(uint64_t), buffer.get(), buffer);
+    EXPECT_TRUE(slab->IsExternal());
+    {
+        auto a = DCRTPoly::FromTowerSlab(m_params, Format::EVALUATION, slab);
+        ASSERT_TRUE(a.IsContiguous());
+        EXPECT_EQ(a.GetTowerSlab(), slab);
+        for (size_t i = 0; i < towers; ++i) {
+            EXPECT_EQ(static_cast<const void*>(&a.GetElementAtIndex(i)[0]), slab->Tower(i));
+            EXPECT_EQ(a.GetElementAtIndex(i)[3].ConvertToInt(), i * m_n + 4);
+        }
+        // 拷贝落到自己的存储上，原视图不变
+        DCRTPoly b(a);
+        b.GetAllElements()[0][0] = NativeInteger(0);
+        EXPECT_EQ(buffer.get()[0], 1u);
+    }
+    EXPECT_FALSE(slab->Preloaded(0));
+    auto c = DCRTPoly::FromTowerSlab(m_params, Format::EVALUATION, slab);
+    EXPECT_EQ(c.GetElementAtIndex(1)[3].ConvertToInt(), 0u);
+}
+
+class UTTowerArena : public ::testing::Test {
+protected:
+    void SetUp() override {
+        intnat::TowerArena::SetEnabled(true);
+        intnat::TowerArena::Trim();
+        intnat::TowerArena::ResetStats();
+    }
+    void TearDown() override {
+        intnat::TowerArena::Trim();
+        intnat::TowerArena::SetEnabled(m_enabled);
+        intnat::TowerArena::SetThreadCapacity(m_capacity);
+    }
+
+    NativeInteger m_q = NativeInteger((uint64_t(1) << 40) + 1);
+    bool m_enabled    = intnat::TowerArena::Enabled();
+    size_t m_capacity = intnat::TowerArena::GetThreadCapacity();
+};
+
+TEST_F(UTTowerArena, reuses_freed_towers_inside_scope) {
+    intnat::TowerArena::Scope arena;
+    const void* first;
+    {
+        NativeVector v(1024, m_q);
+        first = &v[0];
+    }
+    NativeVector w(1024, m_q);
+    EXPECT_EQ(static_cast<const void*>(&w[0]), first);
+    auto stats = intnat::TowerArena::GetStats();
+    EXPECT_EQ(stats.heap_allocs, 1u);
+    EXPECT_EQ(stats.arena_frees, 1u);
+    EXPECT_EQ(stats.arena_allocs, 1u);
+
+    // 别的大小不会拿到这一块
+    NativeVector x(512, m_q);
+    EXPECT_EQ(intnat::TowerArena::GetStats().heap_allocs, 2u);
+}
+
+TEST_F(UTTowerArena, slabs_are_recycled_too) {
+    const auto storage = intnat::GetTowerStorage();
+    intnat::SetTowerStorage(intnat::TowerStorage::CONTIGUOUS);
+    auto params = std::make_shared<ILDCRTParams<BigInteger>>(64, 3, 50);
+    {
+        intnat::TowerArena::Scope arena;
+        { DCRTPoly a(params, Format::EVALUATION, true); }
+        intnat::TowerArena::ResetStats();
+        DCRTPoly b(params, Format::EVALUATION, true);
+        EXPECT_TRUE(b.IsContiguous());
+        EXPECT_EQ(intnat::TowerArena::GetStats().heap_allocs, 0u);
+        EXPECT_EQ(intnat::TowerArena::GetStats().arena_allocs, 1u);
+    }
+    intnat::SetTowerStorage(storage);
+}
+
+TEST_F(UTTowerArena, no_caching_outside_scope_or_when_disabled) {
+    { NativeVector v(1024, m_q); }
+    EXPECT_EQ(intnat::TowerArena::GetStats().heap_frees, 1u);
+
+    intnat::TowerArena::SetEnabled(false);
+    {
+        intnat::TowerArena::Scope arena;
+        EXPECT_FALSE(intnat::TowerArena::Active());
+        { NativeVector v(1024, m_q); }
+    }
+    EXPECT_EQ(intnat::TowerArena::GetStats().arena_frees, 0u);
+
+    intnat::TowerArena::SetEnabled(true);
+    intnat::TowerArena::SetThreadCapacity(0);
+    {
+        intnat::TowerArena::Scope arena;
+        { NativeVector v(1024, m_q); }
+    }
+    EXPECT_EQ(intnat::TowerArena::GetStats().arena_frees, 0u);
+    EXPECT_EQ(intnat::TowerArena::GetStats().heap_frees, 3u);
+}
+
+TEST_F(UTTowerArena, scope_is_per_thread) {
+    // 另一个线程开着 Scope，本线程的释放照常还给堆
+    std::promise<void> opened, done;
+    std::thread other([&] {
+        intnat::TowerArena::Scope arena;
+        opened.set_value();
+        done.get_future().wait();
+    });
+    opened.get_future().wait();
+    EXPECT_FALSE(intnat::TowerArena::Active());
+    { NativeVector v(1024, m_q); }
+    done.set_value();
+    other.join();
+
+    auto stats = intnat::TowerArena::GetStats();
+    EXPECT_EQ(stats.arena_frees, 0u);
+    EXPECT_EQ(stats.heap_frees, 1u);
+
+    // 其他线程的计数在它退出后仍算在总数里
+    std::thread([&] { NativeVector v(1024, m_q); }).join();
+    EXPECT_EQ(intnat::TowerArena::GetStats().heap_allocs, 2u);
+}
+
+TEST_F(UTTowerArena, meter_counts_live_tower_bytes) {
+    const int64_t towerBytes = 1024 * sizeof(NativeInteger);
+    intnat::TowerArena::Meter meter;
+    {
+        NativeVector a(1024, m_q);
+        NativeVector b(1024, m_q);
+        EXPECT_EQ(meter.LiveBytes(), 2 * towerBytes);
+        // 从空闲表取出的块也算在内
+        intnat::TowerArena::Scope arena;
+        { NativeVector c(1024, m_q); }
+        NativeVector d(1024, m_q);
+        EXPECT_EQ(meter.LiveBytes(), 3 * towerBytes);
+    }
+    EXPECT_EQ(meter.LiveBytes(), 0);
+    EXPECT_EQ(meter.PeakBytes(), 3 * towerBytes);
+}
@@ -0,0 +1,218 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  This code checks that DeviceDCRTPoly keeps towers resident on the simulated
+  accelerator across consecutive ops and only transfers them when the host
+  needs the data.
+ */
+
+#ifdef OPENFHE_FPGA_SIM
+
+#include "gtest/gtest.h"
+#include <memory>
+#include <vector>
+
+#include "FpgaSimulator.h"
+#include "OffloadDispatcher.h"
+#include "lattice/hal/default/device-dcrtpoly.h"
+#include "math/nbtheory.h"
+
+using namespace lbcrypto;
+
+namespace {
+
+// distinct 59-bit primes, q = 1 mod 2^17; the on-chip tables hold 3 Q + 2 P moduli
+const std::vector<uint64_t> kQ = {576460752300015617ULL, 576460752298835969ULL, 576460752298180609ULL};
+const std::vector<uint64_t> kP = {576460752289923073ULL, 576460752289529857ULL};
+
+const size_t kPolyBytes = kQ.size() * FPGA_RING_DIM * sizeof(uint64_t);
+
+// records that save() handed something to the archive
+struct CountingArchive {
+    size_t calls = 0;
+    template <class T>
+    void operator()(T&&) {
+        ++calls;
+    }
+};
+
+class UTDeviceDCRTPoly : public ::testing::Test {
+protected:
+    void SetUp() override {
+        std::vector<NativeInteger> moduli, roots;
+        std::vector<uint64_t> qr, pr;
+        for (auto m : kQ) {
+            NativeInteger mod(m);
+            moduli.push_back(mod);
+            roots.push_back(RootOfUnity<NativeInteger>(2 * FPGA_RING_DIM, mod));
+            qr.push_back(roots.back().ConvertToInt());
+        }
+        for (auto m : kP)
+            pr.push_back(RootOfUnity<NativeInteger>(2 * FPGA_RING_DIM, NativeInteger(m)).ConvertToInt());
+        params = std::make_shared<ILDCRTParams<BigInteger>>(2 * FPGA_RING_DIM, moduli, roots);
+
+        DCRTPoly::DugType dug;
+        a = DCRTPoly(dug, params, Format::EVALUATION);
+        b = DCRTPoly(dug, params, Format::EVALUATION);
+
+        // CPU references: a*b + a - b, and the same in COEFFICIENT format
+        PolyAccelerator::Set(nullptr);
+        expected = a * b;
+        expected += a;
+        expected -= b;
+        expectedCoef = expected;
+        expectedCoef.SwitchFormat();
+
+        PolyAccelerator::Set(PolyAccelerator::Create("sim"));
+        PolyAccelerator::Get()->InitModuli(kQ, kP, qr, pr, FPGA_RING_DIM);
+        OffloadDispatcher::Active()->SetPolicy(OffloadPolicy::ALWAYS);
+        PolyAccelerator::Get()->ResetTransferStats();
+    }
+
+    void TearDown() override {
+        PolyAccelerator::Set(nullptr);
+    }
+
+    static FpgaTransferStats Stats() {
+        return PolyAccelerator::Get()->GetTransferStats();
+    }
+
+    std::shared_ptr<ILDCRTParams<BigInteger>> params;
+    DCRTPoly a, b, expected, expectedCoef;
+};
+
+}  // namespace
+
+TEST_F(UTDeviceDCRTPoly, host_polys_round_trip_every_op) {
+    // baseline: each offloaded op uploads its inputs and reads its result back
+    DCRTPoly c = a * b;
+    c += a;
+    c -= b;
+    EXPECT_EQ(c, expected);
+    c.SwitchFormat();
+    EXPECT_EQ(Stats().h2d_bytes, 7 * kPolyBytes);
+    EXPECT_EQ(Stats().d2h_bytes, 4 * kPolyBytes);
+}
+
+TEST_F(UTDeviceDCRTPoly, chain_stays_resident) {
+    DeviceDCRTPoly da(a), db(b);
+    EXPECT_FALSE(da.IsResident());
+    EXPECT_EQ(Stats().h2d_bytes, 0u);
+
+    DeviceDCRTPoly dc = da.Times(db);
+    dc += da;
+    dc -= db;
+    dc.SwitchFormat();
+
+    // the inputs went up once; nothing came back
+    EXPECT_EQ(dc.GetResidency(), DeviceDCRTPoly::Residency::DEVICE);
+    EXPECT_EQ(da.GetResidency(), DeviceDCRTPoly::Residency::BOTH);
+    EXPECT_EQ(dc.GetFormat(), Format::COEFFICIENT);
+    EXPECT_EQ(Stats().h2d_bytes, 2 * kPolyBytes);
+    EXPECT_EQ(Stats().d2h_bytes, 0u);
+    EXPECT_EQ(Stats().launches, 4u);
+
+    // first host access reads back once
+    DCRTPoly c = dc.Host();
+    EXPECT_EQ(Stats().d2h_bytes, kPolyBytes);
+    dc.Host();
+    EXPECT_EQ(Stats().d2h_bytes, kPolyBytes);
+    EXPECT_EQ(dc.GetResidency(), DeviceDCRTPoly::Residency::BOTH);
+
+    // the resident NTT leaves the towers in the CPU order
+    EXPECT_EQ(c, expectedCoef);
+}
+
+TEST_F(UTDeviceDCRTPoly, reinstalled_accelerator_moves_data_home) {
+    DeviceDCRTPoly da(a), db(b);
+    DeviceDCRTPoly dc = da.Times(db);
+    dc += da;
+    dc -= db;
+    EXPECT_EQ(dc.GetResidency(), DeviceDCRTPoly::Residency::DEVICE);
+    auto& sim = FpgaSimulator::GetInstance();
+    EXPECT_EQ(sim.GetResidentCount(), 3u);
+
+    // the next op reads dc back from the old backend and frees its resident memory there
+    PolyAccelerator::Set(nullptr);
+    dc.SwitchFormat();
+    EXPECT_FALSE(dc.IsResident());
+    EXPECT_EQ(sim.GetResidentCount(), 2u);
+    EXPECT_EQ(sim.GetTransferStats().d2h_bytes, kPolyBytes);
+    EXPECT_EQ(dc.Host(), expectedCoef);
+}
+
+TEST_F(UTDeviceDCRTPoly, host_writes_invalidate_device_copy) {
+    DeviceDCRTPoly da(a), db(b);
+    da += db;
+    EXPECT_EQ(Stats().h2d_bytes, 2 * kPolyBytes);
+
+    // a CPU-only op syncs first, then the next device op uploads again
+    da.MutableHost() = da.MutableHost().Negate();
+    EXPECT_EQ(da.GetResidency(), DeviceDCRTPoly::Residency::HOST);
+    EXPECT_EQ(Stats().d2h_bytes, kPolyBytes);
+
+    da += db;
+    EXPECT_EQ(Stats().h2d_bytes, 3 * kPolyBytes);
+
+    DCRTPoly ref = (a + b).Negate() + b;
+    EXPECT_EQ(std::move(da).ToHost(), ref);
+    EXPECT_EQ(FpgaSimulator::GetInstance().GetResidentCount(), 1u);  // db
+}
+
+TEST_F(UTDeviceDCRTPoly, serialization_syncs) {
+    DeviceDCRTPoly da(a), db(b);
+    da *= db;
+    EXPECT_EQ(Stats().d2h_bytes, 0u);
+
+    CountingArchive ar;
+    da.save(ar, 0);
+    EXPECT_EQ(ar.calls, 1u);
+    EXPECT_EQ(Stats().d2h_bytes, kPolyBytes);
+    EXPECT_EQ(da.GetResidency(), DeviceDCRTPoly::Residency::BOTH);
+    EXPECT_EQ(da.Host(), a * b);
+}
+
+TEST_F(UTDeviceDCRTPoly, falls_back_without_device) {
+    OffloadDispatcher::Active()->SetPolicy(OffloadPolicy::NEVER);
+    DeviceDCRTPoly da(a), db(b);
+    DeviceDCRTPoly dc = da.Times(db);
+    dc += da;
+    dc -= db;
+    dc.SwitchFormat();
+    EXPECT_FALSE(dc.IsResident());
+    EXPECT_EQ(dc.Host(), expectedCoef);
+    EXPECT_EQ(Stats().h2d_bytes, 0u);
+    EXPECT_EQ(Stats().d2h_bytes, 0u);
+}
+
+#endif
@@ -0,0 +1,119 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  This code tests the size-bucketed device buffer pool used by FpgaManager. The
+  pool is instantiated with a host-side buffer type so no XRT device is needed.
+ */
+
+#include "gtest/gtest.h"
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "FpgaBufferPool.h"
+
+namespace {
+using HostBuffer = std::vector<uint8_t>;
+
+struct CountingFactory {
+    int* allocs;
+    HostBuffer operator()(size_t bytes, int) const {
+        ++(*allocs);
+        return HostBuffer(bytes);
+    }
+};
+}  // namespace
+
+TEST(UTFpgaBufferPool, bucket_size) {
+    EXPECT_EQ(DeviceBufferPool<HostBuffer>::BucketSize(1), DeviceBufferPool<HostBuffer>::kMinBucketBytes);
+    EXPECT_EQ(DeviceBufferPool<HostBuffer>::BucketSize(4096 * 8), 4096u * 8);
+    EXPECT_EQ(DeviceBufferPool<HostBuffer>::BucketSize(4096 * 8 + 1), 4096u * 16);
+}
+
+TEST(UTFpgaBufferPool, reuse_per_group_and_bucket) {
+    int allocs = 0;
+    DeviceBufferPool<HostBuffer> pool(CountingFactory{&allocs});
+
+    const size_t limbBytes = 4096 * sizeof(uint64_t);
+    {
+        auto a = pool.Acquire(0, limbBytes);
+        auto b = pool.Acquire(2, limbBytes);
+        EXPECT_EQ(a->size(), limbBytes);
+        EXPECT_EQ(pool.GetStats().in_use, 2u);
+    }
+    EXPECT_EQ(pool.GetStats().cached, 2u);
+
+    for (int i = 0; i < 10; ++i) {
+        auto a = pool.Acquire(0, limbBytes);
+        auto b = pool.Acquire(2, limbBytes);
+    }
+    // a different group or bucket must not be served from those buffers
+    { auto c = pool.Acquire(1, limbBytes); }
+    { auto d = pool.Acquire(0, 3 * limbBytes); }
+
+    auto st = pool.GetStats();
+    EXPECT_EQ(allocs, 4);
+    EXPECT_EQ(st.misses, 4u);
+    EXPECT_EQ(st.hits, 20u);
+    EXPECT_EQ(st.releases, 24u);
+    EXPECT_EQ(st.in_use, 0u);
+    EXPECT_EQ(st.bytes, 3 * limbBytes + DeviceBufferPool<HostBuffer>::BucketSize(3 * limbBytes));
+
+    pool.Clear();
+    EXPECT_EQ(pool.GetStats().cached, 0u);
+    EXPECT_EQ(pool.GetStats().bytes, 0u);
+}
+
+TEST(UTFpgaBufferPool, idle_limit_and_move) {
+    int allocs = 0;
+    DeviceBufferPool<HostBuffer> pool(CountingFactory{&allocs}, 1);
+    {
+        auto a = pool.Acquire(0, 100);
+        auto b = pool.Acquire(0, 100);
+        auto moved = std::move(a);
+        EXPECT_FALSE(a.Valid());
+        EXPECT_TRUE(moved.Valid());
+    }
+    // only one idle buffer is kept per bucket; the other is freed
+    auto st = pool.GetStats();
+    EXPECT_EQ(st.releases, 2u);
+    EXPECT_EQ(st.cached, 1u);
+    EXPECT_EQ(st.bytes, DeviceBufferPool<HostBuffer>::kMinBucketBytes);
+}
+
+TEST(UTFpgaBufferPool, failed_allocation_is_not_counted) {
+    DeviceBufferPool<HostBuffer> pool([](size_t, int) -> HostBuffer { throw std::runtime_error("no device"); });
+    EXPECT_THROW(pool.Acquire(0, 100), std::runtime_error);
+    auto st = pool.GetStats();
+    EXPECT_EQ(st.in_use, 0u);
+    EXPECT_EQ(st.bytes, 0u);
+}
@@ -0,0 +1,113 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  This code tests the three-stage asynchronous command queue used by FpgaManager
+  to overlap host-to-device copies, kernel runs and device-to-host copies.
+ */
+
+#include "gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "FpgaCommandQueue.h"
+
+namespace {
+void Busy() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+}
+}  // namespace
+
+TEST(UTFpgaCommandQueue, stages_run_in_order_per_command) {
+    FpgaCommandQueue queue;
+    const int n = 8;
+    std::vector<int> stage(n, 0);
+    std::vector<std::future<void>> futs;
+    for (int i = 0; i < n; ++i) {
+        futs.push_back(queue.Submit([&, i] { stage[i] = 1; },
+                                    [&, i] {
+                                        ASSERT_EQ(stage[i], 1);
+                                        stage[i] = 2;
+                                    },
+                                    [&, i] {
+                                        ASSERT_EQ(stage[i], 2);
+                                        stage[i] = 3;
+                                    }));
+    }
+    for (auto& f : futs)
+        f.get();
+    for (int i = 0; i < n; ++i)
+        EXPECT_EQ(stage[i], 3);
+    auto st = queue.GetStats();
+    EXPECT_EQ(st.submitted, static_cast<uint64_t>(n));
+    EXPECT_EQ(st.completed, static_cast<uint64_t>(n));
+}
+
+TEST(UTFpgaCommandQueue, pipeline_overlaps_and_respects_depth) {
+    FpgaCommandQueue queue(2);
+    std::atomic<int> liveInputs{0}, maxLiveInputs{0};
+    for (int i = 0; i < 12; ++i) {
+        queue.Submit(
+            [&] {
+                int v = ++liveInputs;
+                int m = maxLiveInputs.load();
+                while (v > m && !maxLiveInputs.compare_exchange_weak(m, v)) {
+                }
+                Busy();
+            },
+            [&] {
+                Busy();
+                --liveInputs;
+            },
+            Busy);
+    }
+    queue.Drain();
+    auto st = queue.GetStats();
+    EXPECT_EQ(st.completed, 12u);
+    // at least two stages were busy at once, and never more than the ping-pong depth of inputs
+    EXPECT_GE(st.max_overlap, 2u);
+    EXPECT_LE(maxLiveInputs.load(), 2);
+}
+
+TEST(UTFpgaCommandQueue, exception_skips_later_stages) {
+    FpgaCommandQueue queue;
+    bool ranD2H = false;
+    auto bad    = queue.Submit([] { throw std::runtime_error("dma failed"); }, nullptr, [&] { ranD2H = true; });
+    auto good   = queue.Submit(nullptr, nullptr, nullptr);
+    EXPECT_THROW(bad.get(), std::runtime_error);
+    EXPECT_NO_THROW(good.get());
+    EXPECT_FALSE(ranD2H);
+    EXPECT_EQ(queue.GetStats().failed, 1u);
+}
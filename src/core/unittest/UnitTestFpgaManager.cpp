@@ -0,0 +1,247 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  This code tests how FpgaManager splits the towers of a DCRTPoly into kernel
+  launches for the multi-limb NTT/INTT offload.
+ */
+
+#include "gtest/gtest.h"
+#include <vector>
+
+#include "FpgaManager.h"
+
+using Runs = std::vector<FpgaManager::LimbRun>;
+
+static void ExpectRuns(const Runs& got, const Runs& expected) {
+    ASSERT_EQ(got.size(), expected.size());
+    for (size_t i = 0; i < got.size(); ++i) {
+        EXPECT_EQ(got[i].first, expected[i].first) << "run " << i;
+        EXPECT_EQ(got[i].count, expected[i].count) << "run " << i;
+        EXPECT_EQ(got[i].mod_idx, expected[i].mod_idx) << "run " << i;
+    }
+}
+
+TEST(UTFpgaManager, contiguous_towers_use_one_launch) {
+    ExpectRuns(FpgaManager::PlanLimbRuns({0, 1, 2}), {{0, 3, 0}});
+    ExpectRuns(FpgaManager::PlanLimbRuns({3, 4}), {{0, 2, 3}});
+}
+
+TEST(UTFpgaManager, gaps_and_limit_split_runs) {
+    // moduli 0,1 then 3 (index 2 is not part of this polynomial)
+    ExpectRuns(FpgaManager::PlanLimbRuns({0, 1, 3}), {{0, 2, 0}, {2, 1, 3}});
+    // out-of-order towers cannot share a launch
+    ExpectRuns(FpgaManager::PlanLimbRuns({1, 0}), {{0, 1, 1}, {1, 1, 0}});
+    // at most max_limbs towers per launch
+    ExpectRuns(FpgaManager::PlanLimbRuns({0, 1, 2, 3, 4}, 2), {{0, 2, 0}, {2, 2, 2}, {4, 1, 4}});
+}
+
+TEST(UTFpgaManager, unknown_modulus_falls_back) {
+    EXPECT_TRUE(FpgaManager::PlanLimbRuns({0, -1, 2}).empty());
+    EXPECT_TRUE(FpgaManager::PlanLimbRuns({}).empty());
+}
+
+// q = 1 mod 2^17, so it has 2n-th roots of unity for every n up to FPGA_MAX_RING_DIM
+static const uint64_t kStreamModulus = 576460752300015617ULL;
+
+static uint64_t FindRoot(uint64_t q, size_t n) {
+    for (uint64_t g = 2;; ++g) {
+        uint64_t psi = MathUtils::Power(g, (q - 1) / (2 * n), q);
+        if (MathUtils::Power(psi, n, q) == q - 1)
+            return psi;
+    }
+}
+
+TEST(UTFpgaManager, stream_image_layout) {
+    const size_t n   = 1 << 13;
+    const uint64_t q = kStreamModulus;
+    const uint64_t r = FindRoot(q, n);
+    auto fwd         = FpgaManager::PackNttStreamImage({q, q}, {r, r}, n, false);
+    auto inv         = FpgaManager::PackNttStreamImage({q, q}, {r, r}, n, true);
+
+    const size_t seg = FpgaManager::NTT_STREAM_LIMB_WORDS + n;
+    ASSERT_EQ(fwd.size(), FpgaManager::NTT_STREAM_HDR_WORDS + 2 * seg);
+    EXPECT_EQ(fwd[FpgaManager::NTT_STREAM_LOG_N], 13u);
+    EXPECT_EQ(fwd[FpgaManager::NTT_STREAM_INVERSE], 0u);
+    EXPECT_EQ(inv[FpgaManager::NTT_STREAM_INVERSE], 1u);
+
+    // second modulus segment: [q, k, m, 0] then psi^{br(i)}
+    const uint64_t* p = fwd.data() + FpgaManager::NTT_STREAM_HDR_WORDS + seg;
+    const uint64_t* w = p + FpgaManager::NTT_STREAM_LIMB_WORDS;
+    const uint64_t* v = inv.data() + FpgaManager::NTT_STREAM_HDR_WORDS + seg + FpgaManager::NTT_STREAM_LIMB_WORDS;
+    EXPECT_EQ(p[0], q);
+    EXPECT_EQ(p[1], 59u);
+    EXPECT_EQ(w[0], 1u);
+    EXPECT_EQ(w[1], MathUtils::Power(r, n / 2, q));  // br(1) = n/2
+    EXPECT_EQ(w[n / 2], r);                           // br(n/2) = 1
+    for (size_t i = 0; i < n; i += 97)
+        EXPECT_EQ((unsigned __int128)w[i] * v[i] % q, 1u) << "i = " << i;
+}
+
+TEST(UTFpgaManager, stream_ring_dims_and_tiles) {
+    EXPECT_TRUE(FpgaManager::IsStreamRingDim(FPGA_RING_DIM));
+    EXPECT_TRUE(FpgaManager::IsStreamRingDim(FPGA_MAX_RING_DIM));
+    EXPECT_FALSE(FpgaManager::IsStreamRingDim(2 * FPGA_MAX_RING_DIM));
+    EXPECT_FALSE(FpgaManager::IsStreamRingDim(3000));
+
+    // a large context is split into launches of at most StreamTileLimbs towers
+    const size_t tile = FpgaManager::StreamTileLimbs(FPGA_MAX_RING_DIM);
+    EXPECT_EQ(tile * FPGA_MAX_RING_DIM * sizeof(uint64_t), (size_t)FPGA_STREAM_TILE_BYTES);
+    std::vector<int> idx(3 * tile);
+    for (size_t i = 0; i < idx.size(); ++i)
+        idx[i] = (int)i;
+    auto runs = FpgaManager::PlanLimbRuns(idx, tile);
+    ASSERT_EQ(runs.size(), 3u);
+    EXPECT_EQ(runs[2].first, 2 * tile);
+    EXPECT_EQ(runs[2].mod_idx, (int)(2 * tile));
+}
+
+TEST(UTFpgaManager, init_image_matches_natural_twiddles) {
+    const size_t n   = FPGA_RING_DIM;
+    const uint64_t q = kStreamModulus;
+    const uint64_t r = FindRoot(q, n);
+    auto image       = FpgaManager::PackInitImage({q, q, q}, {q, q}, {r, r, r, r, r}, n);
+
+    ASSERT_NE(image.init_p_offset, 0u);
+    EXPECT_EQ(image.init_p_offset % FpgaManager::FPGA_IMAGE_ALIGN_WORDS, 0u);
+    EXPECT_EQ(image.stream_offset[0] % FpgaManager::FPGA_IMAGE_ALIGN_WORDS, 0u);
+    EXPECT_EQ(image.stream_offset[1] % FpgaManager::FPGA_IMAGE_ALIGN_WORDS, 0u);
+
+    // OP_INIT: psi^i / psi^-i in natural order, permuted by GenerateTwiddleIndices
+    std::vector<int> perm = MathUtils::GenerateTwiddleIndices((int)n);
+    const uint64_t rinv   = MathUtils::ModInverse(r, q);
+    const uint64_t* ntt   = image.words.data() + 3 * 3 + 4 * n;  // limb 4 of segment 1
+    const uint64_t* intt  = image.words.data() + image.init_p_offset + 2 * 3 + 4 * n;
+    for (size_t i = 0; i < perm.size(); i += 61) {
+        EXPECT_EQ(ntt[i], MathUtils::Power(r, perm[i], q)) << "i = " << i;
+        EXPECT_EQ(intt[i], MathUtils::Power(rinv, perm[i], q)) << "i = " << i;
+    }
+}
+
+TEST(UTFpgaManager, init_image_uses_fixed_kernel_slots) {
+    // OP_INIT reads Q at slots [0, KERNEL_LIMB_Q) and P right after them, whatever the number of Q moduli
+    const size_t n   = FPGA_RING_DIM;
+    const uint64_t q = kStreamModulus;
+    const uint64_t r = FindRoot(q, n);
+    auto image       = FpgaManager::PackInitImage({q, q}, {q, q}, {r, r, r, r}, n);
+
+    const int lq          = PolyAccelerator::KERNEL_LIMB_Q;
+    const int lp          = MAX_LIMBS - lq;
+    const uint64_t* seg_p = image.words.data() + image.init_p_offset;
+    EXPECT_EQ(image.words[0], q);
+    EXPECT_EQ(image.words[1], q);
+    EXPECT_EQ(image.words[2], 0u);  // unused Q slot
+    EXPECT_EQ(seg_p[0], q);
+    EXPECT_EQ(seg_p[1], q);
+    EXPECT_NE(seg_p[lp], 0u);  // K_HALF of P_0
+
+    const uint64_t* ntt  = image.words.data() + 3 * lq;
+    const uint64_t* intt = seg_p + 3 * lp;
+    std::vector<int> perm = MathUtils::GenerateTwiddleIndices((int)n);
+    EXPECT_EQ(ntt[2 * n + 1], 0u);
+    EXPECT_EQ(intt[2 * n + 1], 0u);
+    EXPECT_EQ(ntt[lq * n + 1], MathUtils::Power(r, perm[1], q));  // P_0 in slot KERNEL_LIMB_Q
+    EXPECT_EQ(intt[(lq + 1) * n + 1], MathUtils::Power(MathUtils::ModInverse(r, q), perm[1], q));
+
+    EXPECT_EQ(FpgaManager::OnChipSlot(1, 2), 1);
+    EXPECT_EQ(FpgaManager::OnChipSlot(2, 2), lq);
+    EXPECT_EQ(FpgaManager::OnChipSlot(3, 4), -1);  // Q beyond the kernel Q slots
+    EXPECT_EQ(FpgaManager::OnChipSlot(6, 4), -1);  // P beyond MAX_LIMBS
+}
+
+TEST(UTFpgaManager, bconv_needs_output_as_wide_as_input) {
+    // the kernel's Barrett reduction is exact below 2^(2k) only, k = ceil(log2 out)
+    const uint64_t wide[]   = {576460752300015617ULL, 1125899906949121ULL};  // 59 and 50 bits
+    const uint64_t narrow[] = {557057};                                      // 19 bits
+    EXPECT_TRUE(PolyAccelerator::BConvFits(wide, 2, wide, 1));
+    EXPECT_TRUE(PolyAccelerator::BConvFits(narrow, 1, wide, 2));
+    EXPECT_FALSE(PolyAccelerator::BConvFits(wide, 1, wide + 1, 1));
+    EXPECT_FALSE(PolyAccelerator::BConvFits(wide + 1, 1, narrow, 1));
+}
+
+TEST(UTFpgaManager, init_image_reuses_cached_tables) {
+    const size_t n   = 1 << 12;
+    const uint64_t q = kStreamModulus;
+    const uint64_t r = FindRoot(q, n);
+    auto computed    = FpgaManager::PackInitImage({q}, {q}, {r, r}, n);
+
+    std::vector<uint64_t> fwd(n), inv(n);
+    MathUtils::BitReversedPowers(r, q, n, fwd.data());
+    MathUtils::BitReversedPowers(MathUtils::ModInverse(r, q), q, n, inv.data());
+    size_t calls = 0;
+    auto lookup  = [&](uint64_t, size_t, std::vector<uint64_t>& f, std::vector<uint64_t>& i) {
+        ++calls;
+        f = fwd;
+        i = inv;
+        return true;
+    };
+    auto reused = FpgaManager::PackInitImage({q}, {q}, {r, r}, n, lookup);
+    EXPECT_EQ(calls, 2u);
+    EXPECT_EQ(reused.words, computed.words);
+
+    // a table built for another root is not used
+    std::vector<uint64_t> other(n, 7);
+    auto stale = FpgaManager::PackInitImage({q}, {q}, {r, r}, n,
+                                            [&](uint64_t, size_t, std::vector<uint64_t>& f, std::vector<uint64_t>& i) {
+                                                f = other;
+                                                i = other;
+                                                return true;
+                                            });
+    EXPECT_EQ(stale.words, computed.words);
+}
+
+TEST(UTFpgaManager, init_image_disk_round_trip) {
+    const size_t n   = 1 << 13;
+    const uint64_t q = kStreamModulus;
+    const uint64_t r = FindRoot(q, n);
+    auto image       = FpgaManager::PackInitImage({q, q}, {q}, {r, r, r}, n);
+    EXPECT_EQ(image.init_p_offset, 0u);  // no OP_INIT section for N != FPGA_RING_DIM
+
+    const std::string path = FpgaManager::InitImageCachePath(testing::TempDir(), image);
+    ASSERT_TRUE(FpgaManager::SaveInitImage(path, image));
+
+    FpgaManager::FpgaInitImage loaded;
+    loaded.ring_dim = n;
+    loaded.num_q    = 2;
+    loaded.moduli   = {q, q, q};
+    loaded.roots    = {r, r, r};
+    EXPECT_EQ(FpgaManager::InitImageCachePath(testing::TempDir(), loaded), path);
+    ASSERT_TRUE(FpgaManager::LoadInitImage(path, loaded));
+    EXPECT_EQ(loaded.words, image.words);
+    EXPECT_EQ(loaded.stream_offset[1], image.stream_offset[1]);
+    EXPECT_EQ(loaded.stream_words, image.stream_words);
+
+    // a different modulus split does not match this file
+    FpgaManager::FpgaInitImage other = loaded;
+    other.num_q                      = 1;
+    EXPECT_FALSE(FpgaManager::LoadInitImage(path, other));
+    std::remove(path.c_str());
+}
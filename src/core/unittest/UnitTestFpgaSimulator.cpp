@@ -0,0 +1,500 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  This code runs the fpga_backend kernels through the in-process simulator
+  backend of PolyAccelerator and checks them against CPU reference results.
+ */
+
+#ifdef OPENFHE_FPGA_SIM
+
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <future>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "FpgaManager.h"
+#include "FpgaSimulator.h"
+#include "OffloadDispatcher.h"
+#include "math/math-hal.h"
+
+namespace {
+
+using u128 = unsigned __int128;
+
+// distinct 59-bit primes, q = 1 mod 2^17
+const std::vector<uint64_t> kQ = {576460752300015617ULL, 576460752298835969ULL, 576460752298180609ULL};
+const std::vector<uint64_t> kP = {576460752289923073ULL, 576460752289529857ULL};
+
+uint64_t FindRoot(uint64_t q, size_t n) {
+    for (uint64_t g = 2;; ++g) {
+        uint64_t psi = MathUtils::Power(g, (q - 1) / (2 * n), q);
+        if (MathUtils::Power(psi, n, q) == q - 1)
+            return psi;
+    }
+}
+
+// 3 + 2 moduli at n = FPGA_RING_DIM
+FpgaSimulator& InitSim(size_t n = FPGA_RING_DIM, const std::vector<uint64_t>& q = kQ,
+                       const std::vector<uint64_t>& p = kP) {
+    std::vector<uint64_t> qr, pr;
+    for (auto m : q)
+        qr.push_back(FindRoot(m, n));
+    for (auto m : p)
+        pr.push_back(FindRoot(m, n));
+    auto& sim = FpgaSimulator::GetInstance();
+    sim.InitModuli(q, p, qr, pr, n);
+    return sim;
+}
+
+std::vector<uint64_t> Random(size_t n, uint64_t q, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> v(n);
+    for (auto& x : v)
+        x = rng() % q;
+    return v;
+}
+
+}  // namespace
+
+TEST(UTFpgaSimulator, registry_selects_backends) {
+    EXPECT_EQ(PolyAccelerator::Create("cpu"), nullptr);
+    EXPECT_ANY_THROW(PolyAccelerator::Create("bogus"));
+
+    PolyAccelerator::Set(PolyAccelerator::Create("sim"));
+    ASSERT_NE(PolyAccelerator::Get(), nullptr);
+    EXPECT_STREQ(PolyAccelerator::Get()->Name(), "sim");
+    // the backend is wrapped in the offload dispatcher
+    ASSERT_NE(OffloadDispatcher::Active(), nullptr);
+    EXPECT_EQ(&OffloadDispatcher::Active()->Backend(), &FpgaSimulator::GetInstance());
+
+    PolyAccelerator::Set(nullptr);
+    EXPECT_EQ(PolyAccelerator::Get(), nullptr);
+}
+
+TEST(UTFpgaSimulator, stream_ntt_matches_definition) {
+    // N != FPGA_RING_DIM: every tower goes through OP_NTT_STREAM
+    const size_t n   = 1 << 13;
+    const uint64_t q = kQ[0];
+    auto& sim        = InitSim(n, {q, q}, {q});
+    ASSERT_TRUE(sim.SupportsRingDim(n));
+
+    const uint64_t psi = FindRoot(q, n);
+    auto a             = Random(n, q, 1);
+    auto ntt           = a;
+    uint64_t* towers[] = {ntt.data()};
+    ASSERT_TRUE(sim.NttBatchOffload(true, towers, &q, 1, n));
+
+    // out[br(i)] = sum_j a_j * psi^{(2i+1) j}
+    const uint32_t logn = 13;
+    for (size_t i = 0; i < n; i += 509) {
+        uint64_t root = MathUtils::Power(psi, 2 * i + 1, q), acc = 0, w = 1;
+        for (size_t j = 0; j < n; ++j) {
+            acc = (uint64_t)(((u128)acc + (u128)a[j] * w % q) % q);
+            w   = (uint64_t)((u128)w * root % q);
+        }
+        size_t br = 0;
+        for (uint32_t b = 0; b < logn; ++b)
+            br |= ((i >> b) & 1) << (logn - 1 - b);
+        EXPECT_EQ(ntt[br], acc) << "i = " << i;
+    }
+
+    ASSERT_TRUE(sim.NttBatchOffload(false, towers, &q, 1, n));
+    EXPECT_EQ(ntt, a);
+}
+
+TEST(UTFpgaSimulator, ntt_hooks_match_cpu) {
+    // the DCRTPoly / NativePoly hooks must return the CPU (bit-reversed) order at n = FPGA_RING_DIM too
+    const size_t n = FPGA_RING_DIM;
+
+    // CPU reference first; an earlier test may have cached tables for another root of these moduli
+    std::vector<std::vector<uint64_t>> data, orig, expected;
+    std::vector<uint64_t> qr, pr;
+    std::vector<uint64_t*> towers;
+    for (size_t i = 0; i < kQ.size(); ++i) {
+        data.push_back(Random(n, kQ[i], 10 + i));
+        NativeVector v(n, NativeInteger(kQ[i]));
+        for (size_t j = 0; j < n; ++j)
+            v[j] = data.back()[j];
+        const NativeInteger psi(FindRoot(kQ[i], n));
+        ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(psi, 2 * n, &v);
+        expected.emplace_back(n);
+        for (size_t j = 0; j < n; ++j)
+            expected.back()[j] = v[j].ConvertToInt();
+
+        const NativeVector *table, *precon;
+        ASSERT_TRUE(ChineseRemainderTransformFTT<NativeVector>::GetForwardTablesForVerification(NativeInteger(kQ[i]),
+                                                                                                n, &table, &precon));
+        qr.push_back((*table)[n / 2].ConvertToInt());  // the psi the CPU used
+    }
+    for (auto m : kP)
+        pr.push_back(FindRoot(m, n));
+    orig = data;
+    for (auto& d : data)
+        towers.push_back(d.data());
+
+    auto& sim = FpgaSimulator::GetInstance();
+    sim.InitModuli(kQ, kP, qr, pr, n);
+    sim.ResetTransferStats();
+    ASSERT_TRUE(sim.NttBatchOffload(true, towers.data(), kQ.data(), kQ.size(), n));
+    EXPECT_EQ(data, expected);
+    ASSERT_TRUE(sim.NttBatchOffload(false, towers.data(), kQ.data(), kQ.size(), n));
+    EXPECT_EQ(data, orig);
+
+    // three contiguous towers: one launch each way
+    auto stats = sim.GetTransferStats();
+    EXPECT_EQ(stats.launches, 2u);
+    EXPECT_EQ(stats.h2d_bytes, 2 * kQ.size() * n * sizeof(uint64_t));
+    EXPECT_EQ(stats.d2h_bytes, stats.h2d_bytes);
+
+    // single limb hooks, out of place and in place
+    std::vector<uint64_t> single(n), inplace = expected[1];
+    ASSERT_TRUE(sim.NttForwardOffload(orig[1].data(), single.data(), kQ[1], n));
+    EXPECT_EQ(single, expected[1]);
+    ASSERT_TRUE(sim.NttInverseOffload(inplace.data(), inplace.data(), kQ[1], n));
+    EXPECT_EQ(inplace, orig[1]);
+}
+
+TEST(UTFpgaSimulator, batched_ntt_runs_match_cpu) {
+    // towers out of device order and past one stream tile: several launches per call, in place
+    const size_t n = 1 << 12;
+    const std::vector<uint64_t> order = {kQ[2], kQ[0], kQ[1], kQ[2], kQ[1], kQ[0], kQ[1]};
+
+    std::vector<uint64_t> qr, pr;
+    for (auto q : kQ) {
+        const NativeInteger psi(FindRoot(q, n));
+        ChineseRemainderTransformFTT<NativeVector>().PreCompute(psi, 2 * n, NativeInteger(q));
+        const NativeVector *table, *precon;
+        ASSERT_TRUE(ChineseRemainderTransformFTT<NativeVector>::GetForwardTablesForVerification(NativeInteger(q), n,
+                                                                                                &table, &precon));
+        qr.push_back((*table)[n / 2].ConvertToInt());  // the psi the CPU uses
+    }
+    for (auto m : kP)
+        pr.push_back(FindRoot(m, n));
+    auto& sim = FpgaSimulator::GetInstance();
+    sim.InitModuli(kQ, kP, qr, pr, n);
+
+    std::vector<std::vector<uint64_t>> data, orig, expected;
+    std::vector<uint64_t*> towers;
+    for (size_t i = 0; i < order.size(); ++i) {
+        data.push_back(Random(n, order[i], 40 + i));
+        NativeVector v(n, NativeInteger(order[i]));
+        for (size_t j = 0; j < n; ++j)
+            v[j] = data.back()[j];
+        const size_t q = std::find(kQ.begin(), kQ.end(), order[i]) - kQ.begin();
+        ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(NativeInteger(qr[q]), 2 * n,
+                                                                                         &v);
+        expected.emplace_back(n);
+        for (size_t j = 0; j < n; ++j)
+            expected.back()[j] = v[j].ConvertToInt();
+    }
+    orig = data;
+    for (auto& d : data)
+        towers.push_back(d.data());
+
+    const auto runs = FpgaManager::PlanLimbRuns({2, 0, 1, 2, 1, 0, 1}, FpgaManager::StreamTileLimbs(n));
+    ASSERT_GT(runs.size(), 1u);
+    sim.ResetTransferStats();
+    ASSERT_TRUE(sim.NttBatchOffload(true, towers.data(), order.data(), order.size(), n));
+    for (size_t i = 0; i < order.size(); ++i)
+        EXPECT_EQ(data[i], expected[i]) << "tower " << i;
+    ASSERT_TRUE(sim.NttBatchOffload(false, towers.data(), order.data(), order.size(), n));
+    EXPECT_EQ(data, orig);
+    EXPECT_EQ(sim.GetTransferStats().launches, 2 * runs.size());
+}
+
+TEST(UTFpgaSimulator, unsupported_shapes_fall_back) {
+    auto& sim = InitSim();
+    std::vector<uint64_t> a(FPGA_RING_DIM, 1), out(FPGA_RING_DIM, 7);
+    const uint64_t unknown = 65537;
+    EXPECT_FALSE(sim.NttForwardOffload(a.data(), out.data(), unknown, FPGA_RING_DIM));
+    EXPECT_FALSE(sim.NttForwardOffload(a.data(), out.data(), kQ[0], FPGA_RING_DIM / 2));
+    EXPECT_FALSE(sim.BConvOffload(a.data(), a.data(), a.data(), out.data(), FPGA_RING_DIM, 0));
+    EXPECT_EQ(out, std::vector<uint64_t>(FPGA_RING_DIM, 7));
+    EXPECT_ANY_THROW(sim.NttForwardOffloadAsync(a.data(), out.data(), unknown, FPGA_RING_DIM).get());
+}
+
+TEST(UTFpgaSimulator, modops_match_cpu) {
+    const size_t n = FPGA_RING_DIM;
+    auto& sim      = InitSim();
+
+    std::vector<std::vector<uint64_t>> a, b, out(kQ.size(), std::vector<uint64_t>(n));
+    std::vector<const uint64_t*> pa, pb;
+    std::vector<uint64_t*> po;
+    for (size_t i = 0; i < kQ.size(); ++i) {
+        a.push_back(Random(n, kQ[i], 20 + i));
+        b.push_back(Random(n, kQ[i], 30 + i));
+    }
+    for (size_t i = 0; i < kQ.size(); ++i) {
+        pa.push_back(a[i].data());
+        pb.push_back(b[i].data());
+        po.push_back(out[i].data());
+    }
+
+    for (int op : {OP_ADD, OP_SUB, OP_MULT}) {
+        ASSERT_TRUE(sim.ModOpOffload(op, pa.data(), pb.data(), po.data(), kQ.data(), kQ.size(), n));
+        for (size_t i = 0; i < kQ.size(); ++i) {
+            const uint64_t q = kQ[i];
+            for (size_t r = 0; r < n; r += 37) {
+                uint64_t x = a[i][r], y = b[i][r];
+                uint64_t expected = op == OP_ADD ? (uint64_t)(((u128)x + y) % q) :
+                                    op == OP_SUB ? (x >= y ? x - y : x + (q - y)) :
+                                                   (uint64_t)((u128)x * y % q);
+                ASSERT_EQ(out[i][r], expected) << "op " << op << " tower " << i << " r " << r;
+            }
+        }
+    }
+}
+
+TEST(UTFpgaSimulator, bconv_matches_cpu) {
+    const size_t n = FPGA_RING_DIM;
+    auto& sim      = InitSim();
+    const int sizeP = 2;
+
+    std::vector<uint64_t> x(PolyAccelerator::KERNEL_LIMB_Q * n);
+    for (int i = 0; i < PolyAccelerator::KERNEL_LIMB_Q; ++i) {
+        auto limb = Random(n, kQ[i], 40 + i);
+        std::copy(limb.begin(), limb.end(), x.begin() + i * n);
+    }
+    std::vector<uint64_t> w(PolyAccelerator::KERNEL_LIMB_Q * PolyAccelerator::KERNEL_MAX_OUT_COLS, 0);
+    for (int i = 0; i < PolyAccelerator::KERNEL_LIMB_Q; ++i)
+        for (int j = 0; j < sizeP; ++j)
+            w[i * PolyAccelerator::KERNEL_MAX_OUT_COLS + j] = Random(1, kP[j], 50 + 5 * i + j)[0];
+
+    std::vector<uint64_t> result(sizeP * n);
+    ASSERT_TRUE(sim.BConvOffload(x.data(), w.data(), kP.data(), result.data(), n, sizeP));
+
+    for (int j = 0; j < sizeP; ++j) {
+        for (size_t r = 0; r < n; r += 41) {
+            u128 sum = 0;
+            for (int i = 0; i < PolyAccelerator::KERNEL_LIMB_Q; ++i)
+                sum += (u128)x[i * n + r] * w[i * PolyAccelerator::KERNEL_MAX_OUT_COLS + j];
+            ASSERT_EQ(result[j * n + r], (uint64_t)(sum % kP[j])) << "tower " << j << " r " << r;
+        }
+
+        // single output tower: same column
+        std::vector<uint64_t> col(PolyAccelerator::KERNEL_LIMB_Q), tower(n);
+        for (int i = 0; i < PolyAccelerator::KERNEL_LIMB_Q; ++i)
+            col[i] = w[i * PolyAccelerator::KERNEL_MAX_OUT_COLS + j];
+        ASSERT_TRUE(sim.BConvTowerOffload(x.data(), col.data(), kP[j], tower.data(), n));
+        EXPECT_TRUE(std::equal(tower.begin(), tower.end(), result.begin() + j * n));
+    }
+}
+
+TEST(UTFpgaSimulator, automorphism_matches_cpu) {
+    const size_t n   = FPGA_RING_DIM;
+    const uint64_t q = kQ[0];
+    auto& sim        = InitSim();
+
+    auto a            = Random(n, q, 60);
+    const uint32_t k  = 5;
+    const uint32_t m  = 2 * n;
+    uint32_t kinv     = 1;
+    while ((uint64_t)kinv * k % m != 1)
+        kinv += 2;
+    std::vector<uint64_t> out(n);
+    ASSERT_TRUE(sim.AutoOffload(a.data(), out.data(), k, kinv, q, n));
+
+    // X^j -> X^{jk}, X^n = -1 (PolyImpl::AutomorphismTransform, COEFFICIENT)
+    std::vector<uint64_t> expected(n);
+    for (uint32_t j = 0, jk = 0; j < n; ++j, jk += k)
+        expected[jk & (n - 1)] = ((jk / n) & 1) ? (a[j] ? q - a[j] : 0) : a[j];
+    EXPECT_EQ(out, expected);
+}
+
+TEST(UTFpgaSimulator, concurrent_and_async_calls_match_serial) {
+    const size_t n = FPGA_RING_DIM;
+    auto& sim      = InitSim();
+
+    const size_t jobs = 8;
+    std::vector<std::vector<uint64_t>> in, serial(jobs, std::vector<uint64_t>(n));
+    for (size_t t = 0; t < jobs; ++t) {
+        in.push_back(Random(n, kQ[t % kQ.size()], 70 + t));
+        ASSERT_TRUE(sim.NttForwardOffload(in[t].data(), serial[t].data(), kQ[t % kQ.size()], n));
+    }
+
+    std::vector<std::vector<uint64_t>> threaded(jobs, std::vector<uint64_t>(n));
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < jobs; ++t)
+        workers.emplace_back([&, t] { sim.NttForwardOffload(in[t].data(), threaded[t].data(), kQ[t % kQ.size()], n); });
+    for (auto& w : workers)
+        w.join();
+    EXPECT_EQ(threaded, serial);
+
+    std::vector<std::vector<uint64_t>> async(jobs, std::vector<uint64_t>(n));
+    std::vector<std::future<void>> pending;
+    for (size_t t = 0; t < jobs; ++t)
+        pending.push_back(sim.NttForwardOffloadAsync(in[t].data(), async[t].data(), kQ[t % kQ.size()], n));
+    sim.Synchronize();
+    for (auto& f : pending)
+        f.get();
+    EXPECT_EQ(async, serial);
+}
+
+TEST(UTFpgaSimulator, hks_digit_matches_cpu) {
+    // OP_HKS_DIGIT against INTT -> x QHatInv -> BConv -> NTT -> key MAC in the CPU (bit-reversed) order,
+    // accumulated over the digits, with fewer Q moduli than the kernel has Q slots as well
+    const size_t n = FPGA_RING_DIM;
+    // a narrow modulus (the 19-bit extra tower of FLEXIBLEAUTOEXT) in the complement of a 59-bit digit is
+    // beyond the kernel's Barrett range: the call must decline and leave the output alone
+    const uint64_t narrow = 557057;
+    struct Case {
+        std::vector<uint64_t> qs;
+        std::vector<std::pair<size_t, size_t>> digits;  // (start, alpha)
+        bool device = true;
+    };
+    const std::vector<uint64_t> q2 = {kQ[0], kQ[1]}, q3 = kQ, qn = {kQ[0], kQ[1], narrow};
+    const std::vector<Case> cases = {{q2, {{0, 1}}},         {q2, {{1, 1}}},         {q2, {{0, 2}}},
+                                     {q2, {{0, 1}, {1, 1}}}, {q3, {{1, 1}}},         {q3, {{0, 2}}},
+                                     {q3, {{1, 2}}},         {q3, {{0, 2}, {2, 1}}}, {q3, {{0, 1}, {1, 1}, {2, 1}}},
+                                     {qn, {{0, 2}, {2, 1}}, false}};
+    for (const Case& c : cases) {
+        const std::vector<uint64_t>& qs = c.qs;
+        const size_t numQ               = qs.size();
+        std::vector<uint64_t> all = qs, roots;
+        all.insert(all.end(), kP.begin(), kP.end());
+        for (auto q : all) {
+            ChineseRemainderTransformFTT<NativeVector>().PreCompute(NativeInteger(FindRoot(q, n)), 2 * n,
+                                                                    NativeInteger(q));
+            const NativeVector *table, *precon;
+            ASSERT_TRUE(ChineseRemainderTransformFTT<NativeVector>::GetForwardTablesForVerification(NativeInteger(q), n,
+                                                                                                    &table, &precon));
+            roots.push_back((*table)[n / 2].ConvertToInt());  // the psi the CPU uses
+        }
+        auto& sim = FpgaSimulator::GetInstance();
+        sim.InitModuli(qs, kP, {roots.begin(), roots.begin() + numQ}, {roots.begin() + numQ, roots.end()}, n);
+
+        auto cpuNtt = [&](const std::vector<uint64_t>& in, size_t e, bool forward) {
+            NativeVector v(n, NativeInteger(all[e]));
+            for (size_t j = 0; j < n; ++j)
+                v[j] = in[j];
+            if (forward)
+                ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(roots[e], 2 * n, &v);
+            else
+                ChineseRemainderTransformFTT<NativeVector>().InverseTransformFromBitReverseInPlace(roots[e], 2 * n,
+                                                                                                   &v);
+            std::vector<uint64_t> out(n);
+            for (size_t j = 0; j < n; ++j)
+                out[j] = v[j].ConvertToInt();
+            return out;
+        };
+
+        const size_t sizeQlP = all.size();
+        std::mt19937_64 rng(numQ * 16 + c.digits.size());
+        std::vector<std::vector<uint64_t>> expected0(sizeQlP, std::vector<uint64_t>(n, 0)), expected1 = expected0;
+
+        // per digit: towers, QHat tables and keys, kept alive until the offload
+        struct Digit {
+            std::vector<std::vector<uint64_t>> towers, kb, ka;
+            std::vector<const uint64_t*> towers_p, kb_p, ka_p;
+            std::vector<uint64_t> qhat_inv, qhat_mod;
+        };
+        std::vector<Digit> digits(c.digits.size());
+        std::vector<PolyAccelerator::HksDigit> hks;
+        for (size_t dj = 0; dj < c.digits.size(); ++dj) {
+            const size_t start = c.digits[dj].first, alpha = c.digits[dj].second, sizeCompl = sizeQlP - alpha;
+            Digit& d           = digits[dj];
+            std::vector<size_t> compl_idx;
+            for (size_t e = 0; e < sizeQlP; ++e)
+                if (e < start || e >= start + alpha)
+                    compl_idx.push_back(e);
+
+            d.qhat_inv.resize(alpha);
+            d.qhat_mod.resize(alpha * sizeCompl);
+            for (size_t i = 0; i < alpha; ++i) {
+                d.towers.push_back(Random(n, all[start + i], rng()));
+                d.qhat_inv[i] = rng() % all[start + i];
+                for (size_t k = 0; k < sizeCompl; ++k)
+                    d.qhat_mod[i * sizeCompl + k] = rng() % all[compl_idx[k]];
+            }
+            for (size_t e = 0; e < sizeQlP; ++e) {
+                d.kb.push_back(Random(n, all[e], rng()));
+                d.ka.push_back(Random(n, all[e], rng()));
+            }
+            for (auto& v : d.towers)
+                d.towers_p.push_back(v.data());
+            for (size_t e = 0; e < sizeQlP; ++e) {
+                d.kb_p.push_back(d.kb[e].data());
+                d.ka_p.push_back(d.ka[e].data());
+            }
+            hks.push_back({d.towers_p.data(), alpha, start, d.qhat_inv.data(), d.qhat_mod.data(), d.kb_p.data(),
+                           d.ka_p.data()});
+
+            // CPU reference: the digit itself on its towers, the extended digit on the complement
+            std::vector<std::vector<uint64_t>> ext(sizeQlP), coef(alpha);
+            for (size_t i = 0; i < alpha; ++i) {
+                ext[start + i] = d.towers[i];
+                coef[i]        = cpuNtt(d.towers[i], start + i, false);
+                for (auto& x : coef[i])
+                    x = (uint64_t)((u128)x * d.qhat_inv[i] % all[start + i]);
+            }
+            for (size_t k = 0; k < sizeCompl; ++k) {
+                const size_t e = compl_idx[k];
+                std::vector<uint64_t> y(n);
+                for (size_t j = 0; j < n; ++j) {
+                    u128 acc = 0;
+                    for (size_t i = 0; i < alpha; ++i)
+                        acc += (u128)coef[i][j] * d.qhat_mod[i * sizeCompl + k];
+                    y[j] = (uint64_t)(acc % all[e]);
+                }
+                ext[e] = cpuNtt(y, e, true);
+            }
+            for (size_t e = 0; e < sizeQlP; ++e) {
+                for (size_t j = 0; j < n; ++j) {
+                    expected0[e][j] = (uint64_t)((expected0[e][j] + (u128)ext[e][j] * d.kb[e][j]) % all[e]);
+                    expected1[e][j] = (uint64_t)((expected1[e][j] + (u128)ext[e][j] * d.ka[e][j]) % all[e]);
+                }
+            }
+        }
+
+        std::vector<std::vector<uint64_t>> out0(sizeQlP, std::vector<uint64_t>(n)), out1 = out0;
+        std::vector<uint64_t*> out0_p, out1_p;
+        for (size_t e = 0; e < sizeQlP; ++e) {
+            out0_p.push_back(out0[e].data());
+            out1_p.push_back(out1[e].data());
+        }
+        if (!c.device) {
+            EXPECT_FALSE(sim.HksFusedOffload(hks, all.data(), sizeQlP, out0_p.data(), out1_p.data(), n));
+            EXPECT_EQ(out0[0], std::vector<uint64_t>(n, 0));
+            continue;
+        }
+        ASSERT_TRUE(sim.HksFusedOffload(hks, all.data(), sizeQlP, out0_p.data(), out1_p.data(), n));
+        for (size_t e = 0; e < sizeQlP; ++e) {
+            EXPECT_EQ(out0[e], expected0[e]) << "numQ " << numQ << " digits " << c.digits.size() << " tower " << e;
+            EXPECT_EQ(out1[e], expected1[e]) << "numQ " << numQ << " digits " << c.digits.size() << " tower " << e;
+        }
+    }
+}
+
+#endif  // OPENFHE_FPGA_SIM
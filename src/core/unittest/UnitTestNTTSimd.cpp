@@ -0,0 +1,370 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  This code checks the runtime-dispatched SIMD NTT kernels: every instruction
+  set the CPU supports must give the same transform as the scalar kernel, and
+  the blocked multi-tower engine must match the unblocked per-tower transform.
+  It also checks the lazy-reduction key multiply-accumulate (with a stored or
+  expanded from a seed) and the blocked basis conversion against plain 128-bit
+  modular arithmetic.
+ */
+
+#include "gtest/gtest.h"
+#include <random>
+#include <string>
+#include <vector>
+
+#include "OffloadDispatcher.h"
+#include "lattice/lat-hal.h"
+#include "math/distrgen.h"
+#include "math/hal/intnat/ntt-simd.h"
+#include "math/nbtheory.h"
+
+using namespace lbcrypto;
+using intnat::NttIsa;
+
+namespace {
+
+std::shared_ptr<ILNativeParams> MakeParams(uint32_t m, uint32_t bits) {
+    NativeInteger q    = LastPrime<NativeInteger>(bits, m);
+    NativeInteger root = RootOfUnity<NativeInteger>(m, q);
+    return std::make_shared<ILNativeParams>(m, q, root);
+}
+
+// schoolbook product mod X^n + 1
+NativePoly NegacyclicProduct(const NativePoly& a, const NativePoly& b) {
+    const uint32_t n = a.GetLength();
+    const auto& q    = a.GetModulus();
+    NativePoly c(a.GetParams(), Format::COEFFICIENT, true);
+    for (uint32_t i = 0; i < n; ++i) {
+        for (uint32_t j = 0; j < n; ++j) {
+            auto prod = a[i].ModMul(b[j], q);
+            if (i + j < n)
+                c[i + j].ModAddEq(prod, q);
+            else
+                c[i + j - n].ModSubEq(prod, q);
+        }
+    }
+    return c;
+}
+
+}  // namespace
+
+class UTNTTSimd : public ::testing::Test {
+protected:
+    void TearDown() override {
+        intnat::SetNttIsa(m_isa);
+        intnat::SetNttBlockSize(m_block);
+    }
+
+    static std::vector<NttIsa> Supported() {
+        std::vector<NttIsa> isas;
+        for (NttIsa isa : {NttIsa::SCALAR, NttIsa::AVX2, NttIsa::AVX512IFMA}) {
+            if (intnat::NttIsaSupported(isa))
+                isas.push_back(isa);
+        }
+        return isas;
+    }
+
+    NttIsa m_isa   = intnat::GetNttIsa();
+    size_t m_block = intnat::GetNttBlockSize();
+    // 只测主机内核，不让钩子走到加速器
+    OffloadDispatcher::ScopedCpuOnly m_cpuOnly;
+};
+
+TEST_F(UTNTTSimd, set_isa_clamps_to_cpu) {
+    EXPECT_EQ(intnat::SetNttIsa(NttIsa::SCALAR), NttIsa::SCALAR);
+    EXPECT_EQ(intnat::GetNttIsa(), NttIsa::SCALAR);
+
+    const NttIsa best = Supported().back();
+    EXPECT_EQ(intnat::SetNttIsa(NttIsa::AVX512IFMA), best);
+    EXPECT_EQ(intnat::GetNttIsa(), best);
+}
+
+// IFMA covers q < 2^50; the 55/60-bit moduli take the AVX2 kernel instead
+TEST_F(UTNTTSimd, negacyclic_product_every_isa) {
+    const uint32_t m = 512;
+    for (uint32_t bits : {28u, 49u, 55u, 60u}) {
+        auto params = MakeParams(m, bits);
+        DiscreteUniformGeneratorImpl<NativeVector> dug;
+        NativePoly a(dug, params, Format::COEFFICIENT);
+        NativePoly b(dug, params, Format::COEFFICIENT);
+        const NativePoly expected = NegacyclicProduct(a, b);
+
+        for (NttIsa isa : Supported()) {
+            intnat::SetNttIsa(isa);
+            NativePoly x(a), y(b);
+            x.SwitchFormat();
+            y.SwitchFormat();
+            NativePoly z = x * y;
+            z.SwitchFormat();
+            EXPECT_EQ(z, expected) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+        }
+    }
+}
+
+TEST_F(UTNTTSimd, isas_agree_bit_for_bit) {
+    const uint32_t m = 8192;
+    for (uint32_t bits : {28u, 49u, 55u, 60u}) {
+        auto params = MakeParams(m, bits);
+        DiscreteUniformGeneratorImpl<NativeVector> dug;
+        const NativePoly a(dug, params, Format::COEFFICIENT);
+
+        intnat::SetNttIsa(NttIsa::SCALAR);
+        NativePoly reference(a);
+        reference.SwitchFormat();
+
+        for (NttIsa isa : Supported()) {
+            intnat::SetNttIsa(isa);
+            NativePoly x(a);
+            x.SwitchFormat();
+            EXPECT_EQ(x, reference) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+            x.SwitchFormat();
+            EXPECT_EQ(x, a) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+        }
+    }
+}
+
+// n = 4096 split into 16..256-element blocks: the column phase then spans 4..256 rows
+TEST_F(UTNTTSimd, blocked_dcrtpoly_matches_per_tower) {
+    const uint32_t m = 8192;
+    for (uint32_t bits : {49u, 60u}) {
+        auto params = std::make_shared<ILDCRTParams<BigInteger>>(m, 3, bits);
+        DiscreteUniformGeneratorImpl<NativeVector> dug;
+        const DCRTPoly a(dug, params, Format::COEFFICIENT);
+
+        // unblocked, one tower at a time
+        intnat::SetNttBlockSize(m);
+        std::vector<NativePoly> reference;
+        for (size_t i = 0; i < a.GetNumOfElements(); ++i) {
+            reference.push_back(a.GetElementAtIndex(i));
+            reference.back().SwitchFormat();
+        }
+
+        for (NttIsa isa : Supported()) {
+            intnat::SetNttIsa(isa);
+            for (size_t block : {16u, 64u, 256u}) {
+                EXPECT_EQ(intnat::SetNttBlockSize(block), block);
+                const std::string msg =
+                    std::string(intnat::NttIsaName(isa)) + ", block " + std::to_string(block) + ", " +
+                    std::to_string(bits) + " bits";
+                DCRTPoly x(a);
+                x.SwitchFormat();
+                ASSERT_EQ(x.GetFormat(), Format::EVALUATION) << msg;
+                for (size_t i = 0; i < x.GetNumOfElements(); ++i) {
+                    EXPECT_EQ(x.GetElementAtIndex(i), reference[i]) << msg << ", tower " << i;
+                }
+                x.SwitchFormat();
+                EXPECT_EQ(x, a) << msg;
+            }
+        }
+    }
+}
+
+// n = 61 leaves a scalar tail for every vector width; 300 terms at 60 bits take two 128-bit chunks
+TEST_F(UTNTTSimd, key_mac_every_isa) {
+    const size_t n = 61;
+    std::mt19937_64 rng(42);
+    for (uint32_t bits : {28u, 49u, 55u, 60u}) {
+        const uint64_t q = LastPrime<NativeInteger>(bits, 128).ConvertToInt();
+        for (size_t numTerms : {1u, 3u, 300u}) {
+            std::vector<std::vector<uint64_t>> c(numTerms), b(numTerms), a(numTerms);
+            std::vector<intnat::MacTerm> terms(numTerms);
+            std::vector<uint64_t> expected0(n, 0), expected1(n, 0);
+            for (size_t j = 0; j < numTerms; ++j) {
+                for (auto* v : {&c[j], &b[j], &a[j]}) {
+                    v->resize(n);
+                    for (auto& x : *v)
+                        x = rng() % q;
+                }
+                terms[j] = {c[j].data(), b[j].data(), a[j].data()};
+                for (size_t k = 0; k < n; ++k) {
+                    expected0[k] = NativeInteger(expected0[k])
+                                       .ModAdd(NativeInteger(c[j][k]).ModMul(NativeInteger(b[j][k]), q), q)
+                                       .ConvertToInt();
+                    expected1[k] = NativeInteger(expected1[k])
+                                       .ModAdd(NativeInteger(c[j][k]).ModMul(NativeInteger(a[j][k]), q), q)
+                                       .ConvertToInt();
+                }
+            }
+
+            for (NttIsa isa : Supported()) {
+                intnat::SetNttIsa(isa);
+                std::vector<uint64_t> out0(n, 1), out1(n, 1);
+                ASSERT_TRUE(intnat::KeyMacLazy(terms, n, q, out0.data(), out1.data()));
+                const std::string msg = std::string(intnat::NttIsaName(isa)) + ", " + std::to_string(bits) +
+                                        " bits, " + std::to_string(numTerms) + " terms";
+                EXPECT_EQ(out0, expected0) << msg;
+                EXPECT_EQ(out1, expected1) << msg;
+            }
+        }
+    }
+}
+
+// digits over Ql·P, keys over Q·P: tower 2 of the keys has no digit tower
+TEST_F(UTNTTSimd, key_mult_accumulate_matches_modmul) {
+    const uint32_t m = 2048;
+    for (uint32_t bits : {49u, 60u}) {
+        auto keyParams = std::make_shared<ILDCRTParams<BigInteger>>(m, 5, bits);
+        const auto& p  = keyParams->GetParams();
+        auto digitParams = std::make_shared<ILDCRTParams<BigInteger>>(
+            m, std::vector<std::shared_ptr<ILNativeParams>>{p[0], p[1], p[3], p[4]});
+        const uint32_t sizeQl = 2;
+
+        DiscreteUniformGeneratorImpl<NativeVector> dug;
+        std::vector<DCRTPoly> digits, bv, av;
+        for (size_t j = 0; j < 3; ++j) {
+            digits.emplace_back(dug, digitParams, Format::EVALUATION);
+            bv.emplace_back(dug, keyParams, Format::EVALUATION);
+            av.emplace_back(dug, keyParams, Format::EVALUATION);
+        }
+
+        DCRTPoly expected0(digitParams, Format::EVALUATION, true), expected1(digitParams, Format::EVALUATION, true);
+        for (size_t j = 0; j < digits.size(); ++j) {
+            for (size_t i = 0; i < 4; ++i) {
+                const size_t k = (i < sizeQl) ? i : i + 1;
+                const auto& ci = digits[j].GetElementAtIndex(i);
+                expected0.SetElementAtIndex(i, expected0.GetElementAtIndex(i) + ci * bv[j].GetElementAtIndex(k));
+                expected1.SetElementAtIndex(i, expected1.GetElementAtIndex(i) + ci * av[j].GetElementAtIndex(k));
+            }
+        }
+
+        for (NttIsa isa : Supported()) {
+            intnat::SetNttIsa(isa);
+            DCRTPoly out0(digitParams, Format::EVALUATION, true), out1(digitParams, Format::EVALUATION, true);
+            DCRTPoly::KeyMultAccumulate(digits, bv, av, sizeQl, out0, out1);
+            EXPECT_EQ(out0, expected0) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+            EXPECT_EQ(out1, expected1) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+        }
+    }
+}
+
+// a expanded from a seed: deterministic per (seed, stream, tower index), and the
+// seeded multiply-accumulate equals the one over the expanded a
+TEST_F(UTNTTSimd, key_mult_accumulate_with_seeded_a) {
+    const uint32_t m = 2048;
+    for (uint32_t bits : {49u, 60u}) {
+        auto keyParams = std::make_shared<ILDCRTParams<BigInteger>>(m, 5, bits);
+        const auto& p  = keyParams->GetParams();
+        auto digitParams = std::make_shared<ILDCRTParams<BigInteger>>(
+            m, std::vector<std::shared_ptr<ILNativeParams>>{p[0], p[1], p[3], p[4]});
+        auto prefixParams =
+            std::make_shared<ILDCRTParams<BigInteger>>(m, std::vector<std::shared_ptr<ILNativeParams>>{p[0], p[1]});
+        const uint32_t sizeQl = 2;
+
+        const PRNGSeed seed = SeedUniformGenerator::GenerateSeed();
+        EXPECT_EQ(DCRTPoly::FromSeed(keyParams, seed, 0), DCRTPoly::FromSeed(keyParams, seed, 0));
+        EXPECT_NE(DCRTPoly::FromSeed(keyParams, seed, 0), DCRTPoly::FromSeed(keyParams, seed, 1));
+        EXPECT_NE(DCRTPoly::FromSeed(keyParams, seed, 0),
+                  DCRTPoly::FromSeed(keyParams, SeedUniformGenerator::GenerateSeed(), 0));
+        const auto prefix = DCRTPoly::FromSeed(prefixParams, seed, 2);
+        const auto full   = DCRTPoly::FromSeed(keyParams, seed, 2);
+        for (size_t i = 0; i < 2; ++i)
+            EXPECT_EQ(prefix.GetElementAtIndex(i), full.GetElementAtIndex(i)) << "tower " << i;
+
+        DiscreteUniformGeneratorImpl<NativeVector> dug;
+        std::vector<DCRTPoly> digits, bv, av;
+        for (uint32_t j = 0; j < 3; ++j) {
+            digits.emplace_back(dug, digitParams, Format::EVALUATION);
+            bv.emplace_back(dug, keyParams, Format::EVALUATION);
+            av.push_back(DCRTPoly::FromSeed(keyParams, seed, j));
+        }
+
+        for (NttIsa isa : Supported()) {
+            intnat::SetNttIsa(isa);
+            DCRTPoly expected0(digitParams, Format::EVALUATION, true), expected1(digitParams, Format::EVALUATION, true);
+            DCRTPoly::KeyMultAccumulate(digits, bv, av, sizeQl, expected0, expected1);
+            DCRTPoly out0(digitParams, Format::EVALUATION, true), out1(digitParams, Format::EVALUATION, true);
+            DCRTPoly::KeyMultAccumulate(digits, bv, seed, sizeQl, out0, out1);
+            EXPECT_EQ(out0, expected0) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+            EXPECT_EQ(out1, expected1) << intnat::NttIsaName(isa) << ", " << bits << " bits";
+        }
+    }
+}
+
+// n = 300 gives one full 256-column block and a partial one with a scalar tail;
+// sizeP = 7 splits into an output group of 4 and one of 3
+TEST_F(UTNTTSimd, bconv_every_isa) {
+    const size_t n = 300;
+    std::mt19937_64 rng(7);
+    for (uint32_t bits : {28u, 49u, 60u}) {
+        for (size_t sizeQ : {1u, 5u, 13u}) {
+            for (size_t sizeP : {1u, 3u, 7u}) {
+                intnat::BConvParams params;
+                NativeInteger prime = LastPrime<NativeInteger>(bits, 128);
+                for (size_t i = 0; i < sizeQ + sizeP; ++i) {
+                    (i < sizeQ ? params.q : params.p).push_back(prime.ConvertToInt());
+                    prime = PreviousPrime<NativeInteger>(prime, 128);
+                }
+                std::vector<std::vector<uint64_t>> x(sizeQ);
+                std::vector<const uint64_t*> px(sizeQ);
+                for (size_t i = 0; i < sizeQ; ++i) {
+                    const uint64_t q = params.q[i];
+                    const NativeInteger w(rng() % q);
+                    params.qHatInv.push_back(w.ConvertToInt());
+                    params.qHatInvPrecon.push_back(w.PrepModMulConst(q).ConvertToInt());
+                    for (size_t j = 0; j < sizeP; ++j)
+                        params.qHatModp.push_back(rng() % params.p[j]);
+                    x[i].resize(n);
+                    for (auto& v : x[i])
+                        v = rng() % q;
+                    px[i] = x[i].data();
+                }
+
+                std::vector<std::vector<uint64_t>> expected(sizeP, std::vector<uint64_t>(n, 0));
+                for (size_t i = 0; i < sizeQ; ++i) {
+                    for (size_t k = 0; k < n; ++k) {
+                        const uint64_t s = static_cast<uint64_t>(static_cast<unsigned __int128>(x[i][k]) *
+                                                                 params.qHatInv[i] % params.q[i]);
+                        for (size_t j = 0; j < sizeP; ++j) {
+                            const uint64_t p = params.p[j];
+                            const uint64_t t = static_cast<uint64_t>(
+                                static_cast<unsigned __int128>(s) * params.qHatModp[i * sizeP + j] % p);
+                            expected[j][k]   = (expected[j][k] + t) % p;
+                        }
+                    }
+                }
+
+                for (NttIsa isa : Supported()) {
+                    intnat::SetNttIsa(isa);
+                    std::vector<std::vector<uint64_t>> y(sizeP, std::vector<uint64_t>(n, 1));
+                    std::vector<uint64_t*> py(sizeP);
+                    for (size_t j = 0; j < sizeP; ++j)
+                        py[j] = y[j].data();
+                    ASSERT_TRUE(intnat::BConvLazy(params, px.data(), py.data(), n));
+                    EXPECT_EQ(y, expected) << intnat::NttIsaName(isa) << ", " << bits << " bits, " << sizeQ << " x "
+                                           << sizeP;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,300 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+
+/*
+  This code tests the offload cost model and the CPU / accelerator dispatcher,
+  using the in-process simulator as the device.
+ */
+
+#ifdef OPENFHE_FPGA_SIM
+
+#include "gtest/gtest.h"
+#include <map>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "FpgaSimulator.h"
+#include "OffloadDispatcher.h"
+#include "math/math-hal.h"
+#include "math/nbtheory.h"
+#include "utils/parallel.h"
+
+using namespace lbcrypto;
+
+namespace {
+
+const size_t kN = 1 << 13;  // OP_NTT_STREAM, bit-identical to the CPU NTT
+
+const std::vector<uint64_t> kQ = {576460752300015617ULL, 576460752298835969ULL, 576460752298180609ULL};
+const std::vector<uint64_t> kP = {576460752289923073ULL, 576460752289529857ULL};
+
+std::vector<uint64_t> Random(size_t n, uint64_t q, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> v(n);
+    for (auto& x : v)
+        x = rng() % q;
+    return v;
+}
+
+// 2kN-th root of unity, fixed per modulus for the whole run
+NativeInteger Root(uint64_t q) {
+    static std::map<uint64_t, NativeInteger> roots;
+    auto it = roots.find(q);
+    if (it == roots.end())
+        it = roots.emplace(q, RootOfUnity<NativeInteger>(2 * kN, NativeInteger(q))).first;
+    return it->second;
+}
+
+std::vector<uint64_t> CpuNtt(const std::vector<uint64_t>& a, uint64_t q) {
+    NativeInteger modulus(q);
+    NativeVector v(a.size(), modulus);
+    for (size_t i = 0; i < a.size(); ++i)
+        v[i] = a[i];
+    ChineseRemainderTransformFTT<NativeVector>().ForwardTransformToBitReverseInPlace(Root(q), 2 * kN, &v);
+    std::vector<uint64_t> out(a.size());
+    for (size_t i = 0; i < a.size(); ++i)
+        out[i] = v[i].ConvertToInt();
+    return out;
+}
+
+// one thread and a model whose NTT break-even at kN is exactly 3 limbs:
+// CPU 53.2 us / limb, device 100 us + 13.3 us / limb
+class UTOffloadDispatcher : public ::testing::Test {
+protected:
+    void SetUp() override {
+        OpenFHEParallelControls.Disable();
+
+        std::vector<uint64_t> qr, pr;
+        for (auto q : kQ) {
+            ChineseRemainderTransformFTT<NativeVector>().PreCompute(Root(q), 2 * kN, NativeInteger(q));
+            qr.push_back(Root(q).ConvertToInt());
+        }
+        for (auto p : kP)
+            pr.push_back(Root(p).ConvertToInt());
+        sim = &FpgaSimulator::GetInstance();
+        sim->InitModuli(kQ, kP, qr, pr, kN);
+
+        // the simulator is a process-wide singleton: do not let the dispatcher own it
+        dispatcher = std::make_unique<OffloadDispatcher>(std::shared_ptr<PolyAccelerator>(sim, [](PolyAccelerator*) {}));
+        dispatcher->SetPolicy(OffloadPolicy::AUTO);
+        model.h2d_bytes_per_s        = 1e15;
+        model.d2h_bytes_per_s        = 1e15;
+        model.launch_latency_s       = 100e-6;
+        model.device_butterfly_per_s = 4e9;
+        model.cpu_butterfly_per_s    = 1e9;
+        dispatcher->SetCostModel(model);
+    }
+
+    void TearDown() override {
+        dispatcher.reset();
+        OpenFHEParallelControls.Enable();
+    }
+
+    FpgaSimulator* sim = nullptr;
+    std::unique_ptr<OffloadDispatcher> dispatcher;
+    OffloadCostModel model;
+};
+
+}  // namespace
+
+TEST_F(UTOffloadDispatcher, cost_model_predictions) {
+    const double butterflies = 0.5 * kN * 13;
+    EXPECT_NEAR(model.CpuSeconds(AccelOp::NTT, kN, 4, 1), 4 * butterflies / 1e9, 1e-12);
+    EXPECT_NEAR(model.CpuSeconds(AccelOp::NTT, kN, 4, 2), 2 * butterflies / 1e9, 1e-12);
+    // more threads than limbs do not help
+    EXPECT_DOUBLE_EQ(model.CpuSeconds(AccelOp::NTT, kN, 2, 8), model.CpuSeconds(AccelOp::NTT, kN, 2, 2));
+
+    EXPECT_NEAR(model.DeviceSeconds(AccelOp::NTT, kN, 4), 100e-6 + 4 * butterflies / 4e9, 1e-9);
+    EXPECT_NEAR(model.DeviceSeconds(AccelOp::NTT, kN, 4, 3) - model.DeviceSeconds(AccelOp::NTT, kN, 4), 200e-6,
+                1e-12);
+
+    // BConv ships its KERNEL_LIMB_Q input towers once, however many outputs there are
+    OffloadCostModel slowLink;
+    slowLink.h2d_bytes_per_s = 1e6;
+    const double input       = kN * sizeof(uint64_t) * PolyAccelerator::KERNEL_LIMB_Q / 1e6;
+    EXPECT_GT(slowLink.DeviceSeconds(AccelOp::BCONV, kN, 1), input);
+    EXPECT_LT(slowLink.DeviceSeconds(AccelOp::BCONV, kN, 5), 2 * input);
+}
+
+TEST_F(UTOffloadDispatcher, decide_at_break_even) {
+    ASSERT_EQ(dispatcher->BreakEvenLimbs(AccelOp::NTT, kN), 3u);
+    EXPECT_FALSE(dispatcher->Decide(AccelOp::NTT, kN, 2));
+    EXPECT_TRUE(dispatcher->Decide(AccelOp::NTT, kN, 3));
+
+    const OffloadOpStats s = dispatcher->GetStats()[AccelOp::NTT];
+    EXPECT_EQ(s.cpu_calls, 1u);
+    EXPECT_EQ(s.device_calls, 1u);
+    EXPECT_EQ(s.limbs, 5u);
+    EXPECT_NEAR(s.predicted_cpu_s, model.CpuSeconds(AccelOp::NTT, kN, 2) + model.CpuSeconds(AccelOp::NTT, kN, 3),
+                1e-12);
+    EXPECT_NEAR(s.predicted_chosen_s,
+                model.CpuSeconds(AccelOp::NTT, kN, 2) + model.DeviceSeconds(AccelOp::NTT, kN, 3), 1e-12);
+    EXPECT_LT(s.predicted_chosen_s, std::min(s.predicted_cpu_s, s.predicted_device_s));
+
+    dispatcher->ResetStats();
+    EXPECT_EQ(dispatcher->GetStats()[AccelOp::NTT].limbs, 0u);
+
+    // a device that never pays off
+    OffloadCostModel slow = model;
+    slow.device_butterfly_per_s = 1e8;
+    dispatcher->SetCostModel(slow);
+    EXPECT_EQ(dispatcher->BreakEvenLimbs(AccelOp::NTT, kN), 0u);
+}
+
+TEST_F(UTOffloadDispatcher, policies_and_declines) {
+    auto a           = Random(kN, kQ[0], 1);
+    auto data        = a;
+    uint64_t* tower[] = {data.data()};
+
+    // AUTO, one limb: the CPU is faster, nothing is touched
+    sim->ResetTransferStats();
+    EXPECT_FALSE(dispatcher->NttBatchOffload(true, tower, &kQ[0], 1, kN));
+    EXPECT_EQ(data, a);
+
+    dispatcher->SetPolicy(OffloadPolicy::NEVER);
+    EXPECT_FALSE(dispatcher->NttBatchOffload(true, tower, &kQ[0], 1, kN));
+    EXPECT_EQ(sim->GetTransferStats().launches, 0u);
+
+    dispatcher->SetPolicy(OffloadPolicy::ALWAYS);
+    {
+        OffloadDispatcher::ScopedCpuOnly cpuOnly;
+        EXPECT_FALSE(dispatcher->NttBatchOffload(true, tower, &kQ[0], 1, kN));
+    }
+    ASSERT_TRUE(dispatcher->NttBatchOffload(true, tower, &kQ[0], 1, kN));
+    EXPECT_EQ(data, CpuNtt(a, kQ[0]));
+    EXPECT_EQ(sim->GetTransferStats().launches, 1u);
+
+    // chosen for the device but not on it: counted as declined
+    const uint64_t unknown = 65537;
+    EXPECT_FALSE(dispatcher->NttBatchOffload(true, tower, &unknown, 1, kN));
+
+    const auto stats = dispatcher->GetStats();
+    EXPECT_EQ(stats[AccelOp::NTT].cpu_calls, 2u);
+    EXPECT_EQ(stats[AccelOp::NTT].device_calls, 2u);
+    EXPECT_EQ(stats[AccelOp::NTT].declined, 1u);
+}
+
+TEST_F(UTOffloadDispatcher, async_ntts_are_batched) {
+    ASSERT_TRUE(OffloadDispatcher::GetCpuTransform());
+    sim->ResetTransferStats();
+
+    std::vector<std::vector<uint64_t>> in, out(kQ.size(), std::vector<uint64_t>(kN));
+    std::vector<std::future<void>> pending;
+    for (size_t i = 0; i < kQ.size(); ++i) {
+        in.push_back(Random(kN, kQ[i], 10 + i));
+        pending.push_back(dispatcher->NttForwardOffloadAsync(in[i].data(), out[i].data(), kQ[i], kN));
+        // below the break-even the towers wait; the third one fills the batch and launches it
+        EXPECT_EQ(dispatcher->GetStats().batches, i + 1 < kQ.size() ? 0u : 1u);
+    }
+    EXPECT_EQ(sim->GetTransferStats().launches, 1u);
+    for (auto& f : pending)
+        f.get();
+    for (size_t i = 0; i < kQ.size(); ++i)
+        EXPECT_EQ(out[i], CpuNtt(in[i], kQ[i])) << "tower " << i;
+
+    // two towers never reach the break-even: waiting runs them on the CPU
+    pending.clear();
+    for (size_t i = 0; i < 2; ++i)
+        pending.push_back(dispatcher->NttInverseOffloadAsync(out[i].data(), out[i].data(), kQ[i], kN));
+    for (auto& f : pending)
+        f.get();
+    for (size_t i = 0; i < 2; ++i)
+        EXPECT_EQ(out[i], in[i]) << "tower " << i;
+
+    const auto stats = dispatcher->GetStats();
+    EXPECT_EQ(stats.batches, 2u);
+    EXPECT_EQ(stats.batched_limbs, 5u);
+    EXPECT_EQ(stats[AccelOp::NTT].device_calls, 1u);
+    EXPECT_EQ(stats[AccelOp::NTT].cpu_calls, 1u);
+    EXPECT_EQ(sim->GetTransferStats().launches, 1u);
+}
+
+TEST_F(UTOffloadDispatcher, async_batches_are_per_thread_and_owned_by_their_futures) {
+    // a dropped future still runs its towers
+    std::vector<uint64_t> in = Random(kN, kQ[0], 20), out(kN);
+    dispatcher->NttForwardOffloadAsync(in.data(), out.data(), kQ[0], kN);
+    EXPECT_EQ(out, CpuNtt(in, kQ[0]));
+    EXPECT_EQ(dispatcher->GetStats().batches, 1u);
+
+    // towers submitted on another thread do not join this thread's batch
+    std::vector<uint64_t> mine = Random(kN, kQ[1], 21), theirs = Random(kN, kQ[2], 22);
+    std::vector<uint64_t> mineOut(kN), theirsOut(kN);
+    auto pending = dispatcher->NttForwardOffloadAsync(mine.data(), mineOut.data(), kQ[1], kN);
+    std::thread other([&] {
+        dispatcher->NttForwardOffloadAsync(theirs.data(), theirsOut.data(), kQ[2], kN).get();
+    });
+    other.join();
+    EXPECT_EQ(theirsOut, CpuNtt(theirs, kQ[2]));
+    EXPECT_EQ(dispatcher->GetStats().batches, 2u);
+    pending.get();
+    EXPECT_EQ(mineOut, CpuNtt(mine, kQ[1]));
+    EXPECT_EQ(dispatcher->GetStats().batched_limbs, 3u);
+}
+
+TEST_F(UTOffloadDispatcher, calibrates_once) {
+    std::vector<uint64_t> qr, pr;
+    for (auto q : kQ)
+        qr.push_back(Root(q).ConvertToInt());
+    for (auto p : kP)
+        pr.push_back(Root(p).ConvertToInt());
+    OffloadDispatcher fresh(std::shared_ptr<PolyAccelerator>(sim, [](PolyAccelerator*) {}));
+    fresh.SetPolicy(OffloadPolicy::AUTO);
+    fresh.InitModuli(kQ, kP, qr, pr, kN);
+    const OffloadCostModel first = fresh.GetCostModel();
+    EXPECT_TRUE(first.calibrated);
+
+    // loading the moduli again keeps the measured model
+    fresh.InitModuli(kQ, kP, qr, pr, kN);
+    EXPECT_EQ(fresh.GetCostModel().cpu_butterfly_per_s, first.cpu_butterfly_per_s);
+    EXPECT_EQ(fresh.GetCostModel().launch_latency_s, first.launch_latency_s);
+}
+
+TEST_F(UTOffloadDispatcher, calibration_measures_both_sides) {
+    auto calibrated = dispatcher->Calibrate(kQ[0], kN);
+    EXPECT_TRUE(calibrated.calibrated);
+    EXPECT_GT(calibrated.cpu_butterfly_per_s, 0);
+    EXPECT_GT(calibrated.cpu_elem_per_s, 0);
+    EXPECT_GT(calibrated.h2d_bytes_per_s, 0);
+    EXPECT_GT(calibrated.d2h_bytes_per_s, 0);
+    EXPECT_GT(calibrated.device_butterfly_per_s, 0);
+    // the measured rates replace the configured ones
+    EXPECT_NE(calibrated.cpu_butterfly_per_s, model.cpu_butterfly_per_s);
+    EXPECT_EQ(dispatcher->GetCostModel().cpu_butterfly_per_s, calibrated.cpu_butterfly_per_s);
+
+    // calibration goes straight to the backend and leaves no decisions behind
+    EXPECT_EQ(dispatcher->GetStats()[AccelOp::NTT].device_calls + dispatcher->GetStats()[AccelOp::NTT].cpu_calls, 0u);
+}
+
+#endif  // OPENFHE_FPGA_SIM
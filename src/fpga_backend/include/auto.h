@@ -27,4 +27,13 @@ extern "C" void Compute_Auto(
     int mod_index
 );
 
+// Single-limb automorphism in EVALUATION (bit-reversed slot order, OpenFHE
+// PrecomputeAutoMap): a pure permutation, no negation.
+// output[rev(j)] = input[rev(((2j+1)*k mod 2N) >> 1)].
+extern "C" void Auto_Eval(
+    uint64_t input[SQRT][SQRT],
+    uint32_t k,
+    uint64_t output[SQRT][SQRT]
+);
+
 #endif // AUTO_H
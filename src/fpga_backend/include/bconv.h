@@ -1,8 +1,10 @@
 #ifndef BCONV_H
 #define BCONV_H
 
+#ifndef FPGA_STANDALONE_TEST
 #include <ap_int.h>
 #include <hls_stream.h>
+#endif
 #include "define.h"
 #include "arithmetic.h"
 
@@ -19,6 +19,14 @@
   typedef unsigned __int128 uint128_t;
 #endif
 
+// 主机端编译（C-Sim / 进程内模拟器）没有 ap_int.h：kernel 只用到 64/128 位宽，映射到原生整数
+#ifdef FPGA_STANDALONE_TEST
+  template <int W> struct ap_uint_host;
+  template <> struct ap_uint_host<64>  { typedef uint64_t type; };
+  template <> struct ap_uint_host<128> { typedef unsigned __int128 type; };
+  template <int W> using ap_uint = typename ap_uint_host<W>::type;
+#endif
+
 // =========================================================
 // 2. 核心维度参数
 // =========================================================
@@ -43,6 +51,11 @@ static const int MAX_OUT_COLS = LIMB_Q + LIMB_P;  // 5
 
 static const int STAGE = 12; //log2(RING_DIM)
 
+// OP_NTT_STREAM 支持的最大环维度（运行时 N = 2^log_n，log_n <= MAX_LOG_RING_DIM）
+// N > RING_DIM 的多项式不进片上 [64][64] buffer，而是逐 limb 经 HBM 流过 URAM
+static const int MAX_LOG_RING_DIM = 16;
+static const int MAX_RING_DIM = 1 << MAX_LOG_RING_DIM;  // 65536
+
 // 总limb数：输入 Q limbs + 最多 MAX_OUT_COLS 个输出 limbs
 // Compute_BConv 的 Store_X 写回位置为 in_x[LIMB_Q + p]，p 最大为 MAX_OUT_COLS-1，
 // 因此 in_x 第一维必须为 LIMB_Q + MAX_OUT_COLS。
@@ -62,6 +75,44 @@ static const int LIMB = MAX_LIMBS;
 #define OP_INTT   5
 #define OP_BCONV  6  // Fixed: was OP_AUTO, now matches opcode.h
 #define OP_AUTO   7  // Reserved for future use
+#define OP_HKS_DIGIT 8  // Fused hybrid key-switch digit: INTT -> BConv -> NTT -> MAC
+#define OP_NTT_STREAM 9 // 运行时 N (<= MAX_RING_DIM)、任意 limb 数的 NTT/INTT，逐 limb 流式处理
+#define OP_HKS_ROTATE 10 // 批量 hoisted 旋转：共用 digits，逐旋转 MAC + EVALUATION 自同态
+
+// OP_HKS_DIGIT 的 mem_in2 头部布局（uint64_t 字），Host 端 FpgaManager 保持一致
+// 头部之后: key_b [sizeQlP × RING_DIM]，key_a [sizeQlP × RING_DIM]（QlP 顺序）
+static const int HKS_META_ALPHA   = 0;  // 本 digit 的 tower 数
+static const int HKS_META_START   = 1;  // digit 在 Ql 中的起始下标
+static const int HKS_META_SIZE    = 2;  // sizeQlP
+static const int HKS_META_ACC     = 3;  // 1: 累加到 mem_out, 0: 覆盖（第一个 digit）
+static const int HKS_META_DEVIDX  = 4;                                // [MAX_OUT_COLS] QlP tower -> 模数索引
+static const int HKS_META_QHATINV = HKS_META_DEVIDX + MAX_OUT_COLS;   // [LIMB_Q]
+static const int HKS_META_W       = HKS_META_QHATINV + LIMB_Q;        // [LIMB_Q][MAX_OUT_COLS]
+static const int HKS_META_WORDS   = 32;
+
+// OP_HKS_ROTATE 的 mem_in2：num_active_limbs 个旋转，每个一段 (ROT_META_WORDS + 2 × numDigits × sizeQlP × RING_DIM) 字
+//   头部之后: key_b [numDigits][sizeQlP][RING_DIM]，key_a 同（QlP 顺序），Host 端 FpgaManager 保持一致
+// mem_in1: hoisted digits [numDigits][sizeQlP][RING_DIM]（EVALUATION），所有旋转共用；
+//          ROT_META_FIRST 时后接 [sizeQlP][RING_DIM] 的 first 项，MAC 后加到 b 侧
+// mem_out: 每个旋转 [b | a]，各 sizeQlP 个 tower，已做自同态
+static const int ROT_META_DIGITS = 0;  // digit 数（所有旋转相同）
+static const int ROT_META_SIZE   = 1;  // sizeQlP（所有旋转相同）
+static const int ROT_META_AUTO   = 2;  // 自同态下标 k
+static const int ROT_META_FIRST  = 3;  // 1: mem_in1 带 first 项
+static const int ROT_META_DEVIDX = 4;  // [MAX_OUT_COLS] QlP tower -> 模数索引
+static const int ROT_META_WORDS  = 16;
+
+// OP_NTT_STREAM 的 mem_in2 布局（uint64_t 字），Host 端 FpgaManager 保持一致
+//   头部 NTT_STREAM_HDR_WORDS 字: [log_n, inverse]
+//   之后按设备模数索引，每个模数一段 (NTT_STREAM_LIMB_WORDS + N) 字: [q, k_half, m, 保留] + N 个 twiddle
+//   twiddle 按 bit-reverse 顺序: 正变换 psi^{br(i)}，逆变换 psi^{-br(i)}（与 OpenFHE 一致）
+//   逆变换每级蝶形除 2（Configurable_PE），不需要 n^{-1}
+// 整个 mem_in2 镜像常驻设备（InitModuli 上传一次），kernel 按 mod_index 取段。
+// mem_in1 / mem_out: num_active_limbs 个 limb，每个 N 个系数，模数索引 mod_index 起连续
+static const int NTT_STREAM_LOG_N   = 0;
+static const int NTT_STREAM_INVERSE = 1;
+static const int NTT_STREAM_HDR_WORDS  = 8;
+static const int NTT_STREAM_LIMB_WORDS = 4;
 
 // =========================================================
 // 4. 辅助常量
@@ -151,4 +151,21 @@ extern "C" {
     );
 }
 
+// 运行时 N (2^log_n <= MAX_RING_DIM)、任意 limb 数的 NTT/INTT（OP_NTT_STREAM）
+// 每个 limb 从 HBM 读入 URAM buffer，按 OpenFHE 的 bit-reverse twiddle 顺序做原地蝶形，再写回 HBM。
+// tw_image 布局见 define.h NTT_STREAM_*。
+extern "C" {
+    void Compute_NTT_Stream(
+        const uint64_t *mem_in,
+        const uint64_t *tw_image,
+        uint64_t *mem_out,
+
+        uint64_t data_buffer[MAX_RING_DIM],
+        uint64_t twiddle_buffer[MAX_RING_DIM],
+
+        int num_active_limbs,
+        int mod_idx_offset
+    );
+}
+
 #endif // NTT_KERNEL_H
\ No newline at end of file
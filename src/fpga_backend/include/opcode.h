@@ -16,5 +16,8 @@
 #define OP_INTT 5
 #define OP_BCONV 6
 #define OP_AUTO  7
+#define OP_HKS_DIGIT 8
+#define OP_NTT_STREAM 9
+#define OP_HKS_ROTATE 10
 
 #endif // OPCODE_H
\ No newline at end of file
@@ -84,3 +84,34 @@ ROW_COL:
         }
     }
 }
+
+static int ReverseBits(int x) {
+#pragma HLS INLINE
+    int r = 0;
+    for (int b = 0; b < STAGE; ++b) {
+#pragma HLS UNROLL
+        r = (r << 1) | ((x >> b) & 1);
+    }
+    return r;
+}
+
+// EVALUATION-domain automorphism: slot j of the natural order holds the
+// evaluation at psi^(2j+1); X -> X^k maps it to the slot of psi^((2j+1)k).
+void Auto_Eval(
+    uint64_t input[SQRT][SQRT],
+    uint32_t k,
+    uint64_t output[SQRT][SQRT]
+) {
+#pragma HLS INLINE off
+
+ROW_COL:
+    for (int j = 0; j < N; ++j) {
+#pragma HLS PIPELINE II=1
+
+        uint32_t src  = (uint32_t)(((((uint64_t)j << 1) + 1) * k) % (uint64_t)N2) >> 1;
+        int out_idx   = ReverseBits(j);
+        int in_idx    = ReverseBits((int)src);
+
+        output[out_idx >> LOG_SQRT][out_idx & (M - 1)] = input[in_idx >> LOG_SQRT][in_idx & (M - 1)];
+    }
+}
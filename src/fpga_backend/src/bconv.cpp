@@ -1,5 +1,7 @@
 #include "../include/bconv.h"
+#ifndef FPGA_STANDALONE_TEST
 #include <hls_stream.h>
+#endif
 
 static const int MULTMOD_LAT  = 4;
 static const int TOTAL_CYCLES = LIMB_Q + RING_DIM + MAX_OUT_COLS - 1 + MULTMOD_LAT;
@@ -419,4 +419,73 @@ void Compute_NTT(
     }
 
 
-}
\ No newline at end of file
+}
+
+void Compute_NTT_Stream(
+    const uint64_t *mem_in,
+    const uint64_t *tw_image,
+    uint64_t *mem_out,
+
+    uint64_t data_buffer[MAX_RING_DIM],
+    uint64_t twiddle_buffer[MAX_RING_DIM],
+
+    int num_active_limbs,
+    int mod_idx_offset
+) {
+    const int log_n   = (int)tw_image[NTT_STREAM_LOG_N];
+    const bool is_ntt = tw_image[NTT_STREAM_INVERSE] == 0;
+    const int n       = 1 << log_n;
+    const int seg     = NTT_STREAM_LIMB_WORDS + n;
+
+    STREAM_LIMB_LOOP:
+    for (int l = 0; l < num_active_limbs; l++) {
+        #pragma HLS LOOP_TRIPCOUNT min=1 max=64 avg=16
+        const uint64_t *limb_tw = tw_image + NTT_STREAM_HDR_WORDS + (size_t)(mod_idx_offset + l) * seg;
+        const uint64_t modulus  = limb_tw[0];
+        const uint64_t k_half   = limb_tw[1];
+        const uint64_t m        = limb_tw[2];
+        const uint64_t *tw      = limb_tw + NTT_STREAM_LIMB_WORDS;
+
+        // -- HBM -> URAM
+        STREAM_LOAD:
+        for (int i = 0; i < n; i++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=4096 max=65536
+            data_buffer[i]    = mem_in[(size_t)l * n + i];
+            twiddle_buffer[i] = tw[i];
+        }
+
+        // -- log_n 级蝶形，每级 n/2 个互不相关的蝶形
+        //    正变换 (CT): m = 1, 2, ..., n/2；逆变换 (GS): m = n/2, ..., 1
+        //    蝶形 k 属于第 i = k >> log_t 组，数据对为 (j, j + t)，twiddle 为 tw[m + i]
+        STREAM_STAGE:
+        for (int s = 0; s < log_n; s++) {
+            #pragma HLS LOOP_TRIPCOUNT min=12 max=16
+            const int log_t = is_ntt ? (log_n - 1 - s) : s;
+            const int t     = 1 << log_t;
+            const int grp   = 1 << (log_n - 1 - log_t);
+
+            STREAM_BUTTERFLY:
+            for (int k = 0; k < (n >> 1); k++) {
+                #pragma HLS PIPELINE II=1
+                #pragma HLS LOOP_TRIPCOUNT min=2048 max=32768
+                #pragma HLS DEPENDENCE variable=data_buffer inter false
+                const int i = k >> log_t;
+                const int j = (i << (log_t + 1)) | (k & (t - 1));
+                uint64_t res1, res2;
+                Configurable_PE(data_buffer[j], data_buffer[j + t], twiddle_buffer[grp + i], res1, res2,
+                                modulus, k_half, m, is_ntt);
+                data_buffer[j]     = res1;
+                data_buffer[j + t] = res2;
+            }
+        }
+
+        // -- URAM -> HBM
+        STREAM_STORE:
+        for (int i = 0; i < n; i++) {
+            #pragma HLS PIPELINE II=1
+            #pragma HLS LOOP_TRIPCOUNT min=4096 max=65536
+            mem_out[(size_t)l * n + i] = data_buffer[i];
+        }
+    }
+}
@@ -34,6 +34,12 @@ static uint64_t M[MAX_LIMBS];
 static uint64_t NTTTwiddleFactor[MAX_LIMBS][PE_PARALLEL][RING_DIM];
 static uint64_t INTTTwiddleFactor[MAX_LIMBS][PE_PARALLEL][RING_DIM];
 
+// ------------------------
+// OP_NTT_STREAM 的单 limb 工作区（N 最大 MAX_RING_DIM），URAM 存储
+// ------------------------
+static uint64_t stream_buffer[MAX_RING_DIM];
+static uint64_t stream_twiddle[MAX_RING_DIM];
+
 void Top(
     const uint64_t *mem_in1,
     const uint64_t *mem_in2,
@@ -70,56 +76,60 @@ void Top(
     #pragma HLS BIND_STORAGE variable=NTTTwiddleFactor type=rom_1p impl=uram
     #pragma HLS BIND_STORAGE variable=INTTTwiddleFactor type=rom_1p impl=uram
 
+    #pragma HLS BIND_STORAGE variable=stream_buffer type=ram_2p impl=uram
+    #pragma HLS BIND_STORAGE variable=stream_twiddle type=ram_1p impl=uram
+
     switch(opcode) {
         case OP_INIT: {
             std::cout << "[FPGA] Initializing Modulus Parameters..." << std::endl;
-            
-            // 简单布局：Q模数在索引0,1,2，P模数在索引3,4
-            // 无padding，与Host端一致
-            
+
+            // Host 把所有初始化参数打包成一个镜像，整体一次 DMA，经 mem_in2 传入：
+            //   段 1 (mem_in2[0..]):         [MODULUS×LIMB_Q] [K_HALF×LIMB_Q] [M×LIMB_Q] [NTT_TF : limb × RING_DIM]
+            //   段 2 (mem_in2[mod_index..]): [MODULUS×LIMB_P] [K_HALF×LIMB_P] [M×LIMB_P] [INTT_TF: limb × RING_DIM]
+            // 简单布局：Q模数在索引0,1,2，P模数在索引3,4，无padding，与Host端一致
+            //
+            // BU_NUM 是 FPGA 内部并行度，Host 不感知；
+            // 加载时将每 limb 的 RING_DIM 个 TF 广播给所有 BU。
+            const uint64_t *init_q = mem_in2;
+            const uint64_t *init_p = mem_in2 + mod_index;
+
             init_Q_MOD:
             for (int i = 0; i < LIMB_Q; i++){
                 #pragma HLS PIPELINE II=1
-                MODULUS[i] = mem_in1[i];
+                MODULUS[i] = init_q[i];
             }
             init_Q_KHALF:
             for (int i = 0; i < LIMB_Q; i++){
                 #pragma HLS PIPELINE II=1
-                K_HALF[i] = mem_in1[LIMB_Q + i];
+                K_HALF[i] = init_q[LIMB_Q + i];
             }
             init_Q_M:
             for (int i = 0; i < LIMB_Q; i++){
                 #pragma HLS PIPELINE II=1
-                M[i] = mem_in1[LIMB_Q*2 + i];
+                M[i] = init_q[LIMB_Q*2 + i];
             }
             init_P_Loop:
             for (int j = 0; j < LIMB_P; j++){
                 // P模数从索引LIMB_Q开始，即索引3,4
                 int idx = LIMB_Q + j;
-                MODULUS[idx] = mem_in2[j];
-                K_HALF[idx] = mem_in2[LIMB_P + j];
-                M[idx] = mem_in2[LIMB_P*2 + j];
+                MODULUS[idx] = init_p[j];
+                K_HALF[idx] = init_p[LIMB_P + j];
+                M[idx] = init_p[LIMB_P*2 + j];
                 
                 #ifndef __SYNTHESIS__
                 std::cout << "[FPGA Init] P[" << j << "] (idx=" << idx << "): MOD=" << MODULUS[idx] 
                           << ", K=" << K_HALF[idx] << ", M=" << M[idx] << std::endl;
                 #endif
             }
-            // mem_in1 布局: [MODULUS×LIMB_Q] [K_HALF×LIMB_Q] [M×LIMB_Q]
-            //               [NTT_TF : MAX_LIMBS × RING_DIM]   ← Host 只传 RING_DIM 个/limb
-            // mem_in2 布局: [MODULUS×LIMB_P] [K_HALF×LIMB_P] [M×LIMB_P]
-            //               [INTT_TF: MAX_LIMBS × RING_DIM]   ← 同上
-            //
-            // BU_NUM 是 FPGA 内部并行度，Host 不感知；
-            // 加载时将每 limb 的 RING_DIM 个 TF 广播给所有 BU。
-            static const int NTT_TF_BASE  = LIMB_Q * 3;   // mem_in1 中 NTT_TF 起始偏移
-            static const int INTT_TF_BASE = LIMB_P * 3;   // mem_in2 中 INTT_TF 起始偏移
+            static const int NTT_TF_BASE  = LIMB_Q * 3;   // 段 1 中 NTT_TF 起始偏移
+            static const int INTT_TF_BASE = LIMB_P * 3;   // 段 2 中 INTT_TF 起始偏移
 
+            // Host 只打包 LIMB_Q + LIMB_P 个 limb 的 TF
             init_NTTTwiddle_Loop:
-            for (int l = 0; l < MAX_LIMBS; l++){
+            for (int l = 0; l < LIMB_Q + LIMB_P; l++){
                 for (int t = 0; t < RING_DIM; t++){
                     #pragma HLS PIPELINE II=1
-                    uint64_t tf_val = mem_in1[NTT_TF_BASE + l * RING_DIM + t];
+                    uint64_t tf_val = init_q[NTT_TF_BASE + l * RING_DIM + t];
                     for (int b = 0; b < PE_PARALLEL; b++){
                         #pragma HLS UNROLL
                         NTTTwiddleFactor[l][b][t] = tf_val;
@@ -127,10 +137,10 @@ void Top(
                 }
             }
             init_INTTTwiddle_Loop:
-            for (int l = 0; l < MAX_LIMBS; l++){
+            for (int l = 0; l < LIMB_Q + LIMB_P; l++){
                 for (int t = 0; t < RING_DIM; t++){
                     #pragma HLS PIPELINE II=1
-                    uint64_t tf_val = mem_in2[INTT_TF_BASE + l * RING_DIM + t];
+                    uint64_t tf_val = init_p[INTT_TF_BASE + l * RING_DIM + t];
                     for (int b = 0; b < PE_PARALLEL; b++){
                         #pragma HLS UNROLL
                         INTTTwiddleFactor[l][b][t] = tf_val;
@@ -180,7 +190,12 @@ void Top(
             Store(poly_buffer_1, mem_out, num_active_limbs, mod_index);
             break;
 
-    
+        case OP_NTT_STREAM:
+            // 任意 N / limb 数：mem_in2 为常驻的 twiddle 镜像（正或逆），
+            // num_active_limbs 个 limb 对应模数索引 mod_index 起连续
+            Compute_NTT_Stream(mem_in1, mem_in2, mem_out, stream_buffer, stream_twiddle, num_active_limbs, mod_index);
+            break;
+
         case OP_BCONV: {
             // num_active_limbs = sizeP (输出列数)
             int sizeP = num_active_limbs;
@@ -188,9 +203,10 @@ void Top(
             // Load Q limbs (输入) 到 poly_buffer_1[0..LIMB_Q-1]
             Load(mem_in1, poly_buffer_1, LIMB_Q, 0);
             
-            // mem_in2布局: [权重矩阵 LIMB_Q*MAX_OUT_COLS] [输出模数 MAX_OUT_COLS]
+            // mem_in2布局: [权重矩阵 LIMB_Q*MAX_OUT_COLS] [输出模数] [k_half] [m_barrett]（后三段各 MAX_OUT_COLS）
             // 权重矩阵: in_w[q][p] = mem_in2[q * MAX_OUT_COLS + p]
             // 输出模数: out_mod[p] = mem_in2[LIMB_Q * MAX_OUT_COLS + p]
+            // sizeP = 1 即单输出 tower 模式（OC），只有第 0 列有效
             
             static uint64_t in_w[LIMB_Q][MAX_OUT_COLS];
             for (int q = 0; q < LIMB_Q; q++){
@@ -241,6 +257,166 @@ void Top(
             break;
         }
 
+        case OP_HKS_DIGIT: {
+            // 一个 digit 的完整 hybrid key-switch 链，中间结果全部留在片上：
+            //   mem_in1 : digit 的 alpha 个 tower（EVALUATION）
+            //   mem_in2 : HKS 头部 + key_b + key_a（见 define.h HKS_META_*）
+            //   mem_out : [c0' | c1']，各 sizeQlP 个 tower，跨 digit 累加
+            // poly_buffer_2 保存扩展后的 digit（QlP，按模数索引放行），
+            // result_buffer 先作 BConv 暂存，再作乘积暂存。
+            const int alpha   = (int)mem_in2[HKS_META_ALPHA];
+            const int start   = (int)mem_in2[HKS_META_START];
+            const int sizeQlP = (int)mem_in2[HKS_META_SIZE];
+            const bool acc    = mem_in2[HKS_META_ACC] != 0;
+            const int sizeCompl = sizeQlP - alpha;
+            const uint64_t *key_b = mem_in2 + HKS_META_WORDS;
+            const uint64_t *key_a = key_b + sizeQlP * RING_DIM;
+
+            int dev_idx[MAX_OUT_COLS];
+            for (int e = 0; e < MAX_OUT_COLS; e++)
+                dev_idx[e] = (e < sizeQlP) ? (int)mem_in2[HKS_META_DEVIDX + e] : 0;
+            const int digit_idx = dev_idx[start];
+
+            // digit、key 和累加器都是主机（OP_NTT_STREAM）的顺序；片上 NTT 的输出是行错位的
+            // 片上顺序，所以 INTT 前后、NTT 之后各做一次 InterLeave，换回主机顺序再参与 MAC。
+            // 1. digit 原样（EVALUATION）放入扩展 buffer，同时拷贝一份做 INTT
+            Load(mem_in1, poly_buffer_2, alpha, digit_idx);
+            Load(mem_in1, poly_buffer_1, alpha, digit_idx);
+            for (int l = digit_idx; l < digit_idx + alpha; l++){
+                InterLeave(poly_buffer_1[l], true);
+            }
+            Compute_NTT(poly_buffer_1, NTTTwiddleFactor, INTTTwiddleFactor, MODULUS, K_HALF, M, false, alpha, digit_idx);
+            for (int l = digit_idx; l < digit_idx + alpha; l++){
+                InterLeave(poly_buffer_1[l], false);
+            }
+
+            // 2. x * [q_i^-1]_{q_i} 写入 BConv 输入行 0..LIMB_Q-1（未用行清零）
+            for (int q = 0; q < LIMB_Q; q++){
+                uint64_t qhat_inv = mem_in2[HKS_META_QHATINV + q];
+                int l = digit_idx + q;
+                for (int i = 0; i < SQRT; i++){
+                    for (int j = 0; j < SQRT; j++){
+                        #pragma HLS PIPELINE II=1
+                        uint64_t v = 0;
+                        if (q < alpha)
+                            MultMod(poly_buffer_1[l][i][j], qhat_inv, MODULUS[l], M[l], K_HALF[l], v);
+                        result_buffer[q][i][j] = v;
+                    }
+                }
+            }
+
+            // 3. BConv 到补集（compl c -> QlP tower e，跳过 digit 自身范围）
+            static uint64_t hks_w[LIMB_Q][MAX_OUT_COLS];
+            static uint64_t hks_mod[MAX_OUT_COLS];
+            static uint64_t hks_k_half[MAX_OUT_COLS];
+            static uint64_t hks_m[MAX_OUT_COLS];
+            for (int q = 0; q < LIMB_Q; q++){
+                for (int c = 0; c < MAX_OUT_COLS; c++){
+                    hks_w[q][c] = mem_in2[HKS_META_W + q * MAX_OUT_COLS + c];
+                }
+            }
+            for (int c = 0; c < MAX_OUT_COLS; c++){
+                int e = (c < start) ? c : c + alpha;
+                int d = (c < sizeCompl) ? dev_idx[e] : 0;
+                hks_mod[c]    = MODULUS[d];
+                hks_k_half[c] = K_HALF[d];
+                hks_m[c]      = M[d];
+            }
+            Compute_BConv(result_buffer, hks_w, hks_mod, hks_k_half, hks_m, sizeCompl);
+
+            // 4. 补集 tower 移入扩展 buffer 并做 NTT
+            for (int c = 0; c < sizeCompl; c++){
+                int e = (c < start) ? c : c + alpha;
+                int d = dev_idx[e];
+                for (int i = 0; i < SQRT; i++){
+                    for (int j = 0; j < SQRT; j++){
+                        #pragma HLS PIPELINE II=1
+                        poly_buffer_2[d][i][j] = result_buffer[LIMB_Q + c][i][j];
+                    }
+                }
+                InterLeave(poly_buffer_2[d], true);
+                Compute_NTT(poly_buffer_2, NTTTwiddleFactor, INTTTwiddleFactor, MODULUS, K_HALF, M, true, 1, d);
+                InterLeave(poly_buffer_2[d], false);
+            }
+
+            // 5. MAC: c0' += ext * b, c1' += ext * a（逐 tower，只有累加器经过 mem_out）
+            for (int half = 0; half < 2; half++){
+                const uint64_t *key = (half == 0) ? key_b : key_a;
+                uint64_t *acc_out   = mem_out + half * sizeQlP * RING_DIM;
+                for (int e = 0; e < sizeQlP; e++){
+                    int d = dev_idx[e];
+                    Load(key + e * RING_DIM, poly_buffer_1, 1, d);
+                    Compute_Mult(poly_buffer_2, poly_buffer_1, result_buffer, MODULUS, K_HALF, M, 1, d);
+                    if (acc){
+                        Load(acc_out + e * RING_DIM, poly_buffer_1, 1, d);
+                        Compute_Add(result_buffer, poly_buffer_1, result_buffer, MODULUS, 1, d);
+                    }
+                    Store(result_buffer, acc_out + e * RING_DIM, 1, d);
+                }
+            }
+            break;
+        }
+
+        case OP_HKS_ROTATE: {
+            // 同一密文的 num_active_limbs 个 hoisted 旋转（BSGS 的 baby steps）一次启动完成：
+            //   mem_in1 : digits [numDigits][sizeQlP]（EVALUATION）+ 可选 first [sizeQlP]，上传一次，各旋转共用
+            //   mem_in2 : 每个旋转 ROT 头部 + key_b + key_a（见 define.h ROT_META_*）
+            //   mem_out : 每个旋转 [σ_k(Σ d·b) | σ_k(Σ d·a)]，各 sizeQlP 个 tower
+            // 逐 tower 累加：result_buffer 存 b 侧、poly_buffer_2 存 a 侧，
+            // EVALUATION 下的 σ_k 是纯置换，写回前经 poly_buffer_1 完成。
+            const int numDigits    = (int)mem_in2[ROT_META_DIGITS];
+            const int sizeQlP      = (int)mem_in2[ROT_META_SIZE];
+            const bool add_first   = mem_in2[ROT_META_FIRST] != 0;
+            const size_t key_words = (size_t)numDigits * sizeQlP * RING_DIM;
+            const uint64_t *first  = mem_in1 + key_words;
+            const size_t rot_words = ROT_META_WORDS + 2 * key_words;
+
+            for (int r = 0; r < num_active_limbs; r++){
+                const uint64_t *meta  = mem_in2 + r * rot_words;
+                const uint32_t k      = (uint32_t)meta[ROT_META_AUTO];
+                const uint64_t *key_b = meta + ROT_META_WORDS;
+                const uint64_t *key_a = key_b + key_words;
+                uint64_t *out         = mem_out + (size_t)r * 2 * sizeQlP * RING_DIM;
+
+                for (int e = 0; e < sizeQlP; e++){
+                    const int d = (int)meta[ROT_META_DEVIDX + e];
+                    for (int j = 0; j < numDigits; j++){
+                        const size_t off = ((size_t)j * sizeQlP + e) * RING_DIM;
+                        Load(mem_in1 + off, poly_buffer_1, 1, d);
+                        for (int i = 0; i < SQRT; i++){
+                            for (int t = 0; t < SQRT; t++){
+                                #pragma HLS PIPELINE II=1
+                                uint64_t x = poly_buffer_1[d][i][t];
+                                uint64_t pb, pa;
+                                MultMod(x, key_b[off + i * SQRT + t], MODULUS[d], M[d], K_HALF[d], pb);
+                                MultMod(x, key_a[off + i * SQRT + t], MODULUS[d], M[d], K_HALF[d], pa);
+                                if (j == 0){
+                                    result_buffer[d][i][t] = pb;
+                                    poly_buffer_2[d][i][t] = pa;
+                                } else {
+                                    AddMod(result_buffer[d][i][t], pb, MODULUS[d], true);
+                                    AddMod(poly_buffer_2[d][i][t], pa, MODULUS[d], true);
+                                }
+                            }
+                        }
+                    }
+                    if (add_first){
+                        for (int i = 0; i < SQRT; i++){
+                            for (int t = 0; t < SQRT; t++){
+                                #pragma HLS PIPELINE II=1
+                                AddMod(result_buffer[d][i][t], first[e * RING_DIM + i * SQRT + t], MODULUS[d], true);
+                            }
+                        }
+                    }
+                    Auto_Eval(result_buffer[d], k, poly_buffer_1[d]);
+                    Store(poly_buffer_1, out + e * RING_DIM, 1, d);
+                    Auto_Eval(poly_buffer_2[d], k, poly_buffer_1[d]);
+                    Store(poly_buffer_1, out + (sizeQlP + e) * RING_DIM, 1, d);
+                }
+            }
+            break;
+        }
+
         default:
             std::cout << "[FPGA] Unknown opcode: " << opcode << std::endl;
             break;
@@ -78,6 +78,27 @@ int main() {
         printf("[Auto Test] Identity (k=%d): HW vs SW %s\n", r, err == 0 ? "PASS" : "FAIL");
         if (err != 0) return -1;
     }
-   
+
+    // EVALUATION-domain automorphism (OP_HKS_ROTATE): k = 1 is the identity and
+    // applying k then kinv restores the input.
+    uint64_t back[SQRT][SQRT];
+    pack_1d_to_2d(vec_in, input);
+    for (uint32_t k = 1; k < (uint32_t)N2; k += 2) {
+        uint32_t kinv = mod_inverse(k, N2);
+        Auto_Eval(input, k, output);
+        Auto_Eval(output, kinv, back);
+
+        int err = 0;
+        for (int i = 0; i < N; ++i) {
+            if (back[i / M][i % M] != vec_in[i]) err++;
+            if (k == 1 && output[i / M][i % M] != vec_in[i]) err++;
+        }
+        if (err != 0) {
+            printf("[Auto Eval Test] k=%u: k^-1 * k %s\n", k, "FAIL");
+            return -1;
+        }
+    }
+    printf("[Auto Eval Test] all odd k: PASS\n");
+    return 0;
 }
 
@@ -0,0 +1,166 @@
+//============================================================================
+// File   : ntt_stream_tb.cpp
+// Author : Testbench for Compute_NTT_Stream (OP_NTT_STREAM, HLS C-Sim)
+// Date   : 2026-10-16
+//
+// Description:
+//   对 ntt_kernel.cpp 中运行时 N 的流式 NTT 进行功能验证：
+//     1. N=16 正变换与 O(N^2) 负包绕定义逐点比较（bit-reverse 输出顺序）
+//     2. N=2^13 / 2^16、2 个 limb、mod_idx_offset=1：正变换 + 逆变换往返
+//
+// 编译方式 (g++ standalone):
+//   g++ -std=c++14 -O2 -DFPGA_STANDALONE_TEST \
+//       -I../include \
+//       ntt_stream_tb.cpp \
+//       ../src/ntt_kernel.cpp \
+//       ../src/arithmetic.cpp \
+//       -o ntt_stream_tb && ./ntt_stream_tb
+//============================================================================
+
+#define FPGA_STANDALONE_TEST   // 使 define.h 使用标准 __int128
+
+#include <iostream>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/ntt_kernel.h"
+
+static int g_total = 0;
+static int g_passed = 0;
+
+static void check(bool cond, const std::string &name) {
+    ++g_total;
+    if (cond) {
+        ++g_passed;
+        std::cout << "  [PASS] " << name << "\n";
+    } else {
+        std::cout << "  [FAIL] " << name << "\n";
+    }
+}
+
+static uint64_t sw_mulmod(uint64_t a, uint64_t b, uint64_t mod) {
+    return (uint64_t)((unsigned __int128)a * b % mod);
+}
+
+static uint64_t sw_powmod(uint64_t base, uint64_t exp, uint64_t mod) {
+    uint64_t res = 1;
+    base %= mod;
+    while (exp) {
+        if (exp & 1) res = sw_mulmod(res, base, mod);
+        base = sw_mulmod(base, base, mod);
+        exp >>= 1;
+    }
+    return res;
+}
+
+static int bit_reverse(int x, int bits) {
+    int r = 0;
+    for (int i = 0; i < bits; i++) {
+        r = (r << 1) | (x & 1);
+        x >>= 1;
+    }
+    return r;
+}
+
+// 2N 次本原单位根：psi^N == -1
+static uint64_t find_psi(uint64_t mod, int n) {
+    for (uint64_t g = 2;; g++) {
+        uint64_t psi = sw_powmod(g, (mod - 1) / (2 * (uint64_t)n), mod);
+        if (sw_powmod(psi, n, mod) == mod - 1) return psi;
+    }
+}
+
+// 与 FpgaManager::PackNttStreamImage 相同的布局
+static std::vector<uint64_t> build_image(const std::vector<uint64_t> &mods, int log_n, bool inverse) {
+    const int n   = 1 << log_n;
+    const int seg = NTT_STREAM_LIMB_WORDS + n;
+    std::vector<uint64_t> img(NTT_STREAM_HDR_WORDS + mods.size() * seg, 0);
+    img[NTT_STREAM_LOG_N]   = log_n;
+    img[NTT_STREAM_INVERSE] = inverse ? 1 : 0;
+    for (size_t l = 0; l < mods.size(); l++) {
+        uint64_t q = mods[l];
+        uint64_t *p = img.data() + NTT_STREAM_HDR_WORDS + l * seg;
+        int bits = 0;
+        for (uint64_t t = q; t; t >>= 1) ++bits;
+        p[0] = q;
+        p[1] = bits;
+        p[2] = (uint64_t)(((unsigned __int128)1 << (2 * bits)) / q);
+        uint64_t psi = find_psi(q, n);
+        if (inverse) psi = sw_powmod(psi, q - 2, q);
+        uint64_t w = 1;
+        for (int i = 0; i < n; i++) {
+            p[NTT_STREAM_LIMB_WORDS + bit_reverse(i, log_n)] = w;
+            w = sw_mulmod(w, psi, q);
+        }
+    }
+    return img;
+}
+
+static uint64_t data_buffer[MAX_RING_DIM];
+static uint64_t twiddle_buffer[MAX_RING_DIM];
+
+// ============================================================
+// 测试 1：N=16 与负包绕定义比较
+//   out[br(i)] = sum_j a_j * psi^{(2i+1) j}
+// ============================================================
+static void test_stream_definition() {
+    std::cout << "\n[Test 1] Compute_NTT_Stream N=16 vs definition\n";
+    const int log_n = 4, n = 1 << log_n;
+    const uint64_t q = 576460752300015617ULL;
+    auto img = build_image({q}, log_n, false);
+    uint64_t psi = find_psi(q, n);
+
+    std::mt19937_64 rng(1);
+    std::vector<uint64_t> a(n), out(n);
+    for (auto &x : a) x = rng() % q;
+
+    Compute_NTT_Stream(a.data(), img.data(), out.data(), data_buffer, twiddle_buffer, 1, 0);
+
+    bool ok = true;
+    for (int i = 0; i < n && ok; i++) {
+        uint64_t root = sw_powmod(psi, 2 * i + 1, q), acc = 0, w = 1;
+        for (int j = 0; j < n; j++) {
+            acc = (uint64_t)(((unsigned __int128)acc + sw_mulmod(a[j], w, q)) % q);
+            w = sw_mulmod(w, root, q);
+        }
+        ok = (out[bit_reverse(i, log_n)] == acc);
+    }
+    check(ok, "正变换与负包绕定义一致");
+}
+
+// ============================================================
+// 测试 2：多 limb 往返，mod_idx_offset 跳过第一个模数段
+// ============================================================
+static void test_stream_roundtrip(int log_n) {
+    std::cout << "\n[Test 2] Compute_NTT_Stream roundtrip N=2^" << log_n << "\n";
+    const int n = 1 << log_n;
+    std::vector<uint64_t> mods = {576460752298835969ULL, 576460752300015617ULL, 576460752298835969ULL};
+    auto fwd = build_image(mods, log_n, false);
+    auto inv = build_image(mods, log_n, true);
+
+    std::mt19937_64 rng(log_n);
+    std::vector<uint64_t> a(2 * n), ntt(2 * n), back(2 * n);
+    for (int l = 0; l < 2; l++)
+        for (int i = 0; i < n; i++) a[l * n + i] = rng() % mods[1 + l];
+
+    Compute_NTT_Stream(a.data(), fwd.data(), ntt.data(), data_buffer, twiddle_buffer, 2, 1);
+    Compute_NTT_Stream(ntt.data(), inv.data(), back.data(), data_buffer, twiddle_buffer, 2, 1);
+
+    check(ntt != a, "正变换改变了数据");
+    check(back == a, "INTT(NTT(a)) == a（2 limbs）");
+}
+
+int main() {
+    std::cout << "============================================================\n";
+    std::cout << "  NTT Stream Testbench  MAX_RING_DIM=" << MAX_RING_DIM << "\n";
+    std::cout << "============================================================\n";
+
+    test_stream_definition();
+    test_stream_roundtrip(13);
+    test_stream_roundtrip(MAX_LOG_RING_DIM);
+
+    std::cout << "\n  NTT Stream 结果：" << g_passed << " / " << g_total << " 通过\n";
+    return (g_passed == g_total) ? 0 : 1;
+}
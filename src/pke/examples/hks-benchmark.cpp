@@ -1,21 +1,28 @@
 #define PROFILE
 
 #include "openfhe.h"
-#include "FpgaManager.h"
+#include "PolyAccelerator.h"
+#include "OffloadDispatcher.h"
 #include "keyswitch/hks_strategy.h"
+#include "keyswitch/hks_autotuner.h"
 
 #include <chrono>
 #include <cstring>
+#include <iomanip>
 #include <iostream>
 
 using namespace lbcrypto;
 
 static void PrintUsage(const char* prog) {
-    std::cout << "Usage: " << prog << " --strategy <DC|MP|OC> [--iters N]\n"
+    std::cout << "Usage: " << prog << " --strategy <DC|MP|OC|FUSED|AUTO> [--iters N] [--profile FILE] [--trace FILE]\n"
               << "  DC  Digit-Centric (default): per-digit INTT→BConv→NTT\n"
               << "  MP  Max-Parallel:            all-INTT → all-BConv → all-NTT\n"
-              << "  OC  Output-Centric:          per-P-tower BConv (min peak SRAM)\n"
-              << "  --iters N  number of EvalRotate calls to time (default 10)\n";
+              << "  OC  Output-Centric:          single-tower BConv (min peak SRAM)\n"
+              << "  FUSED On-device digit chain: INTT→BConv→NTT→MAC in one kernel per digit\n"
+              << "  AUTO  Autotuned:             fastest of the above per (N, sizeQl, sizeP, digits)\n"
+              << "  --iters N       number of EvalRotate calls to time (default 10)\n"
+              << "  --profile FILE  AUTO profile to load and update\n"
+              << "  --trace FILE    write a Chrome trace (chrome://tracing) of the timed calls\n";
 }
 
 int main(int argc, char* argv[]) {
@@ -24,24 +31,24 @@ int main(int argc, char* argv[]) {
     // -------------------------------------------------------------------------
     HKSStrategy strategy = HKSStrategy::DC;
     int iters = 10;
+    const char* tracePath = nullptr;
 
     for (int i = 1; i < argc; i++) {
         if (std::strcmp(argv[i], "--strategy") == 0 && i + 1 < argc) {
-            std::string s = argv[++i];
-            if (s == "MP")      strategy = HKSStrategy::MP;
-            else if (s == "OC") strategy = HKSStrategy::OC;
-            else if (s == "DC") strategy = HKSStrategy::DC;
-            else { PrintUsage(argv[0]); return 1; }
+            if (!ParseHKSStrategy(argv[++i], strategy)) { PrintUsage(argv[0]); return 1; }
         } else if (std::strcmp(argv[i], "--iters") == 0 && i + 1 < argc) {
             iters = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--profile") == 0 && i + 1 < argc) {
+            HKSAutotuner::GetInstance().LoadProfile(argv[++i]);
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
         } else if (std::strcmp(argv[i], "--help") == 0) {
             PrintUsage(argv[0]); return 0;
         }
     }
 
     SetHKSStrategy(strategy);
-    const char* stratName[] = {"DC", "MP", "OC"};
-    const char* sname = stratName[static_cast<int>(strategy)];
+    const char* sname = HKSStrategyName(strategy);
     std::cout << "[HKS-Bench] Strategy: " << sname << "  Iters: " << iters << "\n\n";
 
     // -------------------------------------------------------------------------
@@ -81,10 +88,10 @@ int main(int argc, char* argv[]) {
         }
     }
 
-    if (FpgaManager::GetInstance().IsReady()) {
-        std::cout << "[Host] Initializing FPGA...\n";
-        FpgaManager::GetInstance().InitModuli(fpga_q_mods, fpga_p_mods, fpga_q_roots, fpga_p_roots);
-        std::cout << "[Host] FPGA ready.\n\n";
+    if (auto* accel = PolyAccelerator::Get()) {
+        std::cout << "[Host] Initializing accelerator (" << accel->Name() << ")...\n";
+        accel->InitModuli(fpga_q_mods, fpga_p_mods, fpga_q_roots, fpga_p_roots, cc->GetRingDimension());
+        std::cout << "[Host] Accelerator ready.\n\n";
     } else {
         std::cout << "[Host] FPGA not available, running on CPU.\n\n";
     }
@@ -112,15 +119,37 @@ int main(int argc, char* argv[]) {
     // Capture per-operation stats (single call after warm-up)
     // -------------------------------------------------------------------------
     ResetHKSStats();
+    SetHKSPeakMeasurement(true);
     cc->EvalRotate(ctxt, 1);
+    SetHKSPeakMeasurement(false);
     HKSStats s = GetHKSStats();
 
+    // Tower allocations per EvalRotate without and with the key-switch arena
+    // (the first call with the arena on only fills the per-thread free lists)
+    const bool arenaEnabled = intnat::TowerArena::Enabled();
+    intnat::TowerArena::SetEnabled(false);
+    intnat::TowerArena::ResetStats();
+    cc->EvalRotate(ctxt, 1);
+    const intnat::TowerArenaStats allocOff = intnat::TowerArena::GetStats();
+    intnat::TowerArena::SetEnabled(true);
+    cc->EvalRotate(ctxt, 1);
+    intnat::TowerArena::ResetStats();
+    cc->EvalRotate(ctxt, 1);
+    const intnat::TowerArenaStats allocOn = intnat::TowerArena::GetStats();
+    intnat::TowerArena::SetEnabled(arenaEnabled);
+
     size_t p_tower_bytes = (size_t)s.peak_p_towers * s.ring_dim * sizeof(uint64_t);
 
     std::cout << "\n====================================================\n";
     std::cout << "  HKS Strategy Evaluation Report\n";
     std::cout << "====================================================\n";
     std::cout << "  Strategy        : " << sname << "\n";
+    HKSStrategy picked;
+    if (strategy == HKSStrategy::AUTO &&
+        HKSAutotuner::GetInstance().Lookup({(uint32_t)s.ring_dim, (uint32_t)s.size_ql, (uint32_t)s.size_p,
+                                            (uint32_t)s.num_digits},
+                                           picked))
+        std::cout << "  AUTO picked     : " << HKSStrategyName(picked) << "\n";
     std::cout << "  Ring Dim (N)    : " << s.ring_dim << "\n";
     std::cout << "  sizeQl          : " << s.size_ql << "\n";
     std::cout << "  sizeP           : " << s.size_p << "\n";
@@ -135,25 +164,54 @@ int main(int argc, char* argv[]) {
     std::cout << "  BConv           : " << s.bconv << "\n";
     std::cout << "  ModMul (limb)   : " << s.modmul_limb << "\n";
     std::cout << "----------------------------------------------------\n";
-    std::cout << "  [Peak SRAM - P-tower complement buffer]\n";
-    std::cout << "  P-towers held   : " << s.peak_p_towers << "\n";
+    std::cout << "  [Peak SRAM - complement tower buffer]\n";
+    std::cout << "  Towers claimed  : " << s.peak_p_towers << "\n";
+    std::cout << "  Towers measured : " << s.peak_p_towers_measured << "\n";
     std::cout << "  Buffer size     : " << p_tower_bytes << " bytes"
               << "  (" << p_tower_bytes / 1024.0 << " KB)\n";
     std::cout << "----------------------------------------------------\n";
+    std::cout << "  [Tower allocations per EvalRotate]\n";
+    std::cout << "  Heap (no arena) : " << allocOff.heap_allocs << "\n";
+    std::cout << "  Heap (arena)    : " << allocOn.heap_allocs << "\n";
+    std::cout << "  Reused (arena)  : " << allocOn.arena_allocs << "\n";
+    std::cout << "----------------------------------------------------\n";
+    std::cout << "  [Host <-> FPGA traffic per KeySwitch]\n";
+    std::cout << "  H2D             : " << s.bytes_h2d << " bytes\n";
+    std::cout << "  D2H             : " << s.bytes_d2h << " bytes\n";
+    std::cout << "----------------------------------------------------\n";
+    std::cout << "  [Wall time per phase]\n";
+    for (size_t p = 0; p < HKS_NUM_PHASES; p++) {
+        if (s.phase_ns[p] != 0)
+            std::cout << "  " << std::left << std::setw(16) << HKSPhaseName(static_cast<HKSPhase>(p)) << ": "
+                      << s.phase_ns[p] / 1e6 << " ms\n";
+    }
+    std::cout << "----------------------------------------------------\n";
 
     // -------------------------------------------------------------------------
     // Timed benchmark
     // -------------------------------------------------------------------------
+    if (tracePath)
+        HKSTracer::GetInstance().Start();
     auto t0 = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < iters; i++) {
         cc->EvalRotate(ctxt, 1);
     }
     auto t1 = std::chrono::high_resolution_clock::now();
+    if (tracePath) {
+        HKSTracer::GetInstance().Stop();
+        if (!HKSTracer::GetInstance().WriteChromeTrace(tracePath))
+            std::cerr << "cannot write " << tracePath << "\n";
+    }
 
     double total_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
     std::cout << "  [Timing (" << iters << " iters)]\n";
     std::cout << "  Total           : " << total_ms << " ms\n";
     std::cout << "  Avg per op      : " << total_ms / iters << " ms\n";
+    if (auto* dispatcher = OffloadDispatcher::Active()) {
+        std::cout << "----------------------------------------------------\n";
+        std::cout << "  [CPU / device dispatch]\n";
+        std::cout << dispatcher->GetStats();
+    }
     std::cout << "====================================================\n";
 
     return 0;
@@ -15,7 +15,7 @@
  #define PROFILE
 
  #include "openfhe.h"
- #include "FpgaManager.h"
+ #include "PolyAccelerator.h"
  
  using namespace lbcrypto;
  
@@ -91,9 +91,9 @@
  
      // 4. 调用 FPGA Init
      // 这会将 Q 和 P 发送到 FPGA 的 BRAM/URAM
-     if (FpgaManager::GetInstance().IsReady()) {
-         std::cout << "[Host] Sending moduli to FPGA..." << std::endl;
-         FpgaManager::GetInstance().InitModuli(fpga_q_mods, fpga_p_mods, fpga_q_roots, fpga_p_roots);
+     if (auto* accel = PolyAccelerator::Get()) {
+         std::cout << "[Host] Sending moduli to " << accel->Name() << "..." << std::endl;
+         accel->InitModuli(fpga_q_mods, fpga_p_mods, fpga_q_roots, fpga_p_roots, cc->GetRingDimension());
          std::cout << "[Host] FPGA Initialization Done." << std::endl;
      } else {
          std::cerr << "\n[CRITICAL WARNING] FPGA not ready! Calculations will fail or fallback." << std::endl;
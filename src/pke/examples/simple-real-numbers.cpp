@@ -15,7 +15,7 @@
 #define PROFILE
 
 #include "openfhe.h"
-#include "FpgaManager.h"
+#include "PolyAccelerator.h"
 
 using namespace lbcrypto;
 
@@ -90,10 +90,10 @@ int main() {
     }
 
     // 4. 调用 FPGA Init
-    if (FpgaManager::GetInstance().IsReady()) {
-        std::cout << "[Host] Sending moduli and roots to FPGA..." << std::endl;
+    if (auto* accel = PolyAccelerator::Get()) {
+        std::cout << "[Host] Sending moduli and roots to " << accel->Name() << "..." << std::endl;
         // 把 roots 一起传进去！
-        FpgaManager::GetInstance().InitModuli(fpga_q_mods, fpga_p_mods, fpga_q_roots, fpga_p_roots);
+        accel->InitModuli(fpga_q_mods, fpga_p_mods, fpga_q_roots, fpga_p_roots, cc->GetRingDimension());
         std::cout << "[Host] FPGA Initialization Done." << std::endl;
     }
     else {
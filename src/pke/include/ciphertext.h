@@ -39,15 +39,43 @@
 #include "ciphertext-fwd.h"
 #include "cryptoobject.h"
 #include "key/key.h"
+#include "math/seeduniformgenerator.h"
 #include "metadata.h"
+#include "utils/exception.h"
+
+#include "cereal/types/array.hpp"
 
 #include <map>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace lbcrypto {
+
+// ---------------------------------------------------------------------------
+// Format of the ciphertexts Encrypt() with a private key produces (process-wide,
+// like EvalKeyFormat). In SEEDED format the uniformly random c1 of a fresh
+// ciphertext is DCRTPoly::FromSeed(params of c0, seed, 0); the ciphertext
+// keeps the seed and serializes it in place of c1, nearly halving its size.
+// Deserialization expands c1 again, so the loaded ciphertext is a regular one.
+// Only the RNS schemes (CKKS, BGV, BFV with STANDARD encryption) seed c1;
+// public-key encryption is not affected.
+// ---------------------------------------------------------------------------
+enum class CiphertextFormat {
+    FULL,    // c0 and c1 serialized
+    SEEDED,  // c0 and the seed of c1 serialized
+};
+
+inline CiphertextFormat& GetCiphertextFormat() {
+    static CiphertextFormat f = CiphertextFormat::FULL;
+    return f;
+}
+
+inline void SetCiphertextFormat(CiphertextFormat f) {
+    GetCiphertextFormat() = f;
+}
 /**
  * @brief CiphertextImpl
  *
@@ -96,7 +124,8 @@ public:
           m_scalingFactor(ct->m_scalingFactor),
           m_scalingFactorInt(ct->m_scalingFactorInt),
           m_encodingType(ct->m_encodingType),
-          m_metadataMap(ct->m_metadataMap) {}
+          m_metadataMap(ct->m_metadataMap),
+          m_c1Seed(ct->m_c1Seed) {}
 
     /**
    * Move constructor
@@ -113,7 +142,8 @@ public:
           m_scalingFactor(std::move(ct->m_scalingFactor)),
           m_scalingFactorInt(std::move(ct->m_scalingFactorInt)),
           m_encodingType(std::move(ct->m_encodingType)),
-          m_metadataMap(std::move(ct->m_metadataMap)) {}
+          m_metadataMap(std::move(ct->m_metadataMap)),
+          m_c1Seed(std::move(ct->m_c1Seed)) {}
 
     /**
    * Destructor
@@ -157,6 +187,7 @@ public:
    * @return the first (and only!) ring element
    */
     Element& GetElement() {
+        m_c1Seed.reset();
         if (m_elements.size() == 1)
             return m_elements[0];
         OPENFHE_THROW(
@@ -177,6 +208,7 @@ public:
    * @return vector of ring elements
    */
     std::vector<Element>& GetElements() {
+        m_c1Seed.reset();
         return m_elements;
     }
 
@@ -191,6 +223,7 @@ public:
    * @param &element is a polynomial ring element.
    */
     void SetElement(const Element& element) {
+        m_c1Seed.reset();
         if (m_elements.size() == 0)
             m_elements.push_back(element);
         else if (m_elements.size() == 1)
@@ -207,6 +240,7 @@ public:
    * @param &element is a polynomial ring element.
    */
     void SetElements(const std::vector<Element>& elements) {
+        m_c1Seed.reset();
         m_elements = elements;
     }
 
@@ -216,9 +250,28 @@ public:
    * @param &&element is a polynomial ring element.
    */
     void SetElements(std::vector<Element>&& elements) noexcept {
+        m_c1Seed.reset();
         m_elements = std::move(elements);
     }
 
+    // ---- seeded c1 (CiphertextFormat::SEEDED) ----
+    // Seed of c1, or nullptr. Set by Encrypt() in SEEDED format; any non-const
+    // access to the elements drops it, so a ciphertext whose elements may have
+    // changed serializes c1 in full.
+    const std::shared_ptr<const PRNGSeed>& GetC1Seed() const {
+        return m_c1Seed;
+    }
+
+    // c1 must equal FromSeed(params of c0, *seed, 0); nullptr drops the seed
+    void SetC1Seed(std::shared_ptr<const PRNGSeed> seed) {
+        m_c1Seed = std::move(seed);
+    }
+
+    // Whether c1 is serialized as its seed
+    bool IsSeeded() const {
+        return m_c1Seed != nullptr && m_elements.size() == 2;
+    }
+
     /**
    * Get the degree of the scaling factor for the encrypted message.
    */
@@ -408,6 +461,7 @@ public:
     virtual Ciphertext<Element> Clone() const {
         auto ct        = this->CloneEmpty();
         ct->m_elements = m_elements;
+        ct->m_c1Seed   = m_c1Seed;
         return ct;
     }
 
@@ -463,7 +517,14 @@ public:
     template <class Archive>
     void save(Archive& ar, std::uint32_t const version) const {
         ar(cereal::base_class<CryptoObject<Element>>(this));
-        ar(cereal::make_nvp("v", m_elements));
+        const bool seeded = IsSeeded();
+        if (seeded) {
+            const std::vector<Element> c0{m_elements[0]};
+            ar(cereal::make_nvp("v", c0));
+        }
+        else {
+            ar(cereal::make_nvp("v", m_elements));
+        }
         ar(cereal::make_nvp("sl", m_slots));
         ar(cereal::make_nvp("l", m_level));
         ar(cereal::make_nvp("t", m_hopslevel));
@@ -472,6 +533,9 @@ public:
         ar(cereal::make_nvp("si", m_scalingFactorInt));
         ar(cereal::make_nvp("e", m_encodingType));
         ar(cereal::make_nvp("m", m_metadataMap));
+        ar(cereal::make_nvp("sd", seeded));
+        if (seeded)
+            ar(cereal::make_nvp("c1s", *m_c1Seed));
     }
 
     template <class Archive>
@@ -489,16 +553,39 @@ public:
         ar(cereal::make_nvp("si", m_scalingFactorInt));
         ar(cereal::make_nvp("e", m_encodingType));
         ar(cereal::make_nvp("m", m_metadataMap));
+        m_c1Seed.reset();
+        if (version < 2)
+            return;
+        bool seeded = false;
+        ar(cereal::make_nvp("sd", seeded));
+        if (seeded) {
+            PRNGSeed seed;
+            ar(cereal::make_nvp("c1s", seed));
+            ExpandC1(seed);
+        }
     }
 
     std::string SerializedObjectName() const {
         return "Ciphertext";
     }
     static uint32_t SerializedVersion() {
-        return 1;
+        return 2;
     }
 
 private:
+    // appends c1 = FromSeed(params of c0, seed, 0) to a deserialized {c0} and keeps the seed
+    void ExpandC1(const PRNGSeed& seed) {
+        if constexpr (std::is_same<Element, DCRTPoly>::value) {
+            if (m_elements.size() != 1)
+                OPENFHE_THROW("seeded ciphertext must have exactly one serialized element");
+            m_elements.push_back(Element::FromSeed(m_elements[0].GetParams(), seed, 0));
+            m_c1Seed = std::make_shared<const PRNGSeed>(seed);
+        }
+        else {
+            OPENFHE_THROW("seeded ciphertexts are only supported for DCRTPoly");
+        }
+    }
+
     // vector of ring elements for this Ciphertext
     std::vector<Element> m_elements;
 
@@ -522,6 +609,9 @@ private:
 
     // A map to hold different Metadata objects - used for flexible extensions of Ciphertext
     MetadataMap m_metadataMap{std::make_shared<std::map<std::string, std::shared_ptr<Metadata>>>()};
+
+    // seed of c1 if the ciphertext is a fresh SEEDED encryption (see CiphertextFormat)
+    std::shared_ptr<const PRNGSeed> m_c1Seed;
 };
 
 template <>
@@ -42,6 +42,7 @@
 #include "cryptocontext-fwd.h"
 #include "encoding/plaintextfactory.h"
 #include "key/evalkey.h"
+#include "key/evalkey-registry.h"
 #include "key/keypair.h"
 #include "scheme/scheme-swch-params.h"
 #include "schemebase/base-pke.h"
@@ -69,6 +70,8 @@
 
 namespace lbcrypto {
 
+class LazyEvalKeyMap;
+
 /**
  * @class CryptoContextImpl
  * @brief A class to simplify access to OpenFHE's PKE functionality.
@@ -256,9 +259,9 @@ class CryptoContextImpl : public Serializable {
         const std::string& keyTag, const std::vector<uint32_t>& indexList);
 
     // cached evalmult keys, by secret key UID
-    static std::map<std::string, std::vector<EvalKey<Element>>> s_evalMultKeyMap;
+    static EvalKeyRegistry<std::vector<EvalKey<Element>>> s_evalMultKeyMap;
     // cached evalautomorphism keys, by secret key UID
-    static std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>> s_evalAutomorphismKeyMap;
+    static EvalKeyRegistry<std::map<uint32_t, EvalKey<Element>>> s_evalAutomorphismKeyMap;
 
 protected:
     // crypto parameters
@@ -641,16 +644,15 @@ public:
     */
     template <typename ST>
     static bool SerializeEvalMultKey(std::ostream& ser, const ST& sertype, const std::string& keyTag = "") {
-        const auto& evalMultKeys = CryptoContextImpl<Element>::GetAllEvalMultKeys();
         if (keyTag.length() == 0) {
-            Serial::Serialize(evalMultKeys, ser, sertype);
+            Serial::Serialize(CryptoContextImpl<Element>::GetAllEvalMultKeys(), ser, sertype);
         }
         else {
-            const auto it = evalMultKeys.find(keyTag);
-            if (it == evalMultKeys.end())
+            const auto keys = CryptoContextImpl<Element>::s_evalMultKeyMap.Find(keyTag);
+            if (!keys)
                 return false;  // no such keyTag
 
-            std::map<std::string, std::vector<EvalKey<Element>>> omap{{it->first, it->second}};
+            std::map<std::string, std::vector<EvalKey<Element>>> omap{{keyTag, *keys}};
 
             Serial::Serialize(omap, ser, sertype);
         }
@@ -808,17 +810,14 @@ public:
     template <typename ST>
     static bool SerializeEvalAutomorphismKey(std::ostream& ser, const ST& sertype, const std::string& keyTag = "") {
         // TODO (dsuponit): do we need Serailize/Deserialized to return bool?
-        std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>* smap;
         std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>> omap;
         if (keyTag.length() == 0) {
-            smap = &CryptoContextImpl<Element>::GetAllEvalAutomorphismKeys();
+            omap = CryptoContextImpl<Element>::GetAllEvalAutomorphismKeys();
         }
         else {
-            const auto keys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(keyTag);
-            omap[keyTag]    = keys;
-            smap            = &omap;
+            omap[keyTag] = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(keyTag);
         }
-        Serial::Serialize(*smap, ser, sertype);
+        Serial::Serialize(omap, ser, sertype);
         return true;
     }
 
@@ -834,7 +833,7 @@ public:
     static bool SerializeEvalAutomorphismKey(std::ostream& ser, const ST& sertype, const CryptoContext<Element> cc) {
         std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>> omap;
         for (const auto& k : CryptoContextImpl<Element>::GetAllEvalAutomorphismKeys()) {
-            if (k.second->begin()->second->GetCryptoContext() == cc) {
+            if (!k.second->empty() && k.second->begin()->second->GetCryptoContext() == cc) {
                 omap[k.first] = k.second;
             }
         }
@@ -929,6 +928,59 @@ public:
         return true;
     }
 
+    /**
+    * @brief Writes the EvalAutomorphism keys for keyTag to a flat, memory-mappable key-store file
+    *
+    * @param path file to write; replaced atomically
+    * @param keyTag secret key tag
+    * @return true on success
+    * @attention See EvalKeyStore for the format. Throws if there are no keys for keyTag
+    */
+    static bool SerializeEvalAutomorphismKeyStore(const std::string& path, const std::string& keyTag);
+
+    /**
+    * @brief Maps a key-store file written by SerializeEvalAutomorphismKeyStore and adds its keys for cc
+    *
+    * @param path file to map
+    * @param cc the CryptoContext the keys belong to
+    * @return true on success
+    * @attention The key towers are views into the mapping and nothing is parsed per coefficient.
+    * Indices that already have a key for the store's keyTag keep it
+    */
+    static bool DeserializeEvalAutomorphismKeyStore(const std::string& path, const CryptoContext<Element>& cc);
+
+    /**
+    * @brief Maps a key-store file like DeserializeEvalAutomorphismKeyStore, but adds keys that are only
+    * loaded when an operation first uses them
+    *
+    * @param path file to map
+    * @param cc the CryptoContext the keys belong to
+    * @param budgetBytes memory budget for the loaded keys (0: no limit); the least recently used keys
+    * above it drop their pages and are read back from the file when used again
+    * @return the lazy key map, for prefetch hints, the budget and statistics
+    * @attention Indices that already have a key for the store's keyTag keep it. See LazyEvalKeyMap
+    */
+    static std::shared_ptr<LazyEvalKeyMap> DeserializeEvalAutomorphismKeyStoreLazy(const std::string& path,
+                                                                                const CryptoContext<Element>& cc,
+                                                                                size_t budgetBytes = 0);
+
+    /**
+    * @brief Returns the lazy key map behind the EvalAutomorphism keys for keyTag
+    *
+    * @param keyTag secret key tag
+    * @return the lazy key map or nullptr if the keys for keyTag were not added lazily
+    */
+    static std::shared_ptr<LazyEvalKeyMap> GetLazyEvalAutomorphismKeyMap(const std::string& keyTag);
+
+    /**
+    * @brief Asks the OS to read the lazily loaded EvalAutomorphism keys for the given indices ahead of use
+    *
+    * @param keyTag secret key tag
+    * @param indexList automorphism indices (not rotation indices)
+    * @attention No-op if the keys for keyTag were not added lazily
+    */
+    static void PrefetchEvalAutomorphismKeys(const std::string& keyTag, const std::vector<uint32_t>& indexList);
+
     /**
     * @brief Clears the entire EvalAutomorphismKey cache
     */
@@ -1077,23 +1129,31 @@ public:
     //------------------------------------------------------------------------------
 
     /**
-    * @brief Gets a map of all relinearization/evaluation multiplication keys
+    * @brief Gets a snapshot of all relinearization/evaluation multiplication keys
     * @return std::map where the map key/data pair is "keyTag"/"EvalMultKeys vector"
     */
-    static std::map<std::string, std::vector<EvalKey<Element>>>& GetAllEvalMultKeys();
+    static std::map<std::string, std::vector<EvalKey<Element>>> GetAllEvalMultKeys();
 
     /**
     * @brief Gets a vector of relinearization/evaluation multiplication keys for the given keyTag
     * @param keyTag secret key tag
-    * @return vector of EvalMultKeys
+    * @return vector of EvalMultKeys, valid on the calling thread until it fetches keyTag again
+    *         or clears it; use GetEvalMultKeyVectorPtr() to hold the keys longer
     */
     static const std::vector<EvalKey<Element>>& GetEvalMultKeyVector(const std::string& keyTag);
 
     /**
-    * @brief Gets a map of all EvalAutomorphism keys
+    * @brief Gets a vector of relinearization/evaluation multiplication keys for the given keyTag
+    * @param keyTag secret key tag
+    * @return shared_ptr to the EvalMultKeys vector
+    */
+    static std::shared_ptr<std::vector<EvalKey<Element>>> GetEvalMultKeyVectorPtr(const std::string& keyTag);
+
+    /**
+    * @brief Gets a snapshot of all EvalAutomorphism keys
     * @return std::map where the map key/data pair is "keyTag"/"shared_ptr to EvalMultKey map"
     */
-    static std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>& GetAllEvalAutomorphismKeys();
+    static std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>> GetAllEvalAutomorphismKeys();
 
     /**
     * @brief Gets a map of EvalAutomorphism keys for the given keyTag
@@ -1106,17 +1166,16 @@ public:
     /**
     * @brief Gets a map of EvalAutomorphism keys for the given keyTag
     * @param keyTag secret key tag
-    * @return EvalAutomorphismKey map
+    * @return EvalAutomorphismKey map, valid on the calling thread until it fetches keyTag again
+    *         or clears it; use GetEvalAutomorphismKeyMapPtr() to hold the keys longer
     */
-    static std::map<uint32_t, EvalKey<Element>>& GetEvalAutomorphismKeyMap(const std::string& keyTag) {
-        return *(CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(keyTag));
-    }
+    static const std::map<uint32_t, EvalKey<Element>>& GetEvalAutomorphismKeyMap(const std::string& keyTag);
 
     /**
-    * @brief Gets a map of all summation keys
+    * @brief Gets a snapshot of all summation keys
     * @return std::map where the map key/data pair is "keyTag"/"shared_ptr to EvalSumKey map"
     */
-    static std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>& GetAllEvalSumKeys();
+    static std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>> GetAllEvalSumKeys();
 
     /**
     * @brief Gets a map of EvalSum keys for the given keyTag
@@ -1882,11 +1941,11 @@ public:
     Ciphertext<Element> EvalMult(ConstCiphertext<Element>& ciphertext1, ConstCiphertext<Element>& ciphertext2) const {
         TypeCheck(ciphertext1, ciphertext2);
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext1->GetKeyTag());
-        if (!evalKeyVec.size())
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext1->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalMult");
 
-        return GetScheme()->EvalMult(ciphertext1, ciphertext2, evalKeyVec[0]);
+        return GetScheme()->EvalMult(ciphertext1, ciphertext2, (*evalKeyVec)[0]);
     }
 
     /**
@@ -1899,11 +1958,11 @@ public:
     Ciphertext<Element> EvalMultMutable(Ciphertext<Element>& ciphertext1, Ciphertext<Element>& ciphertext2) const {
         TypeCheck(ciphertext1, ciphertext2);
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext1->GetKeyTag());
-        if (!evalKeyVec.size())
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext1->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalMultMutable");
 
-        return GetScheme()->EvalMultMutable(ciphertext1, ciphertext2, evalKeyVec[0]);
+        return GetScheme()->EvalMultMutable(ciphertext1, ciphertext2, (*evalKeyVec)[0]);
     }
 
     /**
@@ -1915,11 +1974,11 @@ public:
     void EvalMultMutableInPlace(Ciphertext<Element>& ciphertext1, Ciphertext<Element>& ciphertext2) const {
         TypeCheck(ciphertext1, ciphertext2);
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext1->GetKeyTag());
-        if (!evalKeyVec.size())
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext1->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalMultMutableInPlace");
 
-        GetScheme()->EvalMultMutableInPlace(ciphertext1, ciphertext2, evalKeyVec[0]);
+        GetScheme()->EvalMultMutableInPlace(ciphertext1, ciphertext2, (*evalKeyVec)[0]);
     }
 
     /**
@@ -1931,11 +1990,11 @@ public:
     Ciphertext<Element> EvalSquare(ConstCiphertext<Element>& ciphertext) const {
         ValidateCiphertext(ciphertext);
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext->GetKeyTag());
-        if (!evalKeyVec.size())
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalSquare");
 
-        return GetScheme()->EvalSquare(ciphertext, evalKeyVec[0]);
+        return GetScheme()->EvalSquare(ciphertext, (*evalKeyVec)[0]);
     }
 
     /**
@@ -1947,11 +2006,11 @@ public:
     Ciphertext<Element> EvalSquareMutable(Ciphertext<Element>& ciphertext) const {
         ValidateCiphertext(ciphertext);
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext->GetKeyTag());
-        if (!evalKeyVec.size())
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalSquareMutable");
 
-        return GetScheme()->EvalSquareMutable(ciphertext, evalKeyVec[0]);
+        return GetScheme()->EvalSquareMutable(ciphertext, (*evalKeyVec)[0]);
     }
 
     /**
@@ -1962,11 +2021,11 @@ public:
     void EvalSquareInPlace(Ciphertext<Element>& ciphertext) const {
         ValidateCiphertext(ciphertext);
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext->GetKeyTag());
-        if (!evalKeyVec.size())
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalSquareInPlace");
 
-        GetScheme()->EvalSquareInPlace(ciphertext, evalKeyVec[0]);
+        GetScheme()->EvalSquareInPlace(ciphertext, (*evalKeyVec)[0]);
     }
 
     /**
@@ -2034,12 +2093,12 @@ public:
         if (!ciphertext)
             OPENFHE_THROW("Input ciphertext is nullptr");
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext->GetKeyTag());
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext->GetKeyTag());
 
-        if (evalKeyVec.size() < (ciphertext->NumberCiphertextElements() - 2))
+        if (evalKeyVec->size() < (ciphertext->NumberCiphertextElements() - 2))
             OPENFHE_THROW("Insufficient value was used for maxRelinSkDeg to generate keys for Relinearize");
 
-        return GetScheme()->Relinearize(ciphertext, evalKeyVec);
+        return GetScheme()->Relinearize(ciphertext, *evalKeyVec);
     }
 
     /**
@@ -2052,11 +2111,11 @@ public:
         if (!ciphertext)
             OPENFHE_THROW("Input ciphertext is nullptr");
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext->GetKeyTag());
-        if (evalKeyVec.size() < (ciphertext->NumberCiphertextElements() - 2))
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext->GetKeyTag());
+        if (evalKeyVec->size() < (ciphertext->NumberCiphertextElements() - 2))
             OPENFHE_THROW("Insufficient value was used for maxRelinSkDeg to generate keys for RelinearizeInPlace");
 
-        GetScheme()->RelinearizeInPlace(ciphertext, evalKeyVec);
+        GetScheme()->RelinearizeInPlace(ciphertext, *evalKeyVec);
     }
 
     /**
@@ -2071,14 +2130,14 @@ public:
         if (!ciphertext1 || !ciphertext2)
             OPENFHE_THROW("Input ciphertext is nullptr");
 
-        const auto& evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext1->GetKeyTag());
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext1->GetKeyTag());
 
-        if (evalKeyVec.size() <
+        if (evalKeyVec->size() <
             (ciphertext1->NumberCiphertextElements() + ciphertext2->NumberCiphertextElements() - 3)) {
             OPENFHE_THROW("Insufficient value was used for maxRelinSkDeg to generate keys for EvalMultAndRelinearize");
         }
 
-        return GetScheme()->EvalMultAndRelinearize(ciphertext1, ciphertext2, evalKeyVec);
+        return GetScheme()->EvalMultAndRelinearize(ciphertext1, ciphertext2, *evalKeyVec);
     }
 
     Ciphertext<Element> EvalMultNoCheck(ConstCiphertext<Element>& ctxt, NativeInteger k) const {
@@ -2331,8 +2390,8 @@ public:
     Ciphertext<Element> EvalRotate(ConstCiphertext<Element>& ciphertext, int32_t index) const {
         ValidateCiphertext(ciphertext);
 
-        auto evalKeyMap = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ciphertext->GetKeyTag());
-        return GetScheme()->EvalAtIndex(ciphertext, index, evalKeyMap);
+        const auto evalKeyMap = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertext->GetKeyTag());
+        return GetScheme()->EvalAtIndex(ciphertext, index, *evalKeyMap);
     }
 
     /**
@@ -2404,8 +2463,30 @@ public:
     */
     Ciphertext<Element> EvalFastRotationExt(ConstCiphertext<Element>& ciphertext, uint32_t index,
                                             const std::shared_ptr<std::vector<Element>> digits, bool addFirst) const {
-        auto evalKeyMap = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ciphertext->GetKeyTag());
-        return GetScheme()->EvalFastRotationExt(ciphertext, index, digits, addFirst, evalKeyMap);
+        const auto evalKeyMap = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertext->GetKeyTag());
+        return GetScheme()->EvalFastRotationExt(ciphertext, index, digits, addFirst, *evalKeyMap);
+    }
+
+    /**
+    * @brief Performs EvalFastRotationExt for several rotation indices of the same ciphertext,
+    * e.g. the baby steps of a baby-step/giant-step linear transform.
+    *
+    * With an accelerator the digits are uploaded once and the automorphisms and key-switching
+    * products of all indices run on the device; otherwise this is one EvalFastRotationExt per index.
+    * Only supported with hybrid key switching.
+    *
+    * @param ciphertext  Input ciphertext.
+    * @param indices     Rotation indices (positive for left, negative for right); 0 gives KeySwitchExt.
+    * @param digits      Precomputed digits for the ciphertext.
+    * @param addFirst    If true, the first element c0 is also computed.
+    * @return Rotated ciphertexts in extended basis, in the order of indices.
+    */
+    std::vector<Ciphertext<Element>> EvalFastRotationExtBatch(ConstCiphertext<Element>& ciphertext,
+                                                              const std::vector<int32_t>& indices,
+                                                              const std::shared_ptr<std::vector<Element>> digits,
+                                                              bool addFirst) const {
+        const auto evalKeyMap = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertext->GetKeyTag());
+        return GetScheme()->EvalFastRotationExtBatch(ciphertext, indices, digits, addFirst, *evalKeyMap);
     }
 
     /**
@@ -2508,11 +2589,11 @@ public:
         ValidateCiphertext(ciphertext1);
         ValidateCiphertext(ciphertext2);
 
-        auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertext1->GetKeyTag());
-        if (0 == evalKeyVec.size())
+        auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertext1->GetKeyTag());
+        if (evalKeyVec->empty())
             OPENFHE_THROW("Evaluation key has not been generated for EvalMult");
 
-        return GetScheme()->ComposedEvalMult(ciphertext1, ciphertext2, evalKeyVec[0]);
+        return GetScheme()->ComposedEvalMult(ciphertext1, ciphertext2, (*evalKeyVec)[0]);
     }
 
     /**
@@ -2647,10 +2728,10 @@ public:
             OPENFHE_THROW("Empty input ciphertext vector");
         if (ciphertextVec.size() == 1)
             return ciphertextVec[0];
-        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVector(ciphertextVec[0]->GetKeyTag());
-        if (evalKeyVec.size() < (ciphertextVec[0]->NumberCiphertextElements() - 2))
+        const auto evalKeyVec = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ciphertextVec[0]->GetKeyTag());
+        if (evalKeyVec->size() < (ciphertextVec[0]->NumberCiphertextElements() - 2))
             OPENFHE_THROW("Insufficient value was used for maxRelinSkDeg to generate keys");
-        return GetScheme()->EvalMultMany(ciphertextVec, evalKeyVec);
+        return GetScheme()->EvalMultMany(ciphertextVec, *evalKeyVec);
     }
 
     //------------------------------------------------------------------------------
@@ -0,0 +1,216 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef LBCRYPTO_CRYPTO_KEY_EVALKEY_LAZY_H
+#define LBCRYPTO_CRYPTO_KEY_EVALKEY_LAZY_H
+
+#include "cryptocontext-fwd.h"
+#include "key/evalkey-store.h"
+#include "key/evalkeyrelin.h"
+#include "lattice/lat-hal.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lbcrypto {
+
+// ---------------------------------------------------------------------------
+// Automorphism keys of one key tag, loaded from an EvalKeyStore on first use.
+//
+// GetKeyMap() returns one LazyEvalKeyRelin per index of the store, to be
+// inserted into the automorphism key map like any other keys: lookups and
+// "key map is empty" checks behave as before, but a key's views are only
+// built the first time its a/b vectors are read.
+//
+// Each access stamps the key with a use counter; the keys accessed since their
+// pages were last dropped are resident. When the resident keys hold more than
+// the byte budget, the least recently used ones drop their pages from the
+// process (EvalKeyStore::Advise); the views stay valid and a later access reads
+// the pages back from the file. The budget therefore bounds the key memory of a
+// mapped store; without mmap the whole file is resident anyway and the budget
+// has no effect. An access to a resident key only writes that key's own stamp
+// (nothing at all if it is already the most recent); the map's lock is taken
+// when a key becomes resident.
+//
+// Prefetch() asks the OS to start reading keys ahead of use, e.g. the keys of
+// the next bootstrapping stage while the current one runs.
+// All members are thread-safe.
+// ---------------------------------------------------------------------------
+class LazyEvalKeyMap : public std::enable_shared_from_this<LazyEvalKeyMap> {
+public:
+    struct Stats {
+        size_t loads{0};      // keys whose views were built
+        size_t evictions{0};  // keys that dropped their pages for the budget
+    };
+
+    // budgetBytes = 0: no limit
+    static std::shared_ptr<LazyEvalKeyMap> Create(std::shared_ptr<EvalKeyStore> store,
+                                                  const CryptoContext<DCRTPoly>& cc, size_t budgetBytes = 0);
+
+    // One not yet loaded key per index of the store, tagged with GetKeyTag()
+    std::shared_ptr<std::map<uint32_t, EvalKey<DCRTPoly>>> GetKeyMap();
+
+    const std::string& GetKeyTag() const {
+        return m_store->GetKeyTag();
+    }
+    const std::shared_ptr<EvalKeyStore>& GetStore() const {
+        return m_store;
+    }
+
+    // Read-ahead hint for the keys of the given automorphism indices; absent indices are skipped
+    void Prefetch(const std::vector<uint32_t>& indices) const;
+
+    void SetBudget(size_t budgetBytes);
+    size_t GetBudget() const;
+    // Bytes of the resident keys
+    size_t GetResidentBytes() const;
+    // Indices of the resident keys, most recently used first
+    std::vector<uint32_t> GetResidentIndices() const;
+    Stats GetStats() const;
+
+private:
+    friend class LazyEvalKeyRelin;
+
+    // Use stamp and residency of one key. The slots are made with the map and
+    // never move, so each key keeps a pointer to its own
+    struct Slot {
+        uint32_t index{0};
+        std::atomic<uint64_t> lastUse{0};
+        std::atomic<bool> resident{false};
+    };
+
+    LazyEvalKeyMap(std::shared_ptr<EvalKeyStore> store, const CryptoContext<DCRTPoly>& cc, size_t budgetBytes);
+
+    Slot& SlotOf(uint32_t index);
+    void Load(uint32_t index, EvalKeyImpl<DCRTPoly>& key);
+    void Touch(Slot& slot);
+    // drops the pages of the least recently used keys until the budget holds
+    // (the most recent key always stays); m_mutex held
+    void EnforceBudget();
+
+    std::shared_ptr<EvalKeyStore> m_store;
+    CryptoContext<DCRTPoly> m_cc;
+    std::shared_ptr<DCRTPoly::Params> m_params;
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::unordered_map<uint32_t, Slot*> m_slotOf;  // not modified after construction
+    std::atomic<uint64_t> m_clock{1};  // ahead of the stamp of a key never used
+
+    mutable std::mutex m_mutex;  // residency changes, budget and stats
+    size_t m_budget;
+    size_t m_resident{0};
+    size_t m_residentKeys{0};
+    Stats m_stats;
+};
+
+// ---------------------------------------------------------------------------
+// EvalKeyRelin whose a/b vectors are views into an EvalKeyStore, built on the
+// first read. cereal writes the vectors like a plain EvalKeyRelin (loading the
+// key first); a deserialized key holds its vectors itself, with no store behind
+// it. Key stores are written with SerializeEvalAutomorphismKeyStore.
+// ---------------------------------------------------------------------------
+class LazyEvalKeyRelin : public EvalKeyRelinImpl<DCRTPoly> {
+public:
+    LazyEvalKeyRelin(std::shared_ptr<LazyEvalKeyMap> owner, uint32_t index);
+
+    // An empty key for deserialization
+    LazyEvalKeyRelin() = default;
+
+    const std::vector<DCRTPoly>& GetAVector() const override {
+        Load();
+        return EvalKeyRelinImpl<DCRTPoly>::GetAVector();
+    }
+
+    const std::vector<DCRTPoly>& GetBVector() const override {
+        Load();
+        return EvalKeyRelinImpl<DCRTPoly>::GetBVector();
+    }
+
+    bool key_compare(const EvalKeyImpl<DCRTPoly>& rhs) const override;
+
+    uint32_t GetIndex() const {
+        return m_index;
+    }
+    const std::shared_ptr<LazyEvalKeyMap>& GetOwner() const {
+        return m_owner;
+    }
+    bool IsLoaded() const;
+
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::base_class<EvalKeyImpl<DCRTPoly>>(this));
+        ar(::cereal::make_nvp("ak", GetAVector()));
+        ar(::cereal::make_nvp("bk", GetBVector()));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        if (version > SerializedVersion()) {
+            OPENFHE_THROW("serialized object version " + std::to_string(version) +
+                          " is from a later version of the library");
+        }
+        ar(::cereal::base_class<EvalKeyImpl<DCRTPoly>>(this));
+        std::vector<DCRTPoly> a, b;
+        ar(::cereal::make_nvp("ak", a));
+        ar(::cereal::make_nvp("bk", b));
+        SetAVector(std::move(a));
+        SetBVector(std::move(b));
+        m_loaded.store(true, std::memory_order_release);
+    }
+
+    std::string SerializedObjectName() const override {
+        return "LazyEvalKeyRelin";
+    }
+
+    static uint32_t SerializedVersion() {
+        return 1;
+    }
+
+private:
+    void Load() const;
+
+    std::shared_ptr<LazyEvalKeyMap> m_owner;  // nullptr: deserialized, the vectors are in the key
+    LazyEvalKeyMap::Slot* m_slot{nullptr};
+    uint32_t m_index{0};
+    mutable std::once_flag m_once;
+    mutable std::atomic<bool> m_loaded{false};
+};
+
+}  // namespace lbcrypto
+
+#endif  // LBCRYPTO_CRYPTO_KEY_EVALKEY_LAZY_H
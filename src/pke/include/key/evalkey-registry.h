@@ -0,0 +1,225 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef LBCRYPTO_CRYPTO_KEY_EVALKEY_REGISTRY_H
+#define LBCRYPTO_CRYPTO_KEY_EVALKEY_REGISTRY_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace lbcrypto {
+
+// ---------------------------------------------------------------------------
+// Process-wide eval keys by key tag, safe to read and modify from any thread.
+//
+// Tags are spread over NUM_SHARDS shards, each with its own reader-writer lock,
+// so lookups only share a lock with lookups of tags in the same shard, and a
+// writer only blocks its own shard.
+//
+// Published values are never modified: Update() builds a new value from the
+// current one and swaps it in under the shard's lock (copy-on-write), so a
+// reader holding the shared_ptr from Find() keeps a consistent snapshot, and a
+// replaced value is freed once its last reader lets go.
+//
+// Pin() serves callers that need a plain reference: it keeps the value alive
+// for the calling thread until that thread pins the same tag again, or until it
+// erases the tag. Each thread holds at most one pinned value per tag.
+// ---------------------------------------------------------------------------
+template <typename Value>
+class EvalKeyRegistry {
+public:
+    static constexpr size_t NUM_SHARDS = 16;
+
+    // Current value for tag, or nullptr
+    std::shared_ptr<Value> Find(const std::string& tag) const {
+        const auto& shard = ShardOf(tag);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        const auto it = shard.entries.find(tag);
+        return (it == shard.entries.end()) ? nullptr : it->second;
+    }
+
+    // Current value for tag, or nullptr; the value stays alive for the calling
+    // thread until it pins tag again or erases it (see above)
+    const Value* Pin(const std::string& tag) const {
+        auto value = Find(tag);
+        if (!value) {
+            Pins().erase(tag);
+            return nullptr;
+        }
+        auto& pinned = Pins()[tag];
+        pinned.swap(value);
+        return pinned.get();
+    }
+
+    bool Contains(const std::string& tag) const {
+        return Find(tag) != nullptr;
+    }
+
+    // Atomically replaces the value for tag by update(current), where current is
+    // nullptr if the tag is absent; update returns nullptr to leave the tag as is.
+    // Runs under the shard's write lock: keep it to merging, not key generation.
+    // Returns the value for tag after the call.
+    template <typename F>
+    std::shared_ptr<Value> Update(const std::string& tag, F&& update) {
+        auto& shard = ShardOf(tag);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.entries.find(tag);
+        std::shared_ptr<const Value> current;
+        if (it != shard.entries.end())
+            current = it->second;
+        std::shared_ptr<Value> next = update(current);
+        if (!next)
+            return std::const_pointer_cast<Value>(current);
+        if (it == shard.entries.end())
+            shard.entries.emplace(tag, next);
+        else
+            // readers of the replaced value keep it alive through their shared_ptr
+            it->second = next;
+        return next;
+    }
+
+    // Sets the value for tag unless there is one; returns whether it was inserted
+    bool InsertIfAbsent(const std::string& tag, std::shared_ptr<Value> value) {
+        bool inserted = false;
+        Update(tag, [&](const std::shared_ptr<const Value>& current) {
+            inserted = (current == nullptr);
+            return inserted ? std::move(value) : nullptr;
+        });
+        return inserted;
+    }
+
+    bool Erase(const std::string& tag) {
+        auto& shard = ShardOf(tag);
+        Pins().erase(tag);
+        Entry erased;
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            const auto it = shard.entries.find(tag);
+            if (it == shard.entries.end())
+                return false;
+            erased = std::move(it->second);
+            shard.entries.erase(it);
+        }
+        // the keys are released outside the lock
+        return true;
+    }
+
+    // Erases every tag for which pred(tag, value) holds; returns the number erased
+    template <typename Pred>
+    size_t EraseIf(Pred&& pred) {
+        size_t count = 0;
+        for (auto& shard : m_shards) {
+            // declared before the lock, so the keys are released after it
+            std::vector<Entry> erased;
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                if (pred(it->first, static_cast<const Value&>(*it->second))) {
+                    Pins().erase(it->first);
+                    erased.push_back(std::move(it->second));
+                    it = shard.entries.erase(it);
+                    ++count;
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+        return count;
+    }
+
+    void Clear() {
+        Pins().clear();
+        for (auto& shard : m_shards) {
+            std::unordered_map<std::string, Entry> erased;
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            erased.swap(shard.entries);
+        }
+    }
+
+    // Current values of all tags, ordered by tag. Each shard is read atomically;
+    // tags of different shards may be seen at slightly different times.
+    std::map<std::string, std::shared_ptr<Value>> Snapshot() const {
+        std::map<std::string, std::shared_ptr<Value>> all;
+        for (const auto& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (const auto& [tag, entry] : shard.entries)
+                all.emplace(tag, entry);
+        }
+        return all;
+    }
+
+    size_t Size() const {
+        size_t count = 0;
+        for (const auto& shard : m_shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.entries.size();
+        }
+        return count;
+    }
+
+private:
+    using Entry = std::shared_ptr<Value>;
+
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<std::string, Entry> entries;
+    };
+
+    Shard& ShardOf(const std::string& tag) {
+        return m_shards[std::hash<std::string>{}(tag) % NUM_SHARDS];
+    }
+    const Shard& ShardOf(const std::string& tag) const {
+        return m_shards[std::hash<std::string>{}(tag) % NUM_SHARDS];
+    }
+
+    // values this thread pinned in this registry, by tag
+    std::unordered_map<std::string, std::shared_ptr<Value>>& Pins() const {
+        thread_local std::unordered_map<const EvalKeyRegistry*,
+                                        std::unordered_map<std::string, std::shared_ptr<Value>>>
+            pins;
+        return pins[this];
+    }
+
+    std::array<Shard, NUM_SHARDS> m_shards;
+};
+
+}  // namespace lbcrypto
+
+#endif  // LBCRYPTO_CRYPTO_KEY_EVALKEY_REGISTRY_H
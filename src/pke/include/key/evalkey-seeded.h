@@ -0,0 +1,115 @@
+#ifndef LBCRYPTO_CRYPTO_KEY_EVALKEY_SEEDED_H
+#define LBCRYPTO_CRYPTO_KEY_EVALKEY_SEEDED_H
+
+#include "cryptocontext-fwd.h"
+#include "key/evalkeyrelin.h"
+#include "lattice/lat-hal.h"
+#include "math/seeduniformgenerator.h"
+#include "utils/exception.h"
+
+#include "cereal/types/array.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lbcrypto {
+
+// ---------------------------------------------------------------------------
+// Format of the keys KeySwitchHYBRID generates (process-wide, like the HKS
+// strategy). Keys that exist keep their format when it changes.
+// ---------------------------------------------------------------------------
+enum class EvalKeyFormat {
+    FULL,    // a and b vectors stored
+    SEEDED,  // b vector stored, a regenerated from a seed (SeededEvalKeyRelin)
+};
+
+inline EvalKeyFormat& GetEvalKeyFormat() {
+    static EvalKeyFormat f = EvalKeyFormat::FULL;
+    return f;
+}
+
+inline void SetEvalKeyFormat(EvalKeyFormat f) {
+    GetEvalKeyFormat() = f;
+}
+
+// ---------------------------------------------------------------------------
+// EvalKeyRelin whose uniformly random a vector is not stored: a[j] is
+// DCRTPoly::FromSeed(params of b[j], seed, j). The key holds b and a 64-byte
+// seed, half the memory and serialized size of a full key.
+//
+// The key multiply-accumulate of KeySwitchHYBRID expands the towers of a it
+// needs on the fly, and the device key-switch paths (FUSED, batched rotations)
+// expand a into a buffer of their own for the call (ExpandAVector), so neither
+// materializes a in the key. Only the other readers of GetAVector() (BV key
+// switching, threshold HE, EvalKeyStore::Write) get a expanded once and cached
+// in the key for its lifetime, after which the key takes the memory of a full
+// one. The cache is not serialized.
+// ---------------------------------------------------------------------------
+class SeededEvalKeyRelin : public EvalKeyRelinImpl<DCRTPoly> {
+public:
+    explicit SeededEvalKeyRelin(const CryptoContext<DCRTPoly>& cc) : EvalKeyRelinImpl<DCRTPoly>(cc) {}
+
+    SeededEvalKeyRelin() = default;
+
+    // Expands a on the first call. a is defined by the seed: set it with SetSeed(), not SetAVector()
+    const std::vector<DCRTPoly>& GetAVector() const override;
+
+    // a expanded from the seed, not cached in the key
+    std::vector<DCRTPoly> ExpandAVector() const;
+
+    const PRNGSeed& GetSeed() const {
+        return m_seed;
+    }
+    // Also drops an expanded a; not safe while other threads use the key
+    void SetSeed(const PRNGSeed& seed);
+
+    // Whether GetAVector() has expanded and cached a
+    bool IsExpanded() const {
+        return m_expanded.load(std::memory_order_acquire);
+    }
+
+    bool key_compare(const EvalKeyImpl<DCRTPoly>& rhs) const override;
+
+    template <class Archive>
+    void save(Archive& ar, std::uint32_t const version) const {
+        ar(::cereal::base_class<EvalKeyImpl<DCRTPoly>>(this));
+        ar(::cereal::make_nvp("seed", m_seed));
+        ar(::cereal::make_nvp("bk", GetBVector()));
+    }
+
+    template <class Archive>
+    void load(Archive& ar, std::uint32_t const version) {
+        if (version > SerializedVersion()) {
+            OPENFHE_THROW("serialized object version " + std::to_string(version) +
+                          " is from a later version of the library");
+        }
+        ar(::cereal::base_class<EvalKeyImpl<DCRTPoly>>(this));
+        PRNGSeed seed;
+        ar(::cereal::make_nvp("seed", seed));
+        std::vector<DCRTPoly> b;
+        ar(::cereal::make_nvp("bk", b));
+        SetBVector(std::move(b));
+        SetSeed(seed);
+    }
+
+    std::string SerializedObjectName() const override {
+        return "SeededEvalKeyRelin";
+    }
+
+    static uint32_t SerializedVersion() {
+        return 1;
+    }
+
+private:
+    PRNGSeed m_seed{};
+    mutable std::mutex m_mutex;
+    mutable std::atomic<bool> m_expanded{false};
+};
+
+}  // namespace lbcrypto
+
+#endif  // LBCRYPTO_CRYPTO_KEY_EVALKEY_SEEDED_H
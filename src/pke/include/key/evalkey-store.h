@@ -0,0 +1,158 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+#ifndef LBCRYPTO_CRYPTO_KEY_EVALKEY_STORE_H
+#define LBCRYPTO_CRYPTO_KEY_EVALKEY_STORE_H
+
+#include "cryptocontext-fwd.h"
+#include "key/evalkey-fwd.h"
+#include "lattice/lat-hal.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lbcrypto {
+
+// ---------------------------------------------------------------------------
+// Flat, memory-mappable file of EvalKeyRelin<DCRTPoly> keys for one key tag
+// (automorphism keys: one key per index).
+//
+// Layout, version 1, host byte order (Open() rejects a file written with the
+// other byte order by its byte-swapped version field):
+//   header     EvalKeyStoreHeader
+//   key tag    keyTagBytes chars
+//   towers     numTowers x {modulus, root of unity} of the key basis
+//   directory  numKeys x EvalKeyStoreEntry, sorted by index
+//   key data   one page-aligned block per key: b[0..numDigits), then a[0..numDigits),
+//              each polynomial numTowers x ringDim 64-bit words, tower after tower
+//
+// Open() maps the file read-only and GetKey() builds each polynomial as a
+// TowerSlab view into the mapping: nothing is copied or parsed, and all
+// processes that map the same file share its page cache. The views must not be
+// written: key switching only reads the keys and a copy of a view lives on the
+// heap, but modifying a key polynomial in place faults on the mapping.
+// ---------------------------------------------------------------------------
+struct EvalKeyStoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t headerBytes;
+    uint64_t fileBytes;
+    uint32_t cyclotomicOrder;
+    uint32_t ringDim;
+    uint32_t numTowers;
+    uint32_t numKeys;
+    uint32_t keyTagBytes;
+    uint32_t reserved0;
+    uint64_t keyTagOffset;
+    uint64_t towersOffset;
+    uint64_t directoryOffset;
+    uint64_t reserved[3];
+};
+
+struct EvalKeyStoreEntry {
+    uint32_t index;
+    uint32_t numDigits;
+    uint32_t format;  // Format of every polynomial of the key
+    uint32_t reserved;
+    uint64_t offset;  // start of the key data, page aligned
+    uint64_t bytes;   // 2 x numDigits x numTowers x ringDim x 8
+};
+
+class EvalKeyStore {
+public:
+    static constexpr uint32_t VERSION     = 1;
+    static constexpr size_t KEY_ALIGNMENT = 4096;
+
+    // Writes keys to path. Every key must be an EvalKeyRelin whose polynomials
+    // share one tower basis; throws otherwise or on an I/O error.
+    static void Write(const std::string& path, const std::map<uint32_t, EvalKey<DCRTPoly>>& keys,
+                      const std::string& keyTag);
+
+    // Maps path and validates the header and directory; throws on a malformed file
+    static std::shared_ptr<EvalKeyStore> Open(const std::string& path);
+
+    const std::string& GetKeyTag() const {
+        return m_keyTag;
+    }
+    uint32_t GetRingDimension() const {
+        return m_header->ringDim;
+    }
+    size_t GetNumKeys() const {
+        return m_header->numKeys;
+    }
+    std::vector<uint32_t> GetIndices() const;
+    bool Contains(uint32_t index) const {
+        return Find(index) != nullptr;
+    }
+    // Mapped bytes of the key for index (0 if absent)
+    size_t GetKeyBytes(uint32_t index) const;
+
+    // Key for index with views into the mapping, attached to cc and tagged with
+    // GetKeyTag(). The towers are matched by modulus against cc's Q and P bases;
+    // throws if the index is absent or a tower (modulus and root of unity) is not in cc.
+    EvalKey<DCRTPoly> GetKey(uint32_t index, const CryptoContext<DCRTPoly>& cc) const;
+    std::shared_ptr<std::map<uint32_t, EvalKey<DCRTPoly>>> GetAllKeys(const CryptoContext<DCRTPoly>& cc) const;
+
+    // Key basis built from cc's towers (see GetKey), to share between LoadKey calls
+    std::shared_ptr<DCRTPoly::Params> GetParams(const CryptoContext<DCRTPoly>& cc) const;
+    // Sets the a/b vectors of key to views of the key for index; throws if the index is absent
+    void LoadKey(uint32_t index, const std::shared_ptr<DCRTPoly::Params>& params, EvalKeyImpl<DCRTPoly>& key) const;
+
+    // Whether the keys are views into a file mapping (false: the file was read into memory)
+    bool IsMapped() const;
+    // Page-cache hint for the data of the key for index: willNeed starts reading it
+    // ahead; otherwise the process drops its pages, which are read back from the file
+    // on the next access. No-op when the store is not mapped or the index is absent.
+    void Advise(uint32_t index, bool willNeed) const;
+
+private:
+    struct Mapping;
+
+    explicit EvalKeyStore(std::shared_ptr<Mapping> mapping);
+
+    const EvalKeyStoreEntry* Find(uint32_t index) const;
+    void MakeKey(const EvalKeyStoreEntry& e, const std::shared_ptr<DCRTPoly::Params>& params,
+                 EvalKeyImpl<DCRTPoly>& key) const;
+
+    std::shared_ptr<Mapping> m_mapping;
+    const EvalKeyStoreHeader* m_header{nullptr};
+    const uint64_t* m_towers{nullptr};
+    const EvalKeyStoreEntry* m_directory{nullptr};
+    std::string m_keyTag;
+};
+
+}  // namespace lbcrypto
+
+#endif  // LBCRYPTO_CRYPTO_KEY_EVALKEY_STORE_H
@@ -37,6 +37,8 @@
 #define LBCRYPTO_CRYPTO_KEY_KEY_SER_H
 
 #include "key/evalkeyrelin.h"
+#include "key/evalkey-seeded.h"
+#include "key/evalkey-lazy.h"
 #include "utils/serial.h"
 
 CEREAL_REGISTER_TYPE(lbcrypto::EvalKeyImpl<lbcrypto::DCRTPoly>);
@@ -45,4 +47,12 @@ CEREAL_REGISTER_TYPE(lbcrypto::EvalKeyRelinImpl<lbcrypto::DCRTPoly>);
 CEREAL_REGISTER_POLYMORPHIC_RELATION(lbcrypto::EvalKeyImpl<lbcrypto::DCRTPoly>,
                                      lbcrypto::EvalKeyRelinImpl<lbcrypto::DCRTPoly>);
 
+CEREAL_REGISTER_TYPE(lbcrypto::SeededEvalKeyRelin);
+
+CEREAL_REGISTER_POLYMORPHIC_RELATION(lbcrypto::EvalKeyRelinImpl<lbcrypto::DCRTPoly>, lbcrypto::SeededEvalKeyRelin);
+
+CEREAL_REGISTER_TYPE(lbcrypto::LazyEvalKeyRelin);
+
+CEREAL_REGISTER_POLYMORPHIC_RELATION(lbcrypto::EvalKeyRelinImpl<lbcrypto::DCRTPoly>, lbcrypto::LazyEvalKeyRelin);
+
 #endif
@@ -0,0 +1,111 @@
+#ifndef LBCRYPTO_CRYPTO_KEYSWITCH_HKS_AUTOTUNER_H
+#define LBCRYPTO_CRYPTO_KEYSWITCH_HKS_AUTOTUNER_H
+
+#include "keyswitch/hks_strategy.h"
+#include "lattice/lat-hal.h"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace lbcrypto {
+
+// ---------------------------------------------------------------------------
+// Shape of one hybrid key switch; the best strategy is a function of it.
+// sizeQl shrinks as a circuit descends levels, so one context sees many shapes.
+// ---------------------------------------------------------------------------
+struct HKSShape {
+    uint32_t ring_dim   = 0;
+    uint32_t size_ql    = 0;
+    uint32_t size_p     = 0;
+    uint32_t num_digits = 0;  // numPartQl
+
+    bool operator<(const HKSShape& rhs) const {
+        return std::tie(ring_dim, size_ql, size_p, num_digits) <
+               std::tie(rhs.ring_dim, rhs.size_ql, rhs.size_p, rhs.num_digits);
+    }
+    bool operator==(const HKSShape& rhs) const {
+        return std::tie(ring_dim, size_ql, size_p, num_digits) ==
+               std::tie(rhs.ring_dim, rhs.size_ql, rhs.size_p, rhs.num_digits);
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Picks the HKSStrategy for HKSStrategy::AUTO.
+//
+// The first key switch of an unseen shape times every candidate (best of
+// GetTrials() runs each) and caches the fastest. A candidate whose result
+// differs from DC's is never picked. Later calls of that shape only do a map
+// lookup.
+//
+// Winners can be persisted in a profile file. It is plain text, one line per
+// shape: "<ring_dim> <size_ql> <size_p> <num_digits> <STRATEGY>"; '#' starts a
+// comment. The profile named by the OPENFHE_HKS_PROFILE environment variable is
+// loaded when a CryptoContext is created. New winners are written back to it by
+// SaveProfile(), and once more at process exit if any were added.
+// ---------------------------------------------------------------------------
+class HKSAutotuner {
+public:
+    static HKSAutotuner& GetInstance();
+
+    // Cached winner for shape; false if the shape has not been tuned yet
+    bool Lookup(const HKSShape& shape, HKSStrategy& winner) const;
+
+    // Output of one key switch; candidates are checked against DC's
+    using Result = std::shared_ptr<std::vector<DCRTPoly>>;
+
+    // Times run(candidate) for every candidate, caches the fastest and returns it.
+    // DC runs first as the reference; a candidate whose first result differs is
+    // reported and dropped.
+    HKSStrategy Tune(const HKSShape& shape, const std::function<Result(HKSStrategy)>& run);
+
+    // Records a winner without timing (e.g. from an offline sweep)
+    void Set(const HKSShape& shape, HKSStrategy winner);
+
+    // Unless set explicitly, the candidates are taken when Tune() runs: DC, MP,
+    // OC, plus FUSED when an accelerator is installed at that time
+    std::vector<HKSStrategy> GetCandidates() const;
+    void SetCandidates(const std::vector<HKSStrategy>& candidates);
+
+    uint32_t GetTrials() const;
+    void SetTrials(uint32_t trials);
+
+    // Merges the profile at path into the cache and makes it the write-back
+    // target. A missing file is not an error: SaveProfile() creates it.
+    bool LoadProfile(const std::string& path);
+    bool SaveProfile(const std::string& path) const;
+    // Writes the cache to the loaded profile; false if none is loaded
+    bool SaveProfile();
+
+    // Loads OPENFHE_HKS_PROFILE, if set and not loaded yet
+    void LoadProfileFromEnv();
+
+    // Drops every cached winner, forgets the profile path and restores the
+    // default candidates
+    void Clear();
+
+    std::map<HKSShape, HKSStrategy> GetProfile() const;
+
+private:
+    HKSAutotuner() = default;
+    ~HKSAutotuner();
+
+    bool SaveLocked(const std::string& path) const;
+    std::vector<HKSStrategy> CandidatesLocked() const;
+
+    mutable std::mutex m_mutex;
+    std::map<HKSShape, HKSStrategy> m_winners;
+    std::vector<HKSStrategy> m_candidates;  // empty: the defaults
+    uint32_t m_trials = 3;
+    std::string m_profilePath;
+    bool m_dirty = false;  // winners added since the profile was loaded or saved
+};
+
+}  // namespace lbcrypto
+
+#endif
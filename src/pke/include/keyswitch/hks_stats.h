@@ -0,0 +1,212 @@
+#ifndef LBCRYPTO_CRYPTO_KEYSWITCH_HKS_STATS_H
+#define LBCRYPTO_CRYPTO_KEYSWITCH_HKS_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lbcrypto {
+
+// Phases of a hybrid key switch whose wall time is recorded in HKSStats
+enum class HKSPhase {
+    INTT,
+    BCONV,
+    NTT,
+    MAC,      // key inner product (EvalFastKeySwitchCoreExt)
+    MODDOWN,
+    DEVICE,   // HKSStrategy::FUSED: the on-device digit pipeline
+    COUNT,
+};
+
+inline const char* HKSPhaseName(HKSPhase p) {
+    switch (p) {
+        case HKSPhase::INTT:
+            return "INTT";
+        case HKSPhase::BCONV:
+            return "BConv";
+        case HKSPhase::NTT:
+            return "NTT";
+        case HKSPhase::MAC:
+            return "MAC";
+        case HKSPhase::MODDOWN:
+            return "ModDown";
+        case HKSPhase::DEVICE:
+            return "Device";
+        default:
+            break;
+    }
+    return "?";
+}
+
+constexpr size_t HKS_NUM_PHASES = static_cast<size_t>(HKSPhase::COUNT);
+
+// ---------------------------------------------------------------------------
+// Key-switch operation statistics
+//
+// GetHKSStats() is per thread: ResetHKSStats() before a call, read it after,
+// and key switches running on other threads do not interfere. Every completed
+// top-level key switch is also added to a process-wide total, read with
+// GetHKSStatsSnapshot().
+// ---------------------------------------------------------------------------
+struct HKSStats {
+    // --- Operation counts (EvalKeySwitchPrecomputeCore) ---
+    int intt_poly   = 0;  // DCRTPoly-level INTT calls  (each covers alpha limbs)
+    int ntt_poly    = 0;  // DCRTPoly-level NTT  calls
+    int ntt_limb    = 0;  // single-limb NTT calls (OC: one per P-tower per digit)
+    int bconv       = 0;  // BConv calls (OC: one single-tower call per complement tower per digit)
+
+    // --- Operation counts (EvalFastKeySwitchCoreExt) ---
+    int modmul_limb = 0;  // limb-level multiply-accumulate iterations
+
+    // --- Parameters captured at precompute time (last key switch in a snapshot) ---
+    int num_digits  = 0;  // numPartQl
+    int size_ql     = 0;  // current ciphertext Q limbs
+    int size_p      = 0;  // auxiliary P limbs
+    int alpha       = 0;  // limbs per digit
+    int ring_dim    = 0;  // N
+
+    // --- Peak SRAM: max complement ring-elements (BConv outputs) held simultaneously ---
+    // One ring-element = ring_dim * 8 bytes. A digit's complement has sizeQl + sizeP - |digit| towers.
+    // DC:  one complement   (freed once assembled; all of them when the FPGA pipeline is on)
+    // MP:  all complements  (held simultaneously)
+    // OC:  1                (one tower at a time)
+    int peak_p_towers          = 0;  // what the strategy claims (maximum in a snapshot)
+    int peak_p_towers_measured = 0;  // tower storage actually allocated on the host (see SetHKSPeakMeasurement)
+
+    // --- Host <-> FPGA traffic (0 when everything runs on the CPU) ---
+    uint64_t bytes_h2d = 0;
+    uint64_t bytes_d2h = 0;
+
+    // --- Wall time per phase, in nanoseconds (indexed by HKSPhase) ---
+    uint64_t phase_ns[HKS_NUM_PHASES] = {};
+
+    // --- Top-level key switches (KeySwitchCore, hoisted precompute or fast key switch) ---
+    uint64_t key_switches = 0;
+
+    uint64_t PhaseNs(HKSPhase p) const {
+        return phase_ns[static_cast<size_t>(p)];
+    }
+
+    // Counts, bytes and times add up; peaks take the maximum; the shape is rhs's
+    HKSStats& operator+=(const HKSStats& rhs);
+
+    // Per-field difference of two readings of the same thread (later - earlier)
+    HKSStats Since(const HKSStats& earlier) const;
+};
+
+// Statistics of the calling thread
+HKSStats& GetHKSStats();
+
+inline void ResetHKSStats() {
+    GetHKSStats() = HKSStats{};
+}
+
+// Sum over every top-level key switch completed (on any thread) since the last
+// ResetHKSStatsSnapshot()
+HKSStats GetHKSStatsSnapshot();
+
+void ResetHKSStatsSnapshot();
+
+// peak_p_towers_measured is read from intnat::TowerArena::Meter: the peak of tower
+// storage allocated, beyond the output, between the first BConv and the last digit
+// assembly. The meter counts allocations of every thread, so enable it only while
+// key switches run one at a time. Off by default (peak_p_towers_measured stays 0).
+void SetHKSPeakMeasurement(bool enabled);
+bool HKSPeakMeasurementEnabled();
+
+// ---------------------------------------------------------------------------
+// Adds the work done on the calling thread while the outermost scope is alive
+// to the process-wide snapshot (and emits a "KeySwitch" trace span). Nested
+// scopes, e.g. KeySwitchCore -> EvalKeySwitchPrecomputeCore, do nothing.
+// ---------------------------------------------------------------------------
+class HKSStatsScope {
+public:
+    HKSStatsScope();
+    ~HKSStatsScope();
+    HKSStatsScope(const HKSStatsScope&)            = delete;
+    HKSStatsScope& operator=(const HKSStatsScope&) = delete;
+
+private:
+    bool m_outermost;
+    HKSStats m_start;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+// ---------------------------------------------------------------------------
+// Adds its lifetime to GetHKSStats().phase_ns[phase] and, while tracing, emits
+// a span named after the phase
+// ---------------------------------------------------------------------------
+class HKSPhaseTimer {
+public:
+    explicit HKSPhaseTimer(HKSPhase phase) : m_phase(phase), m_begin(std::chrono::steady_clock::now()) {}
+    ~HKSPhaseTimer();
+    HKSPhaseTimer(const HKSPhaseTimer&)            = delete;
+    HKSPhaseTimer& operator=(const HKSPhaseTimer&) = delete;
+
+private:
+    HKSPhase m_phase;
+    std::chrono::steady_clock::time_point m_begin;
+};
+
+// ---------------------------------------------------------------------------
+// Records key-switch spans and writes them in the Chrome trace-event format
+// (chrome://tracing, Perfetto): one "X" event per phase and per key switch,
+// one row per thread.
+//
+// Off by default; a disabled tracer costs one atomic load per span. Setting
+// OPENFHE_HKS_TRACE=<file> starts it when a CryptoContext is created and writes
+// the file at process exit. At most GetMaxEvents() spans are kept; later ones
+// are counted in GetDroppedEvents().
+// ---------------------------------------------------------------------------
+class HKSTracer {
+public:
+    static HKSTracer& GetInstance();
+
+    void Start();
+    void Stop();
+    bool IsEnabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    void Record(const char* name, std::chrono::steady_clock::time_point begin,
+                std::chrono::steady_clock::time_point end, const std::string& args = "");
+
+    bool WriteChromeTrace(const std::string& path) const;
+
+    // Starts tracing into the file named by OPENFHE_HKS_TRACE, if set and not started yet
+    void StartFromEnv();
+
+    void Clear();
+
+    size_t GetNumEvents() const;
+    uint64_t GetDroppedEvents() const;
+    size_t GetMaxEvents() const;
+    void SetMaxEvents(size_t maxEvents);
+
+private:
+    HKSTracer();
+    ~HKSTracer();
+
+    struct Event {
+        const char* name;
+        uint32_t tid;
+        double ts_us;
+        double dur_us;
+        std::string args;
+    };
+
+    std::atomic<bool> m_enabled{false};
+    mutable std::mutex m_mutex;
+    std::vector<Event> m_events;
+    size_t m_maxEvents  = size_t(1) << 20;
+    uint64_t m_dropped  = 0;
+    std::chrono::steady_clock::time_point m_epoch;
+    std::string m_envPath;  // written by the destructor
+};
+
+}  // namespace lbcrypto
+
+#endif
@@ -1,14 +1,49 @@
 #ifndef LBCRYPTO_CRYPTO_KEYSWITCH_HKS_STRATEGY_H
 #define LBCRYPTO_CRYPTO_KEYSWITCH_HKS_STRATEGY_H
 
+#include "keyswitch/hks_stats.h"
+
+#include <cstdint>
+#include <string>
+
 namespace lbcrypto {
 
 enum class HKSStrategy {
     DC,  // Digit-Centric: per-digit INTT→BConv→NTT (default, matches current code)
-    MP,  // Max-Parallel:  all-INTT → all-BConv → all-NTT (global barriers between phases)
+    MP,  // Max-Parallel:  all-INTT → all-BConv → all-NTT (global barriers between phases;
+         // each phase is one OpenMP loop over digits × towers)
     OC,  // Output-Centric: per-output-tower BConv with sizeP=1 (minimal peak SRAM)
+    FUSED,  // On-device INTT→BConv→NTT→MAC per digit (OP_HKS_DIGIT); only (c0', c1') return.
+            // Falls back to DC when the FPGA cannot take the shape (and for hoisted precompute).
+    AUTO,   // Per call: fastest strategy for the (N, sizeQl, sizeP, numPartQl) shape, see hks_autotuner.h
 };
 
+inline const char* HKSStrategyName(HKSStrategy s) {
+    switch (s) {
+        case HKSStrategy::DC:
+            return "DC";
+        case HKSStrategy::MP:
+            return "MP";
+        case HKSStrategy::OC:
+            return "OC";
+        case HKSStrategy::FUSED:
+            return "FUSED";
+        case HKSStrategy::AUTO:
+            return "AUTO";
+    }
+    return "?";
+}
+
+inline bool ParseHKSStrategy(const std::string& name, HKSStrategy& s) {
+    for (auto c : {HKSStrategy::DC, HKSStrategy::MP, HKSStrategy::OC, HKSStrategy::FUSED, HKSStrategy::AUTO}) {
+        if (name == HKSStrategyName(c)) {
+            s = c;
+            return true;
+        }
+    }
+    return false;
+}
+
 inline HKSStrategy& GetHKSStrategy() {
     static HKSStrategy s = HKSStrategy::DC;
     return s;
@@ -19,43 +54,37 @@ inline void SetHKSStrategy(HKSStrategy s) {
 }
 
 // ---------------------------------------------------------------------------
-// Per-KeySwitch operation statistics
-// Reset via ResetHKSStats() before a call; read via GetHKSStats() after.
+// Per-thread override of the process-wide strategy. KeySwitchCore pins the
+// resolved strategy with it, and the autotuner times candidates through it,
+// without touching what other threads see.
 // ---------------------------------------------------------------------------
-struct HKSStats {
-    // --- Operation counts (EvalKeySwitchPrecomputeCore) ---
-    int intt_poly   = 0;  // DCRTPoly-level INTT calls  (each covers alpha limbs)
-    int ntt_poly    = 0;  // DCRTPoly-level NTT  calls
-    int ntt_limb    = 0;  // single-limb NTT calls (OC: one per P-tower per digit)
-    int bconv       = 0;  // ApproxSwitchCRTBasis (BConv) calls
-
-    // --- Operation counts (EvalFastKeySwitchCoreExt) ---
-    int modmul_limb = 0;  // limb-level multiply-accumulate iterations
-
-    // --- Parameters captured at precompute time ---
-    int num_digits  = 0;  // numPartQl
-    int size_ql     = 0;  // current ciphertext Q limbs
-    int size_p      = 0;  // auxiliary P limbs
-    int alpha       = 0;  // limbs per digit
-    int ring_dim    = 0;  // N
-
-    // --- Peak SRAM: max P-tower complement ring-elements held simultaneously ---
-    // One ring-element = ring_dim * 8 bytes.
-    // DC:  sizeP            (one full complement per digit, one digit at a time)
-    // MP:  numPartQl*sizeP  (all complements held simultaneously)
-    // OC:  1                (one P-tower at a time)
-    int peak_p_towers = 0;
-};
-
-inline HKSStats& GetHKSStats() {
-    static HKSStats s;
+inline const HKSStrategy*& HKSStrategyOverride() {
+    static thread_local const HKSStrategy* s = nullptr;
     return s;
 }
 
-inline void ResetHKSStats() {
-    GetHKSStats() = HKSStats{};
+// Strategy in effect for the calling thread
+inline HKSStrategy ActiveHKSStrategy() {
+    const HKSStrategy* s = HKSStrategyOverride();
+    return s ? *s : GetHKSStrategy();
 }
 
+class ScopedHKSStrategy {
+public:
+    explicit ScopedHKSStrategy(HKSStrategy s) : m_strategy(s), m_prev(HKSStrategyOverride()) {
+        HKSStrategyOverride() = &m_strategy;
+    }
+    ~ScopedHKSStrategy() {
+        HKSStrategyOverride() = m_prev;
+    }
+    ScopedHKSStrategy(const ScopedHKSStrategy&)            = delete;
+    ScopedHKSStrategy& operator=(const ScopedHKSStrategy&) = delete;
+
+private:
+    HKSStrategy m_strategy;
+    const HKSStrategy* m_prev;
+};
+
 }  // namespace lbcrypto
 
 
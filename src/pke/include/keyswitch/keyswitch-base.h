@@ -132,6 +132,21 @@ public:
         const std::shared_ptr<ParmType> paramsQl) const {
         OPENFHE_THROW("EvalFastKeySwitchCoreExt is not supported");
     }
+
+    /**
+   * Batched hoisted rotations on the accelerator: for every r, the automorphism
+   * autoIndices[r] of EvalFastKeySwitchCoreExt(digits, evalKeys[r]) (+ first)
+   * over QlP. Returns an empty vector when the batch is not offloaded; callers
+   * then fall back to one EvalFastKeySwitchCoreExt per rotation.
+   *
+   * @param first optional term over QlP added before the automorphism (P*c0)
+   */
+    virtual std::vector<std::shared_ptr<std::vector<Element>>> EvalFastKeySwitchRotateBatchExt(
+        const std::shared_ptr<std::vector<Element>> digits, const std::vector<EvalKey<Element>>& evalKeys,
+        const std::vector<uint32_t>& autoIndices, const Element* first,
+        const std::shared_ptr<ParmType> paramsQl) const {
+        return {};
+    }
 };
 
 }  // namespace lbcrypto
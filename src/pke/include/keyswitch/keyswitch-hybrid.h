@@ -108,6 +108,11 @@ public:
         const std::shared_ptr<std::vector<DCRTPoly>> digits, const EvalKey<DCRTPoly> evalKey,
         const std::shared_ptr<ParmType> paramsQl) const override;
 
+    std::vector<std::shared_ptr<std::vector<DCRTPoly>>> EvalFastKeySwitchRotateBatchExt(
+        const std::shared_ptr<std::vector<DCRTPoly>> digits, const std::vector<EvalKey<DCRTPoly>>& evalKeys,
+        const std::vector<uint32_t>& autoIndices, const DCRTPoly* first,
+        const std::shared_ptr<ParmType> paramsQl) const override;
+
     /////////////////////////////////////////
     // SERIALIZATION
     /////////////////////////////////////////
@@ -53,6 +53,8 @@
  */
 namespace lbcrypto {
 
+class LazyEvalKeyMap;
+
 class CKKSBootstrapPrecom {
 public:
     CKKSBootstrapPrecom() = default;
@@ -307,14 +309,18 @@ private:
     //------------------------------------------------------------------------------
     // Find Rotation Indices
     //------------------------------------------------------------------------------
-    std::vector<int32_t> FindBootstrapRotationIndices(uint32_t slots, uint32_t M);
+    std::vector<int32_t> FindBootstrapRotationIndices(uint32_t slots, uint32_t M) const;
 
     // ATTN: The following 3 functions are helper methods to be called in FindBootstrapRotationIndices() only.
     // so they DO NOT remove possible duplicates and automorphisms corresponding to 0 and M/4.
     // These methods completely depend on FindBootstrapRotationIndices() to do that.
-    std::vector<uint32_t> FindLinearTransformRotationIndices(uint32_t slots, uint32_t M);
-    std::vector<uint32_t> FindCoeffsToSlotsRotationIndices(uint32_t slots, uint32_t M);
-    std::vector<uint32_t> FindSlotsToCoeffsRotationIndices(uint32_t slots, uint32_t M);
+    std::vector<uint32_t> FindLinearTransformRotationIndices(uint32_t slots, uint32_t M) const;
+    std::vector<uint32_t> FindCoeffsToSlotsRotationIndices(uint32_t slots, uint32_t M) const;
+    std::vector<uint32_t> FindSlotsToCoeffsRotationIndices(uint32_t slots, uint32_t M) const;
+
+    // Read-ahead hint for lazily loaded keys (LazyEvalKeyMap): the automorphism keys of
+    // CoeffsToSlots and the conjugation (encoding) or of SlotsToCoeffs, both for a linear-transform bootstrap
+    void PrefetchBootstrapKeys(const LazyEvalKeyMap& keys, uint32_t slots, uint32_t M, bool encoding) const;
 
     //------------------------------------------------------------------------------
     // Auxiliary Bootstrap Functions
@@ -127,6 +127,11 @@ public:
                                              const std::shared_ptr<std::vector<DCRTPoly>> digits, bool addFirst,
                                              const std::map<uint32_t, EvalKey<DCRTPoly>>& evalKeys) const override;
 
+    std::vector<Ciphertext<DCRTPoly>> EvalFastRotationExtBatch(
+        ConstCiphertext<DCRTPoly>& ciphertext, const std::vector<int32_t>& indices,
+        const std::shared_ptr<std::vector<DCRTPoly>> digits, bool addFirst,
+        const std::map<uint32_t, EvalKey<DCRTPoly>>& evalKeys) const override;
+
     uint32_t FindAutomorphismIndex(uint32_t index, uint32_t m) const override;
 
     /////////////////////////////////////
@@ -624,6 +624,13 @@ public:
         OPENFHE_THROW("EvalFastRotationExt is not implemented for this scheme.");
     }
 
+    virtual std::vector<Ciphertext<Element>> EvalFastRotationExtBatch(
+        ConstCiphertext<Element>& ciphertext, const std::vector<int32_t>& indices,
+        const std::shared_ptr<std::vector<Element>> expandedCiphertext, bool addFirst,
+        const std::map<uint32_t, EvalKey<Element>>& evalKeys) const {
+        OPENFHE_THROW("EvalFastRotationExtBatch is not implemented for this scheme.");
+    }
+
     /**
    * Generates evaluation keys for a list of indices
    * Currently works only for power-of-two and cyclic-group cyclotomics
@@ -306,6 +306,17 @@ public:
         return m_KeySwitch->EvalFastKeySwitchCoreExt(digits, evalKey, params);
     }
 
+    virtual std::vector<std::shared_ptr<std::vector<Element>>> EvalFastKeySwitchRotateBatchExt(
+        const std::shared_ptr<std::vector<Element>> digits, const std::vector<EvalKey<Element>>& evalKeys,
+        const std::vector<uint32_t>& autoIndices, const Element* first, const std::shared_ptr<ParmType> params) const {
+        VerifyKeySwitchEnabled(__func__);
+        if (nullptr == digits)
+            OPENFHE_THROW("Input digits is nullptr");
+        if (evalKeys.size() != autoIndices.size())
+            OPENFHE_THROW("Number of evaluation keys does not match the number of automorphism indices");
+        return m_KeySwitch->EvalFastKeySwitchRotateBatchExt(digits, evalKeys, autoIndices, first, params);
+    }
+
     virtual std::shared_ptr<std::vector<Element>> EvalFastKeySwitchCore(
         const std::shared_ptr<std::vector<Element>> digits, const EvalKey<Element> evalKey,
         const std::shared_ptr<ParmType> params) const {
@@ -701,6 +712,28 @@ public:
 
     /**
    * Only supported for hybrid key switching.
+   * EvalFastRotationExt for several rotation indices of the same ciphertext;
+   * with an accelerator the digits are uploaded once and all rotations run on the device.
+   * Index 0 gives KeySwitchExt(ciphertext, addFirst).
+   *
+   * @param ciphertext input ciphertext
+   * @param indices the rotation indices
+   * @param digits the precomputed digits for the ciphertext
+   * @param addFirst if true, the the first element c0 is also computed (otherwise ignored)
+   * @return resulting ciphertexts, in the order of indices
+   */
+    virtual std::vector<Ciphertext<Element>> EvalFastRotationExtBatch(
+        ConstCiphertext<Element>& ciphertext, const std::vector<int32_t>& indices,
+        const std::shared_ptr<std::vector<Element>> digits, bool addFirst,
+        const std::map<uint32_t, EvalKey<Element>>& evalKeys) const {
+        VerifyLeveledSHEEnabled(__func__);
+        if (!ciphertext)
+            OPENFHE_THROW("Input ciphertext is nullptr");
+        return m_LeveledSHE->EvalFastRotationExtBatch(ciphertext, indices, digits, addFirst, evalKeys);
+    }
+
+    /**
+   * Only supported for hybrid key switching.
    * Scales down the polynomial c0 from extended basis P*Q to Q.
    *
    * @param ciphertext input ciphertext in the extended basis
@@ -113,6 +113,11 @@ public:
     std::shared_ptr<std::vector<DCRTPoly>> EncryptZeroCore(const PrivateKey<DCRTPoly> privateKey,
                                                            const std::shared_ptr<ParmType> params) const override;
 
+    // As above; if c1Seed is not nullptr, c1 is DCRTPoly::FromSeed(params, *c1Seed, 0) (CiphertextFormat::SEEDED)
+    std::shared_ptr<std::vector<DCRTPoly>> EncryptZeroCore(const PrivateKey<DCRTPoly> privateKey,
+                                                           const std::shared_ptr<ParmType> params,
+                                                           const PRNGSeed* c1Seed) const;
+
     std::shared_ptr<std::vector<DCRTPoly>> EncryptZeroCore(const PublicKey<DCRTPoly> publicKey,
                                                            const std::shared_ptr<ParmType> params) const override;
 
@@ -34,6 +34,8 @@
  */
 
 #include "cryptocontext.h"
+#include "key/evalkey-lazy.h"
+#include "key/evalkey-store.h"
 #include "key/privatekey.h"
 #include "key/publickey.h"
 #include "math/chebyshev.h"
@@ -43,10 +45,9 @@
 namespace lbcrypto {
 
 template <typename Element>
-std::map<std::string, std::vector<EvalKey<Element>>> CryptoContextImpl<Element>::s_evalMultKeyMap{};
+EvalKeyRegistry<std::vector<EvalKey<Element>>> CryptoContextImpl<Element>::s_evalMultKeyMap{};
 template <typename Element>
-std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>
-    CryptoContextImpl<Element>::s_evalAutomorphismKeyMap{};
+EvalKeyRegistry<std::map<uint32_t, EvalKey<Element>>> CryptoContextImpl<Element>::s_evalAutomorphismKeyMap{};
 
 template <typename Element>
 void CryptoContextImpl<Element>::SetKSTechniqueInScheme() {
@@ -69,57 +70,51 @@ void CryptoContextImpl<Element>::SetKSTechniqueInScheme() {
 template <typename Element>
 void CryptoContextImpl<Element>::EvalMultKeyGen(const PrivateKey<Element>& key) {
     ValidateKey(key);
-    if (CryptoContextImpl<Element>::s_evalMultKeyMap.find(key->GetKeyTag()) ==
-        CryptoContextImpl<Element>::s_evalMultKeyMap.end()) {
-        // the key is not found in the map, so the key has to be generated
-        CryptoContextImpl<Element>::s_evalMultKeyMap[key->GetKeyTag()] = {GetScheme()->EvalMultKeyGen(key)};
+    if (!CryptoContextImpl<Element>::s_evalMultKeyMap.Contains(key->GetKeyTag())) {
+        // the key is not found in the map, so the key has to be generated. It is generated outside
+        // the registry lock; if another thread got there first, its key is kept
+        auto keys = std::make_shared<std::vector<EvalKey<Element>>>(1, GetScheme()->EvalMultKeyGen(key));
+        CryptoContextImpl<Element>::s_evalMultKeyMap.InsertIfAbsent(key->GetKeyTag(), std::move(keys));
     }
 }
 
 template <typename Element>
 void CryptoContextImpl<Element>::EvalMultKeysGen(const PrivateKey<Element>& key) {
     ValidateKey(key);
-    if (CryptoContextImpl<Element>::s_evalMultKeyMap.find(key->GetKeyTag()) ==
-        CryptoContextImpl<Element>::s_evalMultKeyMap.end()) {
+    if (!CryptoContextImpl<Element>::s_evalMultKeyMap.Contains(key->GetKeyTag())) {
         // the key is not found in the map, so the key has to be generated
-        CryptoContextImpl<Element>::s_evalMultKeyMap[key->GetKeyTag()] = GetScheme()->EvalMultKeysGen(key);
+        auto keys = std::make_shared<std::vector<EvalKey<Element>>>(GetScheme()->EvalMultKeysGen(key));
+        CryptoContextImpl<Element>::s_evalMultKeyMap.InsertIfAbsent(key->GetKeyTag(), std::move(keys));
     }
 }
 
 template <typename Element>
 void CryptoContextImpl<Element>::ClearEvalMultKeys() {
-    CryptoContextImpl<Element>::s_evalMultKeyMap.clear();
+    CryptoContextImpl<Element>::s_evalMultKeyMap.Clear();
 }
 
 template <typename Element>
 void CryptoContextImpl<Element>::ClearEvalMultKeys(const std::string& keyTag) {
-    auto kd = CryptoContextImpl<Element>::s_evalMultKeyMap.find(keyTag);
-    if (kd != CryptoContextImpl<Element>::s_evalMultKeyMap.end())
-        CryptoContextImpl<Element>::s_evalMultKeyMap.erase(kd);
+    CryptoContextImpl<Element>::s_evalMultKeyMap.Erase(keyTag);
 }
 
 template <typename Element>
 void CryptoContextImpl<Element>::ClearEvalMultKeys(const CryptoContext<Element>& cc) {
-    for (auto it = CryptoContextImpl<Element>::s_evalMultKeyMap.begin();
-         it != CryptoContextImpl<Element>::s_evalMultKeyMap.end();) {
-        if (it->second[0]->GetCryptoContext() == cc) {
-            it = CryptoContextImpl<Element>::s_evalMultKeyMap.erase(it);
-        }
-        else {
-            ++it;
-        }
-    }
+    CryptoContextImpl<Element>::s_evalMultKeyMap.EraseIf(
+        [&cc](const std::string&, const std::vector<EvalKey<Element>>& keys) {
+            return !keys.empty() && keys[0]->GetCryptoContext() == cc;
+        });
 }
 
 template <typename Element>
 void CryptoContextImpl<Element>::InsertEvalMultKey(const std::vector<EvalKey<Element>>& vectorToInsert,
                                                    const std::string& keyTag) {
     const std::string& tag = (keyTag.empty()) ? vectorToInsert[0]->GetKeyTag() : keyTag;
-    if (CryptoContextImpl<Element>::s_evalMultKeyMap.find(tag) != CryptoContextImpl<Element>::s_evalMultKeyMap.end()) {
+    if (!CryptoContextImpl<Element>::s_evalMultKeyMap.InsertIfAbsent(
+            tag, std::make_shared<std::vector<EvalKey<Element>>>(vectorToInsert))) {
         // we do not allow to override the existing key vector if its keyTag is identical to the keyTag of the new keys
         OPENFHE_THROW("Can not save a EvalMultKeys vector as there is a key vector for the given keyTag");
     }
-    CryptoContextImpl<Element>::s_evalMultKeyMap[tag] = vectorToInsert;
 }
 
 /////////////////////////////////////////
@@ -171,34 +166,60 @@ const std::map<uint32_t, EvalKey<Element>>& CryptoContextImpl<Element>::GetEvalS
 }
 
 template <typename Element>
-std::map<std::string, std::vector<EvalKey<Element>>>& CryptoContextImpl<Element>::GetAllEvalMultKeys() {
-    return CryptoContextImpl<Element>::s_evalMultKeyMap;
+std::map<std::string, std::vector<EvalKey<Element>>> CryptoContextImpl<Element>::GetAllEvalMultKeys() {
+    std::map<std::string, std::vector<EvalKey<Element>>> all;
+    for (const auto& [tag, keys] : CryptoContextImpl<Element>::s_evalMultKeyMap.Snapshot())
+        all.emplace(tag, *keys);
+    return all;
 }
 
 template <typename Element>
 const std::vector<EvalKey<Element>>& CryptoContextImpl<Element>::GetEvalMultKeyVector(const std::string& keyTag) {
-    auto ekv = CryptoContextImpl<Element>::s_evalMultKeyMap.find(keyTag);
-    if (ekv == CryptoContextImpl<Element>::s_evalMultKeyMap.end()) {
+    // pinned for this thread, so the reference outlives a concurrent update of keyTag
+    const auto keys = CryptoContextImpl<Element>::s_evalMultKeyMap.Pin(keyTag);
+    if (!keys) {
+        std::string errMsg(std::string("Call EvalMultKeyGen() to have EvalMultKey available for ID [") + keyTag + "].");
+        OPENFHE_THROW(errMsg);
+    }
+    return *keys;
+}
+
+template <typename Element>
+std::shared_ptr<std::vector<EvalKey<Element>>> CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(
+    const std::string& keyTag) {
+    auto keys = CryptoContextImpl<Element>::s_evalMultKeyMap.Find(keyTag);
+    if (!keys) {
         std::string errMsg(std::string("Call EvalMultKeyGen() to have EvalMultKey available for ID [") + keyTag + "].");
         OPENFHE_THROW(errMsg);
     }
-    return ekv->second;
+    return keys;
 }
 
 template <typename Element>
-std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>&
+std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>
 CryptoContextImpl<Element>::GetAllEvalAutomorphismKeys() {
-    return CryptoContextImpl<Element>::s_evalAutomorphismKeyMap;
+    return CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Snapshot();
 }
 
 template <typename Element>
 std::shared_ptr<std::map<uint32_t, EvalKey<Element>>> CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(
     const std::string& keyTag) {
-    auto ekv = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.find(keyTag);
-    if (ekv == CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.end()) {
+    auto keyMap = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Find(keyTag);
+    if (!keyMap) {
+        OPENFHE_THROW("EvalAutomorphismKeys are not generated for ID [" + keyTag + "].");
+    }
+    return keyMap;
+}
+
+template <typename Element>
+const std::map<uint32_t, EvalKey<Element>>& CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(
+    const std::string& keyTag) {
+    // pinned for this thread, like GetEvalMultKeyVector()
+    const auto keyMap = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Pin(keyTag);
+    if (!keyMap) {
         OPENFHE_THROW("EvalAutomorphismKeys are not generated for ID [" + keyTag + "].");
     }
-    return ekv->second;
+    return *keyMap;
 }
 
 template <typename Element>
@@ -223,7 +244,7 @@ std::shared_ptr<std::map<uint32_t, EvalKey<Element>>> CryptoContextImpl<Element>
 }
 
 template <typename Element>
-std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>&
+std::map<std::string, std::shared_ptr<std::map<uint32_t, EvalKey<Element>>>>
 CryptoContextImpl<Element>::GetAllEvalSumKeys() {
     return CryptoContextImpl<Element>::GetAllEvalAutomorphismKeys();
 }
@@ -270,7 +291,7 @@ void CryptoContextImpl<Element>::EvalAtIndexKeyGen(const PrivateKey<Element> pri
 
 template <typename Element>
 void CryptoContextImpl<Element>::ClearEvalAutomorphismKeys() {
-    CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.clear();
+    CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Clear();
 }
 
 /**
@@ -279,9 +300,7 @@ void CryptoContextImpl<Element>::ClearEvalAutomorphismKeys() {
  */
 template <typename Element>
 void CryptoContextImpl<Element>::ClearEvalAutomorphismKeys(const std::string& keyTag) {
-    auto kd = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.find(keyTag);
-    if (kd != CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.end())
-        CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.erase(kd);
+    CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Erase(keyTag);
 }
 
 /**
@@ -291,28 +310,22 @@ void CryptoContextImpl<Element>::ClearEvalAutomorphismKeys(const std::string& ke
  */
 template <typename Element>
 void CryptoContextImpl<Element>::ClearEvalAutomorphismKeys(const CryptoContext<Element> cc) {
-    for (auto it = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.begin();
-         it != CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.end();) {
-        if (it->second->begin()->second->GetCryptoContext() == cc) {
-            it = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.erase(it);
-        }
-        else {
-            ++it;
-        }
-    }
+    CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.EraseIf(
+        [&cc](const std::string&, const std::map<uint32_t, EvalKey<Element>>& keyMap) {
+            return !keyMap.empty() && keyMap.begin()->second->GetCryptoContext() == cc;
+        });
 }
 
 template <typename Element>
 std::set<uint32_t> CryptoContextImpl<Element>::GetExistingEvalAutomorphismKeyIndices(const std::string& keyTag) {
-    auto keyMapIt = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.find(keyTag);
-    if (keyMapIt == CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.end())
+    const auto keyMap = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Find(keyTag);
+    if (!keyMap)
         // there is no keys for the given keyTag, return empty vector
         return std::set<uint32_t>();
 
     // get all inidices from the existing automorphism key map
-    auto& keyMap = *(keyMapIt->second);
     std::set<uint32_t> indices;
-    for (const auto& [key, _] : keyMap) {
+    for (const auto& [key, _] : *keyMap) {
         indices.insert(key);
     }
 
@@ -328,6 +341,49 @@ std::set<uint32_t> CryptoContextImpl<Element>::GetUniqueValues(const std::set<ui
     return newUniqueValues;
 }
 
+template <typename Element>
+bool CryptoContextImpl<Element>::SerializeEvalAutomorphismKeyStore(const std::string& path,
+                                                                   const std::string& keyTag) {
+    EvalKeyStore::Write(path, *CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(keyTag), keyTag);
+    return true;
+}
+
+template <typename Element>
+bool CryptoContextImpl<Element>::DeserializeEvalAutomorphismKeyStore(const std::string& path,
+                                                                     const CryptoContext<Element>& cc) {
+    const auto store = EvalKeyStore::Open(path);
+    CryptoContextImpl<Element>::InsertEvalAutomorphismKey(store->GetAllKeys(cc), store->GetKeyTag());
+    return true;
+}
+
+template <typename Element>
+std::shared_ptr<LazyEvalKeyMap> CryptoContextImpl<Element>::DeserializeEvalAutomorphismKeyStoreLazy(
+    const std::string& path, const CryptoContext<Element>& cc, size_t budgetBytes) {
+    auto lazy = LazyEvalKeyMap::Create(EvalKeyStore::Open(path), cc, budgetBytes);
+    CryptoContextImpl<Element>::InsertEvalAutomorphismKey(lazy->GetKeyMap(), lazy->GetKeyTag());
+    return lazy;
+}
+
+template <typename Element>
+std::shared_ptr<LazyEvalKeyMap> CryptoContextImpl<Element>::GetLazyEvalAutomorphismKeyMap(const std::string& keyTag) {
+    const auto keyMap = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Find(keyTag);
+    if (!keyMap)
+        return nullptr;
+    // the lazy keys keep their map alive; eagerly added keys may sit in between
+    for (const auto& [_, key] : *keyMap) {
+        if (const auto lazy = std::dynamic_pointer_cast<LazyEvalKeyRelin>(key))
+            return lazy->GetOwner();
+    }
+    return nullptr;
+}
+
+template <typename Element>
+void CryptoContextImpl<Element>::PrefetchEvalAutomorphismKeys(const std::string& keyTag,
+                                                              const std::vector<uint32_t>& indexList) {
+    if (const auto lazy = CryptoContextImpl<Element>::GetLazyEvalAutomorphismKeyMap(keyTag))
+        lazy->Prefetch(indexList);
+}
+
 template <typename Element>
 void CryptoContextImpl<Element>::InsertEvalAutomorphismKey(
     const std::shared_ptr<std::map<uint32_t, EvalKey<Element>>> mapToInsert, const std::string& keyTag) {
@@ -338,35 +394,33 @@ void CryptoContextImpl<Element>::InsertEvalAutomorphismKey(
 
     auto mapToInsertIt    = mapToInsert->begin();
     const std::string& id = (keyTag.empty()) ? mapToInsertIt->second->GetKeyTag() : keyTag;
-    std::set<uint32_t> existingIndices{CryptoContextImpl<Element>::GetExistingEvalAutomorphismKeyIndices(id)};
-    if (existingIndices.empty()) {
-        // there is no keys for the given id, so we insert full mapToInsert
-        CryptoContextImpl<Element>::s_evalAutomorphismKeyMap[id] = mapToInsert;
-    }
-    else {
-        // get all indices from mapToInsert
-        std::set<uint32_t> newIndices;
-        for (const auto& [key, _] : *mapToInsert) {
-            newIndices.insert(key);
-        }
-
-        // find all indices in mapToInsert that are not in the exising map and
-        // insert those new indices and their corresponding keys to the existing map
-        std::set<uint32_t> indicesToInsert{CryptoContextImpl<Element>::GetUniqueValues(existingIndices, newIndices)};
-        auto keyMapIt = CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.find(id);
-        auto& keyMap  = *(keyMapIt->second);
-        for (uint32_t indx : indicesToInsert) {
-            keyMap[indx] = (*mapToInsert)[indx];
-        }
-    }
+    using KeyMap          = std::map<uint32_t, EvalKey<Element>>;
+    CryptoContextImpl<Element>::s_evalAutomorphismKeyMap.Update(
+        id, [&mapToInsert](const std::shared_ptr<const KeyMap>& keyMap) -> std::shared_ptr<KeyMap> {
+            if (!keyMap || keyMap->empty()) {
+                // there is no keys for the given id, so we insert full mapToInsert
+                return mapToInsert;
+            }
+            // the published map may be in use by other threads: insert the indices of mapToInsert that are
+            // not in it into a copy, which replaces it. The keys of the existing indices are kept
+            std::shared_ptr<KeyMap> merged;
+            for (const auto& [indx, key] : *mapToInsert) {
+                if (keyMap->find(indx) == keyMap->end()) {
+                    if (!merged)
+                        merged = std::make_shared<KeyMap>(*keyMap);
+                    merged->emplace(indx, key);
+                }
+            }
+            return merged;
+        });
 }
 
 template <typename Element>
 Ciphertext<Element> CryptoContextImpl<Element>::EvalSum(ConstCiphertext<Element>& ciphertext,
                                                         uint32_t batchSize) const {
     ValidateCiphertext(ciphertext);
-    auto&& evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ciphertext->GetKeyTag());
-    return GetScheme()->EvalSum(ciphertext, batchSize, evalSumKeys);
+    const auto evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertext->GetKeyTag());
+    return GetScheme()->EvalSum(ciphertext, batchSize, *evalSumKeys);
 }
 
 template <typename Element>
@@ -382,8 +436,8 @@ Ciphertext<Element> CryptoContextImpl<Element>::EvalSumCols(
     ConstCiphertext<Element>& ciphertext, uint32_t numCols,
     const std::map<uint32_t, EvalKey<Element>>& evalSumKeysRight) const {
     ValidateCiphertext(ciphertext);
-    auto&& evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ciphertext->GetKeyTag());
-    return GetScheme()->EvalSumCols(ciphertext, numCols, evalSumKeys, evalSumKeysRight);
+    const auto evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertext->GetKeyTag());
+    return GetScheme()->EvalSumCols(ciphertext, numCols, *evalSumKeys, evalSumKeysRight);
 }
 
 template <typename Element>
@@ -393,8 +447,8 @@ Ciphertext<Element> CryptoContextImpl<Element>::EvalAtIndex(ConstCiphertext<Elem
     // This is done after the keyMap so that it is protected if there's not a valid key.
     if (0 == index)
         return ciphertext->Clone();
-    auto&& evalAutomorphismKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ciphertext->GetKeyTag());
-    return GetScheme()->EvalAtIndex(ciphertext, index, evalAutomorphismKeys);
+    const auto evalAutomorphismKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertext->GetKeyTag());
+    return GetScheme()->EvalAtIndex(ciphertext, index, *evalAutomorphismKeys);
 }
 
 template <typename Element>
@@ -403,8 +457,9 @@ Ciphertext<Element> CryptoContextImpl<Element>::EvalMerge(
     if (0 == ciphertextVector.size())
         OPENFHE_THROW("Input ciphertext vector is empty");
     ValidateCiphertext(ciphertextVector[0]);
-    auto evalAutomorphismKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ciphertextVector[0]->GetKeyTag());
-    return GetScheme()->EvalMerge(ciphertextVector, evalAutomorphismKeys);
+    const auto evalAutomorphismKeys =
+        CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ciphertextVector[0]->GetKeyTag());
+    return GetScheme()->EvalMerge(ciphertextVector, *evalAutomorphismKeys);
 }
 
 template <typename Element>
@@ -414,9 +469,9 @@ Ciphertext<Element> CryptoContextImpl<Element>::EvalInnerProduct(ConstCiphertext
     ValidateCiphertext(ct1);
     if (ct2 == nullptr || ct1->GetKeyTag() != ct2->GetKeyTag())
         OPENFHE_THROW("Information was not generated with this crypto context");
-    auto& evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ct1->GetKeyTag());
-    auto& ek          = CryptoContextImpl<Element>::GetEvalMultKeyVector(ct1->GetKeyTag());
-    return GetScheme()->EvalInnerProduct(ct1, ct2, batchSize, evalSumKeys, ek[0]);
+    const auto evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ct1->GetKeyTag());
+    const auto ek          = CryptoContextImpl<Element>::GetEvalMultKeyVectorPtr(ct1->GetKeyTag());
+    return GetScheme()->EvalInnerProduct(ct1, ct2, batchSize, *evalSumKeys, (*ek)[0]);
 }
 
 template <typename Element>
@@ -425,8 +480,8 @@ Ciphertext<Element> CryptoContextImpl<Element>::EvalInnerProduct(ConstCiphertext
     ValidateCiphertext(ct1);
     if (ct2 == nullptr)
         OPENFHE_THROW("Information was not generated with this crypto context");
-    auto& evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMap(ct1->GetKeyTag());
-    return GetScheme()->EvalInnerProduct(ct1, ct2, batchSize, evalSumKeys);
+    const auto evalSumKeys = CryptoContextImpl<Element>::GetEvalAutomorphismKeyMapPtr(ct1->GetKeyTag());
+    return GetScheme()->EvalInnerProduct(ct1, ct2, batchSize, *evalSumKeys);
 }
 
 template <typename Element>
@@ -32,6 +32,8 @@
 #include "cryptocontextfactory.h"
 #include "schemebase/base-scheme.h"
 #include "scheme/scheme-id.h"
+#include "keyswitch/hks_autotuner.h"
+#include "keyswitch/hks_stats.h"
 
 namespace lbcrypto {
 
@@ -57,6 +59,11 @@ template <typename Element>
 void CryptoContextFactory<Element>::AddContext(CryptoContext<Element> cc) {
     CryptoContextFactory<Element>::AllContexts.push_back(cc);
 
+    // HKSStrategy::AUTO winners cached by earlier runs
+    HKSAutotuner::GetInstance().LoadProfileFromEnv();
+    // Key-switch phase trace requested through OPENFHE_HKS_TRACE
+    HKSTracer::GetInstance().StartFromEnv();
+
     if (cc->GetEncodingParams()->GetPlaintextRootOfUnity() != 0) {
         PackedEncoding::SetParams(cc->GetCyclotomicOrder(), cc->GetEncodingParams());
     }
@@ -0,0 +1,203 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/**
+ * Automorphism keys loaded from an EvalKeyStore on first use (LazyEvalKeyMap)
+ */
+
+#include "key/evalkey-lazy.h"
+
+#include "cryptocontext.h"
+#include "utils/exception.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace lbcrypto {
+
+std::shared_ptr<LazyEvalKeyMap> LazyEvalKeyMap::Create(std::shared_ptr<EvalKeyStore> store,
+                                                       const CryptoContext<DCRTPoly>& cc, size_t budgetBytes) {
+    if (!store)
+        OPENFHE_THROW("No eval-key store given");
+    if (!cc)
+        OPENFHE_THROW("No crypto context given");
+    return std::shared_ptr<LazyEvalKeyMap>(new LazyEvalKeyMap(std::move(store), cc, budgetBytes));
+}
+
+LazyEvalKeyMap::LazyEvalKeyMap(std::shared_ptr<EvalKeyStore> store, const CryptoContext<DCRTPoly>& cc,
+                               size_t budgetBytes)
+    : m_store{std::move(store)}, m_cc{cc}, m_params{m_store->GetParams(cc)}, m_budget{budgetBytes} {
+    const auto indices = m_store->GetIndices();
+    m_slots.reset(new Slot[indices.size()]);
+    for (size_t i = 0; i < indices.size(); ++i) {
+        m_slots[i].index = indices[i];
+        m_slotOf.emplace(indices[i], &m_slots[i]);
+    }
+}
+
+LazyEvalKeyMap::Slot& LazyEvalKeyMap::SlotOf(uint32_t index) {
+    const auto it = m_slotOf.find(index);
+    if (it == m_slotOf.end())
+        OPENFHE_THROW("Index " + std::to_string(index) + " is not in the eval-key store");
+    return *it->second;
+}
+
+std::shared_ptr<std::map<uint32_t, EvalKey<DCRTPoly>>> LazyEvalKeyMap::GetKeyMap() {
+    auto keys = std::make_shared<std::map<uint32_t, EvalKey<DCRTPoly>>>();
+    for (uint32_t index : m_store->GetIndices())
+        keys->emplace_hint(keys->end(), index, std::make_shared<LazyEvalKeyRelin>(shared_from_this(), index));
+    return keys;
+}
+
+void LazyEvalKeyMap::Prefetch(const std::vector<uint32_t>& indices) const {
+    for (uint32_t index : indices) {
+        const auto it = m_slotOf.find(index);
+        if (it == m_slotOf.end() || it->second->resident.load(std::memory_order_acquire))
+            continue;
+        m_store->Advise(index, true);
+    }
+}
+
+void LazyEvalKeyMap::SetBudget(size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_budget = budgetBytes;
+    EnforceBudget();
+}
+
+size_t LazyEvalKeyMap::GetBudget() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_budget;
+}
+
+size_t LazyEvalKeyMap::GetResidentBytes() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_resident;
+}
+
+std::vector<uint32_t> LazyEvalKeyMap::GetResidentIndices() const {
+    std::vector<const Slot*> resident;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& kv : m_slotOf) {
+            if (kv.second->resident.load(std::memory_order_relaxed))
+                resident.push_back(kv.second);
+        }
+    }
+    std::sort(resident.begin(), resident.end(), [](const Slot* a, const Slot* b) {
+        return a->lastUse.load(std::memory_order_relaxed) > b->lastUse.load(std::memory_order_relaxed);
+    });
+    std::vector<uint32_t> indices;
+    for (const auto* slot : resident)
+        indices.push_back(slot->index);
+    return indices;
+}
+
+LazyEvalKeyMap::Stats LazyEvalKeyMap::GetStats() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void LazyEvalKeyMap::Load(uint32_t index, EvalKeyImpl<DCRTPoly>& key) {
+    m_store->LoadKey(index, m_params, key);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_stats.loads;
+}
+
+void LazyEvalKeyMap::Touch(Slot& slot) {
+    // repeated reads of the most recent key write nothing
+    if (slot.lastUse.load(std::memory_order_relaxed) != m_clock.load(std::memory_order_relaxed))
+        slot.lastUse.store(m_clock.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (slot.resident.load(std::memory_order_acquire))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (slot.resident.load(std::memory_order_relaxed))
+        return;
+    slot.resident.store(true, std::memory_order_release);
+    m_resident += m_store->GetKeyBytes(slot.index);
+    ++m_residentKeys;
+    EnforceBudget();
+}
+
+void LazyEvalKeyMap::EnforceBudget() {
+    while (m_budget != 0 && m_resident > m_budget && m_residentKeys > 1) {
+        Slot* victim = nullptr;
+        for (const auto& kv : m_slotOf) {
+            Slot* slot = kv.second;
+            if (slot->resident.load(std::memory_order_relaxed) &&
+                (!victim ||
+                 slot->lastUse.load(std::memory_order_relaxed) < victim->lastUse.load(std::memory_order_relaxed)))
+                victim = slot;
+        }
+        if (victim == nullptr)
+            break;
+        victim->resident.store(false, std::memory_order_release);
+        m_resident -= m_store->GetKeyBytes(victim->index);
+        --m_residentKeys;
+        m_store->Advise(victim->index, false);
+        ++m_stats.evictions;
+    }
+}
+
+LazyEvalKeyRelin::LazyEvalKeyRelin(std::shared_ptr<LazyEvalKeyMap> owner, uint32_t index)
+    : EvalKeyRelinImpl<DCRTPoly>(owner->m_cc),
+      m_owner{std::move(owner)},
+      m_slot{&m_owner->SlotOf(index)},
+      m_index{index} {
+    this->SetKeyTag(m_owner->GetKeyTag());
+}
+
+void LazyEvalKeyRelin::Load() const {
+    if (!m_owner)
+        return;
+    std::call_once(m_once, [this] {
+        // the views are set once, before any reader sees them; later reads only touch the LRU list
+        m_owner->Load(m_index, *const_cast<LazyEvalKeyRelin*>(this));
+        m_loaded.store(true, std::memory_order_release);
+    });
+    m_owner->Touch(*m_slot);
+}
+
+bool LazyEvalKeyRelin::IsLoaded() const {
+    return m_loaded.load(std::memory_order_acquire);
+}
+
+bool LazyEvalKeyRelin::key_compare(const EvalKeyImpl<DCRTPoly>& rhs) const {
+    // the base comparison reads the vectors directly
+    Load();
+    if (const auto* lazy = dynamic_cast<const LazyEvalKeyRelin*>(&rhs))
+        lazy->Load();
+    return EvalKeyRelinImpl<DCRTPoly>::key_compare(rhs);
+}
+
+}  // namespace lbcrypto
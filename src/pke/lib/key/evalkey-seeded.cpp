@@ -0,0 +1,80 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/**
+ * Eval keys whose a vector is regenerated from a seed (SeededEvalKeyRelin)
+ */
+
+#include "key/evalkey-seeded.h"
+
+#include <utility>
+
+namespace lbcrypto {
+
+const std::vector<DCRTPoly>& SeededEvalKeyRelin::GetAVector() const {
+    if (!m_expanded.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_expanded.load(std::memory_order_relaxed)) {
+            // a only caches what the seed defines, so the key stays logically const
+            const_cast<SeededEvalKeyRelin*>(this)->EvalKeyRelinImpl<DCRTPoly>::SetAVector(ExpandAVector());
+            m_expanded.store(true, std::memory_order_release);
+        }
+    }
+    return EvalKeyRelinImpl<DCRTPoly>::GetAVector();
+}
+
+std::vector<DCRTPoly> SeededEvalKeyRelin::ExpandAVector() const {
+    const auto& b = GetBVector();
+    std::vector<DCRTPoly> a;
+    a.reserve(b.size());
+    for (uint32_t j = 0; j < b.size(); ++j)
+        a.push_back(DCRTPoly::FromSeed(b[j].GetParams(), m_seed, j));
+    return a;
+}
+
+void SeededEvalKeyRelin::SetSeed(const PRNGSeed& seed) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_seed = seed;
+    EvalKeyRelinImpl<DCRTPoly>::SetAVector(std::vector<DCRTPoly>());
+    m_expanded.store(false, std::memory_order_release);
+}
+
+bool SeededEvalKeyRelin::key_compare(const EvalKeyImpl<DCRTPoly>& rhs) const {
+    if (!CryptoObject<DCRTPoly>::operator==(rhs))
+        return false;
+    // two seeded keys compare without expanding a
+    if (const auto* r = dynamic_cast<const SeededEvalKeyRelin*>(&rhs))
+        return m_seed == r->m_seed && GetBVector() == r->GetBVector();
+    return GetAVector() == rhs.GetAVector() && GetBVector() == rhs.GetBVector();
+}
+
+}  // namespace lbcrypto
@@ -0,0 +1,436 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/**
+ * Flat, memory-mappable eval-key store (EvalKeyStore)
+ */
+
+#include "key/evalkey-store.h"
+
+#include "cryptocontext.h"
+#include "key/evalkeyrelin.h"
+#include "schemerns/rns-cryptoparameters.h"
+#include "utils/exception.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define OPENFHE_EVALKEY_STORE_MMAP
+#endif
+
+namespace lbcrypto {
+
+static_assert(sizeof(NativeInteger) == sizeof(uint64_t), "the key store holds 64-bit native towers");
+static_assert(sizeof(EvalKeyStoreHeader) == 96 && sizeof(EvalKeyStoreEntry) == 32, "on-disk layout changed");
+
+namespace {
+
+constexpr char kMagic[8] = {'O', 'F', 'H', 'E', 'K', 'E', 'Y', 'S'};
+
+size_t AlignUp(size_t x, size_t a) {
+    return (x + a - 1) / a * a;
+}
+
+uint32_t ByteSwap32(uint32_t x) {
+    return (x >> 24) | ((x >> 8) & 0xff00) | ((x << 8) & 0xff0000) | (x << 24);
+}
+
+bool SameBasis(const DCRTPoly::Params& a, const DCRTPoly::Params& b) {
+    const auto& ta = a.GetParams();
+    const auto& tb = b.GetParams();
+    if (a.GetRingDimension() != b.GetRingDimension() || ta.size() != tb.size())
+        return false;
+    for (size_t i = 0; i < ta.size(); ++i) {
+        if (ta[i]->GetModulus() != tb[i]->GetModulus())
+            return false;
+    }
+    return true;
+}
+
+void WritePadding(std::ofstream& out, size_t to) {
+    static const char zeros[EvalKeyStore::KEY_ALIGNMENT] = {};
+    for (size_t at = static_cast<size_t>(out.tellp()); at < to;) {
+        const size_t n = std::min(to - at, sizeof(zeros));
+        out.write(zeros, n);
+        at += n;
+    }
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// The mapped file. Every TowerSlab built over it holds a reference, so keys
+// outlive the EvalKeyStore that produced them. Without mmap the file is read
+// into one aligned buffer instead, with the same layout.
+// ---------------------------------------------------------------------------
+struct EvalKeyStore::Mapping {
+    void* data{nullptr};
+    size_t bytes{0};
+    bool mapped{false};
+
+    explicit Mapping(const std::string& path) {
+#ifdef OPENFHE_EVALKEY_STORE_MMAP
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            OPENFHE_THROW("Cannot open eval-key store [" + path + "]");
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            OPENFHE_THROW("Cannot stat eval-key store [" + path + "]");
+        }
+        bytes = static_cast<size_t>(st.st_size);
+        if (bytes > 0) {
+            // read-only: the key views must not be written (see evalkey-store.h)
+            void* p = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data   = p;
+                mapped = true;
+            }
+        }
+        ::close(fd);
+        if (mapped || bytes == 0)
+            return;
+#endif
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in)
+            OPENFHE_THROW("Cannot open eval-key store [" + path + "]");
+        bytes = static_cast<size_t>(in.tellg());
+        if (bytes == 0)
+            return;
+        data = ::operator new(bytes, std::align_val_t{KEY_ALIGNMENT});
+        in.seekg(0);
+        if (!in.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes))) {
+            ::operator delete(data, std::align_val_t{KEY_ALIGNMENT});
+            OPENFHE_THROW("Cannot read eval-key store [" + path + "]");
+        }
+    }
+
+    ~Mapping() {
+        if (data == nullptr)
+            return;
+#ifdef OPENFHE_EVALKEY_STORE_MMAP
+        if (mapped) {
+            ::munmap(data, bytes);
+            return;
+        }
+#endif
+        ::operator delete(data, std::align_val_t{KEY_ALIGNMENT});
+    }
+
+    Mapping(const Mapping&)            = delete;
+    Mapping& operator=(const Mapping&) = delete;
+
+    const unsigned char* At(uint64_t offset) const {
+        return static_cast<const unsigned char*>(data) + offset;
+    }
+};
+
+void EvalKeyStore::Write(const std::string& path, const std::map<uint32_t, EvalKey<DCRTPoly>>& keys,
+                         const std::string& keyTag) {
+    if (keys.empty())
+        OPENFHE_THROW("No eval keys to write for keyTag [" + keyTag + "]");
+
+    // every polynomial of every key must live in the basis of the first one
+    std::vector<EvalKeyStoreEntry> directory;
+    std::vector<std::pair<const std::vector<DCRTPoly>*, const std::vector<DCRTPoly>*>> polys;
+    std::shared_ptr<DCRTPoly::Params> params;
+    for (const auto& [index, key] : keys) {
+        const auto relin = std::dynamic_pointer_cast<EvalKeyRelinImpl<DCRTPoly>>(key);
+        if (!relin)
+            OPENFHE_THROW("Only EvalKeyRelin keys can be stored; index [" + std::to_string(index) + "]");
+        const auto& b = relin->GetBVector();
+        const auto& a = relin->GetAVector();
+        if (b.empty() || a.size() != b.size())
+            OPENFHE_THROW("Key for index [" + std::to_string(index) + "] has mismatched a/b vectors");
+        if (!params)
+            params = b[0].GetParams();
+        const Format format = b[0].GetFormat();
+        for (const auto* v : {&b, &a}) {
+            for (const auto& poly : *v) {
+                if (!SameBasis(*poly.GetParams(), *params) || poly.GetFormat() != format)
+                    OPENFHE_THROW("Keys to store must share one tower basis and format; index [" +
+                                  std::to_string(index) + "]");
+                for (const auto& tower : poly.GetAllElements()) {
+                    if (tower.IsEmpty() || tower.GetLength() != params->GetRingDimension())
+                        OPENFHE_THROW("Key for index [" + std::to_string(index) + "] has an unallocated tower");
+                }
+            }
+        }
+        EvalKeyStoreEntry e{};
+        e.index     = index;
+        e.numDigits = static_cast<uint32_t>(b.size());
+        e.format    = static_cast<uint32_t>(format);
+        directory.push_back(e);
+        polys.emplace_back(&b, &a);
+    }
+
+    const auto& towers       = params->GetParams();
+    const uint32_t ringDim   = params->GetRingDimension();
+    const uint32_t numTowers = static_cast<uint32_t>(towers.size());
+    const size_t towerBytes  = size_t(ringDim) * sizeof(uint64_t);
+    const size_t polyBytes   = numTowers * towerBytes;
+
+    EvalKeyStoreHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version         = VERSION;
+    h.headerBytes     = sizeof(h);
+    h.cyclotomicOrder = params->GetCyclotomicOrder();
+    h.ringDim         = ringDim;
+    h.numTowers       = numTowers;
+    h.numKeys         = static_cast<uint32_t>(directory.size());
+    h.keyTagBytes     = static_cast<uint32_t>(keyTag.size());
+    h.keyTagOffset    = sizeof(h);
+    h.towersOffset    = AlignUp(h.keyTagOffset + keyTag.size(), sizeof(uint64_t));
+    h.directoryOffset = h.towersOffset + 2 * sizeof(uint64_t) * numTowers;
+    size_t offset     = AlignUp(h.directoryOffset + sizeof(EvalKeyStoreEntry) * directory.size(), KEY_ALIGNMENT);
+    for (auto& e : directory) {
+        e.offset = offset;
+        e.bytes  = 2 * size_t(e.numDigits) * polyBytes;
+        h.fileBytes = e.offset + e.bytes;
+        offset      = AlignUp(h.fileBytes, KEY_ALIGNMENT);
+    }
+
+    // written beside the target and renamed, so a reader never maps a partial file
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out)
+            OPENFHE_THROW("Cannot create eval-key store [" + tmp + "]");
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(keyTag.data(), static_cast<std::streamsize>(keyTag.size()));
+        WritePadding(out, h.towersOffset);
+        for (const auto& t : towers) {
+            const uint64_t pair[2] = {t->GetModulus().ConvertToInt(), t->GetRootOfUnity().ConvertToInt()};
+            out.write(reinterpret_cast<const char*>(pair), sizeof(pair));
+        }
+        out.write(reinterpret_cast<const char*>(directory.data()),
+                  static_cast<std::streamsize>(sizeof(EvalKeyStoreEntry) * directory.size()));
+        for (size_t k = 0; k < directory.size(); ++k) {
+            WritePadding(out, directory[k].offset);
+            for (const auto* v : {polys[k].first, polys[k].second}) {
+                for (const auto& poly : *v) {
+                    for (const auto& tower : poly.GetAllElements())
+                        out.write(reinterpret_cast<const char*>(&tower.GetValues()[0]),
+                                  static_cast<std::streamsize>(towerBytes));
+                }
+            }
+        }
+        if (!out.flush())
+            OPENFHE_THROW("Cannot write eval-key store [" + tmp + "]");
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        OPENFHE_THROW("Cannot move eval-key store into place [" + path + "]");
+    }
+}
+
+std::shared_ptr<EvalKeyStore> EvalKeyStore::Open(const std::string& path) {
+    return std::shared_ptr<EvalKeyStore>(new EvalKeyStore(std::make_shared<Mapping>(path)));
+}
+
+EvalKeyStore::EvalKeyStore(std::shared_ptr<Mapping> mapping) : m_mapping{std::move(mapping)} {
+    const size_t bytes = m_mapping->bytes;
+    if (bytes < sizeof(EvalKeyStoreHeader))
+        OPENFHE_THROW("Not an eval-key store: file too short");
+    m_header = reinterpret_cast<const EvalKeyStoreHeader*>(m_mapping->At(0));
+    const auto& h = *m_header;
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0)
+        OPENFHE_THROW("Not an eval-key store: bad magic");
+    if (h.version != VERSION && ByteSwap32(h.version) == VERSION)
+        OPENFHE_THROW("Eval-key store was written on a machine of the other byte order");
+    if (h.version > VERSION)
+        OPENFHE_THROW("Eval-key store version " + std::to_string(h.version) + " is from a later version of the library");
+    if (h.version != VERSION || h.headerBytes != sizeof(EvalKeyStoreHeader))
+        OPENFHE_THROW("Unsupported eval-key store version " + std::to_string(h.version));
+
+    // every bound is checked as "count <= room / size" before anything is multiplied,
+    // so a corrupt header cannot overflow the arithmetic
+    const uint64_t towerBytes = uint64_t(h.ringDim) * sizeof(uint64_t);
+    const bool shapeOk        = h.ringDim >= 8 && (h.ringDim & (h.ringDim - 1)) == 0 &&
+                         uint64_t(h.cyclotomicOrder) == 2 * uint64_t(h.ringDim) && h.fileBytes <= bytes &&
+                         h.numTowers > 0 && h.numTowers <= h.fileBytes / towerBytes;
+    const bool tablesOk = h.keyTagOffset <= h.towersOffset && h.keyTagBytes <= h.towersOffset - h.keyTagOffset &&
+                          h.towersOffset % sizeof(uint64_t) == 0 && h.towersOffset <= h.directoryOffset &&
+                          h.numTowers <= (h.directoryOffset - h.towersOffset) / (2 * sizeof(uint64_t)) &&
+                          h.directoryOffset % sizeof(uint64_t) == 0 && h.directoryOffset <= h.fileBytes &&
+                          h.numKeys <= (h.fileBytes - h.directoryOffset) / sizeof(EvalKeyStoreEntry);
+    if (!shapeOk || !tablesOk)
+        OPENFHE_THROW("Corrupt eval-key store header");
+    const uint64_t polyBytes = h.numTowers * towerBytes;
+
+    m_keyTag.assign(reinterpret_cast<const char*>(m_mapping->At(h.keyTagOffset)), h.keyTagBytes);
+    m_towers    = reinterpret_cast<const uint64_t*>(m_mapping->At(h.towersOffset));
+    m_directory = reinterpret_cast<const EvalKeyStoreEntry*>(m_mapping->At(h.directoryOffset));
+    for (uint32_t k = 0; k < h.numKeys; ++k) {
+        const auto& e = m_directory[k];
+        if ((k > 0 && e.index <= m_directory[k - 1].index) || e.numDigits == 0 ||
+            e.format > static_cast<uint32_t>(Format::COEFFICIENT) || e.offset % KEY_ALIGNMENT != 0 ||
+            e.numDigits > h.fileBytes / (2 * polyBytes) || e.bytes != 2 * uint64_t(e.numDigits) * polyBytes ||
+            e.offset > h.fileBytes || e.bytes > h.fileBytes - e.offset)
+            OPENFHE_THROW("Corrupt eval-key store directory entry " + std::to_string(k));
+    }
+}
+
+bool EvalKeyStore::IsMapped() const {
+    return m_mapping->mapped;
+}
+
+std::vector<uint32_t> EvalKeyStore::GetIndices() const {
+    std::vector<uint32_t> indices(m_header->numKeys);
+    for (uint32_t k = 0; k < m_header->numKeys; ++k)
+        indices[k] = m_directory[k].index;
+    return indices;
+}
+
+const EvalKeyStoreEntry* EvalKeyStore::Find(uint32_t index) const {
+    const auto* end = m_directory + m_header->numKeys;
+    const auto* it  = std::lower_bound(m_directory, end, index,
+                                       [](const EvalKeyStoreEntry& e, uint32_t i) { return e.index < i; });
+    return (it != end && it->index == index) ? it : nullptr;
+}
+
+size_t EvalKeyStore::GetKeyBytes(uint32_t index) const {
+    const auto* e = Find(index);
+    return e ? e->bytes : 0;
+}
+
+std::shared_ptr<DCRTPoly::Params> EvalKeyStore::GetParams(const CryptoContext<DCRTPoly>& cc) const {
+    if (cc->GetRingDimension() != m_header->ringDim)
+        OPENFHE_THROW("Eval-key store ring dimension " + std::to_string(m_header->ringDim) +
+                      " does not match the crypto context");
+
+    // reuse the context's tower parameters so keys and ciphertexts share them
+    std::unordered_map<uint64_t, std::shared_ptr<ILNativeParams>> byModulus;
+    auto add = [&byModulus](const std::shared_ptr<DCRTPoly::Params>& p) {
+        if (p) {
+            for (const auto& t : p->GetParams())
+                byModulus.emplace(t->GetModulus().ConvertToInt(), t);
+        }
+    };
+    add(cc->GetElementParams());
+    if (const auto rns = std::dynamic_pointer_cast<CryptoParametersRNS>(cc->GetCryptoParameters()))
+        add(rns->GetParamsP());
+
+    std::vector<std::shared_ptr<ILNativeParams>> towers(m_header->numTowers);
+    for (uint32_t i = 0; i < m_header->numTowers; ++i) {
+        const auto it = byModulus.find(m_towers[2 * i]);
+        if (it == byModulus.end())
+            OPENFHE_THROW("Eval-key store modulus " + std::to_string(m_towers[2 * i]) +
+                          " is not in the crypto context");
+        // keys in EVALUATION format are only meaningful with the root they were transformed with
+        if (it->second->GetRootOfUnity().ConvertToInt() != m_towers[2 * i + 1])
+            OPENFHE_THROW("Eval-key store root of unity for modulus " + std::to_string(m_towers[2 * i]) +
+                          " does not match the crypto context");
+        towers[i] = it->second;
+    }
+    return std::make_shared<DCRTPoly::Params>(m_header->cyclotomicOrder, towers);
+}
+
+EvalKey<DCRTPoly> EvalKeyStore::GetKey(uint32_t index, const CryptoContext<DCRTPoly>& cc) const {
+    auto key = std::make_shared<EvalKeyRelinImpl<DCRTPoly>>(cc);
+    LoadKey(index, GetParams(cc), *key);
+    return key;
+}
+
+void EvalKeyStore::LoadKey(uint32_t index, const std::shared_ptr<DCRTPoly::Params>& params,
+                           EvalKeyImpl<DCRTPoly>& key) const {
+    const auto* e = Find(index);
+    if (e == nullptr)
+        OPENFHE_THROW("No key for index [" + std::to_string(index) + "] in the eval-key store for keyTag [" +
+                      m_keyTag + "]");
+    MakeKey(*e, params, key);
+}
+
+std::shared_ptr<std::map<uint32_t, EvalKey<DCRTPoly>>> EvalKeyStore::GetAllKeys(
+    const CryptoContext<DCRTPoly>& cc) const {
+    const auto params = GetParams(cc);
+    auto keys         = std::make_shared<std::map<uint32_t, EvalKey<DCRTPoly>>>();
+    for (uint32_t k = 0; k < m_header->numKeys; ++k) {
+        auto key = std::make_shared<EvalKeyRelinImpl<DCRTPoly>>(cc);
+        MakeKey(m_directory[k], params, *key);
+        keys->emplace_hint(keys->end(), m_directory[k].index, std::move(key));
+    }
+    return keys;
+}
+
+void EvalKeyStore::Advise(uint32_t index, bool willNeed) const {
+#ifdef OPENFHE_EVALKEY_STORE_MMAP
+    const auto* e = Find(index);
+    if (e == nullptr || !m_mapping->mapped)
+        return;
+    // the key blocks are 4 KiB aligned; with larger pages WILLNEED may read a little of
+    // the neighbours, but DONTNEED keeps to the pages that only hold this key
+    const auto page  = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    const auto begin = reinterpret_cast<uintptr_t>(m_mapping->At(e->offset));
+    const auto end   = begin + e->bytes;
+    const uintptr_t from = willNeed ? begin / page * page : (begin + page - 1) / page * page;
+    const uintptr_t to   = willNeed ? (end + page - 1) / page * page : end / page * page;
+    if (from < to)
+        ::madvise(reinterpret_cast<void*>(from), to - from, willNeed ? MADV_WILLNEED : MADV_DONTNEED);
+#endif
+}
+
+void EvalKeyStore::MakeKey(const EvalKeyStoreEntry& e, const std::shared_ptr<DCRTPoly::Params>& params,
+                           EvalKeyImpl<DCRTPoly>& key) const {
+    const size_t towerBytes = size_t(m_header->ringDim) * sizeof(uint64_t);
+    const size_t polyBytes  = m_header->numTowers * towerBytes;
+    const auto format       = static_cast<Format>(e.format);
+    // the mapping is read-only: the slabs only read through these pointers
+    auto* base = const_cast<unsigned char*>(m_mapping->At(e.offset));
+    auto view  = [&](size_t poly) {
+        auto slab = std::make_shared<intnat::TowerSlab>(m_header->numTowers, towerBytes, base + poly * polyBytes,
+                                                        m_mapping);
+        return DCRTPoly::FromTowerSlab(params, format, slab);
+    };
+
+    std::vector<DCRTPoly> b, a;
+    b.reserve(e.numDigits);
+    a.reserve(e.numDigits);
+    for (size_t j = 0; j < e.numDigits; ++j) {
+        b.push_back(view(j));
+        a.push_back(view(e.numDigits + j));
+    }
+    key.SetBVector(std::move(b));
+    key.SetAVector(std::move(a));
+    key.SetKeyTag(m_keyTag);
+}
+
+}  // namespace lbcrypto
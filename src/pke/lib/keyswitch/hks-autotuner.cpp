@@ -0,0 +1,238 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/**
+ * Runtime selection of the hybrid key-switching strategy (HKSStrategy::AUTO)
+ */
+
+#include "keyswitch/hks_autotuner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include "PolyAccelerator.h"
+
+namespace lbcrypto {
+
+HKSAutotuner& HKSAutotuner::GetInstance() {
+    static HKSAutotuner instance;
+    return instance;
+}
+
+HKSAutotuner::~HKSAutotuner() {
+    if (m_dirty && !m_profilePath.empty())
+        SaveLocked(m_profilePath);
+}
+
+bool HKSAutotuner::Lookup(const HKSShape& shape, HKSStrategy& winner) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_winners.find(shape);
+    if (it == m_winners.end())
+        return false;
+    winner = it->second;
+    return true;
+}
+
+HKSStrategy HKSAutotuner::Tune(const HKSShape& shape, const std::function<Result(HKSStrategy)>& run) {
+    std::vector<HKSStrategy> candidates;
+    uint32_t trials;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        candidates = CandidatesLocked();
+        trials     = m_trials;
+    }
+
+    // timing runs outside the lock: other shapes (and other threads) keep going.
+    // DC goes first; its first run is the reference (and, if DC is not a
+    // candidate, an untimed extra run)
+    auto dc = std::find(candidates.begin(), candidates.end(), HKSStrategy::DC);
+    if (dc != candidates.end())
+        std::rotate(candidates.begin(), dc, dc + 1);
+    const bool timeDC = (dc != candidates.end());
+    Result reference  = timeDC ? nullptr : run(HKSStrategy::DC);
+
+    HKSStrategy winner = HKSStrategy::DC;
+    double best        = std::numeric_limits<double>::max();
+    for (auto candidate : candidates) {
+        for (uint32_t t = 0; t < trials; ++t) {
+            auto start     = std::chrono::steady_clock::now();
+            Result result  = run(candidate);
+            double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (t == 0) {
+                if (!reference) {
+                    reference = std::move(result);
+                }
+                else if (!result || *result != *reference) {
+                    std::cerr << "[HKS] " << HKSStrategyName(candidate) << " differs from DC for shape ("
+                              << shape.ring_dim << ", " << shape.size_ql << ", " << shape.size_p << ", "
+                              << shape.num_digits << "); not a candidate" << std::endl;
+                    break;
+                }
+            }
+            if (elapsed < best) {
+                best   = elapsed;
+                winner = candidate;
+            }
+        }
+    }
+
+    Set(shape, winner);
+    return winner;
+}
+
+void HKSAutotuner::Set(const HKSShape& shape, HKSStrategy winner) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_winners[shape] = winner;
+    m_dirty          = true;
+}
+
+std::vector<HKSStrategy> HKSAutotuner::GetCandidates() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return CandidatesLocked();
+}
+
+std::vector<HKSStrategy> HKSAutotuner::CandidatesLocked() const {
+    if (!m_candidates.empty())
+        return m_candidates;
+    std::vector<HKSStrategy> candidates{HKSStrategy::DC, HKSStrategy::MP, HKSStrategy::OC};
+    if (PolyAccelerator::Get() != nullptr)
+        candidates.push_back(HKSStrategy::FUSED);
+    return candidates;
+}
+
+void HKSAutotuner::SetCandidates(const std::vector<HKSStrategy>& candidates) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_candidates.clear();
+    for (auto c : candidates) {
+        // AUTO cannot be its own candidate
+        if (c != HKSStrategy::AUTO)
+            m_candidates.push_back(c);
+    }
+    if (m_candidates.empty())
+        m_candidates.push_back(HKSStrategy::DC);
+}
+
+uint32_t HKSAutotuner::GetTrials() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_trials;
+}
+
+void HKSAutotuner::SetTrials(uint32_t trials) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_trials = (trials == 0) ? 1 : trials;
+}
+
+bool HKSAutotuner::LoadProfile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_profilePath = path;
+
+    std::ifstream in(path);
+    if (!in.is_open())
+        return false;
+
+    std::string line;
+    while (std::getline(in, line)) {
+        auto hash = line.find('#');
+        if (hash != std::string::npos)
+            line.erase(hash);
+        std::istringstream fields(line);
+        HKSShape shape;
+        std::string name;
+        HKSStrategy strategy;
+        if (!(fields >> shape.ring_dim >> shape.size_ql >> shape.size_p >> shape.num_digits >> name))
+            continue;
+        if (!ParseHKSStrategy(name, strategy) || strategy == HKSStrategy::AUTO) {
+            std::cerr << "[HKS] ignoring profile entry \"" << line << "\" in " << path << std::endl;
+            continue;
+        }
+        m_winners[shape] = strategy;
+    }
+    return true;
+}
+
+bool HKSAutotuner::SaveProfile(const std::string& path) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return SaveLocked(path);
+}
+
+bool HKSAutotuner::SaveProfile() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_profilePath.empty() || !SaveLocked(m_profilePath))
+        return false;
+    m_dirty = false;
+    return true;
+}
+
+bool HKSAutotuner::SaveLocked(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out.is_open()) {
+        std::cerr << "[HKS] cannot write profile " << path << std::endl;
+        return false;
+    }
+    out << "# ring_dim size_ql size_p num_digits strategy\n";
+    for (const auto& kv : m_winners) {
+        out << kv.first.ring_dim << ' ' << kv.first.size_ql << ' ' << kv.first.size_p << ' ' << kv.first.num_digits
+            << ' ' << HKSStrategyName(kv.second) << '\n';
+    }
+    return static_cast<bool>(out);
+}
+
+void HKSAutotuner::LoadProfileFromEnv() {
+    const char* path = std::getenv("OPENFHE_HKS_PROFILE");
+    if (path == nullptr || *path == '\0')
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_profilePath == path)
+            return;
+    }
+    LoadProfile(path);
+}
+
+void HKSAutotuner::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_winners.clear();
+    m_candidates.clear();
+    m_profilePath.clear();
+    m_dirty = false;
+}
+
+std::map<HKSShape, HKSStrategy> HKSAutotuner::GetProfile() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_winners;
+}
+
+}  // namespace lbcrypto
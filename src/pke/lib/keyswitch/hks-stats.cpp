@@ -0,0 +1,290 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/**
+ * Per-thread key-switching statistics, their process-wide total and the
+ * Chrome-trace exporter
+ */
+
+#include "keyswitch/hks_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace lbcrypto {
+
+namespace {
+
+std::mutex& SnapshotMutex() {
+    static std::mutex m;
+    return m;
+}
+
+HKSStats& Snapshot() {
+    static HKSStats s;
+    return s;
+}
+
+// Nesting depth of HKSStatsScope on this thread
+int& ScopeDepth() {
+    static thread_local int depth = 0;
+    return depth;
+}
+
+// Small, stable per-thread id for the trace rows
+uint32_t TraceThreadId() {
+    static std::atomic<uint32_t> next{0};
+    static thread_local uint32_t id = next++;
+    return id;
+}
+
+void WriteJsonString(std::ostream& os, const char* s) {
+    os << '"';
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\')
+            os << '\\';
+        os << *s;
+    }
+    os << '"';
+}
+
+std::atomic<bool>& MeasurePeak() {
+    static std::atomic<bool> enabled{false};
+    return enabled;
+}
+
+}  // namespace
+
+HKSStats& HKSStats::operator+=(const HKSStats& rhs) {
+    intt_poly += rhs.intt_poly;
+    ntt_poly += rhs.ntt_poly;
+    ntt_limb += rhs.ntt_limb;
+    bconv += rhs.bconv;
+    modmul_limb += rhs.modmul_limb;
+    if (rhs.ring_dim != 0) {
+        num_digits = rhs.num_digits;
+        size_ql    = rhs.size_ql;
+        size_p     = rhs.size_p;
+        alpha      = rhs.alpha;
+        ring_dim   = rhs.ring_dim;
+    }
+    peak_p_towers          = std::max(peak_p_towers, rhs.peak_p_towers);
+    peak_p_towers_measured = std::max(peak_p_towers_measured, rhs.peak_p_towers_measured);
+    bytes_h2d += rhs.bytes_h2d;
+    bytes_d2h += rhs.bytes_d2h;
+    for (size_t i = 0; i < HKS_NUM_PHASES; i++)
+        phase_ns[i] += rhs.phase_ns[i];
+    key_switches += rhs.key_switches;
+    return *this;
+}
+
+HKSStats HKSStats::Since(const HKSStats& earlier) const {
+    HKSStats d = *this;
+    d.intt_poly -= earlier.intt_poly;
+    d.ntt_poly -= earlier.ntt_poly;
+    d.ntt_limb -= earlier.ntt_limb;
+    d.bconv -= earlier.bconv;
+    d.modmul_limb -= earlier.modmul_limb;
+    d.bytes_h2d -= earlier.bytes_h2d;
+    d.bytes_d2h -= earlier.bytes_d2h;
+    for (size_t i = 0; i < HKS_NUM_PHASES; i++)
+        d.phase_ns[i] -= earlier.phase_ns[i];
+    d.key_switches -= earlier.key_switches;
+    return d;
+}
+
+HKSStats& GetHKSStats() {
+    static thread_local HKSStats s;
+    return s;
+}
+
+HKSStats GetHKSStatsSnapshot() {
+    std::lock_guard<std::mutex> lock(SnapshotMutex());
+    return Snapshot();
+}
+
+void ResetHKSStatsSnapshot() {
+    std::lock_guard<std::mutex> lock(SnapshotMutex());
+    Snapshot() = HKSStats{};
+}
+
+void SetHKSPeakMeasurement(bool enabled) {
+    MeasurePeak().store(enabled, std::memory_order_relaxed);
+}
+
+bool HKSPeakMeasurementEnabled() {
+    return MeasurePeak().load(std::memory_order_relaxed);
+}
+
+HKSStatsScope::HKSStatsScope() : m_outermost(ScopeDepth()++ == 0) {
+    if (m_outermost) {
+        // peaks restart so that the delta carries this key switch's own peak
+        auto& stats                  = GetHKSStats();
+        m_start                      = stats;
+        stats.peak_p_towers          = 0;
+        stats.peak_p_towers_measured = 0;
+        m_begin                      = std::chrono::steady_clock::now();
+    }
+}
+
+HKSStatsScope::~HKSStatsScope() {
+    --ScopeDepth();
+    if (!m_outermost)
+        return;
+
+    auto& stats = GetHKSStats();
+    stats.key_switches++;
+    const HKSStats delta         = stats.Since(m_start);
+    stats.peak_p_towers          = std::max(stats.peak_p_towers, m_start.peak_p_towers);
+    stats.peak_p_towers_measured = std::max(stats.peak_p_towers_measured, m_start.peak_p_towers_measured);
+    {
+        std::lock_guard<std::mutex> lock(SnapshotMutex());
+        Snapshot() += delta;
+    }
+
+    auto& tracer = HKSTracer::GetInstance();
+    if (tracer.IsEnabled()) {
+        tracer.Record("KeySwitch", m_begin, std::chrono::steady_clock::now(),
+                      "\"N\":" + std::to_string(stats.ring_dim) + ",\"size_ql\":" + std::to_string(stats.size_ql) +
+                          ",\"size_p\":" + std::to_string(stats.size_p) +
+                          ",\"digits\":" + std::to_string(stats.num_digits));
+    }
+}
+
+HKSPhaseTimer::~HKSPhaseTimer() {
+    auto end = std::chrono::steady_clock::now();
+    GetHKSStats().phase_ns[static_cast<size_t>(m_phase)] +=
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_begin).count();
+
+    auto& tracer = HKSTracer::GetInstance();
+    if (tracer.IsEnabled())
+        tracer.Record(HKSPhaseName(m_phase), m_begin, end);
+}
+
+HKSTracer& HKSTracer::GetInstance() {
+    static HKSTracer instance;
+    return instance;
+}
+
+HKSTracer::HKSTracer() : m_epoch(std::chrono::steady_clock::now()) {}
+
+HKSTracer::~HKSTracer() {
+    if (!m_envPath.empty() && !WriteChromeTrace(m_envPath))
+        std::cerr << "HKSTracer: cannot write " << m_envPath << std::endl;
+}
+
+void HKSTracer::Start() {
+    m_enabled.store(true, std::memory_order_relaxed);
+}
+
+void HKSTracer::Stop() {
+    m_enabled.store(false, std::memory_order_relaxed);
+}
+
+void HKSTracer::Record(const char* name, std::chrono::steady_clock::time_point begin,
+                       std::chrono::steady_clock::time_point end, const std::string& args) {
+    using us = std::chrono::duration<double, std::micro>;
+    Event e{name, TraceThreadId(), us(begin - m_epoch).count(), us(end - begin).count(), args};
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_events.size() >= m_maxEvents) {
+        m_dropped++;
+        return;
+    }
+    m_events.push_back(std::move(e));
+}
+
+bool HKSTracer::WriteChromeTrace(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out)
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[";
+    for (size_t i = 0; i < m_events.size(); i++) {
+        const auto& e = m_events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":";
+        WriteJsonString(out, e.name);
+        out << ",\"cat\":\"hks\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid << ",\"ts\":" << e.ts_us
+            << ",\"dur\":" << e.dur_us;
+        if (!e.args.empty())
+            out << ",\"args\":{" << e.args << "}";
+        out << "}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" << m_dropped << "}}\n";
+    return static_cast<bool>(out);
+}
+
+void HKSTracer::StartFromEnv() {
+    const char* path = std::getenv("OPENFHE_HKS_TRACE");
+    if (path == nullptr || *path == '\0')
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_envPath.empty())
+            return;
+        m_envPath = path;
+    }
+    Start();
+}
+
+void HKSTracer::Clear() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.clear();
+    m_dropped = 0;
+}
+
+size_t HKSTracer::GetNumEvents() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_events.size();
+}
+
+uint64_t HKSTracer::GetDroppedEvents() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dropped;
+}
+
+size_t HKSTracer::GetMaxEvents() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_maxEvents;
+}
+
+void HKSTracer::SetMaxEvents(size_t maxEvents) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_maxEvents = maxEvents;
+}
+
+}  // namespace lbcrypto
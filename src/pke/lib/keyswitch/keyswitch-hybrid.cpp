@@ -37,15 +37,310 @@
 
 #include "keyswitch/keyswitch-hybrid.h"
 #include "keyswitch/hks_strategy.h"
+#include "keyswitch/hks_autotuner.h"
 
 #include "key/privatekey.h"
 #include "key/publickey.h"
 #include "key/evalkeyrelin.h"
+#include "key/evalkey-seeded.h"
 #include "scheme/ckksrns/ckksrns-cryptoparameters.h"
 #include "ciphertext.h"
 
+#include "PolyAccelerator.h"
+
+#include <algorithm>
+#include <future>
+#include <optional>
+#include <stdexcept>
+
 namespace lbcrypto {
 
+namespace {
+
+// ApproxModDown of (c0', c1') from QlP back to Ql
+std::shared_ptr<std::vector<DCRTPoly>> ModDownToQl(const std::vector<DCRTPoly>& cTilda, const EvalKey<DCRTPoly>& evalKey,
+                                                   const std::shared_ptr<DCRTPoly::Params>& paramsQl) {
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(evalKey->GetCryptoParameters());
+
+    PlaintextModulus t = (cryptoParams->GetNoiseScale() == 1) ? 0 : cryptoParams->GetPlaintextModulus();
+
+    HKSPhaseTimer timer(HKSPhase::MODDOWN);
+    DCRTPoly ct0 = cTilda[0].ApproxModDown(paramsQl, cryptoParams->GetParamsP(), cryptoParams->GetPInvModq(),
+                                           cryptoParams->GetPInvModqPrecon(), cryptoParams->GetPHatInvModp(),
+                                           cryptoParams->GetPHatInvModpPrecon(), cryptoParams->GetPHatModq(),
+                                           cryptoParams->GetModqBarrettMu(), cryptoParams->GettInvModp(),
+                                           cryptoParams->GettInvModpPrecon(), t, cryptoParams->GettModqPrecon());
+
+    DCRTPoly ct1 = cTilda[1].ApproxModDown(paramsQl, cryptoParams->GetParamsP(), cryptoParams->GetPInvModq(),
+                                           cryptoParams->GetPInvModqPrecon(), cryptoParams->GetPHatInvModp(),
+                                           cryptoParams->GetPHatInvModpPrecon(), cryptoParams->GetPHatModq(),
+                                           cryptoParams->GetModqBarrettMu(), cryptoParams->GettInvModp(),
+                                           cryptoParams->GettInvModpPrecon(), t, cryptoParams->GettModqPrecon());
+
+    return std::make_shared<std::vector<DCRTPoly>>(std::initializer_list<DCRTPoly>{std::move(ct0), std::move(ct1)});
+}
+
+// Shape key of the autotuner; numPartQl as computed by EvalKeySwitchPrecomputeCore
+HKSShape ShapeOf(const DCRTPoly& c, const CryptoParametersRNS& cryptoParams) {
+    uint32_t sizeQl    = c.GetNumOfElements();
+    uint32_t alpha     = cryptoParams.GetNumPerPartQ();
+    uint32_t numPartQl = ceil((static_cast<double>(sizeQl)) / alpha);
+    if (numPartQl > cryptoParams.GetNumberOfQPartitions())
+        numPartQl = cryptoParams.GetNumberOfQPartitions();
+    return {c.GetRingDimension(), sizeQl, static_cast<uint32_t>(cryptoParams.GetParamsP()->GetParams().size()),
+            numPartQl};
+}
+
+// Tower storage allocated on the host while alive, beyond what existed when it
+// started, rounded up to towers; the peak goes to HKSStats::peak_p_towers_measured.
+// Does nothing unless SetHKSPeakMeasurement(true).
+class ComplPeakMeter {
+public:
+    ComplPeakMeter(HKSStats& stats, uint32_t ringDim)
+        : m_stats(stats), m_towerBytes(static_cast<int64_t>(ringDim) * sizeof(NativeInteger)) {
+        if (HKSPeakMeasurementEnabled())
+            m_meter.emplace();
+    }
+    ~ComplPeakMeter() {
+        if (!m_meter)
+            return;
+        const int64_t towers           = (m_meter->PeakBytes() + m_towerBytes - 1) / m_towerBytes;
+        m_stats.peak_p_towers_measured = std::max(m_stats.peak_p_towers_measured, static_cast<int>(towers));
+    }
+
+private:
+    HKSStats& m_stats;
+    int64_t m_towerBytes;
+    std::optional<intnat::TowerArena::Meter> m_meter;
+};
+
+// MP phases run as one parallel loop over every (digit, tower) pair: a single
+// digit has only alpha (or sizeQlP - alpha) towers, too few to fill the cores.
+// Loops inside DCRTPolyImpl see omp_in_parallel() and stay serial
+// (ParallelControls::GetThreadLimit), so the two levels do not compete.
+struct TowerJob {
+    uint32_t part;
+    uint32_t tower;
+};
+
+std::vector<TowerJob> TowerJobs(const std::vector<DCRTPoly>& polys) {
+    std::vector<TowerJob> jobs;
+    for (uint32_t part = 0; part < polys.size(); part++) {
+        for (uint32_t i = 0; i < polys[part].GetNumOfElements(); i++)
+            jobs.push_back({part, i});
+    }
+    return jobs;
+}
+
+// MP: NTT/INTT of every tower of every digit
+void SetFormatAllTowers(std::vector<DCRTPoly>& polys, Format format) {
+    // The device takes all towers of a digit in one launch; launches are serial anyway
+    if (PolyAccelerator::Get() != nullptr) {
+        for (auto& poly : polys)
+            poly.SetFormat(format);
+        return;
+    }
+    const auto jobs = TowerJobs(polys);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(jobs.size()))
+    for (size_t k = 0; k < jobs.size(); k++) {
+        auto& tower = polys[jobs[k].part].GetAllElements()[jobs[k].tower];
+        if (tower.GetFormat() != format)
+            tower.SwitchFormat();
+    }
+    for (auto& poly : polys)
+        poly.OverrideFormat(format);
+}
+
+// True if every tower of poly can be transformed by the accelerator's async NTT:
+// the ring dimension is the one loaded by InitModuli and every modulus is on the device
+bool IsFpgaTransformable(const DCRTPoly& poly) {
+    auto* accel = PolyAccelerator::Get();
+    if (accel == nullptr || !accel->SupportsRingDim(poly.GetRingDimension()))
+        return false;
+    for (const auto& tower : poly.GetAllElements()) {
+        if (!accel->HasModulus(tower.GetModulus().ConvertToInt()))
+            return false;
+    }
+    return true;
+}
+
+// NTT/INTT of the towers of a poly queued on the FPGA command queue. The formats
+// change only in FinishFormat, once the data has actually been transformed.
+struct PendingFormat {
+    DCRTPoly* poly = nullptr;
+    Format format  = Format::EVALUATION;
+    std::vector<std::future<void>> towers;  // one per tower, in order
+};
+
+// Queues an in-place NTT/INTT of every tower of poly; the tower data must not be
+// touched before FinishFormat
+PendingFormat SetFormatOffloadAsync(DCRTPoly& poly, Format format) {
+    PendingFormat pending;
+    if (poly.GetFormat() == format)
+        return pending;
+    auto* accel      = PolyAccelerator::Get();
+    const size_t n   = poly.GetRingDimension();
+    const bool toNTT = (format == Format::EVALUATION);
+    pending.poly     = &poly;
+    pending.format   = format;
+    for (auto& tower : poly.GetAllElements()) {
+        auto* data = reinterpret_cast<uint64_t*>(&tower[0]);
+        auto q     = tower.GetModulus().ConvertToInt();
+        pending.towers.push_back(toNTT ? accel->NttForwardOffloadAsync(data, data, q, n) :
+                                         accel->NttInverseOffloadAsync(data, data, q, n));
+    }
+    return pending;
+}
+
+// Waits for the queued transforms, then marks the new format. A tower the device
+// did not accept (std::invalid_argument: nothing was submitted, the data is
+// untouched) is transformed on the CPU; any other failure is rethrown.
+void FinishFormat(PendingFormat& pending) {
+    if (pending.poly == nullptr)
+        return;
+    auto& towers = pending.poly->GetAllElements();
+    for (size_t i = 0; i < pending.towers.size(); ++i) {
+        try {
+            pending.towers[i].get();
+        }
+        catch (const std::invalid_argument&) {
+            towers[i].SwitchFormat();
+        }
+        towers[i].OverrideFormat(pending.format);
+    }
+    pending.poly->OverrideFormat(pending.format);
+    pending = PendingFormat();
+}
+
+void FinishFormat(std::vector<PendingFormat>& pending) {
+    for (auto& p : pending)
+        FinishFormat(p);
+    pending.clear();
+}
+
+// Adds the host <-> device bytes moved during its lifetime to HKSStats
+class FpgaTrafficScope {
+public:
+    FpgaTrafficScope() : m_accel{PolyAccelerator::Get()} {
+        if (m_accel)
+            m_start = m_accel->GetTransferStats();
+    }
+    ~FpgaTrafficScope() {
+        if (!m_accel)
+            return;
+        auto now    = m_accel->GetTransferStats();
+        auto& stats = GetHKSStats();
+        stats.bytes_h2d += now.h2d_bytes - m_start.h2d_bytes;
+        stats.bytes_d2h += now.d2h_bytes - m_start.d2h_bytes;
+    }
+
+private:
+    PolyAccelerator* m_accel;
+    FpgaTransferStats m_start;
+};
+
+const uint64_t* TowerData(const NativePoly& tower) {
+    return reinterpret_cast<const uint64_t*>(&tower[0]);
+}
+
+// The a vector of evalKey for the device paths. A seeded key that has not been
+// expanded is expanded into scratch for this call only, so it keeps half the memory
+const std::vector<DCRTPoly>& DeviceAVector(const EvalKey<DCRTPoly>& evalKey, std::vector<DCRTPoly>& scratch) {
+    const auto* seeded = dynamic_cast<const SeededEvalKeyRelin*>(evalKey.get());
+    if (seeded == nullptr || seeded->IsExpanded())
+        return evalKey->GetAVector();
+    scratch = seeded->ExpandAVector();
+    return scratch;
+}
+
+// HKSStrategy::FUSED: the whole digit loop of EvalKeySwitchPrecomputeCore and the
+// key inner product of EvalFastKeySwitchCoreExt run on the device (OP_HKS_DIGIT);
+// returns (c0', c1') over QlP, or nullptr if the device cannot take this shape.
+std::shared_ptr<std::vector<DCRTPoly>> FusedKeySwitchCoreExt(const DCRTPoly& c, const EvalKey<DCRTPoly>& evalKey) {
+    auto* accel = PolyAccelerator::Get();
+    if (accel == nullptr || c.GetFormat() != Format::EVALUATION || c.GetRingDimension() != FPGA_RING_DIM)
+        return nullptr;
+
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(evalKey->GetCryptoParameters());
+    std::vector<DCRTPoly> expandedA;
+    const std::vector<DCRTPoly>& bv = evalKey->GetBVector();
+    const std::vector<DCRTPoly>& av = DeviceAVector(evalKey, expandedA);
+
+    const auto paramsQl  = c.GetParams();
+    const auto paramsP   = cryptoParams->GetParamsP();
+    const auto paramsQlP = c.GetExtendedCRTBasis(paramsP);
+
+    size_t sizeQl  = paramsQl->GetParams().size();
+    size_t sizeP   = paramsP->GetParams().size();
+    size_t sizeQlP = sizeQl + sizeP;
+    size_t sizeQ   = cryptoParams->GetElementParams()->GetParams().size();
+
+    uint32_t alpha     = cryptoParams->GetNumPerPartQ();
+    uint32_t numPartQl = ceil((static_cast<double>(sizeQl)) / alpha);
+    if (numPartQl > cryptoParams->GetNumberOfQPartitions())
+        numPartQl = cryptoParams->GetNumberOfQPartitions();
+
+    std::vector<uint64_t> moduli(sizeQlP);
+    for (size_t e = 0; e < sizeQlP; ++e)
+        moduli[e] = paramsQlP->GetParams()[e]->GetModulus().ConvertToInt();
+
+    // host-side tables, one entry per digit; the device reads towers in place
+    std::vector<std::vector<const uint64_t*>> towers(numPartQl), keyB(numPartQl), keyA(numPartQl);
+    std::vector<std::vector<uint64_t>> qHatInv(numPartQl), qHatModCompl(numPartQl);
+    std::vector<PolyAccelerator::HksDigit> digits(numPartQl);
+    for (uint32_t part = 0; part < numPartQl; part++) {
+        uint32_t start      = alpha * part;
+        uint32_t sizePartQl = std::min<uint32_t>(alpha, sizeQl - start);
+        size_t sizeCompl    = sizeQlP - sizePartQl;
+
+        const auto& qhatinv = cryptoParams->GetPartQlHatInvModq(part, sizePartQl - 1);
+        const auto& qhatmod = cryptoParams->GetPartQlHatModp(sizeQl - 1, part);
+        for (uint32_t i = 0; i < sizePartQl; i++) {
+            towers[part].push_back(TowerData(c.GetElementAtIndex(start + i)));
+            qHatInv[part].push_back(qhatinv[i].ConvertToInt());
+            for (size_t k = 0; k < sizeCompl; k++)
+                qHatModCompl[part].push_back(qhatmod[i][k].ConvertToInt());
+        }
+        // the key lives in QP; its P towers start at sizeQ
+        for (size_t e = 0; e < sizeQlP; ++e) {
+            size_t idx = (e < sizeQl) ? e : sizeQ + (e - sizeQl);
+            keyB[part].push_back(TowerData(bv[part].GetElementAtIndex(idx)));
+            keyA[part].push_back(TowerData(av[part].GetElementAtIndex(idx)));
+        }
+        digits[part] = {towers[part].data(),  sizePartQl,         start, qHatInv[part].data(),
+                        qHatModCompl[part].data(), keyB[part].data(), keyA[part].data()};
+    }
+
+    DCRTPoly cTilda0(paramsQlP, Format::EVALUATION, true);
+    DCRTPoly cTilda1(paramsQlP, Format::EVALUATION, true);
+    std::vector<uint64_t*> out0(sizeQlP), out1(sizeQlP);
+    for (size_t e = 0; e < sizeQlP; ++e) {
+        out0[e] = reinterpret_cast<uint64_t*>(&cTilda0.GetAllElements()[e][0]);
+        out1[e] = reinterpret_cast<uint64_t*>(&cTilda1.GetAllElements()[e][0]);
+    }
+
+    if (!accel->HksFusedOffload(digits, moduli.data(), sizeQlP, out0.data(), out1.data(), FPGA_RING_DIM))
+        return nullptr;
+
+    auto& stats       = GetHKSStats();
+    stats.num_digits  = (int)numPartQl;
+    stats.size_ql     = (int)sizeQl;
+    stats.size_p      = (int)sizeP;
+    stats.alpha       = (int)alpha;
+    stats.ring_dim    = (int)c.GetRingDimension();
+    stats.intt_poly  += (int)numPartQl;
+    stats.bconv      += (int)numPartQl;
+    stats.ntt_poly   += (int)numPartQl;
+    stats.modmul_limb += 2 * (int)(sizeQlP * numPartQl);
+    // one complement is resident on chip at a time, as in DC; the host holds none
+    stats.peak_p_towers = (int)(sizeQlP - std::min<size_t>(alpha, sizeQl - alpha * (numPartQl - 1)));
+
+    return std::make_shared<std::vector<DCRTPoly>>(
+        std::initializer_list<DCRTPoly>{std::move(cTilda0), std::move(cTilda1)});
+}
+
+}  // namespace
+
 EvalKey<DCRTPoly> KeySwitchHYBRID::KeySwitchGenInternal(const PrivateKey<DCRTPoly> oldKey,
                                                         const PrivateKey<DCRTPoly> newKey) const {
     return KeySwitchHYBRID::KeySwitchGenInternal(oldKey, newKey, nullptr);
@@ -54,7 +349,12 @@ EvalKey<DCRTPoly> KeySwitchHYBRID::KeySwitchGenInternal(const PrivateKey<DCRTPol
 EvalKey<DCRTPoly> KeySwitchHYBRID::KeySwitchGenInternal(const PrivateKey<DCRTPoly> oldKey,
                                                         const PrivateKey<DCRTPoly> newKey,
                                                         const EvalKey<DCRTPoly> ekPrev) const {
-    EvalKeyRelin<DCRTPoly> ek(std::make_shared<EvalKeyRelinImpl<DCRTPoly>>(newKey->GetCryptoContext()));
+    // single-key HE: a seeded key keeps only the seed of a (threshold HE reuses the a of ekPrev)
+    std::shared_ptr<SeededEvalKeyRelin> seeded;
+    if (ekPrev == nullptr && GetEvalKeyFormat() == EvalKeyFormat::SEEDED)
+        seeded = std::make_shared<SeededEvalKeyRelin>(newKey->GetCryptoContext());
+    EvalKeyRelin<DCRTPoly> ek(seeded ? seeded :
+                                       std::make_shared<EvalKeyRelinImpl<DCRTPoly>>(newKey->GetCryptoContext()));
 
     const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(newKey->GetCryptoParameters());
 
@@ -100,9 +400,12 @@ EvalKey<DCRTPoly> KeySwitchHYBRID::KeySwitchGenInternal(const PrivateKey<DCRTPol
     std::vector<NativeInteger> PModq = cryptoParams->GetPModq();
     size_t numPerPartQ               = cryptoParams->GetNumPerPartQ();
 
+    const PRNGSeed seed = seeded ? SeedUniformGenerator::GenerateSeed() : PRNGSeed{};
+
     for (size_t part = 0; part < numPartQ; ++part) {
-        DCRTPoly a = (ekPrev == nullptr) ? DCRTPoly(dug, paramsQP, Format::EVALUATION) :  // single-key HE
-                                           ekPrev->GetAVector()[part];                                      // threshold HE
+        DCRTPoly a = seeded              ? DCRTPoly::FromSeed(paramsQP, seed, part) :
+                     (ekPrev == nullptr) ? DCRTPoly(dug, paramsQP, Format::EVALUATION) :  // single-key HE
+                                           ekPrev->GetAVector()[part];                      // threshold HE
         DCRTPoly e(dgg, paramsQP, Format::EVALUATION);
         DCRTPoly b(paramsQP, Format::EVALUATION, true);
 
@@ -125,11 +428,15 @@ EvalKey<DCRTPoly> KeySwitchHYBRID::KeySwitchGenInternal(const PrivateKey<DCRTPol
             }
         }
 
-        av[part] = a;
+        if (!seeded)
+            av[part] = a;
         bv[part] = b;
     }
 
-    ek->SetAVector(std::move(av));
+    if (seeded)
+        seeded->SetSeed(seed);
+    else
+        ek->SetAVector(std::move(av));
     ek->SetBVector(std::move(bv));
     ek->SetKeyTag(newKey->GetKeyTag());
     return ek;
@@ -210,6 +517,7 @@ EvalKey<DCRTPoly> KeySwitchHYBRID::KeySwitchGenInternal(const PrivateKey<DCRTPol
 }
 
 void KeySwitchHYBRID::KeySwitchInPlace(Ciphertext<DCRTPoly>& ciphertext, const EvalKey<DCRTPoly> ek) const {
+    intnat::TowerArena::Scope arena;
     std::vector<DCRTPoly>& cv = ciphertext->GetElements();
 
     std::shared_ptr<std::vector<DCRTPoly>> ba = (cv.size() == 2) ? KeySwitchCore(cv[1], ek) : KeySwitchCore(cv[2], ek);
@@ -228,6 +536,7 @@ void KeySwitchHYBRID::KeySwitchInPlace(Ciphertext<DCRTPoly>& ciphertext, const E
 }
 
 Ciphertext<DCRTPoly> KeySwitchHYBRID::KeySwitchExt(ConstCiphertext<DCRTPoly> ciphertext, bool addFirst) const {
+    intnat::TowerArena::Scope arena;
     const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(ciphertext->GetCryptoParameters());
 
     const std::vector<DCRTPoly>& cv = ciphertext->GetElements();
@@ -255,6 +564,8 @@ Ciphertext<DCRTPoly> KeySwitchHYBRID::KeySwitchExt(ConstCiphertext<DCRTPoly> cip
 }
 
 Ciphertext<DCRTPoly> KeySwitchHYBRID::KeySwitchDown(ConstCiphertext<DCRTPoly> ciphertext) const {
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
     const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(ciphertext->GetCryptoParameters());
 
     const auto paramsP   = cryptoParams->GetParamsP();
@@ -274,6 +585,7 @@ Ciphertext<DCRTPoly> KeySwitchHYBRID::KeySwitchDown(ConstCiphertext<DCRTPoly> ci
 
     PlaintextModulus t = (cryptoParams->GetNoiseScale() == 1) ? 0 : cryptoParams->GetPlaintextModulus();
 
+    HKSPhaseTimer timer(HKSPhase::MODDOWN);
     DCRTPoly ct0 = cTilda[0].ApproxModDown(paramsQl, cryptoParams->GetParamsP(), cryptoParams->GetPInvModq(),
                                            cryptoParams->GetPInvModqPrecon(), cryptoParams->GetPHatInvModp(),
                                            cryptoParams->GetPHatInvModpPrecon(), cryptoParams->GetPHatModq(),
@@ -292,6 +604,8 @@ Ciphertext<DCRTPoly> KeySwitchHYBRID::KeySwitchDown(ConstCiphertext<DCRTPoly> ci
 }
 
 DCRTPoly KeySwitchHYBRID::KeySwitchDownFirstElement(ConstCiphertext<DCRTPoly> ciphertext) const {
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
     const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(ciphertext->GetCryptoParameters());
 
     const std::vector<DCRTPoly>& cTilda = ciphertext->GetElements();
@@ -311,6 +625,7 @@ DCRTPoly KeySwitchHYBRID::KeySwitchDownFirstElement(ConstCiphertext<DCRTPoly> ci
 
     PlaintextModulus t = (cryptoParams->GetNoiseScale() == 1) ? 0 : cryptoParams->GetPlaintextModulus();
 
+    HKSPhaseTimer timer(HKSPhase::MODDOWN);
     DCRTPoly cv0 = cTilda[0].ApproxModDown(paramsQl, cryptoParams->GetParamsP(), cryptoParams->GetPInvModq(),
                                            cryptoParams->GetPInvModqPrecon(), cryptoParams->GetPHatInvModp(),
                                            cryptoParams->GetPHatInvModpPrecon(), cryptoParams->GetPHatModq(),
@@ -322,12 +637,45 @@ DCRTPoly KeySwitchHYBRID::KeySwitchDownFirstElement(ConstCiphertext<DCRTPoly> ci
 
 std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::KeySwitchCore(const DCRTPoly& a,
                                                                       const EvalKey<DCRTPoly> evalKey) const {
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
+    HKSStrategy strategy = ActiveHKSStrategy();
+    if (strategy == HKSStrategy::AUTO) {
+        const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(evalKey->GetCryptoParameters());
+        const HKSShape shape    = ShapeOf(a, *cryptoParams);
+        auto& tuner             = HKSAutotuner::GetInstance();
+        if (!tuner.Lookup(shape, strategy)) {
+            // the timing runs are thrown away: the winner runs once more below,
+            // so both the result and HKSStats come from it
+            const HKSStats before = GetHKSStats();
+            strategy              = tuner.Tune(shape, [&](HKSStrategy candidate) {
+                ScopedHKSStrategy scope(candidate);
+                return KeySwitchCore(a, evalKey);
+            });
+            GetHKSStats() = before;
+        }
+    }
+    // EvalKeySwitchPrecomputeCore below sees the resolved strategy
+    ScopedHKSStrategy scope(strategy);
+
+    if (strategy == HKSStrategy::FUSED) {
+        std::shared_ptr<std::vector<DCRTPoly>> cTilda;
+        {
+            FpgaTrafficScope traffic;
+            HKSPhaseTimer timer(HKSPhase::DEVICE);
+            cTilda = FusedKeySwitchCoreExt(a, evalKey);
+        }
+        if (cTilda)
+            return ModDownToQl(*cTilda, evalKey, a.GetParams());
+    }
     return EvalFastKeySwitchCore(EvalKeySwitchPrecomputeCore(a, evalKey->GetCryptoParameters()), evalKey,
                                  a.GetParams());
 }
 
 std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalKeySwitchPrecomputeCore(
     const DCRTPoly& c, std::shared_ptr<CryptoParametersBase<DCRTPoly>> cryptoParamsBase) const {
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
     const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(cryptoParamsBase);
 
     const std::shared_ptr<ParmType> paramsQl  = c.GetParams();
@@ -378,9 +726,21 @@ std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalKeySwitchPrecomputeC
     }
 
     std::vector<DCRTPoly> partsCtCompl(numPartQl);
+    // The extended digits are the output and are allocated up front; every
+    // complement tower is moved into its slot, so what the meter below sees on
+    // top of this is the complement storage alone
     std::vector<DCRTPoly> partsCtExt(numPartQl);
-
-    HKSStrategy strategy = GetHKSStrategy();
+    for (uint32_t part = 0; part < numPartQl; part++)
+        partsCtExt[part] = DCRTPoly(paramsQlP, Format::EVALUATION, true);
+
+    // AUTO outside KeySwitchCore (hoisted rotations) uses the cached winner, or DC
+    HKSStrategy strategy = ActiveHKSStrategy();
+    if (strategy == HKSStrategy::AUTO && !HKSAutotuner::GetInstance().Lookup(ShapeOf(c, *cryptoParams), strategy))
+        strategy = HKSStrategy::DC;
+    // FUSED needs the evaluation key (see KeySwitchCore); hoisted precomputation runs as DC
+    if (strategy == HKSStrategy::FUSED)
+        strategy = HKSStrategy::DC;
+    FpgaTrafficScope traffic;
 
     // Capture parameters into stats
     auto& stats       = GetHKSStats();
@@ -394,30 +754,65 @@ std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalKeySwitchPrecomputeC
     // MP: Phase 1 - INTT all digits first (global barrier before BConv)
     // -----------------------------------------------------------------------
     if (strategy == HKSStrategy::MP) {
-        for (uint32_t part = 0; part < numPartQl; part++) {
-            partsCt[part].SetFormat(Format::COEFFICIENT);
-            stats.intt_poly++;
-        }
+        HKSPhaseTimer timer(HKSPhase::INTT);
+        SetFormatAllTowers(partsCt, Format::COEFFICIENT);
+        stats.intt_poly += numPartQl;
     }
 
-    // Set peak_p_towers for DC and MP here (OC sets it to 1 in its branch)
-    if (strategy == HKSStrategy::DC)
-        stats.peak_p_towers = (int)sizeP;
-    else if (strategy == HKSStrategy::MP)
-        stats.peak_p_towers = (int)(numPartQl * sizeP);
+    // Complement size of each digit (the last digit may be shorter, so its complement is larger)
+    size_t maxCompl = 0, sumCompl = 0;
+    for (uint32_t part = 0; part < numPartQl; part++) {
+        size_t sizeCompl = sizeQlP - partsCt[part].GetNumOfElements();
+        maxCompl         = std::max(maxCompl, sizeCompl);
+        sumCompl += sizeCompl;
+    }
+    ComplPeakMeter meter(stats, stats.ring_dim);
 
     // -----------------------------------------------------------------------
     // DC / MP: BConv phase (DC interleaves with INTT/NTT; MP does all BConv here)
     // OC: skipped here, handled separately below
     // -----------------------------------------------------------------------
     if (strategy == HKSStrategy::DC || strategy == HKSStrategy::MP) {
-        for (uint32_t part = 0; part < numPartQl; part++) {
-            // DC: INTT happens per-digit before BConv
-            if (strategy == HKSStrategy::DC) {
-                partsCt[part].SetFormat(Format::COEFFICIENT);
-                stats.intt_poly++;
+        // DC frees each complement as soon as it is assembled; MP (and the
+        // pipelined FPGA DC path) keeps every complement until the end
+        bool holdAll = (strategy == HKSStrategy::MP);
+        // DC on the FPGA: the INTT of digit part+1 is queued before digit part is
+        // consumed and every complement NTT is queued without waiting, so the Top
+        // kernel stays busy while the host prepares the next BConv.
+        const bool asyncFpga = (strategy == HKSStrategy::DC) && IsFpgaTransformable(c);
+        std::vector<PendingFormat> pendingIntt(numPartQl);
+        std::vector<PendingFormat> pendingNtt;
+        if (asyncFpga)
+            pendingIntt[0] = SetFormatOffloadAsync(partsCt[0], Format::COEFFICIENT);
+        holdAll = holdAll || asyncFpga;
+        stats.peak_p_towers = (int)(holdAll ? sumCompl : maxCompl);
+
+        // Assemble partsCtExt[part] from the Q-side digit and its complement towers
+        auto assemble = [&](uint32_t part) {
+            // Both DC and MP: Q-side needs NTT before assembly (MP did it in Phase 3)
+            if (partsCt[part].GetFormat() != Format::EVALUATION) {
+                HKSPhaseTimer timer(HKSPhase::NTT);
+                partsCt[part].SetFormat(Format::EVALUATION);
+            }
+            stats.ntt_poly++;
+
+            uint32_t sizePartQl = partsCt[part].GetNumOfElements();
+            auto& complTowers   = partsCtCompl[part].GetAllElements();
+            usint startPartIdx = alpha * part;
+            usint endPartIdx   = startPartIdx + sizePartQl;
+            for (usint i = 0; i < startPartIdx; i++) {
+                partsCtExt[part].SetElementAtIndex(i, std::move(complTowers[i]));
+            }
+            for (usint i = startPartIdx, idx = 0; i < endPartIdx; i++, idx++) {
+                partsCtExt[part].SetElementAtIndex(i, partsCt[part].GetElementAtIndex(idx));
+            }
+            for (usint i = endPartIdx; i < sizeQlP; ++i) {
+                partsCtExt[part].SetElementAtIndex(i, std::move(complTowers[i - sizePartQl]));
             }
+            partsCtCompl[part] = DCRTPoly();
+        };
 
+        auto bconv = [&](uint32_t part) {
             uint32_t sizePartQl = partsCt[part].GetNumOfElements();
             partsCtCompl[part]  = partsCt[part].ApproxSwitchCRTBasis(
                 cryptoParams->GetParamsPartQ(part), cryptoParams->GetParamsComplPartQ(sizeQl - 1, part),
@@ -425,113 +820,152 @@ std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalKeySwitchPrecomputeC
                 cryptoParams->GetPartQlHatInvModqPrecon(part, sizePartQl - 1),
                 cryptoParams->GetPartQlHatModp(sizeQl - 1, part),
                 cryptoParams->GetmodComplPartqBarrettMu(sizeQl - 1, part));
-            stats.bconv++;
-
-            // DC: NTT happens per-digit after BConv; MP: NTT in Phase 3 below
-            if (strategy == HKSStrategy::DC) {
-                partsCtCompl[part].SetFormat(Format::EVALUATION);
-                stats.ntt_poly++;
-            }
-        }
+        };
 
-        // MP: Phase 3 - NTT all complement towers (global barrier)
         if (strategy == HKSStrategy::MP) {
-            for (uint32_t part = 0; part < numPartQl; part++) {
-                partsCtCompl[part].SetFormat(Format::EVALUATION);
-                stats.ntt_poly++;
+            // MP: Phase 2 - BConv all digits (global barrier before NTT)
+            // With at least as many digits as threads each thread converts whole
+            // digits; otherwise the loop runs over (digit, complement tower) pairs,
+            // which recomputes x * QHatInv per tower but keeps every core busy
+            // (phase times are taken on this thread, around each parallel loop)
+            std::optional<HKSPhaseTimer> timer;
+            timer.emplace(HKSPhase::BCONV);
+            int threads = OpenFHEParallelControls.GetThreadLimit(static_cast<int>(sumCompl));
+            if (threads <= 1 || numPartQl >= static_cast<uint32_t>(threads)) {
+#pragma omp parallel for num_threads(threads)
+                for (uint32_t part = 0; part < numPartQl; part++)
+                    bconv(part);
+            }
+            else {
+                for (uint32_t part = 0; part < numPartQl; part++)
+                    partsCtCompl[part] = DCRTPoly(cryptoParams->GetParamsComplPartQ(sizeQl - 1, part),
+                                                  Format::COEFFICIENT, false);
+                const auto jobs = TowerJobs(partsCtCompl);
+#pragma omp parallel for num_threads(OpenFHEParallelControls.GetThreadLimit(jobs.size()))
+                for (size_t k = 0; k < jobs.size(); k++) {
+                    uint32_t part       = jobs[k].part;
+                    uint32_t sizePartQl = partsCt[part].GetNumOfElements();
+                    partsCtCompl[part].GetAllElements()[jobs[k].tower] = partsCt[part].ApproxSwitchCRTBasisTower(
+                        cryptoParams->GetParamsPartQ(part), cryptoParams->GetParamsComplPartQ(sizeQl - 1, part),
+                        jobs[k].tower, cryptoParams->GetPartQlHatInvModq(part, sizePartQl - 1),
+                        cryptoParams->GetPartQlHatInvModqPrecon(part, sizePartQl - 1),
+                        cryptoParams->GetPartQlHatModp(sizeQl - 1, part),
+                        cryptoParams->GetmodComplPartqBarrettMu(sizeQl - 1, part));
+                }
             }
+            stats.bconv += numPartQl;
+
+            // MP: Phase 3 - NTT all digits and complement towers (global barrier)
+            timer.emplace(HKSPhase::NTT);
+            SetFormatAllTowers(partsCtCompl, Format::EVALUATION);
+            SetFormatAllTowers(partsCt, Format::EVALUATION);
+            stats.ntt_poly += numPartQl;
         }
+        else {
+            for (uint32_t part = 0; part < numPartQl; part++) {
+                // DC: INTT happens per-digit before BConv
+                {
+                    HKSPhaseTimer timer(HKSPhase::INTT);
+                    if (asyncFpga) {
+                        if (part + 1 < numPartQl)
+                            pendingIntt[part + 1] = SetFormatOffloadAsync(partsCt[part + 1], Format::COEFFICIENT);
+                        FinishFormat(pendingIntt[part]);
+                    }
+                    else
+                        partsCt[part].SetFormat(Format::COEFFICIENT);
+                }
+                stats.intt_poly++;
 
-        // Assemble partsCtExt from Q-side digit + P-side complement towers
-        for (uint32_t part = 0; part < numPartQl; part++) {
-            // Both DC and MP: Q-side needs NTT before assembly
-            partsCt[part].SetFormat(Format::EVALUATION);
-            stats.ntt_poly++;
+                {
+                    HKSPhaseTimer timer(HKSPhase::BCONV);
+                    bconv(part);
+                }
+                stats.bconv++;
 
-            uint32_t sizePartQl = partsCt[part].GetNumOfElements();
-            partsCtExt[part]    = DCRTPoly(paramsQlP, Format::EVALUATION, true);
+                // DC: NTT happens per-digit after BConv (queued only, on the FPGA pipeline)
+                {
+                    HKSPhaseTimer timer(HKSPhase::NTT);
+                    if (asyncFpga && IsFpgaTransformable(partsCtCompl[part]))
+                        pendingNtt.push_back(SetFormatOffloadAsync(partsCtCompl[part], Format::EVALUATION));
+                    else
+                        partsCtCompl[part].SetFormat(Format::EVALUATION);
+                    // the last digit's span also covers draining the FPGA pipeline
+                    if (part + 1 == numPartQl)
+                        FinishFormat(pendingNtt);
+                }
+                stats.ntt_poly++;
 
-            usint startPartIdx = alpha * part;
-            usint endPartIdx   = startPartIdx + sizePartQl;
-            for (usint i = 0; i < startPartIdx; i++) {
-                partsCtExt[part].SetElementAtIndex(i, partsCtCompl[part].GetElementAtIndex(i));
-            }
-            for (usint i = startPartIdx, idx = 0; i < endPartIdx; i++, idx++) {
-                partsCtExt[part].SetElementAtIndex(i, partsCt[part].GetElementAtIndex(idx));
-            }
-            for (usint i = endPartIdx; i < sizeQlP; ++i) {
-                partsCtExt[part].SetElementAtIndex(i, partsCtCompl[part].GetElementAtIndex(i - sizePartQl));
+                if (!holdAll)
+                    assemble(part);
             }
         }
+
+        if (holdAll) {
+            for (uint32_t part = 0; part < numPartQl; part++)
+                assemble(part);
+        }
     }
     else {
         // -------------------------------------------------------------------
-        // OC: Output-Centric - process one P-tower at a time across all digits
-        // Minimizes peak SRAM: only one complement tower lives in memory at once
+        // OC: Output-Centric - process one complement tower at a time across all digits
+        // ApproxSwitchCRTBasisTower computes only the tower being assembled, so a
+        // single basis-converted tower is alive at any point
         // -------------------------------------------------------------------
 
-        // Pre-allocate partsCtExt and fill Q-side while partsCt is still in EVALUATION
+        // Fill the Q-side of partsCtExt while partsCt is still in EVALUATION
         for (uint32_t part = 0; part < numPartQl; part++) {
             uint32_t sizePartQl = partsCt[part].GetNumOfElements();
-            partsCtExt[part]    = DCRTPoly(paramsQlP, Format::EVALUATION, true);
 
             usint startPartIdx = alpha * part;
             usint endPartIdx   = startPartIdx + sizePartQl;
             for (usint i = startPartIdx, idx = 0; i < endPartIdx; i++, idx++) {
                 partsCtExt[part].SetElementAtIndex(i, partsCt[part].GetElementAtIndex(idx));
             }
-            // P-side towers will be filled tower-by-tower below (default zero)
+            // Complement towers will be filled tower-by-tower below (default zero)
 
             // INTT once for BConv (no redundant round-trip)
+            HKSPhaseTimer timer(HKSPhase::INTT);
             partsCt[part].SetFormat(Format::COEFFICIENT);
             stats.intt_poly++;
         }
-        stats.peak_p_towers = 1;  // OC: one P-tower held at a time
+        stats.peak_p_towers = 1;  // OC: one complement tower held at a time
+
+        // BConv of digit `part` straight into QlP tower extIdx
+        auto convertTower = [&](uint32_t part, usint extIdx) {
+            uint32_t sizePartQl = partsCt[part].GetNumOfElements();
+            usint startPartIdx  = alpha * part;
+            // same mapping as the DC assembly: ext[i] <- compl[i] below the digit, compl[i - sizePartQl] above
+            usint complIdx = (extIdx < startPartIdx) ? extIdx : extIdx - sizePartQl;
+
+            std::optional<HKSPhaseTimer> timer;
+            timer.emplace(HKSPhase::BCONV);
+            auto tower = partsCt[part].ApproxSwitchCRTBasisTower(
+                cryptoParams->GetParamsPartQ(part), cryptoParams->GetParamsComplPartQ(sizeQl - 1, part), complIdx,
+                cryptoParams->GetPartQlHatInvModq(part, sizePartQl - 1),
+                cryptoParams->GetPartQlHatInvModqPrecon(part, sizePartQl - 1),
+                cryptoParams->GetPartQlHatModp(sizeQl - 1, part),
+                cryptoParams->GetmodComplPartqBarrettMu(sizeQl - 1, part));
+            stats.bconv++;
+
+            timer.emplace(HKSPhase::NTT);
+            tower.SetFormat(Format::EVALUATION);
+            stats.ntt_limb++;
+            partsCtExt[part].SetElementAtIndex(extIdx, std::move(tower));
+        };
 
         // Outer loop over each P output tower (one at a time → minimal peak SRAM)
         for (usint p = 0; p < sizeP; p++) {
             for (uint32_t part = 0; part < numPartQl; part++) {
-                uint32_t sizePartQl = partsCt[part].GetNumOfElements();
-
-                // BConv: compute full complement, then pick only tower p
-                // (True OC would call BConvOffload with sizeP=1 directly on FPGA;
-                //  here we use the existing ApproxSwitchCRTBasis and discard other towers)
-                DCRTPoly fullCompl = partsCt[part].ApproxSwitchCRTBasis(
-                    cryptoParams->GetParamsPartQ(part), cryptoParams->GetParamsComplPartQ(sizeQl - 1, part),
-                    cryptoParams->GetPartQlHatInvModq(part, sizePartQl - 1),
-                    cryptoParams->GetPartQlHatInvModqPrecon(part, sizePartQl - 1),
-                    cryptoParams->GetPartQlHatModp(sizeQl - 1, part),
-                    cryptoParams->GetmodComplPartqBarrettMu(sizeQl - 1, part));
-                stats.bconv++;
-
-                // Tower p in QlP space is at index sizeQl+p.
-                // The assembly mapping (same as DC): compl[i - sizePartQl] → ext[i] for i>=endPartIdx
-                // → compl index for P-tower p = (sizeQl + p) - sizePartQl
-                usint startPartIdx = alpha * part;
-                usint endPartIdx   = startPartIdx + sizePartQl;
-                usint extPIdx  = sizeQl + p;
-                usint complIdx = extPIdx - sizePartQl;
-
                 // On first P-tower: also fill Q complement towers (outside digit's own Q range)
                 if (p == 0) {
-                    for (usint i = 0; i < startPartIdx; i++) {
-                        auto t = fullCompl.GetElementAtIndex(i);
-                        t.SetFormat(Format::EVALUATION);
-                        stats.ntt_limb++;
-                        partsCtExt[part].SetElementAtIndex(i, t);
-                    }
-                    for (usint i = endPartIdx; i < sizeQl; i++) {
-                        auto t = fullCompl.GetElementAtIndex(i - sizePartQl);
-                        t.SetFormat(Format::EVALUATION);
-                        stats.ntt_limb++;
-                        partsCtExt[part].SetElementAtIndex(i, t);
-                    }
+                    usint startPartIdx = alpha * part;
+                    usint endPartIdx   = startPartIdx + partsCt[part].GetNumOfElements();
+                    for (usint i = 0; i < startPartIdx; i++)
+                        convertTower(part, i);
+                    for (usint i = endPartIdx; i < sizeQl; i++)
+                        convertTower(part, i);
                 }
-
-                auto tower = fullCompl.GetElementAtIndex(complIdx);
-                tower.SetFormat(Format::EVALUATION);
-                stats.ntt_limb++;
-                partsCtExt[part].SetElementAtIndex(extPIdx, tower);
+                convertTower(part, sizeQl + p);
             }
             // After this iteration: tower p is fully assembled across all digits
         }
@@ -543,71 +977,119 @@ std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalKeySwitchPrecomputeC
 std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalFastKeySwitchCore(
     const std::shared_ptr<std::vector<DCRTPoly>> digits, const EvalKey<DCRTPoly> evalKey,
     const std::shared_ptr<ParmType> paramsQl) const {
-    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(evalKey->GetCryptoParameters());
-
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
     std::shared_ptr<std::vector<DCRTPoly>> cTilda = EvalFastKeySwitchCoreExt(digits, evalKey, paramsQl);
-
-    PlaintextModulus t = (cryptoParams->GetNoiseScale() == 1) ? 0 : cryptoParams->GetPlaintextModulus();
-
-    DCRTPoly ct0 = (*cTilda)[0].ApproxModDown(paramsQl, cryptoParams->GetParamsP(), cryptoParams->GetPInvModq(),
-                                              cryptoParams->GetPInvModqPrecon(), cryptoParams->GetPHatInvModp(),
-                                              cryptoParams->GetPHatInvModpPrecon(), cryptoParams->GetPHatModq(),
-                                              cryptoParams->GetModqBarrettMu(), cryptoParams->GettInvModp(),
-                                              cryptoParams->GettInvModpPrecon(), t, cryptoParams->GettModqPrecon());
-
-    DCRTPoly ct1 = (*cTilda)[1].ApproxModDown(paramsQl, cryptoParams->GetParamsP(), cryptoParams->GetPInvModq(),
-                                              cryptoParams->GetPInvModqPrecon(), cryptoParams->GetPHatInvModp(),
-                                              cryptoParams->GetPHatInvModpPrecon(), cryptoParams->GetPHatModq(),
-                                              cryptoParams->GetModqBarrettMu(), cryptoParams->GettInvModp(),
-                                              cryptoParams->GettInvModpPrecon(), t, cryptoParams->GettModqPrecon());
-
-    return std::make_shared<std::vector<DCRTPoly>>(std::initializer_list<DCRTPoly>{std::move(ct0), std::move(ct1)});
+    return ModDownToQl(*cTilda, evalKey, paramsQl);
 }
 
 std::shared_ptr<std::vector<DCRTPoly>> KeySwitchHYBRID::EvalFastKeySwitchCoreExt(
     const std::shared_ptr<std::vector<DCRTPoly>> digits, const EvalKey<DCRTPoly> evalKey,
     const std::shared_ptr<ParmType> paramsQl) const {
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
     const auto cryptoParams         = std::dynamic_pointer_cast<CryptoParametersRNS>(evalKey->GetCryptoParameters());
     const std::vector<DCRTPoly>& bv = evalKey->GetBVector();
-    const std::vector<DCRTPoly>& av = evalKey->GetAVector();
 
     const std::shared_ptr<ParmType> paramsP   = cryptoParams->GetParamsP();
     const std::shared_ptr<ParmType> paramsQlP = (*digits)[0].GetParams();
 
     size_t sizeQl  = paramsQl->GetParams().size();
     size_t sizeQlP = paramsQlP->GetParams().size();
-    size_t sizeQ   = cryptoParams->GetElementParams()->GetParams().size();
 
     DCRTPoly cTilda0(paramsQlP, Format::EVALUATION, true);
     DCRTPoly cTilda1(paramsQlP, Format::EVALUATION, true);
 
-    for (uint32_t j = 0; j < digits->size(); j++) {
-        const DCRTPoly& cj = (*digits)[j];
-        const DCRTPoly& bj = bv[j];
-        const DCRTPoly& aj = av[j];
+    FpgaTrafficScope traffic;
+    HKSPhaseTimer timer(HKSPhase::MAC);
+    // all digit products are accumulated unreduced; one Barrett reduction per coefficient.
+    // A seeded key that has not been expanded stays so: its a towers are generated as needed
+    const auto* seeded = dynamic_cast<const SeededEvalKeyRelin*>(evalKey.get());
+    if (seeded != nullptr && !seeded->IsExpanded())
+        DCRTPoly::KeyMultAccumulate(*digits, bv, seeded->GetSeed(), sizeQl, cTilda0, cTilda1);
+    else
+        DCRTPoly::KeyMultAccumulate(*digits, bv, evalKey->GetAVector(), sizeQl, cTilda0, cTilda1);
+    // 2 multiply-accumulate ops per limb (for cTilda0 and cTilda1)
+    GetHKSStats().modmul_limb += 2 * (int)(sizeQlP * digits->size());
 
-        for (usint i = 0; i < sizeQl; i++) {
-            const auto& cji = cj.GetElementAtIndex(i);
-            const auto& aji = aj.GetElementAtIndex(i);
-            const auto& bji = bj.GetElementAtIndex(i);
+    return std::make_shared<std::vector<DCRTPoly>>(
+        std::initializer_list<DCRTPoly>{std::move(cTilda0), std::move(cTilda1)});
+}
 
-            cTilda0.SetElementAtIndex(i, cTilda0.GetElementAtIndex(i) + cji * bji);
-            cTilda1.SetElementAtIndex(i, cTilda1.GetElementAtIndex(i) + cji * aji);
-        }
-        for (usint i = sizeQl, idx = sizeQ; i < sizeQlP; i++, idx++) {
-            const auto& cji = cj.GetElementAtIndex(i);
-            const auto& aji = aj.GetElementAtIndex(idx);
-            const auto& bji = bj.GetElementAtIndex(idx);
+// One OP_HKS_ROTATE launch: the digits (and P*c0) go to the device once, every
+// rotation's key MAC and automorphism run there, and all results come back together
+std::vector<std::shared_ptr<std::vector<DCRTPoly>>> KeySwitchHYBRID::EvalFastKeySwitchRotateBatchExt(
+    const std::shared_ptr<std::vector<DCRTPoly>> digits, const std::vector<EvalKey<DCRTPoly>>& evalKeys,
+    const std::vector<uint32_t>& autoIndices, const DCRTPoly* first, const std::shared_ptr<ParmType> paramsQl) const {
+    std::vector<std::shared_ptr<std::vector<DCRTPoly>>> results;
+    auto* accel = PolyAccelerator::Get();
+    if (accel == nullptr || evalKeys.empty() || digits->empty() || (*digits)[0].GetRingDimension() != FPGA_RING_DIM ||
+        (*digits)[0].GetFormat() != Format::EVALUATION)
+        return results;
+
+    HKSStatsScope statsScope;
+    intnat::TowerArena::Scope arena;
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(evalKeys[0]->GetCryptoParameters());
+    const std::shared_ptr<ParmType> paramsQlP = (*digits)[0].GetParams();
+
+    size_t numDigits = digits->size();
+    size_t sizeQl    = paramsQl->GetParams().size();
+    size_t sizeQlP   = paramsQlP->GetParams().size();
+    size_t sizeQ     = cryptoParams->GetElementParams()->GetParams().size();
+
+    std::vector<uint64_t> moduli(sizeQlP);
+    for (size_t e = 0; e < sizeQlP; ++e)
+        moduli[e] = paramsQlP->GetParams()[e]->GetModulus().ConvertToInt();
+
+    std::vector<const uint64_t*> digitTowers, firstTowers;
+    for (const auto& cj : *digits) {
+        for (size_t e = 0; e < sizeQlP; ++e)
+            digitTowers.push_back(TowerData(cj.GetElementAtIndex(e)));
+    }
+    if (first != nullptr) {
+        for (size_t e = 0; e < sizeQlP; ++e)
+            firstTowers.push_back(TowerData(first->GetElementAtIndex(e)));
+    }
 
-            cTilda0.SetElementAtIndex(i, cTilda0.GetElementAtIndex(i) + cji * bji);
-            cTilda1.SetElementAtIndex(i, cTilda1.GetElementAtIndex(i) + cji * aji);
+    // the keys live in QP; their P towers start at sizeQ
+    const size_t numRot = evalKeys.size();
+    std::vector<std::vector<const uint64_t*>> keyB(numRot), keyA(numRot);
+    std::vector<std::vector<uint64_t*>> out0(numRot), out1(numRot);
+    std::vector<PolyAccelerator::HksRotation> rotations(numRot);
+    std::vector<std::vector<DCRTPoly>> expandedA(numRot);
+    results.reserve(numRot);
+    for (size_t r = 0; r < numRot; ++r) {
+        const std::vector<DCRTPoly>& bv = evalKeys[r]->GetBVector();
+        const std::vector<DCRTPoly>& av = DeviceAVector(evalKeys[r], expandedA[r]);
+        for (size_t j = 0; j < numDigits; ++j) {
+            for (size_t e = 0; e < sizeQlP; ++e) {
+                size_t idx = (e < sizeQl) ? e : sizeQ + (e - sizeQl);
+                keyB[r].push_back(TowerData(bv[j].GetElementAtIndex(idx)));
+                keyA[r].push_back(TowerData(av[j].GetElementAtIndex(idx)));
+            }
+        }
+        results.push_back(std::make_shared<std::vector<DCRTPoly>>(std::initializer_list<DCRTPoly>{
+            DCRTPoly(paramsQlP, Format::EVALUATION, true), DCRTPoly(paramsQlP, Format::EVALUATION, true)}));
+        for (size_t e = 0; e < sizeQlP; ++e) {
+            out0[r].push_back(reinterpret_cast<uint64_t*>(&(*results[r])[0].GetAllElements()[e][0]));
+            out1[r].push_back(reinterpret_cast<uint64_t*>(&(*results[r])[1].GetAllElements()[e][0]));
         }
-        // 2 multiply-accumulate ops per limb (for cTilda0 and cTilda1)
-        GetHKSStats().modmul_limb += 2 * (int)sizeQlP;
+        rotations[r] = {autoIndices[r], keyB[r].data(), keyA[r].data(), out0[r].data(), out1[r].data()};
     }
 
-    return std::make_shared<std::vector<DCRTPoly>>(
-        std::initializer_list<DCRTPoly>{std::move(cTilda0), std::move(cTilda1)});
+    bool offloaded;
+    {
+        FpgaTrafficScope traffic;
+        HKSPhaseTimer timer(HKSPhase::DEVICE);
+        offloaded = accel->HksRotateBatchOffload(digitTowers.data(), numDigits,
+                                                 first != nullptr ? firstTowers.data() : nullptr, moduli.data(),
+                                                 sizeQlP, rotations, FPGA_RING_DIM);
+    }
+    if (!offloaded)
+        return {};
+
+    GetHKSStats().modmul_limb += 2 * (int)(sizeQlP * numDigits * numRot);
+    return results;
 }
 
 }  // namespace lbcrypto
@@ -121,7 +121,12 @@ Ciphertext<DCRTPoly> PKEBFVRNS::Encrypt(DCRTPoly ptxt, const PrivateKey<DCRTPoly
     }
     ptxt.SetFormat(Format::COEFFICIENT);
 
-    std::shared_ptr<std::vector<DCRTPoly>> ba = EncryptZeroCore(privateKey, encParams);
+    // EXTENDED encryption scales c1 down from Qr to Q, so only STANDARD keeps c1 equal to the seed's expansion
+    std::shared_ptr<const PRNGSeed> c1Seed;
+    if (GetCiphertextFormat() == CiphertextFormat::SEEDED && cryptoParams->GetEncryptionTechnique() != EXTENDED)
+        c1Seed = std::make_shared<const PRNGSeed>(SeedUniformGenerator::GenerateSeed());
+
+    std::shared_ptr<std::vector<DCRTPoly>> ba = EncryptZeroCore(privateKey, encParams, c1Seed.get());
 
     NativeInteger NegQModt       = cryptoParams->GetNegQModt(level);
     NativeInteger NegQModtPrecon = cryptoParams->GetNegQModtPrecon(level);
@@ -149,6 +154,7 @@ Ciphertext<DCRTPoly> PKEBFVRNS::Encrypt(DCRTPoly ptxt, const PrivateKey<DCRTPoly
     (*ba)[1].SetFormat(Format::EVALUATION);
 
     ciphertext->SetElements({std::move((*ba)[0]), std::move((*ba)[1])});
+    ciphertext->SetC1Seed(std::move(c1Seed));
     ciphertext->SetNoiseScaleDeg(1);
 
     return ciphertext;
@@ -31,6 +31,7 @@
 
 #include "ciphertext.h"
 #include "cryptocontext.h"
+#include "key/evalkey-lazy.h"
 #include "key/evalkeyrelin.h"
 #include "key/privatekey.h"
 #include "lattice/lat-hal.h"
@@ -50,6 +51,7 @@
 #include <limits>
 #include <map>
 #include <memory>
+#include <numeric>
 #ifdef BOOTSTRAPTIMING
     #include <ostream>
 #endif
@@ -476,6 +478,11 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalBootstrap(ConstCiphertext<DCRTPoly>& cipher
 
     uint32_t slots = ciphertext->GetSlots();
 
+    // keys loaded on first use: read the CoeffsToSlots keys ahead now, the SlotsToCoeffs keys during EvalMod
+    const auto lazyKeys = CryptoContextImpl<DCRTPoly>::GetLazyEvalAutomorphismKeyMap(ciphertext->GetKeyTag());
+    if (lazyKeys)
+        PrefetchBootstrapKeys(*lazyKeys, slots, cc->GetCyclotomicOrder(), true);
+
     auto elementParamsRaised = *(cryptoParams->GetElementParams());
     // For FLEXIBLEAUTOEXT we raised ciphertext does not include extra modulus
     // as it is multiplied by auxiliary plaintext
@@ -637,6 +644,8 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalBootstrap(ConstCiphertext<DCRTPoly>& cipher
         auto ctxtEncI   = cc->EvalSub(ctxtEnc, conj);
         cc->EvalAddInPlace(ctxtEnc, conj);
         algo->MultByMonomialInPlace(ctxtEncI, 3 * slots);
+        if (lazyKeys && !isLTBootstrap)
+            PrefetchBootstrapKeys(*lazyKeys, slots, cc->GetCyclotomicOrder(), false);
 
         if (st == FIXEDMANUAL) {
             while (ctxtEnc->GetNoiseScaleDeg() > 1) {
@@ -729,6 +738,8 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalBootstrap(ConstCiphertext<DCRTPoly>& cipher
         auto evalKeyMap = cc->GetEvalAutomorphismKeyMap(ctxtEnc->GetKeyTag());
         auto conj       = Conjugate(ctxtEnc, evalKeyMap);
         cc->EvalAddInPlace(ctxtEnc, conj);
+        if (lazyKeys && !isLTBootstrap)
+            PrefetchBootstrapKeys(*lazyKeys, slots, cc->GetCyclotomicOrder(), false);
 
         if (st == FIXEDMANUAL) {
             while (ctxtEnc->GetNoiseScaleDeg() > 1) {
@@ -814,7 +825,7 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalBootstrap(ConstCiphertext<DCRTPoly>& cipher
 // Find Rotation Indices
 //------------------------------------------------------------------------------
 
-std::vector<int32_t> FHECKKSRNS::FindBootstrapRotationIndices(uint32_t slots, uint32_t M) {
+std::vector<int32_t> FHECKKSRNS::FindBootstrapRotationIndices(uint32_t slots, uint32_t M) const {
     auto& p = GetBootPrecom(slots);
     bool isLTBootstrap =
         (p.m_paramsEnc[CKKS_BOOT_PARAMS::LEVEL_BUDGET] == 1) && (p.m_paramsDec[CKKS_BOOT_PARAMS::LEVEL_BUDGET] == 1);
@@ -842,7 +853,7 @@ std::vector<int32_t> FHECKKSRNS::FindBootstrapRotationIndices(uint32_t slots, ui
 // ATTN: This function is a helper methods to be called in FindBootstrapRotationIndices() only.
 // so it DOES NOT remove possible duplicates and automorphisms corresponding to 0 and M/4.
 // This method completely depends on FindBootstrapRotationIndices() to do that.
-std::vector<uint32_t> FHECKKSRNS::FindLinearTransformRotationIndices(uint32_t slots, uint32_t M) {
+std::vector<uint32_t> FHECKKSRNS::FindLinearTransformRotationIndices(uint32_t slots, uint32_t M) const {
     // Computing the baby-step g and the giant-step h.
     auto& p    = GetBootPrecom(slots);
     uint32_t g = (p.m_dim1 == 0) ? static_cast<uint32_t>(std::ceil(std::sqrt(slots))) : p.m_dim1;
@@ -875,7 +886,7 @@ std::vector<uint32_t> FHECKKSRNS::FindLinearTransformRotationIndices(uint32_t sl
 // ATTN: This function is a helper methods to be called in FindBootstrapRotationIndices() only.
 // so it DOES NOT remove possible duplicates and automorphisms corresponding to 0 and M/4.
 // This method completely depends on FindBootstrapRotationIndices() to do that.
-std::vector<uint32_t> FHECKKSRNS::FindCoeffsToSlotsRotationIndices(uint32_t slots, uint32_t M) {
+std::vector<uint32_t> FHECKKSRNS::FindCoeffsToSlotsRotationIndices(uint32_t slots, uint32_t M) const {
     auto& p = GetBootPrecom(slots);
 
     uint32_t levelBudget     = p.m_paramsEnc[CKKS_BOOT_PARAMS::LEVEL_BUDGET];
@@ -930,7 +941,7 @@ std::vector<uint32_t> FHECKKSRNS::FindCoeffsToSlotsRotationIndices(uint32_t slot
     return indexList;
 }
 
-std::vector<uint32_t> FHECKKSRNS::FindSlotsToCoeffsRotationIndices(uint32_t slots, uint32_t M) {
+std::vector<uint32_t> FHECKKSRNS::FindSlotsToCoeffsRotationIndices(uint32_t slots, uint32_t M) const {
     auto& p = GetBootPrecom(slots);
 
     uint32_t levelBudget     = p.m_paramsDec[CKKS_BOOT_PARAMS::LEVEL_BUDGET];
@@ -989,6 +1000,33 @@ std::vector<uint32_t> FHECKKSRNS::FindSlotsToCoeffsRotationIndices(uint32_t slot
     return indexList;
 }
 
+void FHECKKSRNS::PrefetchBootstrapKeys(const LazyEvalKeyMap& keys, uint32_t slots, uint32_t M, bool encoding) const {
+    auto& p = GetBootPrecom(slots);
+    bool isLTBootstrap =
+        (p.m_paramsEnc[CKKS_BOOT_PARAMS::LEVEL_BUDGET] == 1) && (p.m_paramsDec[CKKS_BOOT_PARAMS::LEVEL_BUDGET] == 1);
+
+    std::vector<uint32_t> rotations;
+    if (isLTBootstrap)
+        rotations = FindLinearTransformRotationIndices(slots, M);
+    else if (encoding)
+        rotations = FindCoeffsToSlotsRotationIndices(slots, M);
+    else
+        rotations = FindSlotsToCoeffsRotationIndices(slots, M);
+
+    // same filtering as FindBootstrapRotationIndices, then rotation -> automorphism index
+    std::set<uint32_t> s(rotations.begin(), rotations.end());
+    s.erase(0);
+    s.erase(M / 4);
+    std::vector<uint32_t> indices;
+    indices.reserve(s.size() + 1);
+    for (uint32_t r : s)
+        indices.push_back(FindAutomorphismIndex2nComplex(static_cast<int32_t>(r), M));
+    // the conjugation right after CoeffsToSlots
+    if (encoding)
+        indices.push_back(M - 1);
+    keys.Prefetch(indices);
+}
+
 //------------------------------------------------------------------------------
 // Precomputations for CoeffsToSlots and SlotsToCoeffs
 //------------------------------------------------------------------------------
@@ -1510,12 +1548,10 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalLinearTransform(const std::vector<ReadOnlyP
     // later on)
     auto digits = cc->EvalFastRotationPrecompute(ct);
 
-    std::vector<Ciphertext<DCRTPoly>> fastRotation(bStep - 1);
-
-    // hoisted automorphisms
-#pragma omp parallel for
-    for (uint32_t j = 1; j < bStep; ++j)
-        fastRotation[j - 1] = cc->EvalFastRotationExt(ct, j, digits, true);
+    // hoisted automorphisms, one batch for all baby steps
+    std::vector<int32_t> babySteps(bStep - 1);
+    std::iota(babySteps.begin(), babySteps.end(), 1);
+    auto fastRotation = cc->EvalFastRotationExtBatch(ct, babySteps, digits, true);
 
     Ciphertext<DCRTPoly> result;
     DCRTPoly first;
@@ -1616,14 +1652,8 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalCoeffsToSlots(const std::vector<std::vector
         // computes the NTTs for each CRT limb (for the hoisted automorphisms used later on)
         auto digits = cc->EvalFastRotationPrecompute(result);
 
-        std::vector<Ciphertext<DCRTPoly>> fastRotation(g);
-#pragma omp parallel for
-        for (int32_t j = 0; j < g; j++) {
-            if (rot_in[s][j] != 0)
-                fastRotation[j] = cc->EvalFastRotationExt(result, rot_in[s][j], digits, true);
-            else
-                fastRotation[j] = cc->KeySwitchExt(result, true);
-        }
+        auto fastRotation = cc->EvalFastRotationExtBatch(
+            result, std::vector<int32_t>(rot_in[s].begin(), rot_in[s].begin() + g), digits, true);
 
         Ciphertext<DCRTPoly> outer;
         DCRTPoly first;
@@ -1673,15 +1703,8 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalCoeffsToSlots(const std::vector<std::vector
 
         // computes the NTTs for each CRT limb (for the hoisted automorphisms used later on)
         auto digits = cc->EvalFastRotationPrecompute(result);
-        std::vector<Ciphertext<DCRTPoly>> fastRotation(gRem);
-
-#pragma omp parallel for
-        for (int32_t j = 0; j < gRem; ++j) {
-            if (rot_in[stop][j] != 0)
-                fastRotation[j] = cc->EvalFastRotationExt(result, rot_in[stop][j], digits, true);
-            else
-                fastRotation[j] = cc->KeySwitchExt(result, true);
-        }
+        auto fastRotation = cc->EvalFastRotationExtBatch(
+            result, std::vector<int32_t>(rot_in[stop].begin(), rot_in[stop].begin() + gRem), digits, true);
 
         Ciphertext<DCRTPoly> outer;
         DCRTPoly first;
@@ -1789,14 +1812,8 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalSlotsToCoeffs(const std::vector<std::vector
         // computes the NTTs for each CRT limb (for the hoisted automorphisms used later on)
         auto digits = cc->EvalFastRotationPrecompute(result);
 
-        std::vector<Ciphertext<DCRTPoly>> fastRotation(g);
-#pragma omp parallel for
-        for (int32_t j = 0; j < g; ++j) {
-            if (rot_in[s][j] != 0)
-                fastRotation[j] = cc->EvalFastRotationExt(result, rot_in[s][j], digits, true);
-            else
-                fastRotation[j] = cc->KeySwitchExt(result, true);
-        }
+        auto fastRotation = cc->EvalFastRotationExtBatch(
+            result, std::vector<int32_t>(rot_in[s].begin(), rot_in[s].begin() + g), digits, true);
 
         Ciphertext<DCRTPoly> outer;
         DCRTPoly first;
@@ -1845,16 +1862,9 @@ Ciphertext<DCRTPoly> FHECKKSRNS::EvalSlotsToCoeffs(const std::vector<std::vector
         algo->ModReduceInternalInPlace(result, compositeDegree);
         // computes the NTTs for each CRT limb (for the hoisted automorphisms used later on)
         auto digits = cc->EvalFastRotationPrecompute(result);
-        std::vector<Ciphertext<DCRTPoly>> fastRotation(gRem);
-
         int32_t s = levelBudget - flagRem;
-#pragma omp parallel for
-        for (int32_t j = 0; j < gRem; ++j) {
-            if (rot_in[s][j] != 0)
-                fastRotation[j] = cc->EvalFastRotationExt(result, rot_in[s][j], digits, true);
-            else
-                fastRotation[j] = cc->KeySwitchExt(result, true);
-        }
+        auto fastRotation = cc->EvalFastRotationExtBatch(
+            result, std::vector<int32_t>(rot_in[s].begin(), rot_in[s].begin() + gRem), digits, true);
 
         Ciphertext<DCRTPoly> outer;
         DCRTPoly first;
@@ -47,6 +47,23 @@ CKKS implementation. See https://eprint.iacr.org/2020/1118 for details.
 
 namespace lbcrypto {
 
+namespace {
+
+// P * c0 over QlP (zero P towers), the first element of a rotation in the extended basis
+DCRTPoly PModqFirstElement(ConstCiphertext<DCRTPoly>& ciphertext, const CryptoParametersCKKSRNS& cryptoParams,
+                           const std::shared_ptr<DCRTPoly::Params>& paramsQlP) {
+    const auto& c0 = ciphertext->GetElements()[0];
+    size_t sizeQl  = c0.GetNumOfElements();
+    DCRTPoly psiC0 = DCRTPoly(paramsQlP, Format::EVALUATION, true);
+    auto cMult     = c0.TimesNoCheck(cryptoParams.GetPModq());
+    for (uint32_t i = 0; i < sizeQl; i++) {
+        psiC0.SetElementAtIndex(i, std::move(cMult.GetElementAtIndex(i)));
+    }
+    return psiC0;
+}
+
+}  // namespace
+
 /////////////////////////////////////////
 // SHE ADDITION CONSTANT
 /////////////////////////////////////////
@@ -567,16 +584,8 @@ Ciphertext<DCRTPoly> LeveledSHECKKSRNS::EvalFastRotationExt(
 
     std::shared_ptr<std::vector<DCRTPoly>> cTilda = algo->EvalFastKeySwitchCoreExt(digits, evalKey, paramsQl);
 
-    if (addFirst) {
-        const auto paramsQlP = (*cTilda)[0].GetParams();
-        size_t sizeQl        = paramsQl->GetParams().size();
-        DCRTPoly psiC0       = DCRTPoly(paramsQlP, Format::EVALUATION, true);
-        auto cMult           = ciphertext->GetElements()[0].TimesNoCheck(cryptoParams->GetPModq());
-        for (uint32_t i = 0; i < sizeQl; i++) {
-            psiC0.SetElementAtIndex(i, std::move(cMult.GetElementAtIndex(i)));
-        }
-        (*cTilda)[0] += psiC0;
-    }
+    if (addFirst)
+        (*cTilda)[0] += PModqFirstElement(ciphertext, *cryptoParams, (*cTilda)[0].GetParams());
 
     std::vector<uint32_t> vec(N);
     PrecomputeAutoMap(N, autoIndex, &vec);
@@ -589,6 +598,58 @@ Ciphertext<DCRTPoly> LeveledSHECKKSRNS::EvalFastRotationExt(
     return result;
 }
 
+std::vector<Ciphertext<DCRTPoly>> LeveledSHECKKSRNS::EvalFastRotationExtBatch(
+    ConstCiphertext<DCRTPoly>& ciphertext, const std::vector<int32_t>& indices,
+    const std::shared_ptr<std::vector<DCRTPoly>> digits, bool addFirst,
+    const std::map<uint32_t, EvalKey<DCRTPoly>>& evalKeys) const {
+    const auto cc           = ciphertext->GetCryptoContext();
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(ciphertext->GetCryptoParameters());
+    uint32_t M              = cryptoParams->GetElementParams()->GetCyclotomicOrder();
+    auto algo               = cc->GetScheme();
+
+    // every nonzero index goes to the accelerator in one batch
+    std::vector<size_t> batched;
+    std::vector<uint32_t> autoIndices;
+    std::vector<EvalKey<DCRTPoly>> keys;
+    for (size_t r = 0; r < indices.size(); r++) {
+        if (indices[r] == 0)
+            continue;
+        uint32_t autoIndex   = FindAutomorphismIndex2nComplex(indices[r], M);
+        auto evalKeyIterator = evalKeys.find(autoIndex);
+        if (evalKeyIterator == evalKeys.end()) {
+            OPENFHE_THROW("EvalKey for index [" + std::to_string(autoIndex) + "] is not found.");
+        }
+        batched.push_back(r);
+        autoIndices.push_back(autoIndex);
+        keys.push_back(evalKeyIterator->second);
+    }
+
+    std::vector<std::shared_ptr<std::vector<DCRTPoly>>> rotated;
+    if (!keys.empty()) {
+        DCRTPoly psiC0;
+        if (addFirst)
+            psiC0 = PModqFirstElement(ciphertext, *cryptoParams, (*digits)[0].GetParams());
+        rotated = algo->EvalFastKeySwitchRotateBatchExt(digits, keys, autoIndices, addFirst ? &psiC0 : nullptr,
+                                                        ciphertext->GetElements()[0].GetParams());
+    }
+
+    std::vector<Ciphertext<DCRTPoly>> result(indices.size());
+    for (size_t i = 0; i < rotated.size(); i++) {
+        result[batched[i]] = ciphertext->CloneEmpty();
+        result[batched[i]]->SetElements({std::move((*rotated[i])[0]), std::move((*rotated[i])[1])});
+    }
+
+    // index 0 and, without an accelerator, every rotation
+#pragma omp parallel for
+    for (size_t r = 0; r < indices.size(); r++) {
+        if (indices[r] == 0)
+            result[r] = algo->KeySwitchExt(ciphertext, addFirst);
+        else if (rotated.empty())
+            result[r] = EvalFastRotationExt(ciphertext, indices[r], digits, addFirst, evalKeys);
+    }
+    return result;
+}
+
 Ciphertext<DCRTPoly> LeveledSHECKKSRNS::MultByInteger(ConstCiphertext<DCRTPoly>& ciphertext, uint64_t integer) const {
     const std::vector<DCRTPoly>& cv = ciphertext->GetElements();
 
@@ -39,14 +39,19 @@ namespace lbcrypto {
 Ciphertext<DCRTPoly> PKERNS::Encrypt(DCRTPoly plaintext, const PrivateKey<DCRTPoly> privateKey) const {
     Ciphertext<DCRTPoly> ciphertext(std::make_shared<CiphertextImpl<DCRTPoly>>(privateKey));
 
+    std::shared_ptr<const PRNGSeed> c1Seed;
+    if (GetCiphertextFormat() == CiphertextFormat::SEEDED)
+        c1Seed = std::make_shared<const PRNGSeed>(SeedUniformGenerator::GenerateSeed());
+
     const std::shared_ptr<ParmType> ptxtParams = plaintext.GetParams();
-    std::shared_ptr<std::vector<DCRTPoly>> ba  = EncryptZeroCore(privateKey, ptxtParams);
+    std::shared_ptr<std::vector<DCRTPoly>> ba  = EncryptZeroCore(privateKey, ptxtParams, c1Seed.get());
 
     plaintext.SetFormat(EVALUATION);
 
     (*ba)[0] += plaintext;
 
     ciphertext->SetElements({std::move((*ba)[0]), std::move((*ba)[1])});
+    ciphertext->SetC1Seed(std::move(c1Seed));
     ciphertext->SetNoiseScaleDeg(1);
 
     return ciphertext;
@@ -109,6 +114,12 @@ DecryptResult PKERNS::Decrypt(ConstCiphertext<DCRTPoly> ciphertext, const Privat
 
 std::shared_ptr<std::vector<DCRTPoly>> PKERNS::EncryptZeroCore(const PrivateKey<DCRTPoly> privateKey,
                                                                const std::shared_ptr<ParmType> params) const {
+    return EncryptZeroCore(privateKey, params, nullptr);
+}
+
+std::shared_ptr<std::vector<DCRTPoly>> PKERNS::EncryptZeroCore(const PrivateKey<DCRTPoly> privateKey,
+                                                               const std::shared_ptr<ParmType> params,
+                                                               const PRNGSeed* c1Seed) const {
     const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersRNS>(privateKey->GetCryptoParameters());
 
     const DCRTPoly& s  = privateKey->GetPrivateElement();
@@ -118,7 +129,9 @@ std::shared_ptr<std::vector<DCRTPoly>> PKERNS::EncryptZeroCore(const PrivateKey<
 
     const std::shared_ptr<ParmType> elementParams = (params == nullptr) ? cryptoParams->GetElementParams() : params;
 
-    DCRTPoly a(dug, elementParams, Format::EVALUATION);
+    // c1 = -a, so a seeded c1 is the seed's expansion itself
+    DCRTPoly a = (c1Seed == nullptr) ? DCRTPoly(dug, elementParams, Format::EVALUATION) :
+                                       -DCRTPoly::FromSeed(elementParams, *c1Seed, 0);
     DCRTPoly e(dgg, elementParams, Format::EVALUATION);
 
     uint32_t sizeQ  = s.GetParams()->GetParams().size();
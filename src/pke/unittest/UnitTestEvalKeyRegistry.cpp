@@ -0,0 +1,182 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  Unit tests for the thread-safe eval-key registry: evaluation while other threads add and remove keys
+ */
+
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "gen-cryptocontext.h"
+#include "key/evalkey-registry.h"
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lbcrypto;
+
+class UTEvalKeyRegistry : public ::testing::Test {
+protected:
+    void TearDown() override {
+        CryptoContextImpl<DCRTPoly>::ClearEvalMultKeys();
+        CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys();
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+};
+
+TEST_F(UTEvalKeyRegistry, references_stay_valid_across_updates) {
+    EvalKeyRegistry<std::map<uint32_t, int>> registry;
+    using KeyMap = std::map<uint32_t, int>;
+
+    EXPECT_TRUE(registry.InsertIfAbsent("a", std::make_shared<KeyMap>(KeyMap{{1, 10}})));
+    EXPECT_FALSE(registry.InsertIfAbsent("a", std::make_shared<KeyMap>(KeyMap{{1, 11}})));
+    auto held            = registry.Find("a");
+    const KeyMap& pinned = *registry.Pin("a");
+
+    registry.Update("a", [](const std::shared_ptr<const KeyMap>& current) {
+        auto next = std::make_shared<KeyMap>(*current);
+        next->emplace(2, 20);
+        return next;
+    });
+    // the value held or pinned before the update is still the old one
+    EXPECT_EQ(held->size(), 1U);
+    EXPECT_EQ(pinned.size(), 1U);
+    EXPECT_EQ(pinned.at(1), 10);
+    EXPECT_EQ(registry.Find("a")->size(), 2U);
+
+    // the replaced value is freed once its readers let go, including the pin
+    std::weak_ptr<KeyMap> replaced = held;
+    held.reset();
+    EXPECT_FALSE(replaced.expired());
+    EXPECT_EQ(registry.Pin("a")->size(), 2U);
+    EXPECT_TRUE(replaced.expired());
+
+    // update returning nullptr leaves the value as is
+    registry.Update("a", [](const std::shared_ptr<const KeyMap>&) { return std::shared_ptr<KeyMap>(); });
+    EXPECT_EQ(registry.Find("a")->size(), 2U);
+
+    EXPECT_TRUE(registry.InsertIfAbsent("b", std::make_shared<KeyMap>()));
+    EXPECT_EQ(registry.Size(), 2U);
+    EXPECT_EQ(registry.EraseIf([](const std::string&, const KeyMap& m) { return m.empty(); }), 1U);
+    EXPECT_FALSE(registry.Contains("b"));
+    EXPECT_TRUE(registry.Erase("a"));
+    EXPECT_FALSE(registry.Erase("a"));
+    EXPECT_EQ(registry.Snapshot().size(), 0U);
+}
+
+TEST_F(UTEvalKeyRegistry, evaluate_while_inserting_keys) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetScalingModSize(50);
+    parameters.SetBatchSize(8);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetSecurityLevel(HEStd_NotSet);
+
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    cc->EvalMultKeyGen(keys.secretKey);
+    cc->EvalRotateKeyGen(keys.secretKey, {1});
+    const auto tag = keys.secretKey->GetKeyTag();
+
+    std::vector<KeyPair<DCRTPoly>> others;
+    for (int i = 0; i < 3; ++i)
+        others.push_back(cc->KeyGen());
+
+    const std::vector<double> x{1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+    const auto ct          = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(x));
+    const auto expectedMul = cc->EvalMult(ct, ct);
+    const auto expectedRot = cc->EvalRotate(ct, 1);
+
+    // readers evaluate with the keys of tag while the writers add indices to tag and
+    // generate and clear the keys of other tags
+    constexpr int READERS    = 2;
+    constexpr int ITERATIONS = 20;
+    std::atomic<int> mismatches{0};
+    std::atomic<bool> writing{true};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < READERS; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < ITERATIONS || writing; ++i) {
+                if (!(*cc->EvalMult(ct, ct) == *expectedMul))
+                    ++mismatches;
+                if (!(*cc->EvalRotate(ct, 1) == *expectedRot))
+                    ++mismatches;
+            }
+        });
+    }
+
+    std::thread sameTag([&] {
+        for (int32_t r : {2, 3, -1, -2})
+            cc->EvalRotateKeyGen(keys.secretKey, {1, r});
+    });
+    std::thread otherTags([&] {
+        for (const auto& other : others) {
+            const auto otherTag = other.secretKey->GetKeyTag();
+            cc->EvalMultKeyGen(other.secretKey);
+            cc->EvalRotateKeyGen(other.secretKey, {1, 2});
+            EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetEvalMultKeyVector(otherTag).size(), 1U);
+            CryptoContextImpl<DCRTPoly>::ClearEvalMultKeys(otherTag);
+            CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys(otherTag);
+        }
+    });
+    sameTag.join();
+    otherTags.join();
+    writing = false;
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(mismatches, 0);
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetAllEvalMultKeys().size(), 1U);
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetAllEvalAutomorphismKeys().size(), 1U);
+    // every rotation added by the writer is there, and the key of index 1 was kept
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).size(), 5U);
+    EXPECT_TRUE(*cc->EvalRotate(ct, 1) == *expectedRot);
+    for (int32_t r : {2, 3, -1, -2}) {
+        const auto rotated = cc->EvalRotate(ct, r);
+        Plaintext result;
+        cc->Decrypt(keys.secretKey, rotated, &result);
+        result->SetLength(x.size());
+        const auto values = result->GetRealPackedValue();
+        for (size_t i = 0; i < x.size(); ++i)
+            EXPECT_NEAR(values[i], x[(i + x.size() + r) % x.size()], 1e-3) << "rotation " << r;
+    }
+}
@@ -0,0 +1,377 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Unit tests for the memory-mapped eval-key store (EvalKeyStore) and the keys loaded from it on first use (LazyEvalKeyMap)
+ */
+
+#include "scheme/bgvrns/gen-cryptocontext-bgvrns.h"
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "gen-cryptocontext.h"
+#include "key/evalkey-lazy.h"
+#include "key/evalkey-store.h"
+#include "key/evalkeyrelin.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace lbcrypto;
+
+namespace {
+
+// Keeps the a/b vectors a key writes and hands them back on load; the other
+// fields (context, tag) are skipped
+class KeyVectorArchive {
+public:
+    explicit KeyVectorArchive(bool loading) : m_loading{loading} {}
+
+    template <class... T>
+    KeyVectorArchive& operator()(T&&... items) {
+        (Item(items), ...);
+        return *this;
+    }
+
+    std::map<std::string, std::vector<DCRTPoly>> vectors;
+
+private:
+    template <class T>
+    void Item(const cereal::NameValuePair<T>& nvp) {
+        if constexpr (std::is_same_v<std::decay_t<T>, std::vector<DCRTPoly>>) {
+            if constexpr (!std::is_const_v<std::remove_reference_t<T>>) {
+                if (m_loading)
+                    nvp.value = vectors.at(nvp.name);
+            }
+            if (!m_loading)
+                vectors[nvp.name] = nvp.value;
+        }
+    }
+    template <class T>
+    void Item(const T&) {}
+
+    bool m_loading;
+};
+
+}  // namespace
+
+class UTEvalKeyStore : public ::testing::Test {
+protected:
+    void TearDown() override {
+        std::remove(m_path.c_str());
+        CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys();
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+
+    // Writes the rotation keys of cc, reloads them from the store and checks that the
+    // loaded keys are mapped views equal to the originals and rotate identically
+    void RoundTrip(const CryptoContext<DCRTPoly>& cc, const KeyPair<DCRTPoly>& keys, const Ciphertext<DCRTPoly>& ct) {
+        const std::vector<int32_t> rotations{1, 2, -3};
+        cc->EvalRotateKeyGen(keys.secretKey, rotations);
+        const auto tag      = keys.secretKey->GetKeyTag();
+        const auto original = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMapPtr(tag);
+        std::vector<Ciphertext<DCRTPoly>> expected;
+        for (int32_t r : rotations)
+            expected.push_back(cc->EvalRotate(ct, r));
+
+        ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(m_path, tag));
+        cc->ClearEvalAutomorphismKeys();
+        ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::DeserializeEvalAutomorphismKeyStore(m_path, cc));
+
+        const auto& loaded = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag);
+        ASSERT_EQ(loaded.size(), original->size());
+        for (const auto& [index, key] : *original) {
+            const auto it = loaded.find(index);
+            ASSERT_TRUE(it != loaded.end()) << "index " << index;
+            EXPECT_TRUE(*it->second == *key) << "index " << index;
+            EXPECT_NE(it->second->GetBVector()[0].GetTowerSlab(), nullptr);
+            EXPECT_NE(it->second->GetAVector()[0].GetTowerSlab(), nullptr);
+        }
+        for (size_t i = 0; i < rotations.size(); ++i)
+            EXPECT_EQ(*cc->EvalRotate(ct, rotations[i]), *expected[i]) << "rotation " << rotations[i];
+    }
+
+    const std::string m_path = ::testing::TempDir() + "evalkey_store_test.bin";
+};
+
+TEST_F(UTEvalKeyStore, ckks_hybrid_round_trip) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(3);
+    parameters.SetScalingModSize(40);
+    parameters.SetNumLargeDigits(2);
+    parameters.SetKeySwitchTechnique(HYBRID);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    auto ct   = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(std::vector<double>{1.0, 2.0, 3.0, 4.0}));
+    RoundTrip(cc, keys, ct);
+}
+
+TEST_F(UTEvalKeyStore, bgv_bv_round_trip) {
+    CCParams<CryptoContextBGVRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetPlaintextModulus(65537);
+    parameters.SetKeySwitchTechnique(BV);
+    parameters.SetDigitSize(20);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    auto ct   = cc->Encrypt(keys.publicKey, cc->MakePackedPlaintext(std::vector<int64_t>{1, 2, 3, 4, 5}));
+    RoundTrip(cc, keys, ct);
+}
+
+TEST_F(UTEvalKeyStore, directory_and_bad_files) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetScalingModSize(40);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+    auto keys = cc->KeyGen();
+    cc->EvalRotateKeyGen(keys.secretKey, {1, 4});
+    const auto tag = keys.secretKey->GetKeyTag();
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(m_path, tag));
+
+    const auto store = EvalKeyStore::Open(m_path);
+    EXPECT_EQ(store->GetKeyTag(), tag);
+    EXPECT_EQ(store->GetRingDimension(), cc->GetRingDimension());
+    const auto indices = store->GetIndices();
+    ASSERT_EQ(indices.size(), 2u);
+    EXPECT_TRUE(store->Contains(indices[0]));
+    EXPECT_FALSE(store->Contains(0));
+    EXPECT_EQ(store->GetKeyBytes(0), 0u);
+    EXPECT_GT(store->GetKeyBytes(indices[1]), 0u);
+    EXPECT_TRUE(*store->GetKey(indices[1], cc) ==
+                *CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).at(indices[1]));
+    EXPECT_THROW(store->GetKey(0, cc), OpenFHEException);
+
+    // a context with other moduli cannot use the keys
+    parameters.SetScalingModSize(45);
+    auto other = GenCryptoContext(parameters);
+    EXPECT_THROW(store->GetKey(indices[0], other), OpenFHEException);
+
+    std::string bytes;
+    {
+        std::ifstream in(m_path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    // writes bytes with one header or directory field changed
+    const auto writeWith = [&](auto edit) {
+        std::string copy = bytes;
+        auto& h          = *reinterpret_cast<EvalKeyStoreHeader*>(&copy[0]);
+        edit(h, *reinterpret_cast<EvalKeyStoreEntry*>(&copy[h.directoryOffset]),
+             reinterpret_cast<uint64_t*>(&copy[h.towersOffset]));
+        std::ofstream out(m_path, std::ios::binary | std::ios::trunc);
+        out.write(copy.data(), static_cast<std::streamsize>(copy.size()));
+    };
+
+    // a root of unity other than the context's
+    writeWith([](EvalKeyStoreHeader&, EvalKeyStoreEntry&, uint64_t* towers) { towers[1] += 1; });
+    EXPECT_THROW(EvalKeyStore::Open(m_path)->GetKey(indices[0], cc), OpenFHEException);
+    // the other byte order
+    writeWith([](EvalKeyStoreHeader& h, EvalKeyStoreEntry&, uint64_t*) { h.version = 0x01000000; });
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+    // counts and offsets whose products or sums would overflow
+    writeWith([](EvalKeyStoreHeader& h, EvalKeyStoreEntry&, uint64_t*) { h.numTowers = 0xffffffff; });
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+    writeWith([](EvalKeyStoreHeader& h, EvalKeyStoreEntry&, uint64_t*) { h.keyTagOffset = ~uint64_t(0); });
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+    writeWith([](EvalKeyStoreHeader&, EvalKeyStoreEntry& e, uint64_t*) { e.offset = ~uint64_t(0) & ~uint64_t(4095); });
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+    writeWith([](EvalKeyStoreHeader&, EvalKeyStoreEntry& e, uint64_t*) { e.numDigits = 0xffffffff; });
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+
+    // truncated file and bad magic
+    {
+        std::ofstream out(m_path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+    bytes[0] = 'X';
+    {
+        std::ofstream out(m_path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+    EXPECT_THROW(EvalKeyStore::Open(m_path), OpenFHEException);
+}
+
+TEST_F(UTEvalKeyStore, lazy_keys_load_on_first_use_within_budget) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetScalingModSize(40);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    auto ct   = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(std::vector<double>{1.0, 2.0, 3.0, 4.0}));
+    const std::vector<int32_t> rotations{1, 2, 3, -1};
+    cc->EvalRotateKeyGen(keys.secretKey, rotations);
+    const auto tag = keys.secretKey->GetKeyTag();
+    std::vector<Ciphertext<DCRTPoly>> expected;
+    for (int32_t r : rotations)
+        expected.push_back(cc->EvalRotate(ct, r));
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(m_path, tag));
+    cc->ClearEvalAutomorphismKeys();
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetLazyEvalAutomorphismKeyMap(tag), nullptr);
+
+    const auto lazy = CryptoContextImpl<DCRTPoly>::DeserializeEvalAutomorphismKeyStoreLazy(m_path, cc);
+    ASSERT_NE(lazy, nullptr);
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetLazyEvalAutomorphismKeyMap(tag), lazy);
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).size(), rotations.size());
+    EXPECT_TRUE(lazy->GetResidentIndices().empty());
+    EXPECT_EQ(lazy->GetStats().loads, 0u);
+
+    // only the key of the rotation used is loaded
+    EXPECT_EQ(*cc->EvalRotate(ct, 2), *expected[1]);
+    const uint32_t auto2 = cc->FindAutomorphismIndex(2);
+    EXPECT_EQ(lazy->GetResidentIndices(), std::vector<uint32_t>{auto2});
+    EXPECT_EQ(lazy->GetStats().loads, 1u);
+    const size_t keyBytes = lazy->GetStore()->GetKeyBytes(auto2);
+    EXPECT_EQ(lazy->GetResidentBytes(), keyBytes);
+
+    // a budget of two keys keeps the two most recently used
+    lazy->SetBudget(2 * keyBytes);
+    for (size_t i = 0; i < rotations.size(); ++i)
+        EXPECT_EQ(*cc->EvalRotate(ct, rotations[i]), *expected[i]) << "rotation " << rotations[i];
+    EXPECT_EQ(lazy->GetResidentIndices(),
+              (std::vector<uint32_t>{cc->FindAutomorphismIndex(-1), cc->FindAutomorphismIndex(3)}));
+    EXPECT_EQ(lazy->GetResidentBytes(), 2 * keyBytes);
+    EXPECT_EQ(lazy->GetStats().loads, rotations.size());
+    EXPECT_EQ(lazy->GetStats().evictions, 2u);
+
+    // evicted keys are read back from the file
+    lazy->Prefetch({auto2, 12345});
+    EXPECT_EQ(*cc->EvalRotate(ct, 2), *expected[1]);
+    EXPECT_EQ(lazy->GetResidentIndices().front(), auto2);
+    EXPECT_EQ(lazy->GetStats().loads, rotations.size());
+
+    // the lazy keys can be written back to a store
+    const std::string copy = m_path + ".copy";
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(copy, tag));
+    const auto store = EvalKeyStore::Open(copy);
+    for (int32_t r : rotations) {
+        const uint32_t index = cc->FindAutomorphismIndex(r);
+        EXPECT_TRUE(*store->GetKey(index, cc) == *CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).at(index));
+    }
+    std::remove(copy.c_str());
+}
+
+TEST_F(UTEvalKeyStore, lazy_keys_do_not_replace_existing_ones) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetScalingModSize(40);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    cc->EvalRotateKeyGen(keys.secretKey, {1, 2});
+    const auto tag = keys.secretKey->GetKeyTag();
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(m_path, tag));
+    const auto eager = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).at(cc->FindAutomorphismIndex(1));
+    CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys();
+    CryptoContextImpl<DCRTPoly>::InsertEvalAutomorphismKey(
+        std::make_shared<std::map<uint32_t, EvalKey<DCRTPoly>>>(
+            std::map<uint32_t, EvalKey<DCRTPoly>>{{cc->FindAutomorphismIndex(1), eager}}),
+        tag);
+
+    const auto lazy = CryptoContextImpl<DCRTPoly>::DeserializeEvalAutomorphismKeyStoreLazy(m_path, cc);
+    const auto& map = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag);
+    EXPECT_TRUE(map.at(cc->FindAutomorphismIndex(1)) == eager);
+    EXPECT_TRUE(std::dynamic_pointer_cast<LazyEvalKeyRelin>(map.at(cc->FindAutomorphismIndex(2))) != nullptr);
+    EXPECT_EQ(CryptoContextImpl<DCRTPoly>::GetLazyEvalAutomorphismKeyMap(tag), lazy);
+}
+
+TEST_F(UTEvalKeyStore, lazy_key_serializes_its_vectors) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetScalingModSize(40);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    cc->EvalRotateKeyGen(keys.secretKey, {1});
+    const auto tag       = keys.secretKey->GetKeyTag();
+    const uint32_t auto1 = cc->FindAutomorphismIndex(1);
+    const auto eager     = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).at(auto1);
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(m_path, tag));
+    cc->ClearEvalAutomorphismKeys();
+
+    CryptoContextImpl<DCRTPoly>::DeserializeEvalAutomorphismKeyStoreLazy(m_path, cc);
+    const auto lazy = std::dynamic_pointer_cast<LazyEvalKeyRelin>(
+        CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag).at(auto1));
+    ASSERT_NE(lazy, nullptr);
+    EXPECT_FALSE(lazy->IsLoaded());
+
+    // saving loads the key and writes the vectors, not the empty members of the base
+    KeyVectorArchive out(false);
+    lazy->save(out, LazyEvalKeyRelin::SerializedVersion());
+    EXPECT_TRUE(lazy->IsLoaded());
+    EXPECT_EQ(out.vectors.at("ak"), eager->GetAVector());
+    EXPECT_EQ(out.vectors.at("bk"), eager->GetBVector());
+
+    // the loaded key owns its vectors
+    KeyVectorArchive in(true);
+    in.vectors = out.vectors;
+    LazyEvalKeyRelin loaded;
+    loaded.load(in, LazyEvalKeyRelin::SerializedVersion());
+    EXPECT_EQ(loaded.GetOwner(), nullptr);
+    EXPECT_EQ(loaded.GetAVector(), eager->GetAVector());
+    EXPECT_EQ(loaded.GetBVector(), eager->GetBVector());
+}
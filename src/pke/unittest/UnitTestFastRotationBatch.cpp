@@ -0,0 +1,163 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  Unit tests for batched hoisted rotations (EvalFastRotationExtBatch), on the CPU
+  and, with the in-process simulator, through the OP_HKS_ROTATE kernel
+ */
+
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "scheme/ckksrns/ckksrns-cryptoparameters.h"
+#include "gen-cryptocontext.h"
+#include "keyswitch/hks_stats.h"
+
+#include "PolyAccelerator.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <vector>
+
+using namespace lbcrypto;
+
+namespace {
+
+const std::vector<int32_t> kIndices = {1, 2, 0, 3, -1};
+
+}  // namespace
+
+class UTFastRotationBatch : public ::testing::Test {
+protected:
+    void SetUp() override {
+        // the simulator's shape: N = FPGA_RING_DIM, at most 3 Q and 2 P towers
+        CCParams<CryptoContextCKKSRNS> parameters;
+        parameters.SetSecurityLevel(HEStd_NotSet);
+        parameters.SetRingDim(FPGA_RING_DIM);
+        parameters.SetMultiplicativeDepth(1);
+        parameters.SetScalingModSize(50);
+        parameters.SetBatchSize(8);
+        parameters.SetKeySwitchTechnique(HYBRID);
+
+        cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(KEYSWITCH);
+        cc->Enable(LEVELEDSHE);
+
+        keys = cc->KeyGen();
+        cc->EvalRotateKeyGen(keys.secretKey, {1, 2, 3, -1});
+
+        ctxt = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(x));
+    }
+
+    void TearDown() override {
+        PolyAccelerator::Set(nullptr);
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+
+    // one EvalFastRotationExt (or KeySwitchExt for index 0) per index
+    std::vector<Ciphertext<DCRTPoly>> SingleRotations(const std::shared_ptr<std::vector<DCRTPoly>>& digits) {
+        std::vector<Ciphertext<DCRTPoly>> result;
+        for (int32_t index : kIndices)
+            result.push_back(index == 0 ? cc->KeySwitchExt(ctxt, true) :
+                                          cc->EvalFastRotationExt(ctxt, index, digits, true));
+        return result;
+    }
+
+    void ExpectEqual(const std::vector<Ciphertext<DCRTPoly>>& expected,
+                     const std::vector<Ciphertext<DCRTPoly>>& actual) {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t r = 0; r < expected.size(); ++r) {
+            for (size_t i = 0; i < 2; ++i)
+                EXPECT_EQ(expected[r]->GetElements()[i], actual[r]->GetElements()[i])
+                    << "index " << kIndices[r] << " element " << i;
+        }
+    }
+
+    std::vector<double> x = {0.25, 0.5, 0.75, 1.0, 2.0, 3.0, 4.0, 5.0};
+    CryptoContext<DCRTPoly> cc;
+    KeyPair<DCRTPoly> keys;
+    Ciphertext<DCRTPoly> ctxt;
+};
+
+TEST_F(UTFastRotationBatch, matches_single_rotations) {
+    PolyAccelerator::Set(nullptr);
+    auto digits   = cc->EvalFastRotationPrecompute(ctxt);
+    auto expected = SingleRotations(digits);
+    auto actual   = cc->EvalFastRotationExtBatch(ctxt, kIndices, digits, true);
+    ExpectEqual(expected, actual);
+
+    for (size_t r = 0; r < kIndices.size(); ++r) {
+        Plaintext result;
+        cc->Decrypt(keys.secretKey, cc->KeySwitchDown(actual[r]), &result);
+        result->SetLength(x.size());
+        const auto values = result->GetRealPackedValue();
+        for (size_t i = 0; i < x.size(); ++i) {
+            size_t src = (i + x.size() + kIndices[r]) % x.size();
+            EXPECT_NEAR(values[i], x[src], 1e-4) << "index " << kIndices[r] << " slot " << i;
+        }
+    }
+}
+
+#ifdef OPENFHE_FPGA_SIM
+TEST_F(UTFastRotationBatch, device_batch_uploads_digits_once) {
+    PolyAccelerator::Set(nullptr);
+    auto digits   = cc->EvalFastRotationPrecompute(ctxt);
+    auto expected = SingleRotations(digits);
+
+    std::vector<uint64_t> q, p, qr, pr;
+    for (const auto& t : cc->GetElementParams()->GetParams()) {
+        q.push_back(t->GetModulus().ConvertToInt());
+        qr.push_back(t->GetRootOfUnity().ConvertToInt());
+    }
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(cc->GetCryptoParameters());
+    for (const auto& t : cryptoParams->GetParamsP()->GetParams()) {
+        p.push_back(t->GetModulus().ConvertToInt());
+        pr.push_back(t->GetRootOfUnity().ConvertToInt());
+    }
+    PolyAccelerator::Set(PolyAccelerator::Create("sim"));
+    PolyAccelerator::Get()->InitModuli(q, p, qr, pr, FPGA_RING_DIM);
+
+    ResetHKSStats();
+    auto actual = cc->EvalFastRotationExtBatch(ctxt, kIndices, digits, true);
+    ExpectEqual(expected, actual);
+
+    // digits and P*c0 go up once; each rotation adds only its header and key
+    const uint64_t limb      = FPGA_RING_DIM * sizeof(uint64_t);
+    const uint64_t sizeQlP   = (*digits)[0].GetNumOfElements();
+    const uint64_t numDigits = digits->size();
+    const uint64_t numRot    = kIndices.size() - 1;
+    const HKSStats& s        = GetHKSStats();
+    EXPECT_EQ(s.bytes_h2d, (numDigits + 1) * sizeQlP * limb +
+                               numRot * (16 * sizeof(uint64_t) + 2 * numDigits * sizeQlP * limb));
+    EXPECT_EQ(s.bytes_d2h, numRot * 2 * sizeQlP * limb);
+}
+#endif
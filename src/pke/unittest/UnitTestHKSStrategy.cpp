@@ -0,0 +1,387 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+/*
+  Unit tests for the hybrid key-switching strategies (DC / MP / OC / AUTO) and their statistics
+ */
+
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "scheme/ckksrns/ckksrns-cryptoparameters.h"
+#include "gen-cryptocontext.h"
+#include "keyswitch/hks_strategy.h"
+#include "keyswitch/hks_autotuner.h"
+#include "keyswitch/hks_stats.h"
+
+#include "OffloadDispatcher.h"
+#include "PolyAccelerator.h"
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lbcrypto;
+
+class UTHKSStrategy : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CCParams<CryptoContextCKKSRNS> parameters;
+        parameters.SetSecurityLevel(HEStd_NotSet);
+        parameters.SetRingDim(1 << 10);
+        parameters.SetMultiplicativeDepth(5);
+        parameters.SetScalingModSize(40);
+        parameters.SetNumLargeDigits(3);
+        parameters.SetKeySwitchTechnique(HYBRID);
+
+        cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(KEYSWITCH);
+        cc->Enable(LEVELEDSHE);
+
+        keys = cc->KeyGen();
+        cc->EvalRotateKeyGen(keys.secretKey, {1});
+
+        std::vector<double> x = {0.25, 0.5, 0.75, 1.0, 2.0, 3.0, 4.0, 5.0};
+        ctxt = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(x));
+    }
+
+    void TearDown() override {
+        PolyAccelerator::Set(nullptr);
+        SetHKSStrategy(HKSStrategy::DC);
+        HKSAutotuner::GetInstance().Clear();
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+
+    Ciphertext<DCRTPoly> Rotate(HKSStrategy strategy) {
+        SetHKSStrategy(strategy);
+        ResetHKSStats();
+        return cc->EvalRotate(ctxt, 1);
+    }
+
+    CryptoContext<DCRTPoly> cc;
+    KeyPair<DCRTPoly> keys;
+    Ciphertext<DCRTPoly> ctxt;
+};
+
+TEST_F(UTHKSStrategy, strategies_agree) {
+    auto expected = Rotate(HKSStrategy::DC);
+    for (auto strategy : {HKSStrategy::MP, HKSStrategy::OC}) {
+        auto actual = Rotate(strategy);
+        ASSERT_EQ(expected->GetElements().size(), actual->GetElements().size());
+        for (size_t i = 0; i < expected->GetElements().size(); ++i)
+            EXPECT_EQ(expected->GetElements()[i], actual->GetElements()[i])
+                << "strategy " << static_cast<int>(strategy) << " element " << i;
+    }
+}
+
+TEST_F(UTHKSStrategy, mp_parallel_matches_serial) {
+    OpenFHEParallelControls.Disable();
+    auto expected = Rotate(HKSStrategy::MP);
+    OpenFHEParallelControls.Enable();
+    auto actual = Rotate(HKSStrategy::MP);
+    for (size_t i = 0; i < expected->GetElements().size(); ++i)
+        EXPECT_EQ(expected->GetElements()[i], actual->GetElements()[i]) << "element " << i;
+}
+
+#ifdef OPENFHE_FPGA_SIM
+TEST_F(UTHKSStrategy, dc_pipeline_on_device_matches_cpu) {
+    auto expected = Rotate(HKSStrategy::DC);
+
+    // every Q and P tower is on the device: more than MAX_LIMBS, so the async
+    // NTTs of the pipeline can only run through the streaming kernel
+    std::vector<uint64_t> q, p, qr, pr;
+    for (const auto& t : cc->GetElementParams()->GetParams()) {
+        q.push_back(t->GetModulus().ConvertToInt());
+        qr.push_back(t->GetRootOfUnity().ConvertToInt());
+    }
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(cc->GetCryptoParameters());
+    for (const auto& t : cryptoParams->GetParamsP()->GetParams()) {
+        p.push_back(t->GetModulus().ConvertToInt());
+        pr.push_back(t->GetRootOfUnity().ConvertToInt());
+    }
+    ASSERT_GT(q.size() + p.size(), static_cast<size_t>(MAX_LIMBS));
+
+    PolyAccelerator::Set(PolyAccelerator::Create("sim"));
+    PolyAccelerator::Get()->InitModuli(q, p, qr, pr, cc->GetRingDimension());
+    OffloadDispatcher::Active()->SetPolicy(OffloadPolicy::ALWAYS);
+    PolyAccelerator::Get()->ResetTransferStats();
+
+    auto actual = Rotate(HKSStrategy::DC);
+    EXPECT_GT(PolyAccelerator::Get()->GetTransferStats().launches, 0u);
+    ASSERT_EQ(expected->GetElements().size(), actual->GetElements().size());
+    for (size_t i = 0; i < expected->GetElements().size(); ++i)
+        EXPECT_EQ(expected->GetElements()[i], actual->GetElements()[i]) << "element " << i;
+}
+#endif
+
+TEST_F(UTHKSStrategy, measured_peak_matches_claim) {
+    // the measured peak is the complement storage the tower allocator actually handed out
+    SetHKSPeakMeasurement(true);
+    for (auto strategy : {HKSStrategy::DC, HKSStrategy::MP, HKSStrategy::OC}) {
+        Rotate(strategy);
+        const HKSStats& s = GetHKSStats();
+        EXPECT_GT(s.num_digits, 1);
+        EXPECT_EQ(s.peak_p_towers, s.peak_p_towers_measured) << "strategy " << static_cast<int>(strategy);
+    }
+
+    Rotate(HKSStrategy::OC);
+    EXPECT_EQ(GetHKSStats().peak_p_towers_measured, 1);
+
+    SetHKSPeakMeasurement(false);
+    Rotate(HKSStrategy::MP);
+    EXPECT_EQ(GetHKSStats().peak_p_towers_measured, 0);
+}
+
+TEST_F(UTHKSStrategy, auto_tunes_once_per_shape) {
+    auto& tuner = HKSAutotuner::GetInstance();
+    tuner.Clear();
+    tuner.SetTrials(1);
+
+    auto expected = Rotate(HKSStrategy::DC);
+    auto actual   = Rotate(HKSStrategy::AUTO);
+    for (size_t i = 0; i < expected->GetElements().size(); ++i)
+        EXPECT_EQ(expected->GetElements()[i], actual->GetElements()[i]) << "element " << i;
+
+    const HKSStats& s = GetHKSStats();
+    HKSShape shape{(uint32_t)s.ring_dim, (uint32_t)s.size_ql, (uint32_t)s.size_p, (uint32_t)s.num_digits};
+    HKSStrategy winner;
+    ASSERT_TRUE(tuner.Lookup(shape, winner));
+    EXPECT_NE(winner, HKSStrategy::AUTO);
+
+    // the second call of the same shape is a cache hit
+    Rotate(HKSStrategy::AUTO);
+    EXPECT_EQ(tuner.GetProfile().size(), 1u);
+    tuner.SetTrials(3);
+}
+
+TEST_F(UTHKSStrategy, tuner_drops_candidates_that_differ_from_dc) {
+    auto& tuner = HKSAutotuner::GetInstance();
+    tuner.Clear();
+    tuner.SetTrials(1);
+
+    // candidates are read when Tune runs, so an accelerator installed later is seen
+    EXPECT_EQ(tuner.GetCandidates().size(), 3u);
+
+    // MP is the fastest here but returns a wrong result, so DC wins
+    HKSShape shape{1024, 6, 2, 3};
+    auto correct = std::make_shared<std::vector<DCRTPoly>>(ctxt->GetElements());
+    auto wrong   = std::make_shared<std::vector<DCRTPoly>>(ctxt->GetElements());
+    (*wrong)[0]  = (*wrong)[0] + (*wrong)[0];
+    tuner.SetCandidates({HKSStrategy::MP});
+    auto winner = tuner.Tune(shape, [&](HKSStrategy candidate) {
+        if (candidate != HKSStrategy::MP)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        return candidate == HKSStrategy::MP ? wrong : correct;
+    });
+    EXPECT_EQ(winner, HKSStrategy::DC);
+
+    tuner.SetTrials(3);
+}
+
+TEST_F(UTHKSStrategy, profile_round_trip) {
+    auto& tuner = HKSAutotuner::GetInstance();
+    tuner.Clear();
+    const std::string path = ::testing::TempDir() + "hks_profile_test.txt";
+    std::remove(path.c_str());
+
+    HKSShape shape{1024, 6, 2, 3};
+    tuner.Set(shape, HKSStrategy::OC);
+    ASSERT_TRUE(tuner.SaveProfile(path));
+
+    tuner.Clear();
+    HKSStrategy winner;
+    EXPECT_FALSE(tuner.Lookup(shape, winner));
+    ASSERT_TRUE(tuner.LoadProfile(path));
+    ASSERT_TRUE(tuner.Lookup(shape, winner));
+    EXPECT_EQ(winner, HKSStrategy::OC);
+
+    // new winners reach the loaded profile only when it is saved
+    tuner.Set({1024, 5, 2, 3}, HKSStrategy::MP);
+    tuner.Clear();
+    ASSERT_TRUE(tuner.LoadProfile(path));
+    EXPECT_EQ(tuner.GetProfile().size(), 1u);
+
+    tuner.Set({1024, 5, 2, 3}, HKSStrategy::MP);
+    ASSERT_TRUE(tuner.SaveProfile());
+    tuner.Clear();
+    ASSERT_TRUE(tuner.LoadProfile(path));
+    EXPECT_EQ(tuner.GetProfile().size(), 2u);
+
+    tuner.Clear();
+    std::remove(path.c_str());
+}
+
+TEST_F(UTHKSStrategy, stats_are_per_thread) {
+    ResetHKSStatsSnapshot();
+    Rotate(HKSStrategy::DC);
+    const HKSStats mine = GetHKSStats();
+
+    HKSStats theirs;
+    std::thread worker([&] {
+        ResetHKSStats();
+        cc->EvalRotate(ctxt, 1);
+        theirs = GetHKSStats();
+    });
+    worker.join();
+
+    // the worker did not touch this thread's counters
+    EXPECT_EQ(GetHKSStats().bconv, mine.bconv);
+    EXPECT_EQ(GetHKSStats().key_switches, mine.key_switches);
+    EXPECT_EQ(theirs.bconv, mine.bconv);
+
+    const HKSStats total = GetHKSStatsSnapshot();
+    EXPECT_EQ(total.key_switches, mine.key_switches + theirs.key_switches);
+    EXPECT_EQ(total.bconv, mine.bconv + theirs.bconv);
+    EXPECT_EQ(total.modmul_limb, mine.modmul_limb + theirs.modmul_limb);
+    EXPECT_EQ(total.peak_p_towers_measured, mine.peak_p_towers_measured);
+}
+
+TEST_F(UTHKSStrategy, phase_times_and_chrome_trace) {
+    auto& tracer = HKSTracer::GetInstance();
+    tracer.Clear();
+    tracer.Start();
+    Rotate(HKSStrategy::DC);
+    tracer.Stop();
+
+    const HKSStats& s = GetHKSStats();
+    for (auto phase : {HKSPhase::INTT, HKSPhase::BCONV, HKSPhase::NTT, HKSPhase::MAC, HKSPhase::MODDOWN})
+        EXPECT_GT(s.PhaseNs(phase), 0u) << HKSPhaseName(phase);
+
+    // one span per phase call plus the key switch itself
+    EXPECT_EQ(tracer.GetNumEvents(),
+              static_cast<size_t>(s.intt_poly + s.bconv + s.ntt_poly + 1 /* MAC */ + 1 /* ModDown */ + 1));
+
+    const std::string path = ::testing::TempDir() + "hks_trace_test.json";
+    ASSERT_TRUE(tracer.WriteChromeTrace(path));
+    std::ifstream in(path);
+    std::stringstream json;
+    json << in.rdbuf();
+    EXPECT_NE(json.str().find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.str().find("\"name\":\"KeySwitch\""), std::string::npos);
+    EXPECT_NE(json.str().find("\"name\":\"BConv\""), std::string::npos);
+
+    tracer.Clear();
+    std::remove(path.c_str());
+}
+
+#ifdef OPENFHE_FPGA_SIM
+// FUSED needs the simulator's shape: N = FPGA_RING_DIM, at most 3 Q and 2 P towers, and no complement
+// modulus narrower than its digit (see PolyAccelerator::BConvFits): one digit of 2 Q towers, 2 P towers
+class UTHKSFused : public ::testing::Test {
+protected:
+    void SetUp() override {
+        CCParams<CryptoContextCKKSRNS> parameters;
+        parameters.SetSecurityLevel(HEStd_NotSet);
+        parameters.SetRingDim(FPGA_RING_DIM);
+        parameters.SetMultiplicativeDepth(1);
+        parameters.SetScalingModSize(50);
+        parameters.SetScalingTechnique(FIXEDMANUAL);
+        parameters.SetNumLargeDigits(1);
+        parameters.SetBatchSize(8);
+        parameters.SetKeySwitchTechnique(HYBRID);
+
+        cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(KEYSWITCH);
+        cc->Enable(LEVELEDSHE);
+
+        keys = cc->KeyGen();
+        cc->EvalRotateKeyGen(keys.secretKey, {1});
+
+        std::vector<double> x = {0.25, 0.5, 0.75, 1.0, 2.0, 3.0, 4.0, 5.0};
+        ctxt = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(x));
+    }
+
+    void TearDown() override {
+        PolyAccelerator::Set(nullptr);
+        SetHKSStrategy(HKSStrategy::DC);
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+
+    // every Q and P tower of the context on the simulator
+    void InstallSimulator(std::vector<uint64_t>& q, std::vector<uint64_t>& p) {
+        std::vector<uint64_t> qr, pr;
+        for (const auto& t : cc->GetElementParams()->GetParams()) {
+            q.push_back(t->GetModulus().ConvertToInt());
+            qr.push_back(t->GetRootOfUnity().ConvertToInt());
+        }
+        const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(cc->GetCryptoParameters());
+        for (const auto& t : cryptoParams->GetParamsP()->GetParams()) {
+            p.push_back(t->GetModulus().ConvertToInt());
+            pr.push_back(t->GetRootOfUnity().ConvertToInt());
+        }
+        PolyAccelerator::Set(PolyAccelerator::Create("sim"));
+        PolyAccelerator::Get()->InitModuli(q, p, qr, pr, FPGA_RING_DIM);
+    }
+
+    CryptoContext<DCRTPoly> cc;
+    KeyPair<DCRTPoly> keys;
+    Ciphertext<DCRTPoly> ctxt;
+};
+
+TEST_F(UTHKSFused, fused_matches_dc) {
+    SetHKSStrategy(HKSStrategy::DC);
+    auto expected = cc->EvalRotate(ctxt, 1);
+
+    std::vector<uint64_t> q, p;
+    InstallSimulator(q, p);
+    SetHKSStrategy(HKSStrategy::FUSED);
+    ResetHKSStats();
+    auto actual = cc->EvalRotate(ctxt, 1);
+    // the digit loop ran on the device: only (c0', c1') came back from the key switch
+    const HKSStats& s = GetHKSStats();
+    EXPECT_GT(s.PhaseNs(HKSPhase::DEVICE), 0u);
+    EXPECT_EQ(s.bytes_d2h, 2 * (q.size() + p.size()) * FPGA_RING_DIM * sizeof(uint64_t));
+
+    ASSERT_EQ(expected->GetElements().size(), actual->GetElements().size());
+    for (size_t i = 0; i < expected->GetElements().size(); ++i)
+        EXPECT_EQ(expected->GetElements()[i], actual->GetElements()[i]) << "element " << i;
+}
+
+TEST_F(UTHKSFused, parallel_mp_on_device_matches_cpu) {
+    SetHKSStrategy(HKSStrategy::DC);
+    auto expected = cc->EvalRotate(ctxt, 1);
+
+    // the BConv towers of MP are converted on several threads at once, each through the device
+    std::vector<uint64_t> q, p;
+    InstallSimulator(q, p);
+    OpenFHEParallelControls.Enable();
+    SetHKSStrategy(HKSStrategy::MP);
+    auto actual = cc->EvalRotate(ctxt, 1);
+    for (size_t i = 0; i < expected->GetElements().size(); ++i)
+        EXPECT_EQ(expected->GetElements()[i], actual->GetElements()[i]) << "element " << i;
+}
+#endif
@@ -0,0 +1,213 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+
+/*
+  Unit tests for seeded ciphertexts (CiphertextFormat::SEEDED): c1 shipped as its seed
+ */
+
+#include "scheme/bfvrns/gen-cryptocontext-bfvrns.h"
+#include "scheme/bgvrns/gen-cryptocontext-bgvrns.h"
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "gen-cryptocontext.h"
+#include "ciphertext-ser.h"
+#include "cryptocontext-ser.h"
+#include "scheme/bfvrns/bfvrns-ser.h"
+#include "scheme/bgvrns/bgvrns-ser.h"
+#include "scheme/ckksrns/ckksrns-ser.h"
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <vector>
+
+using namespace lbcrypto;
+
+class UTSeededCiphertext : public ::testing::Test {
+protected:
+    void SetUp() override {
+        SetCiphertextFormat(CiphertextFormat::SEEDED);
+    }
+
+    void TearDown() override {
+        SetCiphertextFormat(CiphertextFormat::FULL);
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+
+    static CryptoContext<DCRTPoly> Ckks() {
+        CCParams<CryptoContextCKKSRNS> parameters;
+        parameters.SetSecurityLevel(HEStd_NotSet);
+        parameters.SetRingDim(1 << 10);
+        parameters.SetMultiplicativeDepth(3);
+        parameters.SetScalingModSize(40);
+        parameters.SetBatchSize(8);
+        auto cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(LEVELEDSHE);
+        return cc;
+    }
+
+    static CryptoContext<DCRTPoly> Bgv() {
+        CCParams<CryptoContextBGVRNS> parameters;
+        parameters.SetSecurityLevel(HEStd_NotSet);
+        parameters.SetRingDim(1 << 10);
+        parameters.SetMultiplicativeDepth(2);
+        parameters.SetPlaintextModulus(65537);
+        auto cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(LEVELEDSHE);
+        return cc;
+    }
+
+    static CryptoContext<DCRTPoly> Bfv(EncryptionTechnique technique) {
+        CCParams<CryptoContextBFVRNS> parameters;
+        parameters.SetSecurityLevel(HEStd_NotSet);
+        parameters.SetRingDim(1 << 10);
+        parameters.SetMultiplicativeDepth(2);
+        parameters.SetPlaintextModulus(65537);
+        parameters.SetEncryptionTechnique(technique);
+        auto cc = GenCryptoContext(parameters);
+        cc->Enable(PKE);
+        cc->Enable(LEVELEDSHE);
+        return cc;
+    }
+
+    // A private-key encryption is seeded, its c1 is the seed's expansion and it decrypts to the input
+    static void CheckSeeded(const CryptoContext<DCRTPoly>& cc, const PrivateKey<DCRTPoly>& sk, const Plaintext& ptxt,
+                            const std::function<void(const Plaintext&)>& check) {
+        // const: non-const access to the elements drops the seed
+        const ConstCiphertext<DCRTPoly> ct = cc->Encrypt(sk, ptxt);
+        ASSERT_TRUE(ct->IsSeeded());
+        const auto& cv = ct->GetElements();
+        EXPECT_TRUE(DCRTPoly::FromSeed(cv[0].GetParams(), *ct->GetC1Seed(), 0) == cv[1]);
+
+        Plaintext result;
+        cc->Decrypt(sk, ct, &result);
+        check(result);
+
+        EXPECT_FALSE(cc->Encrypt(sk, ptxt)->GetC1Seed() == ct->GetC1Seed());
+    }
+};
+
+TEST_F(UTSeededCiphertext, ckks_bgv_bfv) {
+    const std::vector<double> x{1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+    auto ckks     = Ckks();
+    auto ckksKeys = ckks->KeyGen();
+    auto checkCkks = [&](const Plaintext& result) {
+        result->SetLength(x.size());
+        const auto values = result->GetRealPackedValue();
+        for (size_t i = 0; i < x.size(); ++i)
+            EXPECT_NEAR(values[i], x[i], 1e-3) << "slot " << i;
+    };
+    CheckSeeded(ckks, ckksKeys.secretKey, ckks->MakeCKKSPackedPlaintext(x), checkCkks);
+    // fewer towers than the key
+    CheckSeeded(ckks, ckksKeys.secretKey, ckks->MakeCKKSPackedPlaintext(x, 1, 2), checkCkks);
+
+    const std::vector<int64_t> y{1, -2, 3, -4, 5, -6, 7, -8};
+    auto checkInt = [&](const Plaintext& result) {
+        result->SetLength(y.size());
+        EXPECT_EQ(result->GetPackedValue(), y);
+    };
+    auto bgv     = Bgv();
+    auto bgvKeys = bgv->KeyGen();
+    CheckSeeded(bgv, bgvKeys.secretKey, bgv->MakePackedPlaintext(y), checkInt);
+
+    auto bfv     = Bfv(STANDARD);
+    auto bfvKeys = bfv->KeyGen();
+    CheckSeeded(bfv, bfvKeys.secretKey, bfv->MakePackedPlaintext(y), checkInt);
+}
+
+TEST_F(UTSeededCiphertext, seed_dropped) {
+    auto cc   = Bgv();
+    auto keys = cc->KeyGen();
+    auto ptxt = cc->MakePackedPlaintext(std::vector<int64_t>{1, 2, 3});
+
+    // public-key encryption and FULL format: c1 is not seeded
+    EXPECT_FALSE(cc->Encrypt(keys.publicKey, ptxt)->IsSeeded());
+    SetCiphertextFormat(CiphertextFormat::FULL);
+    EXPECT_FALSE(cc->Encrypt(keys.secretKey, ptxt)->IsSeeded());
+    SetCiphertextFormat(CiphertextFormat::SEEDED);
+
+    // results and modified ciphertexts no longer match the seed
+    auto ct = cc->Encrypt(keys.secretKey, ptxt);
+    ASSERT_TRUE(ct->IsSeeded());
+    EXPECT_TRUE(ct->Clone()->IsSeeded());
+    EXPECT_FALSE(cc->EvalAdd(ct, ct)->IsSeeded());
+    cc->EvalAddInPlace(ct, ct);
+    EXPECT_FALSE(ct->IsSeeded());
+
+    // BFV EXTENDED encryption scales c1 after sampling it
+    auto bfv     = Bfv(EXTENDED);
+    auto bfvKeys = bfv->KeyGen();
+    EXPECT_FALSE(bfv->Encrypt(bfvKeys.secretKey, bfv->MakePackedPlaintext(std::vector<int64_t>{1}))->IsSeeded());
+}
+
+TEST_F(UTSeededCiphertext, serialize_roundtrip) {
+    const std::vector<int64_t> y{1, -2, 3, -4, 5, -6, 7, -8};
+    for (auto cc : {Bgv(), Bfv(STANDARD)}) {
+        auto keys = cc->KeyGen();
+        auto ptxt = cc->MakePackedPlaintext(y);
+
+        const auto seeded = cc->Encrypt(keys.secretKey, ptxt);
+        const auto full   = seeded->Clone();
+        full->SetC1Seed(nullptr);
+
+        std::stringstream sSeeded, sFull;
+        Serial::Serialize(seeded, sSeeded, SerType::BINARY);
+        Serial::Serialize(full, sFull, SerType::BINARY);
+        EXPECT_LT(sSeeded.str().size(), sFull.str().size() * 6 / 10);
+
+        Ciphertext<DCRTPoly> loaded;
+        Serial::Deserialize(loaded, sSeeded, SerType::BINARY);
+        ASSERT_TRUE(loaded != nullptr);
+        EXPECT_TRUE(loaded->IsSeeded());
+        EXPECT_TRUE(*loaded == *seeded);
+
+        Plaintext result;
+        cc->Decrypt(keys.secretKey, loaded, &result);
+        result->SetLength(y.size());
+        EXPECT_EQ(result->GetPackedValue(), y);
+    }
+
+    auto cc   = Ckks();
+    auto keys = cc->KeyGen();
+    const auto seeded = cc->Encrypt(keys.secretKey, cc->MakeCKKSPackedPlaintext(std::vector<double>{0.5, 0.25}));
+    std::stringstream s;
+    Serial::Serialize(seeded, s, SerType::JSON);
+    Ciphertext<DCRTPoly> loaded;
+    Serial::Deserialize(loaded, s, SerType::JSON);
+    ASSERT_TRUE(loaded != nullptr);
+    EXPECT_TRUE(*loaded == *seeded);
+}
@@ -0,0 +1,273 @@
+//==================================================================================
+// BSD 2-Clause License
+//
+// Copyright (c) 2014-2022, NJIT, Duality Technologies Inc. and other contributors
+//
+// All rights reserved.
+//
+// Author TPOC: contact@openfhe.org
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//==================================================================================
+
+
+/*
+  Unit tests for seeded eval keys (SeededEvalKeyRelin): a regenerated from a seed instead of stored
+ */
+
+#include "scheme/bfvrns/gen-cryptocontext-bfvrns.h"
+#include "scheme/bgvrns/gen-cryptocontext-bgvrns.h"
+#include "scheme/ckksrns/gen-cryptocontext-ckksrns.h"
+#include "scheme/ckksrns/ckksrns-cryptoparameters.h"
+#include "gen-cryptocontext.h"
+#include "key/evalkey-seeded.h"
+#include "key/evalkey-store.h"
+#include "keyswitch/hks_strategy.h"
+
+#include "PolyAccelerator.h"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace lbcrypto;
+
+class UTSeededEvalKey : public ::testing::Test {
+protected:
+    void SetUp() override {
+        SetEvalKeyFormat(EvalKeyFormat::SEEDED);
+    }
+
+    void TearDown() override {
+        SetEvalKeyFormat(EvalKeyFormat::FULL);
+        std::remove(m_path.c_str());
+        CryptoContextImpl<DCRTPoly>::ClearEvalMultKeys();
+        CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys();
+        CryptoContextFactory<DCRTPoly>::ReleaseAllContexts();
+    }
+
+    // Seeded keys of the tag: the relinearization key, then the rotation keys
+    static std::vector<std::shared_ptr<SeededEvalKeyRelin>> SeededKeys(const std::string& tag) {
+        std::vector<std::shared_ptr<SeededEvalKeyRelin>> keys;
+        for (const auto& key : CryptoContextImpl<DCRTPoly>::GetEvalMultKeyVector(tag))
+            keys.push_back(std::dynamic_pointer_cast<SeededEvalKeyRelin>(key));
+        for (const auto& [_, key] : CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag))
+            keys.push_back(std::dynamic_pointer_cast<SeededEvalKeyRelin>(key));
+        return keys;
+    }
+
+    // EvalMult and EvalRotate with seeded keys decrypt correctly without expanding a,
+    // and give the same ciphertexts once a is expanded
+    template <typename MakePlaintext, typename CheckSlots>
+    void Evaluate(const CryptoContext<DCRTPoly>& cc, MakePlaintext&& make, CheckSlots&& check) {
+        auto keys = cc->KeyGen();
+        cc->EvalMultKeyGen(keys.secretKey);
+        cc->EvalRotateKeyGen(keys.secretKey, {1, -2});
+        const auto tag = keys.secretKey->GetKeyTag();
+
+        const auto seeded = SeededKeys(tag);
+        ASSERT_EQ(seeded.size(), 3U);
+        for (const auto& key : seeded) {
+            ASSERT_TRUE(key != nullptr);
+            EXPECT_FALSE(key->IsExpanded());
+        }
+
+        const auto ct      = cc->Encrypt(keys.publicKey, make());
+        const auto product = cc->EvalMult(ct, ct);
+        const auto rotated = cc->EvalRotate(ct, 1);
+        for (const auto& key : seeded)
+            EXPECT_FALSE(key->IsExpanded()) << "key switching expanded a";
+
+        Plaintext result;
+        cc->Decrypt(keys.secretKey, product, &result);
+        check(result, 0, true);
+        cc->Decrypt(keys.secretKey, rotated, &result);
+        check(result, 1, false);
+
+        for (const auto& key : seeded) {
+            EXPECT_EQ(key->GetAVector().size(), key->GetBVector().size());
+            EXPECT_TRUE(key->IsExpanded());
+        }
+        EXPECT_TRUE(*cc->EvalMult(ct, ct) == *product);
+        EXPECT_TRUE(*cc->EvalRotate(ct, 1) == *rotated);
+    }
+
+    const std::string m_path{"UTSeededEvalKey.keys"};
+};
+
+TEST_F(UTSeededEvalKey, ckks_hybrid) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(3);
+    parameters.SetScalingModSize(40);
+    parameters.SetBatchSize(8);
+    parameters.SetNumLargeDigits(2);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    const std::vector<double> x{1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0};
+    Evaluate(
+        cc, [&] { return cc->MakeCKKSPackedPlaintext(x); },
+        [&](Plaintext& result, size_t shift, bool square) {
+            result->SetLength(x.size());
+            const auto values = result->GetRealPackedValue();
+            for (size_t i = 0; i < x.size(); ++i) {
+                const double v = x[(i + shift) % x.size()];
+                EXPECT_NEAR(values[i], square ? v * v : v, 1e-3) << "slot " << i;
+            }
+        });
+}
+
+TEST_F(UTSeededEvalKey, bgv_and_bfv_hybrid) {
+    const std::vector<int64_t> x{1, 2, 3, 4, 5, 6, 7, 8};
+    // the rotation is over all N/2 slots of a row: the last slot gets a zero
+    auto check = [&](Plaintext& result, size_t shift, bool square) {
+        const auto& values = result->GetPackedValue();
+        for (size_t i = 0; i + shift < x.size(); ++i) {
+            const int64_t v = x[i + shift];
+            EXPECT_EQ(values[i], square ? v * v : v) << "slot " << i;
+        }
+    };
+
+    CCParams<CryptoContextBGVRNS> bgv;
+    bgv.SetSecurityLevel(HEStd_NotSet);
+    bgv.SetRingDim(1 << 10);
+    bgv.SetMultiplicativeDepth(2);
+    bgv.SetPlaintextModulus(65537);
+    bgv.SetBatchSize(8);
+    auto cc = GenCryptoContext(bgv);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+    Evaluate(cc, [&] { return cc->MakePackedPlaintext(x); }, check);
+
+    CCParams<CryptoContextBFVRNS> bfv;
+    bfv.SetSecurityLevel(HEStd_NotSet);
+    bfv.SetRingDim(1 << 10);
+    bfv.SetMultiplicativeDepth(2);
+    bfv.SetPlaintextModulus(65537);
+    bfv.SetBatchSize(8);
+    bfv.SetKeySwitchTechnique(HYBRID);
+    auto ccBfv = GenCryptoContext(bfv);
+    ccBfv->Enable(PKE);
+    ccBfv->Enable(KEYSWITCH);
+    ccBfv->Enable(LEVELEDSHE);
+    Evaluate(ccBfv, [&] { return ccBfv->MakePackedPlaintext(x); }, check);
+}
+
+TEST_F(UTSeededEvalKey, compare_and_key_store) {
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(1 << 10);
+    parameters.SetMultiplicativeDepth(2);
+    parameters.SetScalingModSize(40);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    cc->EvalRotateKeyGen(keys.secretKey, {1, 2});
+    const auto tag      = keys.secretKey->GetKeyTag();
+    const auto original = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMapPtr(tag);
+    const auto first    = std::dynamic_pointer_cast<SeededEvalKeyRelin>(original->begin()->second);
+    const auto second   = std::dynamic_pointer_cast<SeededEvalKeyRelin>(original->rbegin()->second);
+    ASSERT_TRUE(first != nullptr && second != nullptr);
+    EXPECT_FALSE(first->GetSeed() == second->GetSeed());
+    EXPECT_FALSE(*first == *second);
+
+    // the same seed and b give the same key, compared without expanding a
+    auto copy = std::make_shared<SeededEvalKeyRelin>(cc);
+    copy->SetBVector(first->GetBVector());
+    copy->SetSeed(first->GetSeed());
+    copy->SetKeyTag(first->GetKeyTag());
+    EXPECT_TRUE(*copy == *first);
+    EXPECT_FALSE(first->IsExpanded());
+
+    // the key store keeps full keys: a is expanded when written
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::SerializeEvalAutomorphismKeyStore(m_path, tag));
+    CryptoContextImpl<DCRTPoly>::ClearEvalAutomorphismKeys();
+    ASSERT_TRUE(CryptoContextImpl<DCRTPoly>::DeserializeEvalAutomorphismKeyStore(m_path, cc));
+    const auto& loaded = CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(tag);
+    ASSERT_EQ(loaded.size(), original->size());
+    for (const auto& [index, key] : *original) {
+        const auto it = loaded.find(index);
+        ASSERT_TRUE(it != loaded.end()) << "index " << index;
+        EXPECT_TRUE(*key == *it->second) << "index " << index;
+    }
+}
+
+#ifdef OPENFHE_FPGA_SIM
+TEST_F(UTSeededEvalKey, device_key_switch_does_not_cache_a) {
+    // the simulator's shape: N = FPGA_RING_DIM, one digit of 2 Q towers and 2 P towers (as UTHKSFused)
+    CCParams<CryptoContextCKKSRNS> parameters;
+    parameters.SetSecurityLevel(HEStd_NotSet);
+    parameters.SetRingDim(FPGA_RING_DIM);
+    parameters.SetMultiplicativeDepth(1);
+    parameters.SetScalingModSize(50);
+    parameters.SetScalingTechnique(FIXEDMANUAL);
+    parameters.SetNumLargeDigits(1);
+    parameters.SetBatchSize(8);
+    parameters.SetKeySwitchTechnique(HYBRID);
+    auto cc = GenCryptoContext(parameters);
+    cc->Enable(PKE);
+    cc->Enable(KEYSWITCH);
+    cc->Enable(LEVELEDSHE);
+
+    auto keys = cc->KeyGen();
+    cc->EvalRotateKeyGen(keys.secretKey, {1});
+    const auto ct       = cc->Encrypt(keys.publicKey, cc->MakeCKKSPackedPlaintext(std::vector<double>{1.0, 2.0}));
+    const auto expected = cc->EvalRotate(ct, 1);
+
+    std::vector<uint64_t> q, p, qr, pr;
+    for (const auto& t : cc->GetElementParams()->GetParams()) {
+        q.push_back(t->GetModulus().ConvertToInt());
+        qr.push_back(t->GetRootOfUnity().ConvertToInt());
+    }
+    const auto cryptoParams = std::dynamic_pointer_cast<CryptoParametersCKKSRNS>(cc->GetCryptoParameters());
+    for (const auto& t : cryptoParams->GetParamsP()->GetParams()) {
+        p.push_back(t->GetModulus().ConvertToInt());
+        pr.push_back(t->GetRootOfUnity().ConvertToInt());
+    }
+    PolyAccelerator::Set(PolyAccelerator::Create("sim"));
+    PolyAccelerator::Get()->InitModuli(q, p, qr, pr, FPGA_RING_DIM);
+    SetHKSStrategy(HKSStrategy::FUSED);
+
+    const auto actual = cc->EvalRotate(ct, 1);
+    SetHKSStrategy(HKSStrategy::DC);
+    PolyAccelerator::Set(nullptr);
+
+    EXPECT_TRUE(*actual == *expected);
+    for (const auto& [_, key] : CryptoContextImpl<DCRTPoly>::GetEvalAutomorphismKeyMap(keys.secretKey->GetKeyTag())) {
+        const auto seeded = std::dynamic_pointer_cast<SeededEvalKeyRelin>(key);
+        ASSERT_TRUE(seeded != nullptr);
+        EXPECT_FALSE(seeded->IsExpanded());
+    }
+}
+#endif